@@ -0,0 +1,90 @@
+// MIT License
+//
+// Copyright(c) 2022-2023 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "pch.h"
+
+#include "allocations.h"
+#include "log.h"
+#include "metrics.h"
+
+namespace {
+
+    using namespace openxr_api_layer;
+    using namespace openxr_api_layer::log;
+
+    // Name of the per-frame call running on the thread, if any.
+    thread_local const char* t_hotPathName = nullptr;
+    std::atomic<bool> g_isWarmedUp{false};
+#ifdef _DEBUG
+    std::atomic<bool> g_wasReported{false};
+#endif
+
+    void onHotPathAllocation(size_t size) {
+        metrics::Increment(metrics::Counter::HotPathAllocations);
+        TraceLoggingWrite(g_traceProvider, "HotPathAllocation", TLArg(t_hotPathName, "Call"), TLArg(size, "Size"));
+
+#ifdef _DEBUG
+        if (!g_wasReported.exchange(true, std::memory_order_relaxed)) {
+            // Logging allocates too.
+            const char* const name = t_hotPathName;
+            t_hotPathName = nullptr;
+            ErrorLog(fmt::format("{}: heap allocation of {} bytes after warm-up\n", name, size));
+            t_hotPathName = name;
+        }
+#endif
+    }
+
+} // namespace
+
+namespace openxr_api_layer::allocations {
+
+    HotPathScope::HotPathScope(const char* name) : m_previousName(t_hotPathName) {
+        t_hotPathName = name;
+    }
+
+    HotPathScope::~HotPathScope() {
+        t_hotPathName = m_previousName;
+    }
+
+    void SetWarmedUp(bool warmedUp) {
+        g_isWarmedUp.store(warmedUp, std::memory_order_relaxed);
+    }
+
+} // namespace openxr_api_layer::allocations
+
+// Replacements for the global operators of the layer module. The array and nothrow forms use these.
+void* operator new(size_t size) {
+    if (t_hotPathName && g_isWarmedUp.load(std::memory_order_relaxed)) {
+        onHotPathAllocation(size);
+    }
+
+    void* const pointer = malloc(size ? size : 1);
+    if (!pointer) {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void operator delete(void* pointer) noexcept {
+    free(pointer);
+}
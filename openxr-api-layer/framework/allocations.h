@@ -0,0 +1,48 @@
+// MIT License
+//
+// Copyright(c) 2022-2023 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+// Verification that the per-frame calls of the layer do not allocate once warmed up. The global operator new of the
+// layer counts the allocations made by a thread while it runs a per-frame call (see HotPathScope) in the
+// HotPathAllocations metric, and debug builds log the first offending call. Only the allocations of the layer are seen,
+// not those of the runtime or of the application. The PerFramePathDoesNotAllocate test fails on any of them.
+namespace openxr_api_layer::allocations {
+
+    // Marks the calling thread as running the given per-frame call, until destroyed. Scopes may be nested.
+    class HotPathScope {
+      public:
+        explicit HotPathScope(const char* name);
+        ~HotPathScope();
+
+        HotPathScope(const HotPathScope&) = delete;
+        HotPathScope& operator=(const HotPathScope&) = delete;
+
+      private:
+        const char* const m_previousName;
+    };
+
+    // Allocations are only counted once the caches filled during the first frames of a session are populated.
+    void SetWarmedUp(bool warmedUp);
+
+} // namespace openxr_api_layer::allocations
@@ -0,0 +1,325 @@
+// MIT License
+//
+// Copyright(c) 2022-2023 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include <charconv>
+
+#include <utils.h>
+
+#include "config.h"
+#include "log.h"
+
+namespace {
+
+    using namespace openxr_api_layer;
+    using namespace openxr_api_layer::config;
+    using namespace openxr_api_layer::log;
+
+    const std::string RegistryKey = "SOFTWARE\\OpenXR-Eye-Trackers";
+
+    bool parseValue(const std::string& text, bool& value) {
+        if (text == "1" || !_stricmp(text.c_str(), "true")) {
+            value = true;
+            return true;
+        }
+        if (text == "0" || !_stricmp(text.c_str(), "false")) {
+            value = false;
+            return true;
+        }
+        return false;
+    }
+
+    // The value is left untouched unless the whole text is valid.
+    bool parseValue(const std::string& text, uint32_t& value) {
+        const char* const end = text.data() + text.size();
+        uint32_t parsed;
+        const auto result = std::from_chars(text.data(), end, parsed);
+        if (result.ec != std::errc() || result.ptr != end) {
+            return false;
+        }
+        value = parsed;
+        return true;
+    }
+
+    bool parseValue(const std::string& text, uint16_t& value) {
+        uint32_t wideValue;
+        if (!parseValue(text, wideValue) || wideValue > std::numeric_limits<uint16_t>::max()) {
+            return false;
+        }
+        value = static_cast<uint16_t>(wideValue);
+        return true;
+    }
+
+    bool parseValue(const std::string& text, uint64_t& value) {
+        // Masks are more readable in hexadecimal.
+        const bool isHexadecimal = text.size() > 2 && text[0] == '0' && (text[1] == 'x' || text[1] == 'X');
+        const char* const begin = text.data() + (isHexadecimal ? 2 : 0);
+        const char* const end = text.data() + text.size();
+        uint64_t parsed;
+        const auto result = std::from_chars(begin, end, parsed, isHexadecimal ? 16 : 10);
+        if (result.ec != std::errc() || result.ptr != end) {
+            return false;
+        }
+        value = parsed;
+        return true;
+    }
+
+    bool parseValue(const std::string& text, float& value) {
+        const char* const end = text.data() + text.size();
+        float parsed;
+        const auto result = std::from_chars(text.data(), end, parsed);
+        if (result.ec != std::errc() || result.ptr != end || !std::isfinite(parsed)) {
+            return false;
+        }
+        value = parsed;
+        return true;
+    }
+
+    bool parseValue(const std::string& text, std::chrono::milliseconds& value) {
+        uint32_t milliseconds;
+        if (!parseValue(text, milliseconds)) {
+            return false;
+        }
+        value = std::chrono::milliseconds(milliseconds);
+        return true;
+    }
+
+    bool parseValue(const std::string& text, utils::general::ThreadPriority& value) {
+        using utils::general::ThreadPriority;
+        static const std::pair<const char*, ThreadPriority> priorities[] = {
+            {"Normal", ThreadPriority::Normal},
+            {"AboveNormal", ThreadPriority::AboveNormal},
+            {"Highest", ThreadPriority::Highest},
+            {"TimeCritical", ThreadPriority::TimeCritical},
+            {"MMCSS", ThreadPriority::Mmcss},
+        };
+        for (const auto& [name, priority] : priorities) {
+            if (!_stricmp(text.c_str(), name)) {
+                value = priority;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool parseValue(const std::string& text, std::filesystem::path& value) {
+        value = std::filesystem::u8path(text);
+        return true;
+    }
+
+    // Settings that existed before the file are also read from the registry.
+    enum class RegistryType {
+        None,
+        Dword,
+        String,
+    };
+
+    struct SettingDescriptor {
+        const char* name;
+        RegistryType registryType;
+        bool (*parse)(Settings& settings, const std::string& text);
+    };
+
+    template <auto Member>
+    SettingDescriptor makeSetting(const char* name, RegistryType registryType) {
+        return {name, registryType, [](Settings& settings, const std::string& text) {
+                    return parseValue(text, settings.*Member);
+                }};
+    }
+
+    const SettingDescriptor k_settings[] = {
+        makeSetting<&Settings::simulateTracker>("SimulateTracker", RegistryType::Dword),
+        makeSetting<&Settings::recordTracker>("RecordTracker", RegistryType::Dword),
+        makeSetting<&Settings::recordQuantized>("RecordQuantized", RegistryType::None),
+        makeSetting<&Settings::replayTracker>("ReplayTracker", RegistryType::String),
+        makeSetting<&Settings::replayRealTime>("ReplayRealTime", RegistryType::Dword),
+        makeSetting<&Settings::replayStartSeconds>("ReplayStartSeconds", RegistryType::Dword),
+        makeSetting<&Settings::shareTracker>("ShareTracker", RegistryType::None),
+        makeSetting<&Settings::minimumConfidence>("MinimumConfidence", RegistryType::None),
+        makeSetting<&Settings::sampleTimeout>("SampleTimeoutMs", RegistryType::None),
+        makeSetting<&Settings::steamLinkPort>("SteamLinkPort", RegistryType::None),
+        makeSetting<&Settings::vrchatOscPort>("VRChatOSCPort", RegistryType::None),
+        makeSetting<&Settings::acquisitionThreadPriority>("AcquisitionThreadPriority", RegistryType::None),
+        makeSetting<&Settings::acquisitionThreadAffinity>("AcquisitionThreadAffinity", RegistryType::None),
+        makeSetting<&Settings::gazeLayerPicking>("GazeLayerPicking", RegistryType::Dword),
+        makeSetting<&Settings::quadViews>("QuadViews", RegistryType::Dword),
+        makeSetting<&Settings::quadViewsFocusWidth>("QuadViewsFocusWidth", RegistryType::Dword),
+        makeSetting<&Settings::quadViewsFocusHeight>("QuadViewsFocusHeight", RegistryType::Dword),
+        makeSetting<&Settings::quadViewsContextDensity>("QuadViewsContextDensity", RegistryType::Dword),
+        makeSetting<&Settings::quadViewsFocusDensity>("QuadViewsFocusDensity", RegistryType::Dword),
+    };
+
+    std::string_view trim(std::string_view text) {
+        const size_t first = text.find_first_not_of(" \t\r");
+        if (first == std::string_view::npos) {
+            return {};
+        }
+        return text.substr(first, text.find_last_not_of(" \t\r") - first + 1);
+    }
+
+    void readRegistry(Settings& settings) {
+        for (const auto& setting : k_settings) {
+            if (setting.registryType == RegistryType::Dword) {
+                if (const auto value = utilities::RegGetDword(HKEY_LOCAL_MACHINE, RegistryKey, setting.name)) {
+                    setting.parse(settings, std::to_string(value.value()));
+                }
+            } else if (setting.registryType == RegistryType::String) {
+                if (const auto value = utilities::RegGetString(HKEY_LOCAL_MACHINE, RegistryKey, setting.name)) {
+                    setting.parse(settings, std::filesystem::path(value.value()).u8string());
+                }
+            }
+        }
+    }
+
+    void readFile(const std::filesystem::path& path, Settings& settings) {
+        std::ifstream file(path);
+        std::string line;
+        uint32_t lineNumber = 0;
+        while (std::getline(file, line)) {
+            lineNumber++;
+
+            const std::string_view content = trim(line);
+            if (content.empty() || content[0] == '#' || content[0] == ';' || content[0] == '[') {
+                continue;
+            }
+
+            const size_t separator = content.find('=');
+            if (separator == std::string_view::npos) {
+                ErrorLog(fmt::format("{}({}): expected \"Name = value\"\n", path.filename().string(), lineNumber));
+                continue;
+            }
+
+            const std::string name(trim(content.substr(0, separator)));
+            const std::string value(trim(content.substr(separator + 1)));
+            const auto setting = std::find_if(std::cbegin(k_settings),
+                                              std::cend(k_settings),
+                                              [&](const SettingDescriptor& setting) {
+                                                  return !_stricmp(setting.name, name.c_str());
+                                              });
+            if (setting == std::cend(k_settings)) {
+                ErrorLog(fmt::format("{}({}): unknown setting {}\n", path.filename().string(), lineNumber, name));
+            } else if (!setting->parse(settings, value)) {
+                ErrorLog(fmt::format(
+                    "{}({}): invalid value \"{}\" for {}\n", path.filename().string(), lineNumber, value, name));
+            } else {
+                Log(fmt::format("Setting {} = {}\n", setting->name, value));
+            }
+        }
+    }
+
+    const Settings k_defaultSettings;
+    std::atomic<const Settings*> g_settings{&k_defaultSettings};
+
+    // Readers hold on to plain references, so the snapshots are never freed. The settings only change upon user
+    // interaction.
+    std::mutex g_snapshotsMutex;
+    std::vector<std::unique_ptr<const Settings>> g_snapshots;
+
+    struct SettingsWatcher : ISettingsWatcher {
+        SettingsWatcher(const std::filesystem::path& path) : m_path(path), m_lastWriteTime(getLastWriteTime(path)) {
+            m_stopEvent.create(wil::EventOptions::ManualReset);
+            m_changeNotification.reset(FindFirstChangeNotificationW(
+                path.parent_path().c_str(), FALSE, FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME));
+            if (!m_changeNotification) {
+                throw std::runtime_error("Failed to watch the settings file");
+            }
+
+            m_watcherThread = std::thread([&]() { watch(); });
+        }
+
+        ~SettingsWatcher() override {
+            m_stopEvent.SetEvent();
+            m_watcherThread.join();
+        }
+
+        void watch() {
+            TraceLocalActivity(local);
+            TraceLoggingWriteStart(local, "SettingsWatcher");
+
+            const HANDLE handles[] = {m_stopEvent.get(), m_changeNotification.get()};
+            while (WaitForMultipleObjects(ARRAYSIZE(handles), handles, FALSE, INFINITE) == WAIT_OBJECT_0 + 1) {
+                // Re-arm first, so that no change goes unnoticed while reloading.
+                if (!FindNextChangeNotification(m_changeNotification.get())) {
+                    ErrorLog("Stopped watching the settings file\n");
+                    break;
+                }
+
+                // Other files of the folder are written too (log, recordings), and editors may save in several
+                // steps: let the writes settle, then only reload when the settings file itself changed.
+                if (m_stopEvent.wait(100)) {
+                    break;
+                }
+
+                const auto lastWriteTime = getLastWriteTime(m_path);
+                if (lastWriteTime != m_lastWriteTime) {
+                    m_lastWriteTime = lastWriteTime;
+
+                    TraceLoggingWriteTagged(local, "SettingsWatcher_Reload");
+                    Log(fmt::format("Reloading settings from: {}\n", m_path.string()));
+                    LoadSettings(m_path);
+                }
+            }
+
+            TraceLoggingWriteStop(local, "SettingsWatcher");
+        }
+
+        static std::optional<std::filesystem::file_time_type> getLastWriteTime(const std::filesystem::path& path) {
+            std::error_code error;
+            const auto lastWriteTime = std::filesystem::last_write_time(path, error);
+            if (error) {
+                return {};
+            }
+            return lastWriteTime;
+        }
+
+        const std::filesystem::path m_path;
+        std::optional<std::filesystem::file_time_type> m_lastWriteTime;
+
+        wil::unique_event_nothrow m_stopEvent;
+        wil::unique_hfind_change m_changeNotification;
+        std::thread m_watcherThread;
+    };
+
+} // namespace
+
+namespace openxr_api_layer::config {
+
+    void LoadSettings(const std::filesystem::path& path) {
+        auto settings = std::make_unique<Settings>();
+        readRegistry(*settings);
+        readFile(path, *settings);
+
+        std::unique_lock lock(g_snapshotsMutex);
+        g_settings.store(settings.get(), std::memory_order_release);
+        g_snapshots.push_back(std::move(settings));
+    }
+
+    const Settings& GetSettings() {
+        return *g_settings.load(std::memory_order_acquire);
+    }
+
+    std::unique_ptr<ISettingsWatcher> WatchSettings(const std::filesystem::path& path) {
+        return std::make_unique<SettingsWatcher>(path);
+    }
+
+} // namespace openxr_api_layer::config
@@ -0,0 +1,88 @@
+// MIT License
+//
+// Copyright(c) 2022-2023 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <utils/general.h>
+
+// The settings of the layer, read from "settings.ini" in the local app data folder of the layer. Each line of the file
+// is a "Name = value" pair, lines starting with '#' or ';' are comments. The values under the registry key
+// HKLM\SOFTWARE\OpenXR-Eye-Trackers are still honored for the settings that existed before the file, and the file
+// takes precedence.
+//
+// Settings are published as immutable snapshots: reading them costs a single atomic load, and a snapshot remains valid
+// for the lifetime of the process. The file is watched for changes, and each setting documents when a new value takes
+// effect.
+namespace openxr_api_layer::config {
+
+    struct Settings {
+        // Tracker selection, upon xrGetSystem().
+        bool simulateTracker{false};
+        bool recordTracker{false};
+        // Record the directions as quantized angles: smaller captures, but replays are not bit-identical.
+        bool recordQuantized{false};
+        std::filesystem::path replayTracker;
+        bool replayRealTime{true};
+        uint32_t replayStartSeconds{0};
+        // The first process to open the eye tracker shares its samples with the processes started after it, which do
+        // not open the eye tracker themselves.
+        bool shareTracker{false};
+
+        // Samples with a lower confidence are discarded (HP Omnicept, Meta Quest Pro, Virtual Desktop). Immediately.
+        float minimumConfidence{0.5f};
+        // Trackers receiving samples asynchronously report the gaze as unavailable when no sample was received for
+        // this long (PlayStation VR2, Steam Link, VRChat OSC). Immediately.
+        std::chrono::milliseconds sampleTimeout{1000};
+        // UDP ports of the OSC trackers, when the tracker resumes (see IEyeTracker::setActive()).
+        uint16_t steamLinkPort{9015};
+        uint16_t vrchatOscPort{9020};
+        // Scheduling of the threads receiving samples (PlayStation VR2, Steam Link, VRChat OSC), when the tracker
+        // resumes. The priority is one of Normal, AboveNormal, Highest, TimeCritical or MMCSS. The affinity is a mask of
+        // logical processors (eg: 0x30 for processors 4 and 5), 0 to run on any processor.
+        utils::general::ThreadPriority acquisitionThreadPriority{utils::general::ThreadPriority::Normal};
+        uint64_t acquisitionThreadAffinity{0};
+
+        // Upon xrCreateSession().
+        bool gazeLayerPicking{false};
+
+        // XR_VARJO_quad_views emulation, upon xrCreateInstance(). Sizes and densities are in percent.
+        bool quadViews{true};
+        uint32_t quadViewsFocusWidth{35};
+        uint32_t quadViewsFocusHeight{35};
+        uint32_t quadViewsContextDensity{40};
+        uint32_t quadViewsFocusDensity{100};
+    };
+
+    // Read the registry and the file, and publish the resulting snapshot.
+    void LoadSettings(const std::filesystem::path& path);
+
+    // The latest snapshot, or the defaults before LoadSettings() is called.
+    const Settings& GetSettings();
+
+    struct ISettingsWatcher {
+        virtual ~ISettingsWatcher() = default;
+    };
+
+    // Reload the settings each time the file is modified, from a background thread, until the watcher is destroyed.
+    std::unique_ptr<ISettingsWatcher> WatchSettings(const std::filesystem::path& path);
+
+} // namespace openxr_api_layer::config
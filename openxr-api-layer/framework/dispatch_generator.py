@@ -38,6 +38,8 @@ from xrconventions import OpenXRConventions
 # Import configuration.
 import layer_apis
 
+instrument_functions = getattr(layer_apis, 'instrument_functions', False)
+
 # Sanity checks on the configuration file
 for func in ['xrCreateInstance', 'xrDestroyInstance', 'xrEnumerateInstanceExtensionProperties']:
     if func in layer_apis.override_functions:
@@ -113,6 +115,8 @@ class DispatchGenCppOutputGenerator(DispatchGenOutputGenerator):
 
 #include "dispatch.h"
 #include "log.h"
+#include "metrics.h"
+#include "stats.h"
 
 using namespace openxr_api_layer::log;
 
@@ -124,6 +128,7 @@ namespace openxr_api_layer
         generated_wrappers = self.genWrappers()
         generated_get_instance_proc_addr = self.genGetInstanceProcAddr()
         generated_create_instance = self.genCreateInstance()
+        generated_function_stats = self.genFunctionStats()
 
         postamble = '''	std::unique_ptr<OpenXrApi> g_instance;
 
@@ -144,6 +149,9 @@ namespace openxr_api_layer
 	// Auto-generated create instance handler.
 {generated_create_instance}
 
+	// Auto-generated statistics accessor.
+{generated_function_stats}
+
 {postamble}'''
 
         write(contents, file=self.outFile)
@@ -157,11 +165,22 @@ namespace openxr_api_layer
                 parameters_list = self.makeParametersList(cur_cmd)
                 arguments_list = self.makeArgumentsList(cur_cmd)
 
+                stats_scope = ''
+                stats_result = ''
+                if instrument_functions:
+                    generated += f'''
+	stats::FunctionStats g_{cur_cmd.name}Stats("{cur_cmd.name}");
+'''
+                    stats_scope = f'''		stats::EntryPointScope statsScope(g_{cur_cmd.name}Stats);
+'''
+                    stats_result = '''		statsScope.setResult(result);
+'''
+
                 if cur_cmd.return_type is not None:
                     generated += f'''
 	XrResult XRAPI_CALL {cur_cmd.name}({parameters_list})
 	{{
-		TraceLocalActivity(local);
+{stats_scope}		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "{cur_cmd.name}");
 
 		XrResult result;
@@ -173,11 +192,12 @@ namespace openxr_api_layer
 		{{
 			TraceLoggingWriteTagged(local, "{cur_cmd.name}_Error", TLArg(exc.what(), "Error"));
 			ErrorLog(fmt::format("{cur_cmd.name}: {{}}\\n", exc.what()));
+			metrics::Increment(metrics::Counter::Exceptions);
 			result = XR_ERROR_RUNTIME_FAILURE;
 		}}
 
 		TraceLoggingWriteStop(local, "{cur_cmd.name}", TLArg(xr::ToCString(result), "Result"));
-		if (XR_FAILED(result)) {{
+{stats_result}		if (XR_FAILED(result)) {{
 			ErrorLog(fmt::format("{cur_cmd.name} failed with {{}}\\n", xr::ToCString(result)));
 		}}
 
@@ -188,7 +208,7 @@ namespace openxr_api_layer
                     generated += f'''
 	void XRAPI_CALL {cur_cmd.name}({parameters_list})
 	{{
-		TraceLocalActivity(local);
+{stats_scope}		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "{cur_cmd.name}");
 
 		try
@@ -199,6 +219,7 @@ namespace openxr_api_layer
 		{{
 			TraceLoggingWriteTagged(local, "{cur_cmd.name}_Error", TLArg(exc.what(), "Error"));
 			ErrorLog(fmt::format("{cur_cmd.name}: {{}}\\n", exc.what()));
+			metrics::Increment(metrics::Counter::Exceptions);
 		}}
 
 		TraceLoggingWriteStop(local, "{cur_cmd.name}"));
@@ -207,6 +228,23 @@ namespace openxr_api_layer
                 
         return generated
 
+    def genFunctionStats(self):
+        stats_list = ''
+        if instrument_functions:
+            for cur_cmd in self.core_commands + self.ext_commands:
+                if cur_cmd.name in (layer_apis.override_functions + ['xrDestroyInstance', 'xrEnumerateInstanceExtensionProperties']):
+                    stats_list += f'''
+			&g_{cur_cmd.name}Stats,'''
+
+        generated = f'''	const std::vector<const stats::FunctionStats*>& stats::GetFunctionStats()
+	{{
+		static const std::vector<const FunctionStats*> allStats{{{stats_list}
+		}};
+		return allStats;
+	}}'''
+
+        return generated
+
     def genCreateInstance(self):
         generated = '''	XrResult OpenXrApi::xrCreateInstance(const XrInstanceCreateInfo* createInfo)
     {
@@ -284,7 +322,7 @@ class DispatchGenHOutputGenerator(DispatchGenOutputGenerator):
     def beginFile(self, genOpts):
         DispatchGenOutputGenerator.beginFile(self, genOpts)
         preamble = '''#pragma once
-
+{stats_include}
 namespace openxr_api_layer
 {
 
@@ -340,7 +378,7 @@ namespace openxr_api_layer
 		virtual XrResult xrDestroyInstance(XrInstance instance) {
 			// Invoking ResetInstance() is equivalent to `delete this;' so we must take precautions.
 			PFN_xrDestroyInstance finalDestroyInstance = m_xrDestroyInstance;
-			ResetInstance();
+{stats_dump}			ResetInstance();
 			return finalDestroyInstance(instance);
 		}
 
@@ -350,29 +388,45 @@ namespace openxr_api_layer
 																uint32_t propertyCapacityInput,
 																uint32_t* propertyCountOutput,
 																XrExtensionProperties* properties) {
-			XrResult result = XR_ERROR_RUNTIME_FAILURE;
+			XrResult result = XR_SUCCESS;
+			std::vector<XrExtensionProperties> extensions;
 			if (!layerName || std::string_view(layerName) != LAYER_NAME) {
-				result = m_xrEnumerateInstanceExtensionProperties(layerName, propertyCapacityInput, propertyCountOutput, properties);
+				uint32_t count = 0;
+				result = m_xrEnumerateInstanceExtensionProperties(layerName, 0, &count, nullptr);
+				if (XR_SUCCEEDED(result)) {
+					extensions.resize(count, {XR_TYPE_EXTENSION_PROPERTIES});
+					result = m_xrEnumerateInstanceExtensionProperties(layerName, count, &count, extensions.data());
+					extensions.resize(count);
+				}
 			}
 
 			if (XR_SUCCEEDED(result)) {
 				if (!layerName || std::string_view(layerName) == LAYER_NAME) {
-					const uint32_t baseOffset = *propertyCountOutput;
-					*propertyCountOutput += (uint32_t)advertisedExtensions.size();
-					if (propertyCapacityInput) {
-						if (propertyCapacityInput < *propertyCountOutput) {
-							result = XR_ERROR_SIZE_INSUFFICIENT;
-						} else {
-							result = XR_SUCCESS;
-							for (uint32_t i = baseOffset; i < *propertyCountOutput; i++) {
-								if (properties[i].type != XR_TYPE_EXTENSION_PROPERTIES) {
-									result = XR_ERROR_VALIDATION_FAILURE;
-									break;
-								}
-
-								strcpy_s(properties[i].extensionName, advertisedExtensions[i - baseOffset].first.c_str());
-								properties[i].extensionVersion = advertisedExtensions[i - baseOffset].second;
+					// Extensions implemented further down the chain are not advertised twice.
+					for (const auto& [extensionName, extensionVersion] : advertisedExtensions) {
+						if (std::none_of(extensions.cbegin(), extensions.cend(), [&](const XrExtensionProperties& extension) {
+								return extensionName == extension.extensionName;
+							})) {
+							XrExtensionProperties& extension = extensions.emplace_back(XrExtensionProperties{XR_TYPE_EXTENSION_PROPERTIES});
+							strcpy_s(extension.extensionName, extensionName.c_str());
+							extension.extensionVersion = extensionVersion;
+						}
+					}
+				}
+
+				*propertyCountOutput = (uint32_t)extensions.size();
+				if (propertyCapacityInput) {
+					if (propertyCapacityInput < *propertyCountOutput) {
+						result = XR_ERROR_SIZE_INSUFFICIENT;
+					} else {
+						for (uint32_t i = 0; i < *propertyCountOutput; i++) {
+							if (properties[i].type != XR_TYPE_EXTENSION_PROPERTIES) {
+								result = XR_ERROR_VALIDATION_FAILURE;
+								break;
 							}
+
+							strcpy_s(properties[i].extensionName, extensions[i].extensionName);
+							properties[i].extensionVersion = extensions[i].extensionVersion;
 						}
 					}
 				}
@@ -388,6 +442,9 @@ namespace openxr_api_layer
 		PFN_xrDestroyInstance m_xrDestroyInstance{nullptr};
 		PFN_xrEnumerateInstanceExtensionProperties m_xrEnumerateInstanceExtensionProperties{nullptr};
 '''
+        # Not using an f-string above to keep the braces readable.
+        preamble = preamble.replace('{stats_include}', '\n#include "stats.h"\n' if instrument_functions else '')
+        preamble = preamble.replace('{stats_dump}', '\t\t\tstats::LogFunctionStats();\n' if instrument_functions else '')
         write(preamble, file=self.outFile)
 
     def endFile(self):
@@ -420,6 +477,11 @@ namespace openxr_api_layer
                 parameters_list = self.makeParametersList(cur_cmd)
                 arguments_list = self.makeArgumentsList(cur_cmd)
 
+                stats_scope = ''
+                if instrument_functions:
+                    stats_scope = '''			stats::DownstreamScope statsScope;
+'''
+
                 generated += '''
 	public:'''
 
@@ -427,14 +489,14 @@ namespace openxr_api_layer
                     generated += f'''
 		virtual XrResult {cur_cmd.name}({parameters_list})
 		{{
-			return m_{cur_cmd.name}({arguments_list});
+{stats_scope}			return m_{cur_cmd.name}({arguments_list});
 		}}
 '''
                 else:
                     generated += f'''
 		virtual void {cur_cmd.name}({parameters_list})
 		{{
-			m_{cur_cmd.name}({arguments_list});
+{stats_scope}			m_{cur_cmd.name}({arguments_list});
 		}}
 '''
 
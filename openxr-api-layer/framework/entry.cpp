@@ -26,6 +26,7 @@
 
 #include "dispatch.h"
 #include "log.h"
+#include "metrics.h"
 #include "version.h"
 
 namespace openxr_api_layer {
@@ -35,11 +36,6 @@ namespace openxr_api_layer {
     // The path that is writable (eg: to store logs).
     std::filesystem::path localAppData;
 
-    namespace log {
-        // The file logger.
-        std::ofstream logStream;
-    } // namespace log
-
     const std::string VersionString = fmt::format("v{}.{}.{}", LayerVersionMajor, LayerVersionMinor, LayerVersionPatch);
 
 } // namespace openxr_api_layer
@@ -72,10 +68,10 @@ XrResult __declspec(dllexport) XRAPI_CALL
     CreateDirectoryA(localAppData.string().c_str(), nullptr);
 
     // Start logging to file.
-    if (!logStream.is_open()) {
-        std::string logFile = (localAppData / (LayerPrettyName + ".log")).string();
-        logStream.open(logFile, std::ios_base::ate);
-    }
+    StartLogging(localAppData / (LayerPrettyName + ".log"));
+
+    // Make live metrics available to monitoring tools.
+    metrics::ExportMetrics();
 
     DebugLog("--> xrNegotiateLoaderApiLayerInterface\n");
 
@@ -5,15 +5,32 @@ override_functions = [
     "xrSuggestInteractionProfileBindings",
     "xrCreateSession",
     "xrDestroySession",
+    "xrPollEvent",
+    "xrEnumerateViewConfigurations",
+    "xrGetViewConfigurationProperties",
+    "xrEnumerateViewConfigurationViews",
+    "xrEnumerateEnvironmentBlendModes",
+    "xrBeginSession",
+    "xrCreateSwapchain",
+    "xrDestroySwapchain",
+    "xrAcquireSwapchainImage",
+    "xrReleaseSwapchainImage",
     "xrGetCurrentInteractionProfile",
     "xrCreateActionSpace",
     "xrDestroySpace",
+    "xrSyncActions",
     "xrGetActionStatePose",
     "xrWaitFrame",
     "xrBeginFrame",
+    "xrEndFrame",
     "xrLocateSpace",
+    "xrLocateViews",
     "xrEnumerateBoundSourcesForAction",
     "xrGetInputSourceLocalizedName",
+    "xrGetFoveationEyeTrackedStateMETA",
+    "xrCreateEyeTrackerFB",
+    "xrDestroyEyeTrackerFB",
+    "xrGetEyeGazesFB",
 ]
 
 # The list of OpenXR functions our layer will use from the runtime.
@@ -26,7 +43,13 @@ requested_functions = [
     "xrPathToString",
     "xrCreateEyeTrackerFB",
     "xrGetEyeGazesFB",
+    "xrConvertWin32PerformanceCounterToTimeKHR",
 ]
 
 # The list of OpenXR extensions our layer will either override or use.
-extensions = ['XR_EXT_eye_gaze_interaction', 'XR_FB_eye_tracking_social']
+extensions = ['XR_EXT_eye_gaze_interaction', 'XR_FB_eye_tracking_social', 'XR_META_foveation_eye_tracked', 'XR_KHR_win32_convert_performance_counter_time']
+
+# Whether to wrap every overriden function with call counters and latency histograms (see framework/stats.h).
+# The statistics are readable at runtime with stats::GetFunctionStats() and written to the log upon xrDestroyInstance().
+# When disabled, the generated dispatcher does not contain any instrumentation code.
+instrument_functions = False
@@ -22,13 +22,275 @@
 
 #include "pch.h"
 
+#include "log.h"
+
 namespace {
-    constexpr uint32_t k_maxLoggedErrors = 100;
-    uint32_t g_globalErrorCount = 0;
+    using openxr_api_layer::log::internal::ErrorLogSite;
+
+    // All call sites that suppressed errors at least once.
+    std::atomic<ErrorLogSite*> g_suppressingErrorLogSites{nullptr};
+
+    // Records are formatted by the caller directly into a slot of the queue.
+    constexpr size_t k_maxRecordLength = 1000;
+    constexpr uint32_t k_recordCount = 256; // Must be a power of two.
+
+    // Upon reaching this size, the log file is renamed with a .1.log suffix and a new file is started.
+    constexpr uint64_t k_maxLogFileSize = 16 * 1024 * 1024;
+    constexpr size_t k_maxBatchSize = 64 * 1024;
+
+    struct Record {
+        std::atomic<uint64_t> sequence;
+        std::time_t timestamp;
+        size_t length;
+        char text[k_maxRecordLength];
+    };
+
+    // A bounded multi-producer/single-consumer queue (after Dmitry Vyukov's bounded MPMC queue). Pushing never blocks:
+    // when the queue is full, beginPush() returns nullptr and the caller drops its record.
+    class RecordQueue {
+      public:
+        RecordQueue() {
+            for (uint32_t i = 0; i < k_recordCount; i++) {
+                m_records[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        Record* beginPush() {
+            uint64_t position = m_pushPosition.load(std::memory_order_relaxed);
+            while (true) {
+                Record& record = m_records[position & (k_recordCount - 1)];
+                const uint64_t sequence = record.sequence.load(std::memory_order_acquire);
+                const int64_t difference = static_cast<int64_t>(sequence - position);
+                if (difference == 0) {
+                    if (m_pushPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        return &record;
+                    }
+                } else if (difference < 0) {
+                    return nullptr;
+                } else {
+                    position = m_pushPosition.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        void endPush(Record* record) {
+            // Sequentially consistent to pair with the writer going idle (see AsyncLogger::writerThread()).
+            record->sequence.store(record->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_seq_cst);
+        }
+
+        // Only one thread at a time may pop records.
+        Record* beginPop() {
+            Record& record = m_records[m_popPosition & (k_recordCount - 1)];
+            if (record.sequence.load(std::memory_order_seq_cst) != m_popPosition + 1) {
+                return nullptr;
+            }
+            return &record;
+        }
+
+        void endPop(Record* record) {
+            record->sequence.store(m_popPosition + k_recordCount, std::memory_order_release);
+            m_popPosition++;
+        }
+
+      private:
+        Record m_records[k_recordCount];
+        alignas(64) std::atomic<uint64_t> m_pushPosition{0};
+        alignas(64) uint64_t m_popPosition{0};
+    };
+
+    // Callers only format their message and enqueue it. A background thread timestamps the records, sends them to the
+    // debugger and writes them to the file in batches.
+    class AsyncLogger {
+      public:
+        void log(const char* fmt, va_list va) {
+            Record* record = m_queue.beginPush();
+            if (!record) {
+                m_droppedRecords.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            record->timestamp = std::time(nullptr);
+            const int length = vsnprintf_s(record->text, sizeof(record->text), _TRUNCATE, fmt, va);
+            record->length = length >= 0 ? length : strlen(record->text);
+            m_queue.endPush(record);
+            wakeWriter();
+        }
+
+        void log(const std::string_view& text) {
+            Record* record = m_queue.beginPush();
+            if (!record) {
+                m_droppedRecords.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            record->timestamp = std::time(nullptr);
+            record->length = std::min(text.size(), sizeof(record->text) - 1);
+            memcpy(record->text, text.data(), record->length);
+            record->text[record->length] = 0;
+            m_queue.endPush(record);
+            wakeWriter();
+        }
+
+        void start(const std::filesystem::path& path) {
+            if (m_wakeEvent) {
+                return;
+            }
+
+            m_path = path;
+            openFile();
+
+            // Pin the DLL so that it is only unloaded upon process exit, after the writer thread is terminated.
+            HMODULE module;
+            GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS, (LPCSTR)&g_suppressingErrorLogSites, &module);
+
+            m_wakeEvent.create(wil::EventOptions::None);
+            std::thread([this] { writerThread(); }).detach();
+
+            m_previousExceptionFilter = SetUnhandledExceptionFilter(unhandledExceptionFilter);
+        }
+
+        // Synchronously write all pending records. Used when the writer thread cannot be relied upon.
+        void flush() {
+            // If the consumer could not be acquired (its owner was terminated or crashed), proceed anyway.
+            const bool acquired = acquireConsumer(100ms);
+            drain();
+            if (acquired) {
+                releaseConsumer();
+            }
+        }
+
+      private:
+        void wakeWriter() {
+            if (m_writerIdle.load(std::memory_order_seq_cst) && m_writerIdle.exchange(false)) {
+                SetEvent(m_wakeEvent.get());
+            }
+        }
+
+        void writerThread() {
+            while (true) {
+                m_writerIdle.store(true, std::memory_order_seq_cst);
+                acquireConsumer();
+                const bool isEmpty = !m_queue.beginPop();
+                releaseConsumer();
+                if (isEmpty) {
+                    WaitForSingleObject(m_wakeEvent.get(), 1000);
+                }
+                m_writerIdle.store(false, std::memory_order_relaxed);
+
+                acquireConsumer();
+                drain();
+                releaseConsumer();
+
+                openxr_api_layer::log::SummarizeSuppressedErrors();
+            }
+        }
+
+        bool acquireConsumer(std::optional<std::chrono::milliseconds> timeout = {}) {
+            const auto start = std::chrono::steady_clock::now();
+            while (m_consumerBusy.exchange(true, std::memory_order_acquire)) {
+                if (timeout && std::chrono::steady_clock::now() - start >= timeout.value()) {
+                    return false;
+                }
+                Sleep(1);
+            }
+            return true;
+        }
+
+        void releaseConsumer() {
+            m_consumerBusy.store(false, std::memory_order_release);
+        }
+
+        void drain() {
+            Record* record;
+            while ((record = m_queue.beginPop())) {
+                char timestamp[64];
+                std::tm localTime{};
+                localtime_s(&localTime, &record->timestamp);
+                std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S %z: ", &localTime);
+
+                m_line = timestamp;
+                m_line.append(record->text, record->length);
+                m_queue.endPop(record);
+
+                OutputDebugStringA(m_line.c_str());
+                m_batch += m_line;
+                if (m_batch.size() >= k_maxBatchSize) {
+                    writeBatch();
+                }
+            }
+
+            const uint64_t droppedRecords = m_droppedRecords.load(std::memory_order_relaxed);
+            if (droppedRecords != m_reportedDroppedRecords) {
+                m_batch += fmt::format("{} log records were dropped\n", droppedRecords - m_reportedDroppedRecords);
+                m_reportedDroppedRecords = droppedRecords;
+            }
+
+            writeBatch();
+        }
+
+        void writeBatch() {
+            if (m_batch.empty()) {
+                return;
+            }
+
+            if (m_file) {
+                DWORD written = 0;
+                WriteFile(m_file.get(), m_batch.data(), static_cast<DWORD>(m_batch.size()), &written, nullptr);
+                m_fileSize += written;
+                if (m_fileSize >= k_maxLogFileSize) {
+                    m_file.reset();
+                    std::filesystem::path rotatedPath = m_path;
+                    rotatedPath.replace_extension(".1" + m_path.extension().string());
+                    MoveFileExW(m_path.c_str(), rotatedPath.c_str(), MOVEFILE_REPLACE_EXISTING);
+                    openFile();
+                }
+            }
+            m_batch.clear();
+        }
+
+        void openFile() {
+            m_file.reset(CreateFileW(m_path.c_str(),
+                                     GENERIC_WRITE,
+                                     FILE_SHARE_READ | FILE_SHARE_DELETE,
+                                     nullptr,
+                                     CREATE_ALWAYS,
+                                     FILE_ATTRIBUTE_NORMAL,
+                                     nullptr));
+            m_fileSize = 0;
+        }
+
+        static LONG WINAPI unhandledExceptionFilter(EXCEPTION_POINTERS* exceptionInfo);
+
+        RecordQueue m_queue;
+        std::atomic<uint64_t> m_droppedRecords{0};
+        uint64_t m_reportedDroppedRecords{0};
+
+        std::atomic<bool> m_consumerBusy{false};
+        std::atomic<bool> m_writerIdle{false};
+        wil::unique_event_nothrow m_wakeEvent;
+
+        std::filesystem::path m_path;
+        wil::unique_hfile m_file;
+        uint64_t m_fileSize{0};
+        std::string m_line;
+        std::string m_batch;
+
+        LPTOP_LEVEL_EXCEPTION_FILTER m_previousExceptionFilter{nullptr};
+    };
+
+    AsyncLogger g_logger;
+
+    LONG WINAPI AsyncLogger::unhandledExceptionFilter(EXCEPTION_POINTERS* exceptionInfo) {
+        openxr_api_layer::log::Log("Unhandled exception 0x%08x\n", exceptionInfo->ExceptionRecord->ExceptionCode);
+        g_logger.flush();
+
+        return g_logger.m_previousExceptionFilter ? g_logger.m_previousExceptionFilter(exceptionInfo)
+                                                  : EXCEPTION_CONTINUE_SEARCH;
+    }
+
 } // namespace
 
 namespace openxr_api_layer::log {
-    extern std::ofstream logStream;
 
     // {cbf3adcd-42b1-4c38-830c-91980af201f8}
     TRACELOGGING_DEFINE_PROVIDER(g_traceProvider,
@@ -37,47 +299,101 @@ namespace openxr_api_layer::log {
 
     TraceLoggingActivity<g_traceProvider> g_traceActivity;
 
-    namespace {
-
-        // Utility logging function.
-        void InternalLog(const char* fmt, va_list va) {
-            const std::time_t now = std::time(nullptr);
+    void StartLogging(const std::filesystem::path& logFile) {
+        g_logger.start(logFile);
+    }
 
-            char buf[1024];
-            size_t offset = std::strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S %z: ", std::localtime(&now));
-            vsnprintf_s(buf + offset, sizeof(buf) - offset, _TRUNCATE, fmt, va);
-            OutputDebugStringA(buf);
-            if (logStream.is_open()) {
-                logStream << buf;
-                logStream.flush();
-            }
+    void FlushLog() {
+        for (ErrorLogSite* site = g_suppressingErrorLogSites.load(std::memory_order_acquire); site;
+             site = site->next) {
+            site->summarize(true);
         }
-    } // namespace
+        g_logger.flush();
+    }
 
     void Log(const char* fmt, ...) {
         va_list va;
         va_start(va, fmt);
-        InternalLog(fmt, va);
+        g_logger.log(fmt, va);
         va_end(va);
     }
 
-    void ErrorLog(const char* fmt, ...) {
-        if (g_globalErrorCount++ < k_maxLoggedErrors) {
+    void Log(const std::string_view& str) {
+        g_logger.log(str);
+    }
+
+    void SummarizeSuppressedErrors() {
+        for (ErrorLogSite* site = g_suppressingErrorLogSites.load(std::memory_order_acquire); site;
+             site = site->next) {
+            site->summarize(false);
+        }
+    }
+
+    namespace internal {
+
+        void LogError(const char* fmt, ...) {
             va_list va;
             va_start(va, fmt);
-            InternalLog(fmt, va);
+            g_logger.log(fmt, va);
             va_end(va);
-            if (g_globalErrorCount == k_maxLoggedErrors) {
-                Log("Maximum number of errors logged. Going silent.");
+        }
+
+        void LogError(const std::string_view& str) {
+            g_logger.log(str);
+        }
+
+        void ErrorLogSite::onSuppressed(uint32_t count) {
+            if (count == k_errorLogBurst && !m_registered.exchange(true, std::memory_order_relaxed)) {
+                next = g_suppressingErrorLogSites.load(std::memory_order_relaxed);
+                while (!g_suppressingErrorLogSites.compare_exchange_weak(
+                    next, this, std::memory_order_release, std::memory_order_relaxed)) {
+                }
             }
         }
-    }
+
+        bool ErrorLogSite::onNewWindow(uint64_t window) {
+            // We already counted one occurrence in the old window, which we now need to move into the new window.
+            uint64_t state = m_state.load(std::memory_order_relaxed);
+            while ((state >> 32) != window) {
+                if (m_state.compare_exchange_weak(state, (window << 32) | 1, std::memory_order_relaxed)) {
+                    const uint32_t count = static_cast<uint32_t>(state) - 1;
+                    if (count > k_errorLogBurst) {
+                        Log(fmt::format("Suppressed {} occurrences of the error at {}:{}\n",
+                                        count - k_errorLogBurst,
+                                        std::filesystem::path(m_file).filename().string(),
+                                        m_line));
+                    }
+                    return true;
+                }
+            }
+
+            // Another thread already started the new window.
+            return shouldLog();
+        }
+
+        void ErrorLogSite::summarize(bool force) {
+            const uint64_t window = GetTickCount64() / k_errorLogWindowMs;
+            uint64_t state = m_state.load(std::memory_order_relaxed);
+            while (static_cast<uint32_t>(state) > k_errorLogBurst && (force || (state >> 32) != window)) {
+                // Keep the current window index so that the call site will not summarize again.
+                const uint64_t newState = (state & ~0xffffffffull) | k_errorLogBurst;
+                if (m_state.compare_exchange_weak(state, newState, std::memory_order_relaxed)) {
+                    Log(fmt::format("Suppressed {} occurrences of the error at {}:{}\n",
+                                    static_cast<uint32_t>(state) - k_errorLogBurst,
+                                    std::filesystem::path(m_file).filename().string(),
+                                    m_line));
+                    break;
+                }
+            }
+        }
+
+    } // namespace internal
 
     void DebugLog(const char* fmt, ...) {
 #ifdef _DEBUG
         va_list va;
         va_start(va, fmt);
-        InternalLog(fmt, va);
+        g_logger.log(fmt, va);
         va_end(va);
 #endif
     }
@@ -42,22 +42,80 @@ namespace openxr_api_layer::log {
 #define TLXArg TLPArg
 #endif
 
-    // General logging function.
+    // Start writing the log to a file from a background thread. Records logged before this call are written too.
+    void StartLogging(const std::filesystem::path& logFile);
+
+    // Synchronously write all pending records (eg: upon process exit).
+    void FlushLog();
+
+    // General logging function. Only formats and enqueues the record, the file I/O happens on a background thread.
     void Log(const char* fmt, ...);
-    static inline void Log(const std::string_view& str) {
-        Log(str.data());
-    }
+    void Log(const std::string_view& str);
 
     // Debug logging function. Can make things very slow (only enabled on Debug builds).
     void DebugLog(const char* fmt, ...);
     static inline void DebugLog(const std::string_view& str) {
-        Log(str.data());
+        Log(str);
     }
 
-    // Error logging function. Goes silent after too many errors.
-    void ErrorLog(const char* fmt, ...);
-    static inline void ErrorLog(const std::string_view& str) {
-        Log(str.data());
-    }
+    namespace internal {
+
+        // State for one ErrorLog() call site. Each site may log k_errorLogBurst records per k_errorLogWindowMs, further
+        // records are counted and summarized once the window is over.
+        class ErrorLogSite {
+          public:
+            static constexpr uint32_t k_errorLogBurst = 10;
+            static constexpr uint64_t k_errorLogWindowMs = 10000;
+
+            constexpr ErrorLogSite(const char* file, int line) : m_file(file), m_line(line) {
+            }
+
+            // The common case costs a single atomic increment. The upper 32 bits of the state are the index of the
+            // current window, the lower 32 bits are the number of occurrences within that window.
+            bool shouldLog() {
+                const uint64_t window = GetTickCount64() / k_errorLogWindowMs;
+                const uint64_t state = m_state.fetch_add(1, std::memory_order_relaxed);
+                if ((state >> 32) == window) {
+                    const uint32_t count = static_cast<uint32_t>(state);
+                    if (count >= k_errorLogBurst) {
+                        onSuppressed(count);
+                        return false;
+                    }
+                    return true;
+                }
+                return onNewWindow(window);
+            }
+
+            // Summarize the occurrences suppressed in a window that is over (or any window when force is set).
+            void summarize(bool force);
+
+            ErrorLogSite* next{nullptr};
+
+          private:
+            void onSuppressed(uint32_t count);
+            bool onNewWindow(uint64_t window);
+
+            const char* const m_file;
+            const int m_line;
+            std::atomic<uint64_t> m_state{0};
+            std::atomic<bool> m_registered{false};
+        };
+
+        void LogError(const char* fmt, ...);
+        void LogError(const std::string_view& str);
+
+    } // namespace internal
+
+    // Error logging. Rate-limited per call site: the arguments are not evaluated while the site is suppressed.
+#define ErrorLog(...)                                                                                                  \
+    do {                                                                                                               \
+        static ::openxr_api_layer::log::internal::ErrorLogSite _errorLogSite(__FILE__, __LINE__);                      \
+        if (_errorLogSite.shouldLog()) {                                                                               \
+            ::openxr_api_layer::log::internal::LogError(__VA_ARGS__);                                                  \
+        }                                                                                                              \
+    } while (false)
+
+    // Write summaries for all call sites with suppressed errors.
+    void SummarizeSuppressedErrors();
 
 } // namespace openxr_api_layer::log
@@ -0,0 +1,204 @@
+// MIT License
+//
+// Copyright(c) 2022-2023 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "pch.h"
+
+#include <layer.h>
+
+#include "log.h"
+#include "metrics.h"
+
+namespace {
+
+    using namespace openxr_api_layer;
+    using namespace openxr_api_layer::metrics;
+
+    constexpr uint32_t k_counterCount = static_cast<uint32_t>(Counter::Count);
+    constexpr uint32_t k_gaugeCount = static_cast<uint32_t>(Gauge::Count);
+    constexpr uint32_t k_histogramCount = static_cast<uint32_t>(Histogram::Count);
+
+    const char* const k_counterNames[] = {
+        "Sessions",
+        "FramesWaited",
+        "GazeQueries",
+        "GazeValidSamples",
+        "GazeInvalidSamples",
+        "StalePeriods",
+        "EyeGazeLocateSpace",
+        "EyeGazeActionState",
+        "Exceptions",
+        "ActionsAndSpacesLockContended",
+        "TrackerLockContended",
+        "ApplicationToCompositionSyncs",
+        "CompositionToApplicationSyncs",
+        "EyeGazesFB",
+        "QuadViewsFramesComposed",
+        "HotPathAllocations",
+    };
+    static_assert(std::size(k_counterNames) == k_counterCount, "Missing counter names");
+
+    const char* const k_gaugeNames[] = {
+        "TrackerType",
+        "SessionActive",
+        "StaleMilliseconds",
+        "GazedLayerIndex",
+        "QuadViewsPixelsPercent",
+        "TrackerActive",
+    };
+    static_assert(std::size(k_gaugeNames) == k_gaugeCount, "Missing gauge names");
+
+    const char* const k_histogramNames[] = {
+        "GazeSampleAge",
+        "GazeAcquisitionCost",
+        "StalePeriodDuration",
+        "ActionsAndSpacesLockWait",
+        "TrackerLockWait",
+        "LayerPickingTime",
+        "QuadViewsCompositionTime",
+        "TrackerResumeTime",
+        "AcquisitionWakeupDelay",
+    };
+    static_assert(std::size(k_histogramNames) == k_histogramCount, "Missing histogram names");
+
+    constexpr uint32_t alignUp(uint32_t value, uint32_t alignment) {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    constexpr uint32_t k_namesOffset = alignUp(sizeof(MetricsHeader), 8);
+    constexpr uint32_t k_countersOffset =
+        alignUp(k_namesOffset + (k_counterCount + k_gaugeCount + k_histogramCount) * k_nameSize, 8);
+    constexpr uint32_t k_gaugesOffset = k_countersOffset + k_counterCount * sizeof(uint64_t);
+    constexpr uint32_t k_histogramsOffset = k_gaugesOffset + k_gaugeCount * sizeof(int64_t);
+    constexpr uint32_t k_segmentSize = k_histogramsOffset + k_histogramCount * sizeof(SharedHistogram);
+
+    // The shared memory is read by other processes, the atomics must be plain 64-bit values.
+    static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t) && std::atomic<uint64_t>::is_always_lock_free,
+                  "Unexpected atomic layout");
+
+    // Process-local storage, used until the metrics are exported.
+    std::atomic<uint64_t> g_localCounters[k_counterCount]{};
+    std::atomic<int64_t> g_localGauges[k_gaugeCount]{};
+    SharedHistogram g_localHistograms[k_histogramCount]{};
+
+    // Never unmapped: other threads may update metrics until the very end of the process.
+    wil::unique_handle g_sharedMemory;
+
+    void copyName(char* destination, const char* name) {
+        strncpy_s(destination, k_nameSize, name, _TRUNCATE);
+    }
+
+} // namespace
+
+namespace openxr_api_layer::metrics {
+
+    using namespace openxr_api_layer::log;
+
+    namespace internal {
+
+        Registry g_registry{g_localCounters, g_localGauges, g_localHistograms};
+
+    } // namespace internal
+
+    void ExportMetrics() {
+        if (g_sharedMemory) {
+            return;
+        }
+
+        const std::string name = fmt::format("Local\\{}.Metrics.{}", LayerPrettyName, GetCurrentProcessId());
+        *g_sharedMemory.put() =
+            CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, k_segmentSize, name.c_str());
+        if (!g_sharedMemory) {
+            ErrorLog(fmt::format("Failed to create metrics shared memory: {}\n", GetLastError()));
+            return;
+        }
+
+        uint8_t* const view =
+            reinterpret_cast<uint8_t*>(MapViewOfFile(g_sharedMemory.get(), FILE_MAP_WRITE, 0, 0, k_segmentSize));
+        if (!view) {
+            ErrorLog(fmt::format("Failed to map metrics shared memory: {}\n", GetLastError()));
+            g_sharedMemory.reset();
+            return;
+        }
+
+        char* names = reinterpret_cast<char*>(view + k_namesOffset);
+        for (const char* counterName : k_counterNames) {
+            copyName(names, counterName);
+            names += k_nameSize;
+        }
+        for (const char* gaugeName : k_gaugeNames) {
+            copyName(names, gaugeName);
+            names += k_nameSize;
+        }
+        for (const char* histogramName : k_histogramNames) {
+            copyName(names, histogramName);
+            names += k_nameSize;
+        }
+
+        // Carry over the values recorded so far. Updates racing with the switch may be lost, which is acceptable.
+        const auto counters = reinterpret_cast<std::atomic<uint64_t>*>(view + k_countersOffset);
+        const auto gauges = reinterpret_cast<std::atomic<int64_t>*>(view + k_gaugesOffset);
+        const auto histograms = reinterpret_cast<SharedHistogram*>(view + k_histogramsOffset);
+        for (uint32_t i = 0; i < k_counterCount; i++) {
+            counters[i].store(g_localCounters[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+        for (uint32_t i = 0; i < k_gaugeCount; i++) {
+            gauges[i].store(g_localGauges[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+        for (uint32_t i = 0; i < k_histogramCount; i++) {
+            histograms[i].count.store(g_localHistograms[i].count.load(std::memory_order_relaxed),
+                                      std::memory_order_relaxed);
+            histograms[i].sum.store(g_localHistograms[i].sum.load(std::memory_order_relaxed),
+                                    std::memory_order_relaxed);
+            for (uint32_t j = 0; j < SharedHistogram::k_bucketCount; j++) {
+                histograms[i].buckets[j].store(g_localHistograms[i].buckets[j].load(std::memory_order_relaxed),
+                                               std::memory_order_relaxed);
+            }
+        }
+        internal::g_registry = {counters, gauges, histograms};
+
+        MetricsHeader header{};
+        header.version = k_metricsVersion;
+        header.headerSize = sizeof(MetricsHeader);
+        header.nameSize = k_nameSize;
+        header.counterCount = k_counterCount;
+        header.gaugeCount = k_gaugeCount;
+        header.histogramCount = k_histogramCount;
+        header.histogramBucketCount = SharedHistogram::k_bucketCount;
+        header.namesOffset = k_namesOffset;
+        header.countersOffset = k_countersOffset;
+        header.gaugesOffset = k_gaugesOffset;
+        header.histogramsOffset = k_histogramsOffset;
+        header.processId = GetCurrentProcessId();
+        FILETIME now;
+        GetSystemTimeAsFileTime(&now);
+        header.startTime = (static_cast<uint64_t>(now.dwHighDateTime) << 32) | now.dwLowDateTime;
+        memcpy(view, &header, sizeof(header));
+
+        // Readers must check the magic value last, it is only published once the segment is complete.
+        reinterpret_cast<std::atomic<uint32_t>*>(view + offsetof(MetricsHeader, magic))
+            ->store(k_metricsMagic, std::memory_order_release);
+
+        Log(fmt::format("Exporting metrics to: {}\n", name));
+    }
+
+} // namespace openxr_api_layer::metrics
@@ -0,0 +1,192 @@
+// MIT License
+//
+// Copyright(c) 2022-2023 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <atomic>
+
+#include "stats.h"
+
+// A fixed-layout registry of live metrics, exported read-only through a named shared memory segment so that a
+// monitoring tool (eg: scripts\Watch-Metrics.ps1) can poll it without touching the application.
+//
+// Layout of the segment "Local\OpenXR-Eye-Trackers.Metrics.<pid>" (all integers little-endian):
+//   MetricsHeader
+//   char names[counterCount + gaugeCount + histogramCount][k_nameSize]   (at namesOffset)
+//   uint64_t counters[counterCount]                                        (at countersOffset)
+//   int64_t gauges[gaugeCount]                                             (at gaugesOffset)
+//   SharedHistogram histograms[histogramCount]                             (at histogramsOffset)
+//
+// New metrics may be appended to the lists below without changing the version, since readers use the counts and
+// offsets from the header. Any other change must bump k_metricsVersion.
+namespace openxr_api_layer::metrics {
+
+    constexpr uint32_t k_metricsMagic = 0x544d5258; // "XRMT"
+    constexpr uint32_t k_metricsVersion = 2;
+    constexpr uint32_t k_nameSize = 32;
+
+    // Monotonic counters.
+    enum class Counter : uint32_t {
+        Sessions = 0,
+        FramesWaited,
+        GazeQueries,
+        GazeValidSamples,
+        GazeInvalidSamples,
+        StalePeriods,
+        EyeGazeLocateSpace,
+        EyeGazeActionState,
+        Exceptions,
+        // Lock acquisitions that had to wait.
+        ActionsAndSpacesLockContended,
+        TrackerLockContended,
+        // Fence round-trips between the application device and the composition device (see utils/composition.cpp).
+        ApplicationToCompositionSyncs,
+        CompositionToApplicationSyncs,
+        // Emulated XR_FB_eye_tracking_social queries.
+        EyeGazesFB,
+        // Frames whose quad views were composited into stereo views (see XR_VARJO_quad_views emulation).
+        QuadViewsFramesComposed,
+        // Heap allocations made by the layer during the per-frame calls, once warmed up (see allocations.h).
+        HotPathAllocations,
+
+        Count
+    };
+
+    // Instantaneous values.
+    enum class Gauge : uint32_t {
+        TrackerType = 0,
+        SessionActive,
+        // Duration of the current stale period (no valid sample), 0 when samples are valid.
+        StaleMilliseconds,
+        // Index of the composition layer under the gaze in the last frame, -1 when none (see GazeLayerPicking).
+        GazedLayerIndex,
+        // Pixels of the four views submitted in the last quad views frame, in percent of full stereo at the
+        // recommended resolution.
+        QuadViewsPixelsPercent,
+        // Whether the acquisition threads of the tracker are running, they are parked while the session is not visible.
+        TrackerActive,
+
+        Count
+    };
+
+    // Durations in nanoseconds.
+    enum class Histogram : uint32_t {
+        GazeSampleAge = 0,
+        GazeAcquisitionCost,
+        StalePeriodDuration,
+        // Time spent waiting for contended locks.
+        ActionsAndSpacesLockWait,
+        TrackerLockWait,
+        // Per-frame cost of finding the composition layer under the gaze.
+        LayerPickingTime,
+        // Per-frame cost of recording the composition of the quad views, on the CPU.
+        QuadViewsCompositionTime,
+        // Time for the tracker to resume its acquisition threads when the session becomes visible.
+        TrackerResumeTime,
+        // Time past its requested sleep for the PlayStation VR2 Toolkit IPC thread to run again (1ms timer resolution).
+        AcquisitionWakeupDelay,
+
+        Count
+    };
+
+    struct MetricsHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t headerSize;
+        uint32_t nameSize;
+        uint32_t counterCount;
+        uint32_t gaugeCount;
+        uint32_t histogramCount;
+        uint32_t histogramBucketCount;
+        uint32_t namesOffset;
+        uint32_t countersOffset;
+        uint32_t gaugesOffset;
+        uint32_t histogramsOffset;
+        uint32_t processId;
+        uint32_t reserved;
+        // FILETIME of the creation of the segment.
+        uint64_t startTime;
+    };
+
+    // Bucket i counts the values in [2^i, 2^(i+1)) nanoseconds (bucket 0 also counts 0), the last bucket counts
+    // everything above.
+    struct SharedHistogram {
+        static constexpr uint32_t k_bucketCount = 40;
+
+        std::atomic<uint64_t> count;
+        std::atomic<uint64_t> sum;
+        std::atomic<uint64_t> buckets[k_bucketCount];
+    };
+
+    namespace internal {
+
+        struct Registry {
+            std::atomic<uint64_t>* counters;
+            std::atomic<int64_t>* gauges;
+            SharedHistogram* histograms;
+        };
+
+        // Points to the shared memory once exported, or to a process-local block until then (or if the export
+        // failed), so that updates never need to check.
+        extern Registry g_registry;
+
+    } // namespace internal
+
+    // Create the shared memory segment. Values recorded before this call are carried over.
+    void ExportMetrics();
+
+    static inline void Increment(Counter counter, uint64_t value = 1) {
+        internal::g_registry.counters[static_cast<uint32_t>(counter)].fetch_add(value, std::memory_order_relaxed);
+    }
+
+    static inline void SetGauge(Gauge gauge, int64_t value) {
+        internal::g_registry.gauges[static_cast<uint32_t>(gauge)].store(value, std::memory_order_relaxed);
+    }
+
+    static inline void Record(Histogram histogram, uint64_t nanoseconds) {
+        SharedHistogram& entry = internal::g_registry.histograms[static_cast<uint32_t>(histogram)];
+        constexpr uint32_t lastBucket = SharedHistogram::k_bucketCount - 1;
+        const uint32_t bucket =
+            nanoseconds ? std::min(stats::LatencyHistogram::getHighestBit(nanoseconds), lastBucket) : 0;
+        entry.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+        entry.sum.fetch_add(nanoseconds, std::memory_order_relaxed);
+        entry.count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Acquire a lock (eg: std::unique_lock or std::shared_lock) on a mutex. The uncontended case costs a single
+    // try_lock(), only contended acquisitions are counted and timed.
+    template <template <typename> typename Lock, typename Mutex>
+    Lock<Mutex> LockMeasuringContention(Mutex& mutex, Counter contended, Histogram wait) {
+        Lock<Mutex> lock(mutex, std::try_to_lock);
+        if (!lock.owns_lock()) {
+            Increment(contended);
+            const auto start = std::chrono::steady_clock::now();
+            lock.lock();
+            Record(wait,
+                   std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start)
+                       .count());
+        }
+        return lock;
+    }
+
+} // namespace openxr_api_layer::metrics
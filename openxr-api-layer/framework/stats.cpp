@@ -0,0 +1,99 @@
+// MIT License
+//
+// Copyright(c) 2022-2023 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "log.h"
+#include "stats.h"
+
+namespace openxr_api_layer::stats {
+
+    using namespace openxr_api_layer::log;
+
+    uint64_t LatencyHistogram::getValueAtPercentile(double percentile) const {
+        const uint64_t count = getCount();
+        if (!count) {
+            return 0;
+        }
+
+        const uint64_t target =
+            std::max(static_cast<uint64_t>(std::ceil(std::clamp(percentile, 0.0, 100.0) / 100.0 * count)), 1ull);
+        uint64_t accumulated = 0;
+        for (uint32_t i = 0; i < k_bucketCount; i++) {
+            accumulated += m_buckets[i].load(std::memory_order_relaxed);
+            if (accumulated >= target) {
+                return std::min(getBucketUpperBound(i), getMax());
+            }
+        }
+
+        return getMax();
+    }
+
+    void LatencyHistogram::reset() {
+        for (auto& bucket : m_buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        m_count.store(0, std::memory_order_relaxed);
+        m_sum.store(0, std::memory_order_relaxed);
+        m_max.store(0, std::memory_order_relaxed);
+    }
+
+    std::string FormatMilliseconds(const LatencyHistogram& histogram) {
+        return fmt::format("count={} mean={:.2f} p50={:.2f} p99={:.2f} max={:.2f}",
+                           histogram.getCount(),
+                           histogram.getMean() / 1e6,
+                           histogram.getValueAtPercentile(50) / 1e6,
+                           histogram.getValueAtPercentile(99) / 1e6,
+                           histogram.getMax() / 1e6);
+    }
+
+    void LogFunctionStats() {
+        const auto& allStats = GetFunctionStats();
+        if (allStats.empty()) {
+            return;
+        }
+
+        const auto toMicroseconds = [](double nanoseconds) { return nanoseconds / 1000.0; };
+
+        Log("Function statistics (microseconds, layer/downstream):\n");
+        for (const FunctionStats* stats : allStats) {
+            const uint64_t calls = stats->calls.load(std::memory_order_relaxed);
+            if (!calls) {
+                continue;
+            }
+
+            Log(fmt::format("  {:<36} calls={:<8} failures={:<4} mean={:.1f}/{:.1f} p50={:.1f}/{:.1f} "
+                            "p99={:.1f}/{:.1f} max={:.1f}\n",
+                            stats->name,
+                            calls,
+                            stats->failures.load(std::memory_order_relaxed),
+                            toMicroseconds(stats->layerTime.getMean()),
+                            toMicroseconds(stats->downstreamTime.getMean()),
+                            toMicroseconds((double)stats->layerTime.getValueAtPercentile(50)),
+                            toMicroseconds((double)stats->downstreamTime.getValueAtPercentile(50)),
+                            toMicroseconds((double)stats->layerTime.getValueAtPercentile(99)),
+                            toMicroseconds((double)stats->downstreamTime.getValueAtPercentile(99)),
+                            toMicroseconds((double)stats->totalTime.getMax())));
+        }
+    }
+
+} // namespace openxr_api_layer::stats
@@ -0,0 +1,207 @@
+// MIT License
+//
+// Copyright(c) 2022-2023 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+
+namespace openxr_api_layer::stats {
+
+    // A lock-free log-linear histogram (same bucketing scheme as HdrHistogram), meant for latencies in nanoseconds.
+    // Each power of two is split into k_subBucketCount linear sub-buckets, for a worst-case relative error of 1/16.
+    class LatencyHistogram {
+      public:
+        static constexpr uint32_t k_subBucketBits = 4;
+        static constexpr uint32_t k_subBucketCount = 1u << k_subBucketBits;
+        // Values are clamped to 2^36 ns (about 68 seconds).
+        static constexpr uint32_t k_maxMagnitude = 36;
+        static constexpr uint32_t k_bucketCount = (k_maxMagnitude - k_subBucketBits + 1) * k_subBucketCount;
+
+        void record(uint64_t value) {
+            m_buckets[getBucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+            m_count.fetch_add(1, std::memory_order_relaxed);
+            m_sum.fetch_add(value, std::memory_order_relaxed);
+
+            uint64_t max = m_max.load(std::memory_order_relaxed);
+            while (value > max && !m_max.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+            }
+        }
+
+        uint64_t getCount() const {
+            return m_count.load(std::memory_order_relaxed);
+        }
+
+        uint64_t getSum() const {
+            return m_sum.load(std::memory_order_relaxed);
+        }
+
+        uint64_t getMax() const {
+            return m_max.load(std::memory_order_relaxed);
+        }
+
+        double getMean() const {
+            const uint64_t count = getCount();
+            return count ? static_cast<double>(getSum()) / count : 0.0;
+        }
+
+        // Returns the upper bound of the bucket containing the requested percentile (0-100).
+        uint64_t getValueAtPercentile(double percentile) const;
+
+        void reset();
+
+        static uint32_t getBucketIndex(uint64_t value) {
+            if (value < k_subBucketCount) {
+                return static_cast<uint32_t>(value);
+            }
+
+            const uint32_t magnitude = getHighestBit(value);
+            if (magnitude >= k_maxMagnitude) {
+                return k_bucketCount - 1;
+            }
+
+            // The leading bit is implicit, the next k_subBucketBits bits select the sub-bucket.
+            const uint32_t shift = magnitude - k_subBucketBits;
+            const uint32_t subBucket = static_cast<uint32_t>(value >> shift) & (k_subBucketCount - 1);
+            return (shift + 1) * k_subBucketCount + subBucket;
+        }
+
+        static uint64_t getBucketUpperBound(uint32_t index) {
+            if (index < k_subBucketCount) {
+                return index;
+            }
+
+            const uint32_t shift = index / k_subBucketCount - 1;
+            const uint64_t subBucket = index % k_subBucketCount;
+            return ((k_subBucketCount + subBucket) << shift) + ((1ull << shift) - 1);
+        }
+
+        // Value must not be 0.
+        static uint32_t getHighestBit(uint64_t value) {
+            unsigned long index;
+#ifdef _WIN64
+            _BitScanReverse64(&index, value);
+#else
+            if (_BitScanReverse(&index, static_cast<unsigned long>(value >> 32))) {
+                index += 32;
+            } else {
+                _BitScanReverse(&index, static_cast<unsigned long>(value));
+            }
+#endif
+            return index;
+        }
+
+      private:
+        std::atomic<uint64_t> m_buckets[k_bucketCount]{};
+        std::atomic<uint64_t> m_count{0};
+        std::atomic<uint64_t> m_sum{0};
+        std::atomic<uint64_t> m_max{0};
+    };
+
+    // Statistics for one entry point of the layer.
+    struct FunctionStats {
+        explicit FunctionStats(const char* name) : name(name) {
+        }
+
+        const char* const name;
+
+        std::atomic<uint64_t> calls{0};
+        std::atomic<uint64_t> failures{0};
+
+        // Time from entering to leaving the entry point.
+        LatencyHistogram totalTime;
+        // Time spent in the downstream implementation (the next layer or the runtime).
+        LatencyHistogram downstreamTime;
+        // Time spent in the layer itself (the difference between the two above).
+        LatencyHistogram layerTime;
+    };
+
+    namespace internal {
+
+        using clock = std::chrono::steady_clock;
+
+        // Accumulated downstream time for the entry point currently executing on this thread.
+        inline thread_local uint64_t t_downstreamTime = 0;
+
+        static inline uint64_t nanosecondsSince(clock::time_point start) {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count();
+        }
+
+    } // namespace internal
+
+    // Scope covering an entry point of the layer. Only used by the generated dispatcher.
+    class EntryPointScope {
+      public:
+        explicit EntryPointScope(FunctionStats& stats)
+            : m_stats(stats), m_savedDownstreamTime(internal::t_downstreamTime),
+              m_start(internal::clock::now()) {
+            internal::t_downstreamTime = 0;
+        }
+
+        ~EntryPointScope() {
+            const uint64_t total = internal::nanosecondsSince(m_start);
+            const uint64_t downstream = std::min(internal::t_downstreamTime, total);
+            m_stats.calls.fetch_add(1, std::memory_order_relaxed);
+            m_stats.totalTime.record(total);
+            m_stats.downstreamTime.record(downstream);
+            m_stats.layerTime.record(total - downstream);
+
+            // An entry point invoked from within another one is accounted as time spent in the outer layer code.
+            internal::t_downstreamTime = m_savedDownstreamTime;
+        }
+
+        void setResult(XrResult result) {
+            if (XR_FAILED(result)) {
+                m_stats.failures.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+      private:
+        FunctionStats& m_stats;
+        const uint64_t m_savedDownstreamTime;
+        const internal::clock::time_point m_start;
+    };
+
+    // Scope covering a call to the downstream implementation. Only used by the generated dispatcher.
+    class DownstreamScope {
+      public:
+        DownstreamScope() : m_start(internal::clock::now()) {
+        }
+
+        ~DownstreamScope() {
+            internal::t_downstreamTime += internal::nanosecondsSince(m_start);
+        }
+
+      private:
+        const internal::clock::time_point m_start;
+    };
+
+    // Summary of a histogram of durations in nanoseconds, in milliseconds.
+    std::string FormatMilliseconds(const LatencyHistogram& histogram);
+
+    // Statistics for all entry points. Empty unless instrument_functions is enabled in layer_apis.py.
+    const std::vector<const FunctionStats*>& GetFunctionStats();
+
+    // Write a summary of the statistics for all entry points that were invoked to the log file.
+    void LogFunctionStats();
+
+} // namespace openxr_api_layer::stats
@@ -25,27 +25,61 @@
 
 #include "layer.h"
 #include "utils.h"
+#include <allocations.h>
+#include <config.h>
 #include <log.h>
+#include <metrics.h>
 #include <util.h>
 
 #include "trackers.h"
+#include "utils/gaze.h"
+#include "utils/hittest.h"
 
 namespace openxr_api_layer {
 
     using namespace log;
     using namespace xr::math;
+    namespace vm = utils::vectormath;
 
     // Our API layer implement these extensions, and their specified version.
     const std::vector<std::pair<std::string, uint32_t>> advertisedExtensions = {
-        std::make_pair(XR_EXT_EYE_GAZE_INTERACTION_EXTENSION_NAME, 2)};
+        std::make_pair(XR_EXT_EYE_GAZE_INTERACTION_EXTENSION_NAME, 2),
+        std::make_pair(XR_META_FOVEATION_EYE_TRACKED_EXTENSION_NAME, 1),
+        std::make_pair(XR_FB_EYE_TRACKING_SOCIAL_EXTENSION_NAME, 1),
+#ifdef XR_USE_GRAPHICS_API_D3D11
+        // The quad views are composited on D3D11.
+        std::make_pair(XR_VARJO_QUAD_VIEWS_EXTENSION_NAME, 1),
+#endif
+    };
 
     // Initialize these vectors with arrays of extensions to block and implicitly request for the instance.
     //
     // Note that we block and implicitly request XR_EXT_eye_gaze_interaction in order to allow passthrough of it to the
     // runtime, in case we detect after instance creation that the upstream API layers or runtime are adequate.
-    const std::vector<std::string> blockedExtensions = {XR_EXT_EYE_GAZE_INTERACTION_EXTENSION_NAME};
+    // XR_META_foveation_eye_tracked is entirely implemented by the layer: the foveation profiles themselves are still
+    // handled by the runtime's XR_FB_foveation. XR_FB_eye_tracking_social is emulated unless the runtime provides the
+    // eye tracking, it is implicitly requested when available. XR_VARJO_quad_views is emulated unless the runtime
+    // implements it.
+    const std::vector<std::string> blockedExtensions = {XR_EXT_EYE_GAZE_INTERACTION_EXTENSION_NAME,
+                                                        XR_META_FOVEATION_EYE_TRACKED_EXTENSION_NAME,
+                                                        XR_FB_EYE_TRACKING_SOCIAL_EXTENSION_NAME,
+                                                        XR_VARJO_QUAD_VIEWS_EXTENSION_NAME};
     const std::vector<std::string> implicitExtensions = {XR_EXT_EYE_GAZE_INTERACTION_EXTENSION_NAME,
-                                                         XR_FB_EYE_TRACKING_SOCIAL_EXTENSION_NAME};
+                                                         XR_FB_EYE_TRACKING_SOCIAL_EXTENSION_NAME,
+                                                         XR_VARJO_QUAD_VIEWS_EXTENSION_NAME,
+                                                         XR_KHR_WIN32_CONVERT_PERFORMANCE_COUNTER_TIME_EXTENSION_NAME};
+
+    // Views of XR_VARJO_quad_views: the context views, followed by the focus views.
+    namespace QuadView {
+        constexpr uint32_t Left = 0;
+        constexpr uint32_t Right = 1;
+        constexpr uint32_t FocusLeft = 2;
+        constexpr uint32_t FocusRight = 3;
+        constexpr uint32_t Count = 4;
+    } // namespace QuadView
+
+    // Frames after which the per-frame calls are expected to no longer allocate (see allocations.h).
+    constexpr uint32_t WarmUpFrames = 100;
 
     // This class implements our API layer.
     class OpenXrLayer : public openxr_api_layer::OpenXrApi {
@@ -63,6 +97,9 @@ namespace openxr_api_layer {
 
             XrResult result = m_bypassApiLayer ? m_xrGetInstanceProcAddr(instance, name, function)
                                                : OpenXrApi::xrGetInstanceProcAddr(instance, name, function);
+            if (XR_SUCCEEDED(result) && m_compositionFrameworkFactory) {
+                m_compositionFrameworkFactory->xrGetInstanceProcAddr_post(instance, name, function);
+            }
 
             TraceLoggingWrite(g_traceProvider, "xrGetInstanceProcAddr", TLPArg(*function, "Function"));
 
@@ -94,22 +131,41 @@ namespace openxr_api_layer {
                     g_traceProvider, "xrCreateInstance", TLArg(createInfo->enabledApiLayerNames[i], "ApiLayerName"));
             }
 
-            // Bypass the API layer unless the application requested the eye gaze interaction extension.
+            // Bypass the API layer unless the application requested one of the extensions we implement.
             bool requestedEyeGazeInteraction = false;
+            bool requestedQuadViews = false;
+            m_isFoveationEyeTrackedEnabled = false;
+            m_isEyeTrackingSocialEnabled = false;
             for (uint32_t i = 0; i < createInfo->enabledExtensionCount; i++) {
                 const std::string_view ext(createInfo->enabledExtensionNames[i]);
                 TraceLoggingWrite(g_traceProvider, "xrCreateInstance", TLArg(ext.data(), "ExtensionName"));
                 if (ext == XR_EXT_EYE_GAZE_INTERACTION_EXTENSION_NAME) {
                     requestedEyeGazeInteraction = true;
+                } else if (ext == XR_META_FOVEATION_EYE_TRACKED_EXTENSION_NAME) {
+                    m_isFoveationEyeTrackedEnabled = true;
+                } else if (ext == XR_FB_EYE_TRACKING_SOCIAL_EXTENSION_NAME) {
+                    m_isEyeTrackingSocialEnabled = true;
+                } else if (ext == XR_VARJO_QUAD_VIEWS_EXTENSION_NAME) {
+                    requestedQuadViews = true;
                 }
             }
 
-            m_bypassApiLayer = !requestedEyeGazeInteraction;
+            m_bypassApiLayer = !requestedEyeGazeInteraction && !m_isFoveationEyeTrackedEnabled &&
+                               !m_isEyeTrackingSocialEnabled && !requestedQuadViews;
             if (m_bypassApiLayer) {
                 Log(fmt::format("{} layer will be bypassed\n", LayerName));
                 return XR_SUCCESS;
             }
 
+            const std::filesystem::path settingsPath = localAppData / "settings.ini";
+            config::LoadSettings(settingsPath);
+            try {
+                m_settingsWatcher = config::WatchSettings(settingsPath);
+            } catch (std::exception& exc) {
+                ErrorLog(fmt::format("{}, changes to the settings require a restart\n", exc.what()));
+            }
+            const config::Settings& settings = config::GetSettings();
+
             XrInstanceProperties instanceProperties = {XR_TYPE_INSTANCE_PROPERTIES};
             CHECK_XRCMD(OpenXrApi::xrGetInstanceProperties(GetXrInstance(), &instanceProperties));
             const auto runtimeName = fmt::format("{} {}.{}.{}",
@@ -120,6 +176,44 @@ namespace openxr_api_layer {
             TraceLoggingWrite(g_traceProvider, "xrCreateInstance", TLArg(runtimeName.c_str(), "RuntimeName"));
             Log(fmt::format("Using OpenXR runtime: {}\n", runtimeName));
 
+            // Needed to relate the time of gaze samples with XrTime.
+            const auto& grantedExtensions = GetGrantedExtensions();
+            m_supportsPerformanceCounterConversion =
+                std::find(grantedExtensions.cbegin(),
+                          grantedExtensions.cend(),
+                          XR_KHR_WIN32_CONVERT_PERFORMANCE_COUNTER_TIME_EXTENSION_NAME) != grantedExtensions.cend();
+            m_supportsEyeTrackingSocial =
+                std::find(grantedExtensions.cbegin(),
+                          grantedExtensions.cend(),
+                          XR_FB_EYE_TRACKING_SOCIAL_EXTENSION_NAME) != grantedExtensions.cend();
+
+            // Quad views are composited into the stereo views on our own D3D11 device.
+            const bool supportsQuadViews =
+                std::find(grantedExtensions.cbegin(), grantedExtensions.cend(), XR_VARJO_QUAD_VIEWS_EXTENSION_NAME) !=
+                grantedExtensions.cend();
+#ifdef XR_USE_GRAPHICS_API_D3D11
+            m_isQuadViewsEnabled = requestedQuadViews && !supportsQuadViews && settings.quadViews;
+            if (m_isQuadViewsEnabled) {
+                const auto toFraction = [](uint32_t percent) { return std::clamp(percent, 10u, 200u) / 100.f; };
+                m_quadViewsFocusFraction.x = std::min(toFraction(settings.quadViewsFocusWidth), 1.f);
+                m_quadViewsFocusFraction.y = std::min(toFraction(settings.quadViewsFocusHeight), 1.f);
+                m_quadViewsContextDensity = toFraction(settings.quadViewsContextDensity);
+                m_quadViewsFocusDensity = toFraction(settings.quadViewsFocusDensity);
+
+                m_compositionFrameworkFactory =
+                    utils::graphics::createCompositionFrameworkFactory(*createInfo,
+                                                                       GetXrInstance(),
+                                                                       m_xrGetInstanceProcAddr,
+                                                                       utils::graphics::CompositionApi::D3D11);
+                Log(fmt::format("Emulating quad views: focus {:.0f}%x{:.0f}% of the field of view, density {:.0f}% "
+                                "(focus) and {:.0f}% (context)\n",
+                                m_quadViewsFocusFraction.x * 100,
+                                m_quadViewsFocusFraction.y * 100,
+                                m_quadViewsFocusDensity * 100,
+                                m_quadViewsContextDensity * 100));
+            }
+#endif
+
             return XR_SUCCESS;
         }
 
@@ -155,6 +249,7 @@ namespace openxr_api_layer {
                     std::string_view systemName(systemProperties.systemName);
                     Log(fmt::format("Using OpenXR system: {}\n", systemName.data()));
 
+                    const config::Settings& settings = config::GetSettings();
                     m_trackerType = TrackerType::None;
                     if (eyeGazeInteractionProperties.supportsEyeGazeInteraction &&
                         systemName.find("Windows Mixed Reality") == std::string::npos) {
@@ -166,43 +261,25 @@ namespace openxr_api_layer {
                             "Upstream layer/runtime reported supportsEyeGazeInteraction, {} layer will be bypassed\n",
                             LayerName));
 
-                    } else if (utilities::RegGetDword(
-                                   HKEY_LOCAL_MACHINE, "SOFTWARE\\OpenXR-Eye-Trackers", "SimulateTracker")
-                                   .value_or(false)) {
-                        // Configuration requested the mouse simulated eye tracking.
-                        m_tracker = createSimulatedEyeTracker();
-                    } else if (eyeTrackingProperties.supportsEyeTracking) {
-                        // Quest Pro only supports "social eye tracking", which we can translate into eye gaze
-                        // interaction.
-                        m_tracker = createQuestProEyeTracker(*this);
                     } else {
-                        // Attempt to initialize external eye tracking API.
-                        if (0) {
-#ifdef _WIN64
-                        }  else if (systemName.find("Windows Mixed Reality") != std::string::npos ||
-                                 systemName.find("SteamVR/OpenXR : holographic") != std::string::npos) {
-                            m_tracker = createOmniceptEyeTracker();
-#endif
-                        } else if (systemName.find("SteamVR/OpenXR : aapvr") != std::string::npos) {
-                            m_tracker = createPimaxEyeTracker();
-                        } else if (systemName.find("SteamVR/OpenXR : oculus") != std::string::npos) {
-                            m_tracker = createVirtualDesktopEyeTracker();
-                            if (!m_tracker) {
-                                m_tracker = createSteamLinkEyeTracker();
-                            }
-                        } else if (systemName.find("SteamVR/OpenXR : playstation_vr2") != std::string::npos) {
-                            m_tracker = createPsvr2ToolkitEyeTracker();
-                        } else if (systemName.find("SteamVR/OpenXR : lighthouse") != std::string::npos) {
-                            //For now, we just check for lighthouse, as the Beyond 2E supports VRChat OSC.
-                            m_tracker = createVRChatOSCEyeTracker();
-                        } else if (systemName.find("SteamVR/OpenXR") != std::string::npos) {
-                            m_tracker = createVarjoEyeTracker();
-                        }
+                        m_tracker = createEyeTracker(systemName, eyeTrackingProperties.supportsEyeTracking);
                     }
+                    m_systemName = systemName;
+                    m_supportsEyeTracking = eyeTrackingProperties.supportsEyeTracking;
 
                     if (m_tracker) {
+                        // When another process won the race to share its tracker, ours is released and replaced by a
+                        // reader of the shared gaze.
+                        if (m_tracker->getType() != TrackerType::Shared && settings.shareTracker) {
+                            m_tracker = createGazePublisher(std::move(m_tracker));
+                        }
+
                         m_trackerType = m_tracker->getType();
                         Log(fmt::format("Using eye tracking: {}\n", getTrackerType(m_trackerType)));
+
+                        if (m_trackerType != TrackerType::Replay && settings.recordTracker) {
+                            m_tracker = createGazeRecorder(std::move(m_tracker), localAppData);
+                        }
                     }
                     TraceLoggingWrite(g_traceProvider, "xrGetSystem", TLArg((int)m_trackerType, "TrackerType"));
                     if (m_trackerType == TrackerType::None) {
@@ -232,10 +309,11 @@ namespace openxr_api_layer {
 
             if (XR_SUCCEEDED(result)) {
                 if (isSystemHandled(systemId) && !isPassthrough()) {
-                    XrSystemEyeGazeInteractionPropertiesEXT* eyeGazeInteractionProperties =
-                        reinterpret_cast<XrSystemEyeGazeInteractionPropertiesEXT*>(properties->next);
-                    while (eyeGazeInteractionProperties) {
-                        if (eyeGazeInteractionProperties->type == XR_TYPE_SYSTEM_EYE_GAZE_INTERACTION_PROPERTIES_EXT) {
+                    XrBaseOutStructure* entry = reinterpret_cast<XrBaseOutStructure*>(properties->next);
+                    while (entry) {
+                        if (entry->type == XR_TYPE_SYSTEM_EYE_GAZE_INTERACTION_PROPERTIES_EXT) {
+                            XrSystemEyeGazeInteractionPropertiesEXT* eyeGazeInteractionProperties =
+                                reinterpret_cast<XrSystemEyeGazeInteractionPropertiesEXT*>(entry);
                             eyeGazeInteractionProperties->supportsEyeGazeInteraction =
                                 m_trackerType != TrackerType::None ? XR_TRUE : XR_FALSE;
 
@@ -243,10 +321,29 @@ namespace openxr_api_layer {
                                               "xrGetSystemProperties",
                                               TLArg(!!eyeGazeInteractionProperties->supportsEyeGazeInteraction,
                                                     "SupportsEyeGazeInteraction"));
-                            break;
+                        } else if (entry->type == XR_TYPE_SYSTEM_FOVEATION_EYE_TRACKED_PROPERTIES_META &&
+                                   m_isFoveationEyeTrackedEnabled) {
+                            XrSystemFoveationEyeTrackedPropertiesMETA* foveationEyeTrackedProperties =
+                                reinterpret_cast<XrSystemFoveationEyeTrackedPropertiesMETA*>(entry);
+                            foveationEyeTrackedProperties->supportsFoveationEyeTracked =
+                                m_trackerType != TrackerType::None ? XR_TRUE : XR_FALSE;
+
+                            TraceLoggingWrite(g_traceProvider,
+                                              "xrGetSystemProperties",
+                                              TLArg(!!foveationEyeTrackedProperties->supportsFoveationEyeTracked,
+                                                    "SupportsFoveationEyeTracked"));
+                        } else if (entry->type == XR_TYPE_SYSTEM_EYE_TRACKING_PROPERTIES_FB &&
+                                   m_isEyeTrackingSocialEnabled && isEyeTrackingSocialEmulated()) {
+                            XrSystemEyeTrackingPropertiesFB* eyeTrackingProperties =
+                                reinterpret_cast<XrSystemEyeTrackingPropertiesFB*>(entry);
+                            eyeTrackingProperties->supportsEyeTracking = XR_TRUE;
+
+                            TraceLoggingWrite(g_traceProvider,
+                                              "xrGetSystemProperties",
+                                              TLArg(!!eyeTrackingProperties->supportsEyeTracking,
+                                                    "SupportsEyeTracking"));
                         }
-                        eyeGazeInteractionProperties = reinterpret_cast<XrSystemEyeGazeInteractionPropertiesEXT*>(
-                            eyeGazeInteractionProperties->next);
+                        entry = entry->next;
                     }
                 }
             }
@@ -275,9 +372,29 @@ namespace openxr_api_layer {
 
                 if (isSystemHandled(createInfo->systemId)) {
                     m_session = *session;
+                    m_gazeLatencyStats = std::make_unique<GazeLatencyStats>();
+                    m_staleSince.reset();
+
+                    m_isLayerPickingEnabled = !isPassthrough() && config::GetSettings().gazeLayerPicking;
+                    {
+                        std::unique_lock lock(m_gazedLayerMutex);
+                        m_gazedLayer.reset();
+                    }
+                    metrics::SetGauge(metrics::Gauge::GazedLayerIndex, -1);
+                    {
+                        std::unique_lock lock(m_foveationMutex);
+                        m_foveation = {};
+                    }
+                    m_isQuadViewsSession = false;
+
+                    metrics::Increment(metrics::Counter::Sessions);
+                    metrics::SetGauge(metrics::Gauge::SessionActive, 1);
+                    metrics::SetGauge(metrics::Gauge::TrackerType, static_cast<int64_t>(m_trackerType));
 
                     if (m_tracker) {
                         m_tracker->start(m_session);
+                        m_isTrackerActive = true;
+                        metrics::SetGauge(metrics::Gauge::TrackerActive, 1);
                     }
                     {
                         XrReferenceSpaceCreateInfo referenceSpaceInfo{XR_TYPE_REFERENCE_SPACE_CREATE_INFO};
@@ -301,7 +418,37 @@ namespace openxr_api_layer {
                 if (isSessionHandled(session)) {
                     if (m_tracker) {
                         m_tracker->stop();
+                        m_isTrackerActive = false;
+                        metrics::SetGauge(metrics::Gauge::TrackerActive, 0);
+                    }
+
+                    if (m_gazeLatencyStats->acquisitionCost.getCount()) {
+                        Log(fmt::format("Gaze sample age (ms): {}\n",
+                                        stats::FormatMilliseconds(m_gazeLatencyStats->sampleAge)));
+                        Log(fmt::format("Gaze display horizon (ms): {}, late samples: {}\n",
+                                        stats::FormatMilliseconds(m_gazeLatencyStats->displayHorizon),
+                                        m_gazeLatencyStats->lateSamples.load()));
+                        Log(fmt::format("Gaze acquisition cost (ms): {}\n",
+                                        stats::FormatMilliseconds(m_gazeLatencyStats->acquisitionCost)));
+                    }
+
+                    metrics::SetGauge(metrics::Gauge::SessionActive, 0);
+                    metrics::SetGauge(metrics::Gauge::StaleMilliseconds, 0);
+                    allocations::SetWarmedUp(false);
+                    m_framesWaited = 0;
+
+                    // The eye trackers and the swapchains are children of the session.
+                    {
+                        std::unique_lock lock(m_eyeTrackersMutex);
+                        m_eyeTrackers.clear();
                     }
+                    {
+                        std::unique_lock lock(m_quadViewsSwapchainsMutex);
+                        m_quadViewsSwapchains.clear();
+                        m_sampledSwapchains.clear();
+                    }
+                    m_stereoSwapchains.clear();
+                    m_isQuadViewsSession = false;
 
                     m_session = XR_NULL_HANDLE;
                 }
@@ -310,6 +457,365 @@ namespace openxr_api_layer {
             return result;
         }
 
+        // https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#xrPollEvent
+        XrResult xrPollEvent(XrInstance instance, XrEventDataBuffer* eventData) override {
+            TraceLoggingWrite(g_traceProvider, "xrPollEvent", TLXArg(instance, "Instance"));
+
+            const XrResult result = OpenXrApi::xrPollEvent(instance, eventData);
+            if (result == XR_SUCCESS && eventData->type == XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED) {
+                const XrEventDataSessionStateChanged* const stateChanged =
+                    reinterpret_cast<const XrEventDataSessionStateChanged*>(eventData);
+
+                TraceLoggingWrite(g_traceProvider,
+                                  "xrPollEvent_SessionStateChanged",
+                                  TLXArg(stateChanged->session, "Session"),
+                                  TLArg(xr::ToCString(stateChanged->state), "State"),
+                                  TLArg(stateChanged->time, "Time"));
+
+                // The gaze is only consumed while the application is rendering to the headset.
+                if (isSessionHandled(stateChanged->session) && m_tracker) {
+                    setTrackerActive(stateChanged->state == XR_SESSION_STATE_VISIBLE ||
+                                     stateChanged->state == XR_SESSION_STATE_FOCUSED);
+                }
+            }
+
+            return result;
+        }
+
+        // https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#xrEnumerateViewConfigurations
+        XrResult xrEnumerateViewConfigurations(XrInstance instance,
+                                               XrSystemId systemId,
+                                               uint32_t viewConfigurationTypeCapacityInput,
+                                               uint32_t* viewConfigurationTypeCountOutput,
+                                               XrViewConfigurationType* viewConfigurationTypes) override {
+            TraceLoggingWrite(g_traceProvider,
+                              "xrEnumerateViewConfigurations",
+                              TLXArg(instance, "Instance"),
+                              TLArg((int)systemId, "SystemId"),
+                              TLArg(viewConfigurationTypeCapacityInput, "ViewConfigurationTypeCapacityInput"));
+
+            if (!isQuadViewsEmulated(systemId)) {
+                return OpenXrApi::xrEnumerateViewConfigurations(instance,
+                                                                systemId,
+                                                                viewConfigurationTypeCapacityInput,
+                                                                viewConfigurationTypeCountOutput,
+                                                                viewConfigurationTypes);
+            }
+
+            // Append the quad views to the view configurations of the runtime.
+            uint32_t count = 0;
+            XrResult result = OpenXrApi::xrEnumerateViewConfigurations(instance, systemId, 0, &count, nullptr);
+            if (XR_SUCCEEDED(result)) {
+                std::vector<XrViewConfigurationType> types(count);
+                result = OpenXrApi::xrEnumerateViewConfigurations(instance, systemId, count, &count, types.data());
+                if (XR_SUCCEEDED(result)) {
+                    types.resize(count);
+                    types.push_back(XR_VIEW_CONFIGURATION_TYPE_PRIMARY_QUAD_VARJO);
+
+                    *viewConfigurationTypeCountOutput = (uint32_t)types.size();
+                    if (viewConfigurationTypeCapacityInput) {
+                        if (viewConfigurationTypeCapacityInput < types.size()) {
+                            return XR_ERROR_SIZE_INSUFFICIENT;
+                        }
+                        std::copy(types.cbegin(), types.cend(), viewConfigurationTypes);
+                    }
+                }
+            }
+
+            return result;
+        }
+
+        // https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#xrGetViewConfigurationProperties
+        XrResult xrGetViewConfigurationProperties(XrInstance instance,
+                                                  XrSystemId systemId,
+                                                  XrViewConfigurationType viewConfigurationType,
+                                                  XrViewConfigurationProperties* configurationProperties) override {
+            TraceLoggingWrite(g_traceProvider,
+                              "xrGetViewConfigurationProperties",
+                              TLXArg(instance, "Instance"),
+                              TLArg((int)systemId, "SystemId"),
+                              TLArg(xr::ToCString(viewConfigurationType), "ViewConfigurationType"));
+
+            if (viewConfigurationType != XR_VIEW_CONFIGURATION_TYPE_PRIMARY_QUAD_VARJO ||
+                !isQuadViewsEmulated(systemId)) {
+                return OpenXrApi::xrGetViewConfigurationProperties(
+                    instance, systemId, viewConfigurationType, configurationProperties);
+            }
+
+            const XrResult result = OpenXrApi::xrGetViewConfigurationProperties(
+                instance, systemId, XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO, configurationProperties);
+            if (XR_SUCCEEDED(result)) {
+                configurationProperties->viewConfigurationType = XR_VIEW_CONFIGURATION_TYPE_PRIMARY_QUAD_VARJO;
+            }
+
+            return result;
+        }
+
+        // https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#xrEnumerateViewConfigurationViews
+        XrResult xrEnumerateViewConfigurationViews(XrInstance instance,
+                                                   XrSystemId systemId,
+                                                   XrViewConfigurationType viewConfigurationType,
+                                                   uint32_t viewCapacityInput,
+                                                   uint32_t* viewCountOutput,
+                                                   XrViewConfigurationView* views) override {
+            TraceLoggingWrite(g_traceProvider,
+                              "xrEnumerateViewConfigurationViews",
+                              TLXArg(instance, "Instance"),
+                              TLArg((int)systemId, "SystemId"),
+                              TLArg(xr::ToCString(viewConfigurationType), "ViewConfigurationType"),
+                              TLArg(viewCapacityInput, "ViewCapacityInput"));
+
+            if (viewConfigurationType != XR_VIEW_CONFIGURATION_TYPE_PRIMARY_QUAD_VARJO ||
+                !isQuadViewsEmulated(systemId)) {
+                return OpenXrApi::xrEnumerateViewConfigurationViews(
+                    instance, systemId, viewConfigurationType, viewCapacityInput, viewCountOutput, views);
+            }
+
+            XrViewConfigurationView stereoViews[xr::StereoView::Count]{{XR_TYPE_VIEW_CONFIGURATION_VIEW},
+                                                                      {XR_TYPE_VIEW_CONFIGURATION_VIEW}};
+            uint32_t stereoViewCount = 0;
+            const XrResult result =
+                OpenXrApi::xrEnumerateViewConfigurationViews(instance,
+                                                             systemId,
+                                                             XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO,
+                                                             xr::StereoView::Count,
+                                                             &stereoViewCount,
+                                                             stereoViews);
+            if (XR_SUCCEEDED(result)) {
+                m_wereQuadViewsEnumerated = true;
+
+                *viewCountOutput = QuadView::Count;
+                if (viewCapacityInput) {
+                    if (viewCapacityInput < QuadView::Count) {
+                        return XR_ERROR_SIZE_INSUFFICIENT;
+                    }
+
+                    // The context views cover the field of view of the stereo views, the focus views a fraction of it.
+                    for (uint32_t i = 0; i < QuadView::Count; i++) {
+                        if (views[i].type != XR_TYPE_VIEW_CONFIGURATION_VIEW) {
+                            return XR_ERROR_VALIDATION_FAILURE;
+                        }
+
+                        const XrViewConfigurationView& stereoView = stereoViews[i % xr::StereoView::Count];
+                        const bool isFocus = i >= xr::StereoView::Count;
+                        const XrExtent2Di resolution = getQuadViewResolution(stereoView, isFocus);
+                        views[i].recommendedImageRectWidth = resolution.width;
+                        views[i].recommendedImageRectHeight = resolution.height;
+                        views[i].maxImageRectWidth = stereoView.maxImageRectWidth;
+                        views[i].maxImageRectHeight = stereoView.maxImageRectHeight;
+                        views[i].recommendedSwapchainSampleCount = stereoView.recommendedSwapchainSampleCount;
+                        views[i].maxSwapchainSampleCount = stereoView.maxSwapchainSampleCount;
+
+                        TraceLoggingWrite(g_traceProvider,
+                                          "xrEnumerateViewConfigurationViews",
+                                          TLArg(views[i].recommendedImageRectWidth, "RecommendedImageRectWidth"),
+                                          TLArg(views[i].recommendedImageRectHeight, "RecommendedImageRectHeight"));
+                    }
+                }
+            }
+
+            return result;
+        }
+
+        // https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#xrEnumerateEnvironmentBlendModes
+        XrResult xrEnumerateEnvironmentBlendModes(XrInstance instance,
+                                                  XrSystemId systemId,
+                                                  XrViewConfigurationType viewConfigurationType,
+                                                  uint32_t environmentBlendModeCapacityInput,
+                                                  uint32_t* environmentBlendModeCountOutput,
+                                                  XrEnvironmentBlendMode* environmentBlendModes) override {
+            TraceLoggingWrite(g_traceProvider,
+                              "xrEnumerateEnvironmentBlendModes",
+                              TLXArg(instance, "Instance"),
+                              TLArg((int)systemId, "SystemId"),
+                              TLArg(xr::ToCString(viewConfigurationType), "ViewConfigurationType"));
+
+            if (viewConfigurationType == XR_VIEW_CONFIGURATION_TYPE_PRIMARY_QUAD_VARJO &&
+                isQuadViewsEmulated(systemId)) {
+                viewConfigurationType = XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO;
+            }
+
+            return OpenXrApi::xrEnumerateEnvironmentBlendModes(instance,
+                                                               systemId,
+                                                               viewConfigurationType,
+                                                               environmentBlendModeCapacityInput,
+                                                               environmentBlendModeCountOutput,
+                                                               environmentBlendModes);
+        }
+
+        // https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#xrBeginSession
+        XrResult xrBeginSession(XrSession session, const XrSessionBeginInfo* beginInfo) override {
+            if (beginInfo->type != XR_TYPE_SESSION_BEGIN_INFO) {
+                return XR_ERROR_VALIDATION_FAILURE;
+            }
+
+            TraceLoggingWrite(
+                g_traceProvider,
+                "xrBeginSession",
+                TLXArg(session, "Session"),
+                TLArg(xr::ToCString(beginInfo->primaryViewConfigurationType), "PrimaryViewConfigurationType"));
+
+            if (!isSessionHandled(session) ||
+                beginInfo->primaryViewConfigurationType != XR_VIEW_CONFIGURATION_TYPE_PRIMARY_QUAD_VARJO ||
+                !isQuadViewsEmulated(m_systemId)) {
+                if (isSessionHandled(session)) {
+                    // The swapchains are no longer read, since the application renders the views of the runtime.
+                    releaseQuadViewsImages();
+                    {
+                        std::unique_lock lock(m_quadViewsSwapchainsMutex);
+                        m_quadViewsSwapchains.clear();
+                    }
+                    m_isQuadViewsSession = false;
+                }
+                return OpenXrApi::xrBeginSession(session, beginInfo);
+            }
+
+            // Composition is only possible for the graphics APIs supported by the composition framework.
+            utils::graphics::ICompositionFramework* const compositionFramework =
+                m_compositionFrameworkFactory->getCompositionFramework(session);
+            if (!compositionFramework) {
+                ErrorLog("Quad views are not supported with this graphics API\n");
+                return XR_ERROR_VIEW_CONFIGURATION_TYPE_UNSUPPORTED;
+            }
+
+            XrSessionBeginInfo stereoBeginInfo = *beginInfo;
+            stereoBeginInfo.primaryViewConfigurationType = XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO;
+            const XrResult result = OpenXrApi::xrBeginSession(session, &stereoBeginInfo);
+            if (XR_SUCCEEDED(result)) {
+                // The stereo views are composited at the resolution recommended by the runtime.
+                XrViewConfigurationView stereoViews[xr::StereoView::Count]{{XR_TYPE_VIEW_CONFIGURATION_VIEW},
+                                                                          {XR_TYPE_VIEW_CONFIGURATION_VIEW}};
+                uint32_t stereoViewCount = 0;
+                CHECK_XRCMD(OpenXrApi::xrEnumerateViewConfigurationViews(GetXrInstance(),
+                                                                         m_systemId,
+                                                                         XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO,
+                                                                         xr::StereoView::Count,
+                                                                         &stereoViewCount,
+                                                                         stereoViews));
+                m_stereoResolution.width = stereoViews[xr::StereoView::Left].recommendedImageRectWidth;
+                m_stereoResolution.height = stereoViews[xr::StereoView::Left].recommendedImageRectHeight;
+                m_isQuadViewsSession = true;
+
+                // The swapchains created before the session began can now be read.
+                {
+                    std::unique_lock lock(m_quadViewsSwapchainsMutex);
+                    for (const auto& [swapchain, createInfo] : m_sampledSwapchains) {
+                        if (m_quadViewsSwapchains.find(swapchain) == m_quadViewsSwapchains.cend()) {
+                            wrapQuadViewsSwapchain(compositionFramework, swapchain, createInfo);
+                        }
+                    }
+                }
+
+                uint64_t quadViewsPixels = 0;
+                for (uint32_t i = 0; i < QuadView::Count; i++) {
+                    const XrExtent2Di resolution =
+                        getQuadViewResolution(stereoViews[i % xr::StereoView::Count], i >= xr::StereoView::Count);
+                    quadViewsPixels += (uint64_t)resolution.width * resolution.height;
+                }
+                Log(fmt::format("Quad views: {}x{} stereo resolution, {:.0f}% of the pixels at the recommended size\n",
+                                m_stereoResolution.width,
+                                m_stereoResolution.height,
+                                100.0 * quadViewsPixels / getStereoPixels()));
+            }
+
+            return result;
+        }
+
+        // https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#xrCreateSwapchain
+        XrResult xrCreateSwapchain(XrSession session,
+                                   const XrSwapchainCreateInfo* createInfo,
+                                   XrSwapchain* swapchain) override {
+            if (createInfo->type != XR_TYPE_SWAPCHAIN_CREATE_INFO) {
+                return XR_ERROR_VALIDATION_FAILURE;
+            }
+
+            TraceLoggingWrite(g_traceProvider,
+                              "xrCreateSwapchain",
+                              TLXArg(session, "Session"),
+                              TLArg(createInfo->arraySize, "ArraySize"),
+                              TLArg(createInfo->width, "Width"),
+                              TLArg(createInfo->height, "Height"),
+                              TLArg(createInfo->format, "Format"),
+                              TLArg(createInfo->sampleCount, "SampleCount"),
+                              TLArg(createInfo->usageFlags, "UsageFlags"));
+
+            // Only single-sampled color swapchains can be used as a source for composition.
+            utils::graphics::ICompositionFramework* const compositionFramework =
+                isSessionHandled(session) && m_compositionFrameworkFactory
+                    ? m_compositionFrameworkFactory->getCompositionFramework(session)
+                    : nullptr;
+            if (!compositionFramework || !(createInfo->usageFlags & XR_SWAPCHAIN_USAGE_COLOR_ATTACHMENT_BIT) ||
+                createInfo->sampleCount != 1 || createInfo->faceCount != 1) {
+                return OpenXrApi::xrCreateSwapchain(session, createInfo, swapchain);
+            }
+
+            // The view configuration is only known once the session begins, until then an application sizing its
+            // swapchains for the quad views is the hint that they will be sampled during composition.
+            XrSwapchainCreateInfo sampledCreateInfo = *createInfo;
+            if (m_isQuadViewsSession || m_wereQuadViewsEnumerated) {
+                sampledCreateInfo.usageFlags |= XR_SWAPCHAIN_USAGE_SAMPLED_BIT;
+            }
+            const XrResult result = OpenXrApi::xrCreateSwapchain(session, &sampledCreateInfo, swapchain);
+            if (XR_SUCCEEDED(result) && (sampledCreateInfo.usageFlags & XR_SWAPCHAIN_USAGE_SAMPLED_BIT)) {
+                TraceLoggingWrite(g_traceProvider, "xrCreateSwapchain", TLXArg(*swapchain, "Swapchain"));
+
+                // Swapchains created before the session begins are wrapped by xrBeginSession().
+                sampledCreateInfo.next = nullptr;
+                std::unique_lock lock(m_quadViewsSwapchainsMutex);
+                m_sampledSwapchains.insert_or_assign(*swapchain, sampledCreateInfo);
+                if (m_isQuadViewsSession) {
+                    wrapQuadViewsSwapchain(compositionFramework, *swapchain, sampledCreateInfo);
+                }
+            }
+
+            return result;
+        }
+
+        // https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#xrDestroySwapchain
+        XrResult xrDestroySwapchain(XrSwapchain swapchain) override {
+            TraceLoggingWrite(g_traceProvider, "xrDestroySwapchain", TLXArg(swapchain, "Swapchain"));
+
+            {
+                std::unique_lock lock(m_quadViewsSwapchainsMutex);
+                m_quadViewsSwapchains.erase(swapchain);
+                m_sampledSwapchains.erase(swapchain);
+            }
+
+            return OpenXrApi::xrDestroySwapchain(swapchain);
+        }
+
+        // https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#xrAcquireSwapchainImage
+        XrResult xrAcquireSwapchainImage(XrSwapchain swapchain,
+                                         const XrSwapchainImageAcquireInfo* acquireInfo,
+                                         uint32_t* index) override {
+            TraceLoggingWrite(g_traceProvider, "xrAcquireSwapchainImage", TLXArg(swapchain, "Swapchain"));
+
+            utils::graphics::ISwapchain* const wrappedSwapchain = getQuadViewsSwapchain(swapchain);
+            if (!wrappedSwapchain) {
+                return OpenXrApi::xrAcquireSwapchainImage(swapchain, acquireInfo, index);
+            }
+
+            const XrResult result = wrappedSwapchain->acquireApplicationImage(acquireInfo, index);
+            if (XR_SUCCEEDED(result)) {
+                TraceLoggingWrite(g_traceProvider, "xrAcquireSwapchainImage", TLArg(*index, "Index"));
+            }
+
+            return result;
+        }
+
+        // https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#xrReleaseSwapchainImage
+        XrResult xrReleaseSwapchainImage(XrSwapchain swapchain,
+                                         const XrSwapchainImageReleaseInfo* releaseInfo) override {
+            TraceLoggingWrite(g_traceProvider, "xrReleaseSwapchainImage", TLXArg(swapchain, "Swapchain"));
+
+            utils::graphics::ISwapchain* const wrappedSwapchain = getQuadViewsSwapchain(swapchain);
+            if (!wrappedSwapchain) {
+                return OpenXrApi::xrReleaseSwapchainImage(swapchain, releaseInfo);
+            }
+
+            return wrappedSwapchain->releaseApplicationImage(releaseInfo);
+        }
+
         // https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#xrSuggestInteractionProfileBindings
         XrResult xrSuggestInteractionProfileBindings(
             XrInstance instance, const XrInteractionProfileSuggestedBinding* suggestedBindings) override {
@@ -325,7 +831,7 @@ namespace openxr_api_layer {
             XrResult result = XR_ERROR_RUNTIME_FAILURE;
             const std::string& interactionProfile = getXrPath(suggestedBindings->interactionProfile);
             if (!isPassthrough() && interactionProfile == "/interaction_profiles/ext/eye_gaze_interaction") {
-                std::unique_lock lock(m_actionsAndSpacesMutex);
+                auto lock = lockActionsAndSpaces<std::unique_lock>();
 
                 result = XR_SUCCESS;
                 for (uint32_t i = 0; i < suggestedBindings->countSuggestedBindings; i++) {
@@ -373,7 +879,7 @@ namespace openxr_api_layer {
                 TraceLoggingWrite(g_traceProvider, "xrCreateActionSpace", TLXArg(*space, "Space"));
 
                 if (isSessionHandled(session) && !isPassthrough()) {
-                    std::unique_lock lock(m_actionsAndSpacesMutex);
+                    auto lock = lockActionsAndSpaces<std::unique_lock>();
 
                     ActionSpace actionSpace{};
                     actionSpace.action = createInfo->action;
@@ -389,21 +895,21 @@ namespace openxr_api_layer {
         XrResult xrDestroySpace(XrSpace space) override {
             TraceLoggingWrite(g_traceProvider, "xrDestroySpace", TLXArg(space, "Space"));
 
-            std::unique_lock lock(m_actionsAndSpacesMutex);
-
-            const XrResult result = OpenXrApi::xrDestroySpace(space);
-
-            if (XR_SUCCEEDED(result)) {
+            // Forget the space before destroying it: once destroyed, the runtime may hand out the same handle to
+            // another thread creating a space.
+            {
+                auto lock = lockActionsAndSpaces<std::unique_lock>();
                 m_actionSpaces.erase(space);
             }
 
-            return result;
+            return OpenXrApi::xrDestroySpace(space);
         }
 
         // https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#xrWaitFrame
         XrResult xrWaitFrame(XrSession session,
                              const XrFrameWaitInfo* frameWaitInfo,
                              XrFrameState* frameState) override {
+            allocations::HotPathScope hotPath("xrWaitFrame");
             TraceLoggingWrite(g_traceProvider, "xrWaitFrame", TLXArg(session, "Session"));
 
             const XrResult result = OpenXrApi::xrWaitFrame(session, frameWaitInfo, frameState);
@@ -417,6 +923,24 @@ namespace openxr_api_layer {
 
                 if (isSessionHandled(session)) {
                     m_lastFrameWaitedTime = frameState->predictedDisplayTime;
+                    metrics::Increment(metrics::Counter::FramesWaited);
+                    if (++m_framesWaited == WarmUpFrames) {
+                        allocations::SetWarmedUp(true);
+                    }
+
+                    // Refresh the relation between our clock and XrTime once per frame.
+                    if (m_supportsPerformanceCounterConversion) {
+                        const auto now = std::chrono::high_resolution_clock::now();
+                        LARGE_INTEGER qpcNow;
+                        QueryPerformanceCounter(&qpcNow);
+                        XrTime xrTimeNow;
+                        if (XR_SUCCEEDED(OpenXrApi::xrConvertWin32PerformanceCounterToTimeKHR(
+                                GetXrInstance(), &qpcNow, &xrTimeNow))) {
+                            m_xrTimeOffset = xrTimeNow - std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                             now.time_since_epoch())
+                                                             .count();
+                        }
+                    }
                 }
             }
 
@@ -425,6 +949,7 @@ namespace openxr_api_layer {
 
         // https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#xrBeginFrame
         XrResult xrBeginFrame(XrSession session, const XrFrameBeginInfo* frameBeginInfo) override {
+            allocations::HotPathScope hotPath("xrBeginFrame");
             TraceLoggingWrite(g_traceProvider, "xrBeginFrame", TLXArg(session, "Session"));
 
             const XrResult result = OpenXrApi::xrBeginFrame(session, frameBeginInfo);
@@ -436,42 +961,67 @@ namespace openxr_api_layer {
             return result;
         }
 
+        // https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#xrEndFrame
+        XrResult xrEndFrame(XrSession session, const XrFrameEndInfo* frameEndInfo) override {
+            if (frameEndInfo->type != XR_TYPE_FRAME_END_INFO) {
+                return XR_ERROR_VALIDATION_FAILURE;
+            }
+
+            TraceLoggingWrite(g_traceProvider,
+                              "xrEndFrame",
+                              TLXArg(session, "Session"),
+                              TLArg(frameEndInfo->displayTime, "DisplayTime"),
+                              TLArg(frameEndInfo->layerCount, "LayerCount"));
+
+            // The runtime only knows of the stereo views.
+            const XrFrameEndInfo* submittedFrameEndInfo = frameEndInfo;
+            XrFrameEndInfo stereoFrameEndInfo;
+            if (isSessionHandled(session) && m_isQuadViewsSession) {
+                stereoFrameEndInfo = *frameEndInfo;
+                composeQuadViews(session, stereoFrameEndInfo);
+                submittedFrameEndInfo = &stereoFrameEndInfo;
+            }
+
+            const XrResult result = OpenXrApi::xrEndFrame(session, submittedFrameEndInfo);
+
+            // The layers remain valid until we return, so we pick after submission in order to not delay the frame.
+            if (XR_SUCCEEDED(result) && isSessionHandled(session) && m_isLayerPickingEnabled) {
+                pickGazedLayer(*frameEndInfo);
+            }
+
+            return result;
+        }
+
         // https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#xrLocateSpace
         XrResult xrLocateSpace(XrSpace space, XrSpace baseSpace, XrTime time, XrSpaceLocation* location) override {
             if (location->type != XR_TYPE_SPACE_LOCATION) {
                 return XR_ERROR_VALIDATION_FAILURE;
             }
 
+            allocations::HotPathScope hotPath("xrLocateSpace");
             TraceLoggingWrite(g_traceProvider,
                               "xrLocateSpace",
                               TLXArg(space, "Space"),
                               TLXArg(baseSpace, "BaseSpace"),
                               TLArg(time, "Time"));
 
-            std::unique_lock lock(m_actionsAndSpacesMutex);
-
+            // Only hold the lock for the lookups, engines may locate spaces from many threads concurrently.
             XrPosef queryPoseOffset;
             bool isQueryEyeGaze = false;
+            XrPosef basePoseOffset;
+            bool isBaseEyeGaze = false;
             {
+                auto lock = lockActionsAndSpaces<std::shared_lock>();
+
                 auto it = m_actionSpaces.find(space);
                 if (it != m_actionSpaces.end()) {
-                    if (!it->second.isEyeGaze) {
-                        it->second.isEyeGaze = !!m_eyeGazeActions.count(it->second.action);
-                    }
-                    isQueryEyeGaze = it->second.isEyeGaze.value();
+                    isQueryEyeGaze = !!m_eyeGazeActions.count(it->second.action);
                     queryPoseOffset = it->second.pose;
                 }
-            }
 
-            XrPosef basePoseOffset;
-            bool isBaseEyeGaze = false;
-            {
-                auto it = m_actionSpaces.find(baseSpace);
+                it = m_actionSpaces.find(baseSpace);
                 if (it != m_actionSpaces.end()) {
-                    if (!it->second.isEyeGaze) {
-                        it->second.isEyeGaze = !!m_eyeGazeActions.count(it->second.action);
-                    }
-                    isBaseEyeGaze = it->second.isEyeGaze.value();
+                    isBaseEyeGaze = !!m_eyeGazeActions.count(it->second.action);
                     basePoseOffset = it->second.pose;
                 }
             }
@@ -481,31 +1031,35 @@ namespace openxr_api_layer {
                 assert(!isPassthrough());
                 // TODO: Support the notion of (in)active actionsets and actionset priority.
                 if (isQueryEyeGaze && isBaseEyeGaze) {
-                    location->pose = Pose::Multiply(queryPoseOffset, Pose::Invert(basePoseOffset));
+                    location->pose = vm::storePose(
+                        vm::multiplyPoses(vm::load(queryPoseOffset), vm::invertPose(vm::load(basePoseOffset))));
                     location->locationFlags =
                         XR_SPACE_LOCATION_ORIENTATION_VALID_BIT | XR_SPACE_LOCATION_ORIENTATION_TRACKED_BIT |
                         XR_SPACE_LOCATION_POSITION_VALID_BIT | XR_SPACE_LOCATION_POSITION_TRACKED_BIT;
                     result = XR_SUCCESS;
                 } else {
+                    metrics::Increment(metrics::Counter::EyeGazeLocateSpace);
                     location->locationFlags = 0;
-                    XrVector3f gazeUnitVector;
-                    if (getEyeGaze(time, false, gazeUnitVector)) {
+                    GazeSample gazeSample;
+                    if (getEyeGaze(time, false, gazeSample)) {
                         XrSpaceLocation viewToSpace{XR_TYPE_SPACE_LOCATION};
                         result = OpenXrApi::xrLocateSpace(
                             m_viewSpace, isQueryEyeGaze ? baseSpace : space, time, &viewToSpace);
                         TraceLoggingWrite(
                             g_traceProvider, "xrLocateSpace_LocateViewSpace", TLArg(xr::ToCString(result), "Result"));
                         if (XR_SUCCEEDED(result) && Pose::IsPoseValid(viewToSpace.locationFlags)) {
-                            const XrPosef eyeGazeToView = Pose::MakePose(
-                                Quaternion::RotationRollPitchYaw({tan(gazeUnitVector.y), -tan(gazeUnitVector.x), 0.f}),
-                                XrVector3f{0, 0, 0});
-
-                            location->pose = Pose::Multiply(
-                                Pose::Multiply(eyeGazeToView, isQueryEyeGaze ? queryPoseOffset : basePoseOffset),
-                                viewToSpace.pose);
+                            const vm::Pose eyeGazeToView{
+                                vm::load(utils::gaze::orientationFromDirection(gazeSample.unitVector)),
+                                vm::set(0, 0, 0)};
+
+                            vm::Pose pose = vm::multiplyPoses(
+                                vm::multiplyPoses(eyeGazeToView,
+                                                  vm::load(isQueryEyeGaze ? queryPoseOffset : basePoseOffset)),
+                                vm::load(viewToSpace.pose));
                             if (isBaseEyeGaze) {
-                                location->pose = Pose::Invert(location->pose);
+                                pose = vm::invertPose(pose);
                             }
+                            location->pose = vm::storePose(pose);
 
                             location->locationFlags = viewToSpace.locationFlags;
 
@@ -514,8 +1068,7 @@ namespace openxr_api_layer {
                                 reinterpret_cast<XrEyeGazeSampleTimeEXT*>(location->next);
                             while (gazeSampleTime) {
                                 if (gazeSampleTime->type == XR_TYPE_EYE_GAZE_SAMPLE_TIME_EXT) {
-                                    // TODO: Handle sample time for trackers that support it.
-                                    gazeSampleTime->time = time;
+                                    gazeSampleTime->time = m_xrTimeOffset ? toXrTime(gazeSample.acquisitionTime) : time;
                                     break;
                                 }
                                 gazeSampleTime = reinterpret_cast<XrEyeGazeSampleTimeEXT*>(gazeSampleTime->next);
@@ -543,6 +1096,50 @@ namespace openxr_api_layer {
             return result;
         }
 
+        // https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#xrLocateViews
+        XrResult xrLocateViews(XrSession session,
+                               const XrViewLocateInfo* viewLocateInfo,
+                               XrViewState* viewState,
+                               uint32_t viewCapacityInput,
+                               uint32_t* viewCountOutput,
+                               XrView* views) override {
+            if (viewLocateInfo->type != XR_TYPE_VIEW_LOCATE_INFO || viewState->type != XR_TYPE_VIEW_STATE) {
+                return XR_ERROR_VALIDATION_FAILURE;
+            }
+
+            TraceLoggingWrite(g_traceProvider,
+                              "xrLocateViews",
+                              TLXArg(session, "Session"),
+                              TLArg(xr::ToCString(viewLocateInfo->viewConfigurationType), "ViewConfigurationType"),
+                              TLArg(viewLocateInfo->displayTime, "DisplayTime"),
+                              TLXArg(viewLocateInfo->space, "Space"),
+                              TLArg(viewCapacityInput, "ViewCapacityInput"));
+
+            if (viewLocateInfo->viewConfigurationType == XR_VIEW_CONFIGURATION_TYPE_PRIMARY_QUAD_VARJO &&
+                isSessionHandled(session) && m_isQuadViewsSession) {
+                return locateQuadViews(session, *viewLocateInfo, viewState, viewCapacityInput, viewCountOutput, views);
+            }
+
+            const XrResult result = OpenXrApi::xrLocateViews(
+                session, viewLocateInfo, viewState, viewCapacityInput, viewCountOutput, views);
+
+            if (XR_SUCCEEDED(result) && viewCapacityInput && isSessionHandled(session) &&
+                m_isFoveationEyeTrackedEnabled && !isPassthrough()) {
+                updateFoveationCenters(*viewLocateInfo, *viewState, *viewCountOutput, views);
+            }
+
+            return result;
+        }
+
+        // https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#xrSyncActions
+        XrResult xrSyncActions(XrSession session, const XrActionsSyncInfo* syncInfo) override {
+            // Only intercepted so that the allocation check (see HotPathScope) covers the whole per-frame path.
+            allocations::HotPathScope hotPath("xrSyncActions");
+            TraceLoggingWrite(g_traceProvider, "xrSyncActions", TLXArg(session, "Session"));
+
+            return OpenXrApi::xrSyncActions(session, syncInfo);
+        }
+
         // https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#xrGetActionStatePose
         XrResult xrGetActionStatePose(XrSession session,
                                       const XrActionStateGetInfo* getInfo,
@@ -551,18 +1148,18 @@ namespace openxr_api_layer {
                 return XR_ERROR_VALIDATION_FAILURE;
             }
 
+            allocations::HotPathScope hotPath("xrGetActionStatePose");
             TraceLoggingWrite(g_traceProvider,
                               "xrGetActionStatePose",
                               TLXArg(session, "Session"),
                               TLXArg(getInfo->action, "Action"),
                               TLArg(getXrPath(getInfo->subactionPath).c_str(), "SubactionPath"));
 
-            std::unique_lock lock(m_actionsAndSpacesMutex);
-
             XrResult result = XR_ERROR_RUNTIME_FAILURE;
-            if (isSessionHandled(session) && !isPassthrough() && m_eyeGazeActions.count(getInfo->action)) {
+            if (isSessionHandled(session) && !isPassthrough() && isEyeGazeAction(getInfo->action)) {
                 // TODO: Support the notion of (in)active actionsets and actionset priority.
-                XrVector3f dummy{};
+                metrics::Increment(metrics::Counter::EyeGazeActionState);
+                GazeSample dummy{};
                 state->isActive = getEyeGaze(m_lastFrameBegunTime, true, dummy) ? XR_TRUE : XR_FALSE;
                 result = XR_SUCCESS;
             } else {
@@ -625,10 +1222,8 @@ namespace openxr_api_layer {
                               TLXArg(enumerateInfo->action, "Action"),
                               TLArg(sourceCapacityInput, "SourceCapacityInput"));
 
-            std::unique_lock lock(m_actionsAndSpacesMutex);
-
             XrResult result = XR_ERROR_RUNTIME_FAILURE;
-            if (isSessionHandled(session) && !isPassthrough() && m_eyeGazeActions.count(enumerateInfo->action)) {
+            if (isSessionHandled(session) && !isPassthrough() && isEyeGazeAction(enumerateInfo->action)) {
                 // TODO: Support the notion of (in)active actionsets and actionset priority.
                 *sourceCountOutput = 1;
                 result = XR_SUCCESS;
@@ -715,17 +1310,665 @@ namespace openxr_api_layer {
             return result;
         }
 
+        // https://registry.khronos.org/OpenXR/specs/1.0/html/xrspec.html#xrGetFoveationEyeTrackedStateMETA
+        XrResult xrGetFoveationEyeTrackedStateMETA(XrSession session,
+                                                   XrFoveationEyeTrackedStateMETA* foveationState) override {
+            if (foveationState->type != XR_TYPE_FOVEATION_EYE_TRACKED_STATE_META) {
+                return XR_ERROR_VALIDATION_FAILURE;
+            }
+
+            TraceLoggingWrite(g_traceProvider, "xrGetFoveationEyeTrackedStateMETA", TLXArg(session, "Session"));
+
+            if (!m_isFoveationEyeTrackedEnabled) {
+                return XR_ERROR_FUNCTION_UNSUPPORTED;
+            }
+            if (!isSessionHandled(session)) {
+                return XR_ERROR_HANDLE_INVALID;
+            }
+
+            {
+                std::unique_lock lock(m_foveationMutex);
+                for (uint32_t i = 0; i < XR_FOVEATION_CENTER_SIZE_META; i++) {
+                    foveationState->foveationCenter[i] = m_foveation.centers[i];
+                }
+                foveationState->flags = m_foveation.isValid ? XR_FOVEATION_EYE_TRACKED_STATE_VALID_BIT_META : 0;
+            }
+
+            TraceLoggingWrite(g_traceProvider,
+                              "xrGetFoveationEyeTrackedStateMETA",
+                              TLArg(xr::ToString(foveationState->foveationCenter[0]).c_str(), "LeftCenter"),
+                              TLArg(xr::ToString(foveationState->foveationCenter[1]).c_str(), "RightCenter"),
+                              TLArg(foveationState->flags, "Flags"));
+
+            return XR_SUCCESS;
+        }
+
+        // https://registry.khronos.org/OpenXR/specs/1.0/html/xrspec.html#xrCreateEyeTrackerFB
+        XrResult xrCreateEyeTrackerFB(XrSession session,
+                                      const XrEyeTrackerCreateInfoFB* createInfo,
+                                      XrEyeTrackerFB* eyeTracker) override {
+            if (createInfo->type != XR_TYPE_EYE_TRACKER_CREATE_INFO_FB) {
+                return XR_ERROR_VALIDATION_FAILURE;
+            }
+
+            TraceLoggingWrite(g_traceProvider, "xrCreateEyeTrackerFB", TLXArg(session, "Session"));
+
+            if (!m_isEyeTrackingSocialEnabled) {
+                return XR_ERROR_FUNCTION_UNSUPPORTED;
+            }
+
+            XrResult result = XR_ERROR_RUNTIME_FAILURE;
+            if (isSessionHandled(session) && isEyeTrackingSocialEmulated()) {
+                std::unique_lock lock(m_eyeTrackersMutex);
+                *eyeTracker = reinterpret_cast<XrEyeTrackerFB>(m_nextEyeTracker++);
+                m_eyeTrackers.insert(*eyeTracker);
+                result = XR_SUCCESS;
+            } else if (m_supportsEyeTrackingSocial) {
+                result = OpenXrApi::xrCreateEyeTrackerFB(session, createInfo, eyeTracker);
+            } else {
+                result = XR_ERROR_FEATURE_UNSUPPORTED;
+            }
+
+            if (XR_SUCCEEDED(result)) {
+                TraceLoggingWrite(g_traceProvider, "xrCreateEyeTrackerFB", TLXArg(*eyeTracker, "EyeTracker"));
+            }
+
+            return result;
+        }
+
+        // https://registry.khronos.org/OpenXR/specs/1.0/html/xrspec.html#xrDestroyEyeTrackerFB
+        XrResult xrDestroyEyeTrackerFB(XrEyeTrackerFB eyeTracker) override {
+            TraceLoggingWrite(g_traceProvider, "xrDestroyEyeTrackerFB", TLXArg(eyeTracker, "EyeTracker"));
+
+            if (isEyeTrackerEmulated(eyeTracker)) {
+                std::unique_lock lock(m_eyeTrackersMutex);
+                m_eyeTrackers.erase(eyeTracker);
+                return XR_SUCCESS;
+            }
+
+            return m_supportsEyeTrackingSocial ? OpenXrApi::xrDestroyEyeTrackerFB(eyeTracker)
+                                               : XR_ERROR_HANDLE_INVALID;
+        }
+
+        // https://registry.khronos.org/OpenXR/specs/1.0/html/xrspec.html#xrGetEyeGazesFB
+        XrResult xrGetEyeGazesFB(XrEyeTrackerFB eyeTracker,
+                                 const XrEyeGazesInfoFB* gazeInfo,
+                                 XrEyeGazesFB* eyeGazes) override {
+            if (gazeInfo->type != XR_TYPE_EYE_GAZES_INFO_FB || eyeGazes->type != XR_TYPE_EYE_GAZES_FB) {
+                return XR_ERROR_VALIDATION_FAILURE;
+            }
+
+            TraceLoggingWrite(g_traceProvider,
+                              "xrGetEyeGazesFB",
+                              TLXArg(eyeTracker, "EyeTracker"),
+                              TLXArg(gazeInfo->baseSpace, "BaseSpace"),
+                              TLArg(gazeInfo->time, "Time"));
+
+            if (!isEyeTrackerEmulated(eyeTracker)) {
+                return m_supportsEyeTrackingSocial ? OpenXrApi::xrGetEyeGazesFB(eyeTracker, gazeInfo, eyeGazes)
+                                                   : XR_ERROR_HANDLE_INVALID;
+            }
+
+            metrics::Increment(metrics::Counter::EyeGazesFB);
+            for (uint32_t eye = 0; eye < xr::StereoView::Count; eye++) {
+                eyeGazes->gaze[eye].isValid = XR_FALSE;
+                eyeGazes->gaze[eye].gazePose = Pose::Identity();
+                eyeGazes->gaze[eye].gazeConfidence = 0.f;
+            }
+            eyeGazes->time = gazeInfo->time;
+
+            // Both eyes come from the same sample.
+            GazeSample gazeSample;
+            if (getEyeGaze(gazeInfo->time, false, gazeSample)) {
+                XrSpaceLocation viewToSpace{XR_TYPE_SPACE_LOCATION};
+                const XrResult result =
+                    OpenXrApi::xrLocateSpace(m_viewSpace, gazeInfo->baseSpace, gazeInfo->time, &viewToSpace);
+                if (XR_FAILED(result)) {
+                    return result;
+                }
+
+                if (Pose::IsPoseValid(viewToSpace.locationFlags)) {
+                    // The gaze originates from each eye.
+                    XrViewLocateInfo viewLocateInfo{XR_TYPE_VIEW_LOCATE_INFO};
+                    viewLocateInfo.viewConfigurationType = XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO;
+                    viewLocateInfo.displayTime = gazeInfo->time;
+                    viewLocateInfo.space = m_viewSpace;
+                    XrViewState viewState{XR_TYPE_VIEW_STATE};
+                    XrView eyeViews[xr::StereoView::Count]{{XR_TYPE_VIEW}, {XR_TYPE_VIEW}};
+                    uint32_t viewCount = 0;
+                    const bool hasEyePositions =
+                        XR_SUCCEEDED(OpenXrApi::xrLocateViews(
+                            m_session, &viewLocateInfo, &viewState, xr::StereoView::Count, &viewCount, eyeViews)) &&
+                        (viewState.viewStateFlags & XR_VIEW_STATE_POSITION_VALID_BIT);
+
+                    XrVector3f eyeDirections[xr::StereoView::Count];
+                    for (uint32_t eye = 0; eye < xr::StereoView::Count; eye++) {
+                        eyeDirections[eye] =
+                            gazeSample.isEyeValid[eye] ? gazeSample.eyeUnitVector[eye] : gazeSample.unitVector;
+                    }
+                    XrQuaternionf eyeOrientations[xr::StereoView::Count];
+                    utils::gaze::orientationsFromDirections(eyeDirections, eyeOrientations, xr::StereoView::Count);
+
+                    for (uint32_t eye = 0; eye < xr::StereoView::Count; eye++) {
+                        const vm::Pose eyeGazeToView{
+                            vm::load(eyeOrientations[eye]),
+                            vm::load(hasEyePositions ? eyeViews[eye].pose.position : XrVector3f{})};
+
+                        eyeGazes->gaze[eye].gazePose =
+                            vm::storePose(vm::multiplyPoses(eyeGazeToView, vm::load(viewToSpace.pose)));
+                        eyeGazes->gaze[eye].gazeConfidence = gazeSample.confidence;
+                        eyeGazes->gaze[eye].isValid = XR_TRUE;
+                    }
+                    if (m_xrTimeOffset) {
+                        eyeGazes->time = toXrTime(gazeSample.acquisitionTime);
+                    }
+                }
+            }
+
+            TraceLoggingWrite(
+                g_traceProvider,
+                "xrGetEyeGazesFB",
+                TLArg(!!eyeGazes->gaze[xr::StereoView::Left].isValid, "LeftValid"),
+                TLArg(xr::ToString(eyeGazes->gaze[xr::StereoView::Left].gazePose).c_str(), "LeftGazePose"),
+                TLArg(!!eyeGazes->gaze[xr::StereoView::Right].isValid, "RightValid"),
+                TLArg(xr::ToString(eyeGazes->gaze[xr::StereoView::Right].gazePose).c_str(), "RightGazePose"),
+                TLArg(eyeGazes->time, "Time"));
+
+            return XR_SUCCESS;
+        }
+
+        const GazeLatencyStats* getGazeLatencyStats() const {
+            return m_gazeLatencyStats.get();
+        }
+
+        bool getGazedLayer(GazedLayer& gazedLayer) {
+            std::unique_lock lock(m_gazedLayerMutex);
+            if (!m_gazedLayer) {
+                return false;
+            }
+            gazedLayer = m_gazedLayer.value();
+            return true;
+        }
+
       private:
-        bool getEyeGaze(XrTime time, bool getStateOnly, XrVector3f& unitVector) {
+        // Find the topmost quad or cylinder layer under the gaze. The compositor draws the layers in the order they are
+        // submitted, so we test them in reverse order and stop at the first hit. Projection layers are ignored.
+        void pickGazedLayer(const XrFrameEndInfo& frameEndInfo) {
+            const auto start = std::chrono::high_resolution_clock::now();
+
+            std::optional<GazedLayer> gazedLayer;
+            GazeSample gazeSample;
+            if (getEyeGaze(frameEndInfo.displayTime, false, gazeSample)) {
+                const vm::Pose eyeGazeToView{vm::load(utils::gaze::orientationFromDirection(gazeSample.unitVector)),
+                                             vm::set(0, 0, 0)};
+
+                // Layers usually share a handful of spaces, only locate each of them once per frame.
+                m_layerPickingRays.clear();
+                const auto getGazeRay = [&](XrSpace space) {
+                    for (const auto& gazeRay : m_layerPickingRays) {
+                        if (gazeRay.first == space) {
+                            return gazeRay.second;
+                        }
+                    }
+
+                    std::optional<XrPosef> gazeRay;
+                    XrSpaceLocation viewToSpace{XR_TYPE_SPACE_LOCATION};
+                    if (XR_SUCCEEDED(OpenXrApi::xrLocateSpace(
+                            m_viewSpace, space, frameEndInfo.displayTime, &viewToSpace)) &&
+                        Pose::IsPoseValid(viewToSpace.locationFlags)) {
+                        gazeRay = vm::storePose(vm::multiplyPoses(eyeGazeToView, vm::load(viewToSpace.pose)));
+                    }
+                    m_layerPickingRays.emplace_back(space, gazeRay);
+                    return gazeRay;
+                };
+
+                for (uint32_t i = frameEndInfo.layerCount; i > 0 && !gazedLayer; i--) {
+                    const XrCompositionLayerBaseHeader* layer = frameEndInfo.layers[i - 1];
+                    if (!layer) {
+                        continue;
+                    }
+
+                    utils::hittest::Hit hit;
+                    const XrSwapchainSubImage* subImage = nullptr;
+                    if (layer->type == XR_TYPE_COMPOSITION_LAYER_QUAD) {
+                        const XrCompositionLayerQuad* quad = reinterpret_cast<const XrCompositionLayerQuad*>(layer);
+                        const std::optional<XrPosef> gazeRay = getGazeRay(quad->space);
+                        if (gazeRay && utils::hittest::hitTestQuad(gazeRay.value(), quad->pose, quad->size, hit)) {
+                            subImage = &quad->subImage;
+                        }
+                    } else if (layer->type == XR_TYPE_COMPOSITION_LAYER_CYLINDER_KHR) {
+                        const XrCompositionLayerCylinderKHR* cylinder =
+                            reinterpret_cast<const XrCompositionLayerCylinderKHR*>(layer);
+                        const std::optional<XrPosef> gazeRay = getGazeRay(cylinder->space);
+                        if (gazeRay && utils::hittest::hitTestCylinder(gazeRay.value(),
+                                                                       cylinder->pose,
+                                                                       cylinder->radius,
+                                                                       cylinder->centralAngle,
+                                                                       cylinder->aspectRatio,
+                                                                       hit)) {
+                            subImage = &cylinder->subImage;
+                        }
+                    }
+
+                    if (subImage) {
+                        const XrRect2Di& rect = subImage->imageRect;
+                        GazedLayer result;
+                        result.layerIndex = i - 1;
+                        result.layerType = layer->type;
+                        result.swapchain = subImage->swapchain;
+                        result.uv = hit.uv;
+                        result.pixel = {
+                            rect.offset.x + std::clamp(static_cast<int32_t>(hit.uv.x * rect.extent.width),
+                                                       0,
+                                                       std::max(rect.extent.width - 1, 0)),
+                            rect.offset.y + std::clamp(static_cast<int32_t>(hit.uv.y * rect.extent.height),
+                                                       0,
+                                                       std::max(rect.extent.height - 1, 0))};
+                        result.space = layer->space;
+                        result.position = hit.pose.position;
+                        result.displayTime = frameEndInfo.displayTime;
+                        gazedLayer = result;
+                    }
+                }
+            }
+
+            metrics::Record(metrics::Histogram::LayerPickingTime,
+                            toNanoseconds(std::chrono::high_resolution_clock::now() - start));
+            const int64_t layerIndex = gazedLayer ? static_cast<int64_t>(gazedLayer->layerIndex) : -1;
+            metrics::SetGauge(metrics::Gauge::GazedLayerIndex, layerIndex);
+            TraceLoggingWrite(g_traceProvider,
+                              "GazedLayer",
+                              TLArg(layerIndex, "LayerIndex"),
+                              TLArg(xr::ToString(gazedLayer ? gazedLayer->uv : XrVector2f{}).c_str(), "UV"));
+
+            std::unique_lock lock(m_gazedLayerMutex);
+            m_gazedLayer = gazedLayer;
+        }
+
+        // Project the gaze onto the view of each eye, in normalized device coordinates clamped to the field of view.
+        // The views may be canted, so the gaze is first brought into the space of each view, whose orientation relative
+        // to the head does not depend on the space used by the application.
+        bool projectGazeToViews(const XrViewLocateInfo& viewLocateInfo,
+                                const XrViewState& viewState,
+                                uint32_t viewCount,
+                                const XrView* views,
+                                XrVector2f (&centers)[xr::StereoView::Count]) {
+            GazeSample gazeSample;
+            XrSpaceLocation spaceToView{XR_TYPE_SPACE_LOCATION};
+            if (!viewCount || !(viewState.viewStateFlags & XR_VIEW_STATE_ORIENTATION_VALID_BIT) ||
+                !getEyeGaze(viewLocateInfo.displayTime, false, gazeSample) ||
+                XR_FAILED(OpenXrApi::xrLocateSpace(
+                    viewLocateInfo.space, m_viewSpace, viewLocateInfo.displayTime, &spaceToView)) ||
+                !(spaceToView.locationFlags & XR_SPACE_LOCATION_ORIENTATION_VALID_BIT)) {
+                return false;
+            }
+
+            for (uint32_t i = 0; i < xr::StereoView::Count; i++) {
+                // Mono configurations share their only view between both eyes.
+                const XrView& view = views[std::min(i, viewCount - 1)];
+                const XrVector3f& gazeInView =
+                    gazeSample.isEyeValid[i] ? gazeSample.eyeUnitVector[i] : gazeSample.unitVector;
+
+                const vm::Vector eyeOrientation = vm::multiplyQuaternions(vm::load(view.pose.orientation),
+                                                                          vm::load(spaceToView.pose.orientation));
+                const XrVector3f gazeInEye =
+                    vm::storeVector3(vm::rotate(vm::load(gazeInView), vm::conjugate(eyeOrientation)));
+
+                XrVector2f& center = centers[i];
+                if (!utils::gaze::projectToView(gazeInEye, view.fov, center)) {
+                    return false;
+                }
+                center.x = std::clamp(center.x, -1.f, 1.f);
+                center.y = std::clamp(center.y, -1.f, 1.f);
+            }
+
+            return true;
+        }
+
+        // Foveation centers for XR_META_foveation_eye_tracked, computed once per display time.
+        void updateFoveationCenters(const XrViewLocateInfo& viewLocateInfo,
+                                    const XrViewState& viewState,
+                                    uint32_t viewCount,
+                                    const XrView* views) {
+            {
+                std::unique_lock lock(m_foveationMutex);
+                if (m_foveation.displayTime == viewLocateInfo.displayTime) {
+                    return;
+                }
+            }
+
+            static_assert(XR_FOVEATION_CENTER_SIZE_META == xr::StereoView::Count);
+            FoveationCenters foveation{};
+            foveation.displayTime = viewLocateInfo.displayTime;
+            foveation.isValid = projectGazeToViews(viewLocateInfo, viewState, viewCount, views, foveation.centers);
+            if (!foveation.isValid) {
+                foveation.centers[xr::StereoView::Left] = foveation.centers[xr::StereoView::Right] = {};
+            }
+
+            TraceLoggingWrite(g_traceProvider,
+                              "FoveationCenters",
+                              TLArg(foveation.isValid, "Valid"),
+                              TLArg(xr::ToString(foveation.centers[0]).c_str(), "LeftCenter"),
+                              TLArg(xr::ToString(foveation.centers[1]).c_str(), "RightCenter"));
+
+            std::unique_lock lock(m_foveationMutex);
+            m_foveation = foveation;
+        }
+
+        // Locate the stereo views, and derive the quad views from them: the context views are the stereo views, and the
+        // focus views share their poses with a field of view around the gaze (or straight ahead without gaze).
+        XrResult locateQuadViews(XrSession session,
+                                 const XrViewLocateInfo& viewLocateInfo,
+                                 XrViewState* viewState,
+                                 uint32_t viewCapacityInput,
+                                 uint32_t* viewCountOutput,
+                                 XrView* views) {
+            XrViewLocateInfo stereoViewLocateInfo = viewLocateInfo;
+            stereoViewLocateInfo.viewConfigurationType = XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO;
+            XrView stereoViews[xr::StereoView::Count]{{XR_TYPE_VIEW}, {XR_TYPE_VIEW}};
+            uint32_t stereoViewCount = 0;
+            const XrResult result = OpenXrApi::xrLocateViews(
+                session, &stereoViewLocateInfo, viewState, xr::StereoView::Count, &stereoViewCount, stereoViews);
+            if (XR_FAILED(result)) {
+                return result;
+            }
+
+            *viewCountOutput = QuadView::Count;
+            if (!viewCapacityInput) {
+                return result;
+            }
+            if (viewCapacityInput < QuadView::Count) {
+                return XR_ERROR_SIZE_INSUFFICIENT;
+            }
+
+            XrVector2f centers[xr::StereoView::Count]{};
+            const bool isGazeValid =
+                projectGazeToViews(stereoViewLocateInfo, *viewState, stereoViewCount, stereoViews, centers);
+            if (!isGazeValid) {
+                for (uint32_t eye = 0; eye < xr::StereoView::Count; eye++) {
+                    if (!utils::gaze::projectToView({0.f, 0.f, -1.f}, stereoViews[eye].fov, centers[eye])) {
+                        centers[eye] = {};
+                    }
+                }
+            }
+
+            for (uint32_t i = 0; i < QuadView::Count; i++) {
+                if (views[i].type != XR_TYPE_VIEW) {
+                    return XR_ERROR_VALIDATION_FAILURE;
+                }
+
+                const uint32_t eye = i % xr::StereoView::Count;
+                views[i].pose = stereoViews[eye].pose;
+                views[i].fov = i < xr::StereoView::Count ? stereoViews[eye].fov
+                                                         : utils::gaze::focusFov(stereoViews[eye].fov,
+                                                                                 centers[eye],
+                                                                                 m_quadViewsFocusFraction.x,
+                                                                                 m_quadViewsFocusFraction.y);
+            }
+
+            TraceLoggingWrite(g_traceProvider,
+                              "xrLocateViews_QuadViews",
+                              TLArg(isGazeValid, "GazeValid"),
+                              TLArg(xr::ToString(views[QuadView::FocusLeft].fov).c_str(), "FocusLeftFov"),
+                              TLArg(xr::ToString(views[QuadView::FocusRight].fov).c_str(), "FocusRightFov"));
+
+            if (m_isFoveationEyeTrackedEnabled) {
+                updateFoveationCenters(stereoViewLocateInfo, *viewState, stereoViewCount, stereoViews);
+            }
+
+            return result;
+        }
+
+        // Composite the four views of the projection layers into stereo views, by drawing the focus views over the
+        // upscaled context views, and substitute the layers of the frame. Only the color is composited: the depth
+        // submitted by the application is not forwarded to the runtime.
+        void composeQuadViews(XrSession session, XrFrameEndInfo& frameEndInfo) {
+            const auto start = std::chrono::high_resolution_clock::now();
+
+            utils::graphics::ICompositionFramework* const compositionFramework =
+                m_compositionFrameworkFactory->getCompositionFramework(session);
+
+            // The storage is reused across frames, and reserved upfront so that the layers can point into it.
+            m_quadViewsLayers.clear();
+            m_quadViewsCompositions.clear();
+            m_stereoLayers.clear();
+            m_stereoLayers.reserve(frameEndInfo.layerCount);
+            m_stereoLayerViews.clear();
+            m_stereoLayerViews.reserve(frameEndInfo.layerCount);
+
+            // Collect the images to read and acquire the images to write, before serializing for composition.
+            uint64_t submittedPixels = 0;
+            for (uint32_t i = 0; i < frameEndInfo.layerCount; i++) {
+                const XrCompositionLayerBaseHeader* const layer = frameEndInfo.layers[i];
+                if (layer->type != XR_TYPE_COMPOSITION_LAYER_PROJECTION ||
+                    reinterpret_cast<const XrCompositionLayerProjection*>(layer)->viewCount != QuadView::Count) {
+                    m_quadViewsLayers.push_back(layer);
+                    continue;
+                }
+
+                QuadViewsComposition composition{};
+                composition.layer = reinterpret_cast<const XrCompositionLayerProjection*>(layer);
+                bool isComplete = true;
+                for (uint32_t view = 0; view < QuadView::Count; view++) {
+                    const XrSwapchainSubImage& subImage = composition.layer->views[view].subImage;
+                    utils::graphics::ISwapchain* const swapchain = getQuadViewsSwapchain(subImage.swapchain);
+                    composition.sourceImages[view] = swapchain ? swapchain->getLastReleasedImage() : nullptr;
+                    isComplete = isComplete && composition.sourceImages[view];
+                    submittedPixels += (uint64_t)subImage.imageRect.extent.width * subImage.imageRect.extent.height;
+                }
+                if (!isComplete) {
+                    ErrorLog(fmt::format("Dropping quad views layer {} without composable images\n", i));
+                    continue;
+                }
+
+                const size_t index = m_quadViewsCompositions.size();
+                if (m_stereoSwapchains.size() <= index) {
+                    m_stereoSwapchains.push_back(createStereoSwapchain(
+                        compositionFramework,
+                        getQuadViewsSwapchain(composition.layer->views[QuadView::Left].subImage.swapchain)
+                            ->getFormatOnApplicationDevice()));
+                }
+                composition.destinationImage = m_stereoSwapchains[index]->acquireImage();
+
+                // The stereo layer takes the place of the quad views layer.
+                composition.layerIndex = (uint32_t)m_quadViewsLayers.size();
+                m_quadViewsLayers.push_back(layer);
+                m_quadViewsCompositions.push_back(composition);
+            }
+
+            if (!m_quadViewsCompositions.empty()) {
+                compositionFramework->serializePreComposition();
+
+                utils::graphics::IGraphicsDevice* const compositionDevice =
+                    compositionFramework->getCompositionDevice();
+                const XrRect2Di stereoRect{{0, 0}, m_stereoResolution};
+                for (size_t i = 0; i < m_quadViewsCompositions.size(); i++) {
+                    const QuadViewsComposition& composition = m_quadViewsCompositions[i];
+                    utils::graphics::IGraphicsTexture* const destination =
+                        composition.destinationImage->getTextureForWrite();
+
+                    std::array<XrCompositionLayerProjectionView, xr::StereoView::Count>& stereoViews =
+                        m_stereoLayerViews.emplace_back();
+                    for (uint32_t eye = 0; eye < xr::StereoView::Count; eye++) {
+                        const XrCompositionLayerProjectionView& context = composition.layer->views[eye];
+                        const XrCompositionLayerProjectionView& focus =
+                            composition.layer->views[eye + xr::StereoView::Count];
+
+                        compositionDevice->blitTexture(composition.sourceImages[eye]->getTextureForRead(),
+                                                       context.subImage.imageRect,
+                                                       context.subImage.imageArrayIndex,
+                                                       destination,
+                                                       stereoRect,
+                                                       eye);
+                        const XrRect2Di focusRect = getFocusRect(context.fov, focus.fov, m_stereoResolution);
+                        if (focusRect.extent.width > 0 && focusRect.extent.height > 0) {
+                            compositionDevice->blitTexture(
+                                composition.sourceImages[eye + xr::StereoView::Count]->getTextureForRead(),
+                                focus.subImage.imageRect,
+                                focus.subImage.imageArrayIndex,
+                                destination,
+                                focusRect,
+                                eye);
+                        }
+
+                        stereoViews[eye] = {XR_TYPE_COMPOSITION_LAYER_PROJECTION_VIEW};
+                        stereoViews[eye].pose = context.pose;
+                        stereoViews[eye].fov = context.fov;
+                        stereoViews[eye].subImage.swapchain = m_stereoSwapchains[i]->getSwapchainHandle();
+                        stereoViews[eye].subImage.imageRect = stereoRect;
+                        stereoViews[eye].subImage.imageArrayIndex = eye;
+                    }
+                    m_stereoSwapchains[i]->releaseImage();
+
+                    XrCompositionLayerProjection& stereoLayer = m_stereoLayers.emplace_back(*composition.layer);
+                    stereoLayer.viewCount = xr::StereoView::Count;
+                    stereoLayer.views = stereoViews.data();
+                    m_quadViewsLayers[composition.layerIndex] =
+                        reinterpret_cast<const XrCompositionLayerBaseHeader*>(&stereoLayer);
+                }
+
+                compositionFramework->serializePostComposition();
+                for (size_t i = 0; i < m_quadViewsCompositions.size(); i++) {
+                    m_stereoSwapchains[i]->commitLastReleasedImage();
+                }
+
+                metrics::Increment(metrics::Counter::QuadViewsFramesComposed);
+                metrics::SetGauge(metrics::Gauge::QuadViewsPixelsPercent,
+                                  (int64_t)(submittedPixels * 100 / std::max(getStereoPixels(), 1ull)));
+            }
+
+            // The images of the application must be released before the runtime sees the frame.
+            releaseQuadViewsImages();
+
+            frameEndInfo.layerCount = (uint32_t)m_quadViewsLayers.size();
+            frameEndInfo.layers = m_quadViewsLayers.data();
+
+            const auto duration = std::chrono::high_resolution_clock::now() - start;
+            metrics::Record(metrics::Histogram::QuadViewsCompositionTime, toNanoseconds(duration));
+
+            TraceLoggingWrite(g_traceProvider,
+                              "QuadViews_Compose",
+                              TLArg(m_quadViewsCompositions.size(), "LayerCount"),
+                              TLArg(submittedPixels, "SubmittedPixels"),
+                              TLArg(toNanoseconds(duration), "DurationNs"));
+        }
+
+        std::shared_ptr<utils::graphics::ISwapchain>
+        createStereoSwapchain(utils::graphics::ICompositionFramework* compositionFramework, int64_t format) const {
+            XrSwapchainCreateInfo createInfo{XR_TYPE_SWAPCHAIN_CREATE_INFO};
+            createInfo.usageFlags = XR_SWAPCHAIN_USAGE_COLOR_ATTACHMENT_BIT | XR_SWAPCHAIN_USAGE_SAMPLED_BIT;
+            createInfo.format = format;
+            createInfo.sampleCount = 1;
+            createInfo.width = m_stereoResolution.width;
+            createInfo.height = m_stereoResolution.height;
+            createInfo.faceCount = 1;
+            createInfo.arraySize = xr::StereoView::Count;
+            createInfo.mipCount = 1;
+            return compositionFramework->createSwapchain(
+                createInfo, utils::graphics::SwapchainMode::Submit | utils::graphics::SwapchainMode::Write);
+        }
+
+        // Region of the image of a context view covered by a focus view with the same pose.
+        static XrRect2Di getFocusRect(const XrFovf& contextFov, const XrFovf& focusFov, const XrExtent2Di& extent) {
+            const float tanLeft = std::tan(contextFov.angleLeft);
+            const float tanRight = std::tan(contextFov.angleRight);
+            const float tanUp = std::tan(contextFov.angleUp);
+            const float tanDown = std::tan(contextFov.angleDown);
+            const auto toX = [&](float angle) {
+                return (int32_t)std::round(
+                    std::clamp((std::tan(angle) - tanLeft) / (tanRight - tanLeft), 0.f, 1.f) * extent.width);
+            };
+            const auto toY = [&](float angle) {
+                return (int32_t)std::round(
+                    std::clamp((tanUp - std::tan(angle)) / (tanUp - tanDown), 0.f, 1.f) * extent.height);
+            };
+
+            const int32_t left = toX(focusFov.angleLeft);
+            const int32_t top = toY(focusFov.angleUp);
+            return {{left, top}, {toX(focusFov.angleRight) - left, toY(focusFov.angleDown) - top}};
+        }
+
+        // Context views cover the field of view of the stereo views, and focus views a fraction of it.
+        XrExtent2Di getQuadViewResolution(const XrViewConfigurationView& stereoView, bool isFocus) const {
+            const float scaleX =
+                isFocus ? m_quadViewsFocusFraction.x * m_quadViewsFocusDensity : m_quadViewsContextDensity;
+            const float scaleY =
+                isFocus ? m_quadViewsFocusFraction.y * m_quadViewsFocusDensity : m_quadViewsContextDensity;
+            return {(int32_t)std::clamp((uint32_t)std::round(stereoView.recommendedImageRectWidth * scaleX),
+                                        1u,
+                                        std::max(stereoView.maxImageRectWidth, 1u)),
+                    (int32_t)std::clamp((uint32_t)std::round(stereoView.recommendedImageRectHeight * scaleY),
+                                        1u,
+                                        std::max(stereoView.maxImageRectHeight, 1u))};
+        }
+
+        uint64_t getStereoPixels() const {
+            return (uint64_t)xr::StereoView::Count * m_stereoResolution.width * m_stereoResolution.height;
+        }
+
+        // Must be called with m_quadViewsSwapchainsMutex held.
+        void wrapQuadViewsSwapchain(utils::graphics::ICompositionFramework* compositionFramework,
+                                    XrSwapchain swapchain,
+                                    const XrSwapchainCreateInfo& createInfo) {
+            try {
+                m_quadViewsSwapchains.insert_or_assign(
+                    swapchain,
+                    compositionFramework->wrapApplicationSwapchain(
+                        swapchain, createInfo, utils::graphics::SwapchainMode::Read));
+            } catch (std::exception& exc) {
+                // The swapchain is still usable for anything but the quad views.
+                ErrorLog(fmt::format("Could not wrap swapchain for quad views: {}\n", exc.what()));
+            }
+        }
+
+        // Hand the images held for composition back to the runtime.
+        void releaseQuadViewsImages() {
+            std::unique_lock lock(m_quadViewsSwapchainsMutex);
+            for (const auto& [handle, swapchain] : m_quadViewsSwapchains) {
+                swapchain->commitLastReleasedImage();
+            }
+        }
+
+        utils::graphics::ISwapchain* getQuadViewsSwapchain(XrSwapchain swapchain) {
+            std::unique_lock lock(m_quadViewsSwapchainsMutex);
+            const auto it = m_quadViewsSwapchains.find(swapchain);
+            return it != m_quadViewsSwapchains.end() ? it->second.get() : nullptr;
+        }
+
+        bool getEyeGaze(XrTime time, bool getStateOnly, GazeSample& sample) {
             bool result = false;
             switch (m_trackerType) {
             default:
                 if (m_tracker) {
+                    auto lock = lockTrackerState(m_trackerMutex);
                     if (!getStateOnly) {
-                        result = m_tracker->getGaze(time, unitVector);
+                        const auto acquisitionStart = std::chrono::high_resolution_clock::now();
+                        sample.acquisitionTime = acquisitionStart;
+                        result = m_tracker->getGaze(time, sample);
+                        const auto now = std::chrono::high_resolution_clock::now();
+
+                        updateGazeMetrics(result, sample, acquisitionStart, now);
+                        if (m_gazeLatencyStats) {
+                            m_gazeLatencyStats->acquisitionCost.record(toNanoseconds(now - acquisitionStart));
+                            if (result) {
+                                m_gazeLatencyStats->sampleAge.record(toNanoseconds(now - sample.acquisitionTime));
+                                if (m_xrTimeOffset) {
+                                    const XrTime horizon = m_lastFrameWaitedTime - toXrTime(now);
+                                    if (horizon >= 0) {
+                                        m_gazeLatencyStats->displayHorizon.record(horizon);
+                                    } else {
+                                        m_gazeLatencyStats->lateSamples.fetch_add(1, std::memory_order_relaxed);
+                                    }
+                                }
+                            }
+                        }
                     } else {
                         result = m_tracker->isGazeAvailable(time);
                     }
+
+                    if (!result && m_trackerType == TrackerType::Shared && m_tracker->hasPublisherExited()) {
+                        promoteToPublisher();
+                    }
                 }
                 break;
 
@@ -736,11 +1979,168 @@ namespace openxr_api_layer {
             TraceLoggingWrite(g_traceProvider,
                               "EyeGaze",
                               TLArg(result, "Valid"),
-                              TLArg(xr::ToString(unitVector).c_str(), "GazeUnitVector"));
+                              TLArg(xr::ToString(sample.unitVector).c_str(), "GazeUnitVector"));
 
             return result;
         }
 
+        void updateGazeMetrics(bool isValid,
+                               const GazeSample& sample,
+                               std::chrono::high_resolution_clock::time_point acquisitionStart,
+                               std::chrono::high_resolution_clock::time_point now) {
+            metrics::Increment(metrics::Counter::GazeQueries);
+            metrics::Record(metrics::Histogram::GazeAcquisitionCost, toNanoseconds(now - acquisitionStart));
+            if (isValid) {
+                metrics::Increment(metrics::Counter::GazeValidSamples);
+                metrics::Record(metrics::Histogram::GazeSampleAge, toNanoseconds(now - sample.acquisitionTime));
+                if (m_staleSince) {
+                    metrics::Record(metrics::Histogram::StalePeriodDuration, toNanoseconds(now - m_staleSince.value()));
+                    metrics::SetGauge(metrics::Gauge::StaleMilliseconds, 0);
+                    m_staleSince.reset();
+                }
+            } else {
+                metrics::Increment(metrics::Counter::GazeInvalidSamples);
+                if (!m_staleSince) {
+                    metrics::Increment(metrics::Counter::StalePeriods);
+                    m_staleSince = now;
+                }
+                metrics::SetGauge(
+                    metrics::Gauge::StaleMilliseconds,
+                    std::chrono::duration_cast<std::chrono::milliseconds>(now - m_staleSince.value()).count());
+            }
+        }
+
+        XrTime toXrTime(std::chrono::high_resolution_clock::time_point time) const {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count() +
+                   m_xrTimeOffset;
+        }
+
+        // Open the eye tracker for the headset reported by the runtime, or attach to the gaze shared by another process
+        // when allowed.
+        std::unique_ptr<IEyeTracker> createEyeTracker(std::string_view systemName,
+                                                      bool supportsEyeTracking,
+                                                      bool canAttachToSharedGaze = true) {
+            const config::Settings& settings = config::GetSettings();
+            if (!settings.replayTracker.empty()) {
+                // Configuration requested to play back a gaze recording.
+                return createReplayEyeTracker(
+                    settings.replayTracker, settings.replayRealTime, std::chrono::seconds(settings.replayStartSeconds));
+            }
+            if (settings.simulateTracker) {
+                // Configuration requested the mouse simulated eye tracking.
+                return createSimulatedEyeTracker();
+            }
+            if (supportsEyeTracking) {
+                // Quest Pro only supports "social eye tracking", which we can translate into eye gaze interaction.
+                return createQuestProEyeTracker(*this);
+            }
+
+            // Another process may already own the eye tracker.
+            if (settings.shareTracker && canAttachToSharedGaze) {
+                if (auto tracker = createSharedEyeTracker()) {
+                    return tracker;
+                }
+            }
+
+            // Attempt to initialize external eye tracking API.
+#ifdef _WIN64
+            if (systemName.find("Windows Mixed Reality") != std::string::npos ||
+                systemName.find("SteamVR/OpenXR : holographic") != std::string::npos) {
+                return createOmniceptEyeTracker();
+            }
+#endif
+            if (systemName.find("SteamVR/OpenXR : aapvr") != std::string::npos) {
+                return createPimaxEyeTracker();
+            }
+            if (systemName.find("SteamVR/OpenXR : oculus") != std::string::npos) {
+                auto tracker = createVirtualDesktopEyeTracker();
+                return tracker ? std::move(tracker) : createSteamLinkEyeTracker();
+            }
+            if (systemName.find("SteamVR/OpenXR : playstation_vr2") != std::string::npos) {
+                return createPsvr2ToolkitEyeTracker();
+            }
+            if (systemName.find("SteamVR/OpenXR : lighthouse") != std::string::npos) {
+                // For now, we just check for lighthouse, as the Beyond 2E supports VRChat OSC.
+                return createVRChatOSCEyeTracker();
+            }
+            if (systemName.find("SteamVR/OpenXR") != std::string::npos) {
+                return createVarjoEyeTracker();
+            }
+            return {};
+        }
+
+        // The process publishing the shared gaze exited: open our own tracker and publish its samples in turn. When
+        // another reader was faster, createGazePublisher() attaches to it instead. Called with m_trackerMutex held.
+        void promoteToPublisher() {
+            std::unique_ptr<IEyeTracker> tracker = createEyeTracker(m_systemName, m_supportsEyeTracking, false);
+            if (!tracker) {
+                return;
+            }
+
+            const config::Settings& settings = config::GetSettings();
+            tracker = createGazePublisher(std::move(tracker));
+            const TrackerType trackerType = tracker->getType();
+            Log(fmt::format("The process sharing the gaze exited, using eye tracking: {}\n",
+                            getTrackerType(trackerType)));
+            if (trackerType != TrackerType::Replay && settings.recordTracker) {
+                tracker = createGazeRecorder(std::move(tracker), localAppData);
+            }
+
+            if (m_session != XR_NULL_HANDLE) {
+                tracker->start(m_session);
+                tracker->setActive(m_isTrackerActive);
+            }
+            m_tracker = std::move(tracker);
+            m_trackerType = trackerType;
+            metrics::SetGauge(metrics::Gauge::TrackerType, static_cast<int64_t>(m_trackerType));
+        }
+
+        // Park or resume the acquisition threads of the tracker. The CPU usage of the process while parked is logged
+        // upon resuming, as a measure of the background cost of the application.
+        void setTrackerActive(bool active) {
+            if (active == m_isTrackerActive) {
+                return;
+            }
+
+            const auto now = std::chrono::high_resolution_clock::now();
+            m_tracker->setActive(active);
+            if (active) {
+                metrics::Record(metrics::Histogram::TrackerResumeTime,
+                                toNanoseconds(std::chrono::high_resolution_clock::now() - now));
+
+                const double parkedSeconds = std::chrono::duration<double>(now - m_trackerParkedSince).count();
+                const double cpuSeconds =
+                    std::chrono::duration<double>(getProcessCpuTime() - m_trackerParkedCpuTime).count();
+                Log(fmt::format("Tracker resumed after {:.1f}s parked, process CPU usage meanwhile: {:.1f}%\n",
+                                parkedSeconds,
+                                parkedSeconds > 0 ? 100.0 * cpuSeconds / parkedSeconds : 0.0));
+            } else {
+                m_trackerParkedSince = now;
+                m_trackerParkedCpuTime = getProcessCpuTime();
+            }
+
+            m_isTrackerActive = active;
+            metrics::SetGauge(metrics::Gauge::TrackerActive, active ? 1 : 0);
+        }
+
+        // User and kernel time of all the threads of the process.
+        static std::chrono::nanoseconds getProcessCpuTime() {
+            FILETIME creationTime, exitTime, kernelTime, userTime;
+            if (!GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime)) {
+                return {};
+            }
+
+            const auto toDuration = [](const FILETIME& time) {
+                return std::chrono::nanoseconds(
+                    ((static_cast<uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime) * 100);
+            };
+            return toDuration(kernelTime) + toDuration(userTime);
+        }
+
+        static uint64_t toNanoseconds(std::chrono::high_resolution_clock::duration duration) {
+            return std::max(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count(), 0ll);
+        }
+
         const std::string getXrPath(XrPath path) {
             if (path == XR_NULL_PATH) {
                 return "";
@@ -766,11 +2166,37 @@ namespace openxr_api_layer {
             return m_trackerType == TrackerType::EyeGazeInteraction;
         }
 
+        // The runtime already implements XR_FB_eye_tracking_social for the Quest Pro (and for the passthrough mode when
+        // it supports the extension), we serve it from our own tracker in all other cases.
+        bool isEyeTrackingSocialEmulated() const {
+            return m_tracker && m_trackerType != TrackerType::QuestPro;
+        }
+
+        // The quad views are only offered on top of a working eye tracker.
+        bool isQuadViewsEmulated(XrSystemId systemId) const {
+            return m_isQuadViewsEnabled && isSystemHandled(systemId) && m_tracker;
+        }
+
+        bool isEyeTrackerEmulated(XrEyeTrackerFB eyeTracker) {
+            std::unique_lock lock(m_eyeTrackersMutex);
+            return m_eyeTrackers.count(eyeTracker);
+        }
+
+        template <template <typename> typename Lock>
+        Lock<std::shared_mutex> lockActionsAndSpaces() {
+            return metrics::LockMeasuringContention<Lock>(m_actionsAndSpacesMutex,
+                                                          metrics::Counter::ActionsAndSpacesLockContended,
+                                                          metrics::Histogram::ActionsAndSpacesLockWait);
+        }
+
+        bool isEyeGazeAction(XrAction action) {
+            auto lock = lockActionsAndSpaces<std::shared_lock>();
+            return m_eyeGazeActions.count(action);
+        }
+
         struct ActionSpace {
             XrAction action;
             XrPosef pose;
-
-            std::optional<bool> isEyeGaze;
         };
 
         bool m_bypassApiLayer{false};
@@ -779,13 +2205,89 @@ namespace openxr_api_layer {
         XrSpace m_viewSpace{XR_NULL_HANDLE};
         std::unique_ptr<IEyeTracker> m_tracker{};
         TrackerType m_trackerType{TrackerType::None};
+        // What the runtime reported in xrGetSystem(), to open the tracker again (see promoteToPublisher()).
+        std::string m_systemName;
+        bool m_supportsEyeTracking{false};
 
         XrTime m_lastFrameBegunTime{};
         XrTime m_lastFrameWaitedTime{};
+        uint32_t m_framesWaited{0};
 
-        std::mutex m_actionsAndSpacesMutex;
+        // Conversion from our clock to XrTime, when supported by the runtime.
+        bool m_supportsPerformanceCounterConversion{false};
+        XrTime m_xrTimeOffset{0};
+
+        std::unique_ptr<GazeLatencyStats> m_gazeLatencyStats;
+        // Serializes the calls to the tracker, which may come from several application threads.
+        std::mutex m_trackerMutex;
+        // Protected by m_trackerMutex.
+        std::optional<std::chrono::high_resolution_clock::time_point> m_staleSince;
+
+        std::unique_ptr<config::ISettingsWatcher> m_settingsWatcher;
+
+        // Follows the state of the session, see xrPollEvent().
+        bool m_isTrackerActive{false};
+        std::chrono::high_resolution_clock::time_point m_trackerParkedSince{};
+        std::chrono::nanoseconds m_trackerParkedCpuTime{};
+
+        // Lookups are far more frequent than updates.
+        std::shared_mutex m_actionsAndSpacesMutex;
         std::unordered_set<XrAction> m_eyeGazeActions;
         std::unordered_map<XrSpace, ActionSpace> m_actionSpaces;
+
+        bool m_isLayerPickingEnabled{false};
+        // Reused across frames to avoid allocations. Only accessed from xrEndFrame().
+        std::vector<std::pair<XrSpace, std::optional<XrPosef>>> m_layerPickingRays;
+        std::mutex m_gazedLayerMutex;
+        std::optional<GazedLayer> m_gazedLayer;
+
+        // Foveation centers in normalized device coordinates of each view, for XR_META_foveation_eye_tracked.
+        struct FoveationCenters {
+            XrTime displayTime;
+            XrVector2f centers[XR_FOVEATION_CENTER_SIZE_META];
+            bool isValid;
+        };
+
+        bool m_isFoveationEyeTrackedEnabled{false};
+        std::mutex m_foveationMutex;
+        FoveationCenters m_foveation{};
+
+        bool m_isEyeTrackingSocialEnabled{false};
+        bool m_supportsEyeTrackingSocial{false};
+        // Handles of the emulated eye trackers, never passed to the runtime.
+        std::mutex m_eyeTrackersMutex;
+        std::unordered_set<XrEyeTrackerFB> m_eyeTrackers;
+        uint64_t m_nextEyeTracker{1};
+
+        // XR_VARJO_quad_views emulation.
+        struct QuadViewsComposition {
+            const XrCompositionLayerProjection* layer;
+            uint32_t layerIndex;
+            utils::graphics::ISwapchainImage* sourceImages[QuadView::Count];
+            utils::graphics::ISwapchainImage* destinationImage;
+        };
+
+        bool m_isQuadViewsEnabled{false};
+        // Fractions of the tangent extents of the field of view covered by the focus views.
+        XrVector2f m_quadViewsFocusFraction{};
+        // Pixel density relative to the recommended resolution of the stereo views.
+        float m_quadViewsContextDensity{1.f};
+        float m_quadViewsFocusDensity{1.f};
+        std::shared_ptr<utils::graphics::ICompositionFrameworkFactory> m_compositionFrameworkFactory;
+        bool m_isQuadViewsSession{false};
+        XrExtent2Di m_stereoResolution{};
+        bool m_wereQuadViewsEnumerated{false};
+        // Swapchains of the application that can be sampled, and the wrappers reading them during composition while
+        // the session uses the quad views.
+        std::mutex m_quadViewsSwapchainsMutex;
+        std::unordered_map<XrSwapchain, XrSwapchainCreateInfo> m_sampledSwapchains;
+        std::unordered_map<XrSwapchain, std::shared_ptr<utils::graphics::ISwapchain>> m_quadViewsSwapchains;
+        // Only accessed from xrEndFrame(), one stereo swapchain per quad views layer.
+        std::vector<std::shared_ptr<utils::graphics::ISwapchain>> m_stereoSwapchains;
+        std::vector<QuadViewsComposition> m_quadViewsCompositions;
+        std::vector<const XrCompositionLayerBaseHeader*> m_quadViewsLayers;
+        std::vector<XrCompositionLayerProjection> m_stereoLayers;
+        std::vector<std::array<XrCompositionLayerProjectionView, xr::StereoView::Count>> m_stereoLayerViews;
     };
 
     // This method is required by the framework to instantiate your OpenXrApi implementation.
@@ -796,6 +2298,14 @@ namespace openxr_api_layer {
         return g_instance.get();
     }
 
+    const GazeLatencyStats* getGazeLatencyStats() {
+        return g_instance ? static_cast<OpenXrLayer*>(g_instance.get())->getGazeLatencyStats() : nullptr;
+    }
+
+    bool getGazedLayer(GazedLayer& gazedLayer) {
+        return g_instance ? static_cast<OpenXrLayer*>(g_instance.get())->getGazedLayer(gazedLayer) : false;
+    }
+
 } // namespace openxr_api_layer
 
 BOOL APIENTRY DllMain(HMODULE hModule, DWORD ul_reason_for_call, LPVOID lpReserved) {
@@ -806,6 +2316,8 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD ul_reason_for_call, LPVOID lpReserv
         break;
 
     case DLL_PROCESS_DETACH:
+        // The logger pins the DLL, so we only get here upon process exit, once the writer thread is terminated.
+        openxr_api_layer::log::FlushLog();
         TraceLoggingUnregister(openxr_api_layer::log::g_traceProvider);
         break;
 
@@ -44,4 +44,29 @@ namespace openxr_api_layer {
     extern const std::vector<std::string> blockedExtensions;
     extern const std::vector<std::string> implicitExtensions;
 
+    // The composition layer under the gaze in the last frame submitted by the application. getGazedLayer() is only
+    // reachable from within the layer: applications cannot query it through OpenXR, the "GazedLayer" trace event and
+    // the GazedLayerIndex gauge of the metrics (see metrics.h) are the only outputs they can see.
+    struct GazedLayer {
+        // Index of the layer in XrFrameEndInfo, and its type (XR_TYPE_COMPOSITION_LAYER_QUAD or
+        // XR_TYPE_COMPOSITION_LAYER_CYLINDER_KHR).
+        uint32_t layerIndex;
+        XrStructureType layerType;
+
+        // Position within the image rect of the layer, from (0, 0) at the top left corner to (1, 1) at the bottom right
+        // corner, and the corresponding pixel of the swapchain image.
+        XrSwapchain swapchain;
+        XrVector2f uv;
+        XrOffset2Di pixel;
+
+        // Where the gaze hits the layer, in the space of the layer.
+        XrSpace space;
+        XrVector3f position;
+
+        XrTime displayTime;
+    };
+
+    // Returns false when no layer was under the gaze, or when picking is disabled (GazeLayerPicking).
+    bool getGazedLayer(GazedLayer& gazedLayer);
+
 } // namespace openxr_api_layer
@@ -105,14 +105,14 @@ namespace openxr_api_layer {
                               TLArg(lvc.valid, "Valid"),
                               TLArg(lvc.data.combinedGazeConfidence, "CombinedGazeConfidence"));
 
-            if (!lvc.valid || lvc.data.combinedGazeConfidence < 0.5f) {
+            if (!lvc.valid || lvc.data.combinedGazeConfidence < config::GetSettings().minimumConfidence) {
                 return false;
             }
 
             return true;
         }
 
-        bool getGaze(XrTime time, XrVector3f& unitVector) override {
+        bool getGaze(XrTime time, GazeSample& sample) override {
             Client::LastValueCached<Abi::EyeTracking> lvc;
             try {
                 lvc = m_omniceptClient->getLastData<Abi::EyeTracking>();
@@ -125,7 +125,7 @@ namespace openxr_api_layer {
                               TLArg(lvc.valid, "Valid"),
                               TLArg(lvc.data.combinedGazeConfidence, "CombinedGazeConfidence"));
 
-            if (!lvc.valid || lvc.data.combinedGazeConfidence < 0.5f) {
+            if (!lvc.valid || lvc.data.combinedGazeConfidence < config::GetSettings().minimumConfidence) {
                 return false;
             }
             TraceLoggingWrite(
@@ -136,9 +136,9 @@ namespace openxr_api_layer {
                         .c_str(),
                     "CombinedGaze"));
 
-            unitVector.x = -lvc.data.combinedGaze.x;
-            unitVector.y = lvc.data.combinedGaze.y;
-            unitVector.z = -lvc.data.combinedGaze.z;
+            sample.unitVector.x = -lvc.data.combinedGaze.x;
+            sample.unitVector.y = lvc.data.combinedGaze.y;
+            sample.unitVector.z = -lvc.data.combinedGaze.z;
 
             return true;
         }
@@ -23,13 +23,20 @@
 
 #pragma once
 
-// Uncomment below the graphics frameworks used by the layer.
+// Uncomment below the graphics frameworks used by the layer. The emulation of XR_VARJO_quad_views composites on D3D11
+// and is compiled out without it, the applications may use any of the graphics frameworks below.
 
-//#define XR_USE_GRAPHICS_API_D3D11
-//#define XR_USE_GRAPHICS_API_D3D12
+#define XR_USE_GRAPHICS_API_D3D11
+#define XR_USE_GRAPHICS_API_D3D12
+
+// Not an OpenXR graphics API: textures in system memory, for running the composition framework without a GPU. Sessions
+// without graphics bindings, like the ones of the test runtime, are composited with it.
+#define XR_USE_GRAPHICS_API_CPU
 
 // Standard library.
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <cstdarg>
 #include <ctime>
 #define _USE_MATH_DEFINES
@@ -38,10 +45,13 @@
 #include <iomanip>
 #include <iostream>
 #include <mutex>
+#include <shared_mutex>
 #include <filesystem>
 #include <fstream>
+#include <functional>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <memory>
 #include <optional>
 #include <map>
@@ -68,6 +78,7 @@ using Microsoft::WRL::ComPtr;
 #include <dxgiformat.h>
 #ifdef XR_USE_GRAPHICS_API_D3D11
 #include <d3d11_4.h>
+#include <d3dcompiler.h>
 #endif
 #ifdef XR_USE_GRAPHICS_API_D3D12
 #include <d3d12.h>
@@ -94,7 +105,7 @@ using Microsoft::WRL::ComPtr;
 #define FMT_HEADER_ONLY
 #include <fmt/format.h>
 
-#if defined(XR_USE_GRAPHICS_API_D3D11) || defined(XR_USE_GRAPHICS_API_D3D12)
+#if defined(XR_USE_GRAPHICS_API_D3D11) || defined(XR_USE_GRAPHICS_API_D3D12) || defined(XR_USE_GRAPHICS_API_CPU)
 // Utilities framework.
 #include <utils/graphics.h>
 #endif
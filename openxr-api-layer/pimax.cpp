@@ -27,6 +27,7 @@
 #include <util.h>
 
 #include "trackers.h"
+#include "utils/gaze.h"
 
 namespace openxr_api_layer {
 
@@ -93,7 +94,7 @@ namespace openxr_api_layer {
             return true;
         }
 
-        bool getGaze(XrTime time, XrVector3f& unitVector) override {
+        bool getGaze(XrTime time, GazeSample& sample) override {
             pvrEyeTrackingInfo state{};
             // TODO: Properly convert and use XrTime.
             pvrResult result = pvr_getEyeTrackingInfo(m_pvrSession, pvr_getTimeSeconds(m_pvr), &state);
@@ -127,11 +128,7 @@ namespace openxr_api_layer {
                 atan((state.GazeTan[xr::StereoView::Left].y + state.GazeTan[xr::StereoView::Right].y) / 2.f);
 
             // Use polar coordinates to create a unit vector.
-            unitVector = {
-                sin(angleHorizontal) * cos(angleVertical),
-                sin(angleVertical),
-                -cos(angleHorizontal) * cos(angleVertical),
-            };
+            sample.unitVector = utils::gaze::directionFromAngles(angleHorizontal, angleVertical);
 
             return true;
         }
@@ -22,6 +22,8 @@
 
 #include "pch.h"
 
+#include <timeapi.h>
+
 #include "utils.h"
 #include <log.h>
 #include <util.h>
@@ -35,6 +37,23 @@ namespace openxr_api_layer {
     using namespace log;
     using namespace psvr2_toolkit::ipc;
 
+    namespace {
+
+        // Sleep() rounds up to the system timer resolution, 15.6ms by default, which is longer than the whole polling
+        // period. The resolution is raised while polling, so the waits are honored and AcquisitionWakeupDelay only
+        // measures how late the thread is scheduled.
+        struct TimerResolution {
+            TimerResolution() {
+                timeBeginPeriod(1);
+            }
+
+            ~TimerResolution() {
+                timeEndPeriod(1);
+            }
+        };
+
+    } // namespace
+
     struct Psvr2ToolkitEyeTracker : IEyeTracker {
         Psvr2ToolkitEyeTracker() {
             WSADATA wsaData{};
@@ -116,7 +135,12 @@ namespace openxr_api_layer {
         }
 
         ~Psvr2ToolkitEyeTracker() override {
-            if (m_started) {
+            if (m_listeningThread.joinable()) {
+                {
+                    std::unique_lock lock(m_activeMutex);
+                    m_isStopping = true;
+                }
+                m_activeChanged.notify_all();
                 m_listeningThread.join();
             }
             if (m_socket != INVALID_SOCKET) {
@@ -128,28 +152,43 @@ namespace openxr_api_layer {
         }
 
         void start(XrSession session) override {
-            m_started = true;
-            m_listeningThread = std::thread([&]() { ipcThread(); });
+            setActive(true);
+            if (!m_listeningThread.joinable()) {
+                m_listeningThread = std::thread([&]() { ipcThread(); });
+            }
         }
 
         void stop() override {
+            setActive(false);
+        }
+
+        // The IPC thread waits while inactive, instead of polling the server.
+        void setActive(bool active) override {
+            TraceLoggingWrite(g_traceProvider, "Psvr2ToolkitEyeTracker_SetActive", TLArg(active, "Active"));
+
+            {
+                std::unique_lock lock(m_activeMutex);
+                m_isActive = active;
+            }
+            m_activeChanged.notify_all();
         }
 
         bool isGazeAvailable(XrTime time) const override {
             const auto now = std::chrono::high_resolution_clock::now();
             {
-                std::unique_lock lock(m_mutex);
-                return (now - m_lastReceivedTime).count() < 1'000'000'000;
+                auto lock = lockTrackerState(m_mutex);
+                return now - m_lastReceivedTime < config::GetSettings().sampleTimeout;
             }
         }
 
-        bool getGaze(XrTime time, XrVector3f& unitVector) override {
+        bool getGaze(XrTime time, GazeSample& sample) override {
             if (!isGazeAvailable(time)) {
                 return false;
             }
 
-            std::unique_lock lock(m_mutex);
-            unitVector = m_latestGaze;
+            auto lock = lockTrackerState(m_mutex);
+            sample.unitVector = m_latestGaze;
+            sample.acquisitionTime = m_lastReceivedTime;
             return true;
         }
 
@@ -161,7 +200,31 @@ namespace openxr_api_layer {
             TraceLocalActivity(local);
             TraceLoggingWriteStart(local, "Psvr2ToolkitEyeTracker_IpcThread");
 
-            while (m_started) {
+            std::unique_ptr<utils::general::IThreadPolicy> policy = applyAcquisitionThreadPolicy("PSVR2 Toolkit");
+            std::optional<TimerResolution> timerResolution;
+            timerResolution.emplace();
+            while (true) {
+                bool isResuming;
+                {
+                    std::unique_lock lock(m_activeMutex);
+                    isResuming = !m_isActive;
+                    if (isResuming) {
+                        // No need for the finer resolution while parked.
+                        timerResolution.reset();
+                    }
+                    m_activeChanged.wait(lock, [&] { return m_isActive || m_isStopping; });
+                    if (m_isStopping) {
+                        break;
+                    }
+                }
+
+                // The settings may have changed while parked.
+                if (isResuming) {
+                    policy.reset();
+                    policy = applyAcquisitionThreadPolicy("PSVR2 Toolkit");
+                    timerResolution.emplace();
+                }
+
                 struct {
                     CommandHeader_t header;
                 } request{};
@@ -220,20 +283,33 @@ namespace openxr_api_layer {
                                       TLArg(xr::ToString(gaze).c_str(), "EyeTrackedGazePoint"));
 
                     if (!(std::isnan(gaze.x) || std::isnan(gaze.y) || std::isnan(gaze.z))) {
-                        std::unique_lock lock(m_mutex);
+                        auto lock = lockTrackerState(m_mutex);
                         m_latestGaze = gaze;
                         m_lastReceivedTime = now;
                     }
                 }
 
                 // This logic is a little janky until there is a proper IPC mechanism.
-                Sleep(5 - (5 - retries));
+                const DWORD sleepMilliseconds = 5 - (5 - retries);
+                const auto sleepStart = std::chrono::steady_clock::now();
+                Sleep(sleepMilliseconds);
+                if (sleepMilliseconds) {
+                    // Oversleeping is how late the thread is scheduled again (see AcquisitionThreadPriority).
+                    const auto overslept = std::chrono::steady_clock::now() - sleepStart -
+                                           std::chrono::milliseconds(sleepMilliseconds);
+                    metrics::Record(
+                        metrics::Histogram::AcquisitionWakeupDelay,
+                        std::max(std::chrono::duration_cast<std::chrono::nanoseconds>(overslept).count(), 0ll));
+                }
             }
 
             TraceLoggingWriteStop(local, "Psvr2ToolkitEyeTracker_IpcThread");
         }
 
-        bool m_started{false};
+        std::mutex m_activeMutex;
+        std::condition_variable m_activeChanged;
+        bool m_isActive{false};
+        bool m_isStopping{false};
         std::thread m_listeningThread;
         SOCKET m_socket{INVALID_SOCKET};
         mutable std::mutex m_mutex;
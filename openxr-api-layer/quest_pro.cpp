@@ -27,6 +27,7 @@
 #include <util.h>
 
 #include "trackers.h"
+#include "utils/gaze.h"
 
 namespace openxr_api_layer {
 
@@ -36,9 +37,11 @@ namespace openxr_api_layer {
         QuestProEyeTracker(OpenXrApi& openXrApi) : m_openXrApi(openXrApi) {
         }
 
+        // The layer also implements XR_FB_eye_tracking_social for the application, we call the runtime directly rather
+        // than through our own overrides.
         void start(XrSession session) override {
             XrEyeTrackerCreateInfoFB createInfo{XR_TYPE_EYE_TRACKER_CREATE_INFO_FB};
-            CHECK_XRCMD(m_openXrApi.xrCreateEyeTrackerFB(session, &createInfo, &m_eyeTracker));
+            CHECK_XRCMD(m_openXrApi.OpenXrApi::xrCreateEyeTrackerFB(session, &createInfo, &m_eyeTracker));
 
             XrReferenceSpaceCreateInfo referenceSpaceInfo{XR_TYPE_REFERENCE_SPACE_CREATE_INFO};
             referenceSpaceInfo.referenceSpaceType = XR_REFERENCE_SPACE_TYPE_VIEW;
@@ -55,7 +58,7 @@ namespace openxr_api_layer {
             eyeGazeInfo.time = time;
 
             XrEyeGazesFB eyeGaze{XR_TYPE_EYE_GAZES_FB};
-            CHECK_XRCMD(m_openXrApi.xrGetEyeGazesFB(m_eyeTracker, &eyeGazeInfo, &eyeGaze));
+            CHECK_XRCMD(m_openXrApi.OpenXrApi::xrGetEyeGazesFB(m_eyeTracker, &eyeGazeInfo, &eyeGaze));
             TraceLoggingWrite(g_traceProvider,
                               "EyeTrackerFB",
                               TLArg(!!eyeGaze.gaze[xr::StereoView::Left].isValid, "LeftValid"),
@@ -66,21 +69,22 @@ namespace openxr_api_layer {
             if (!(eyeGaze.gaze[xr::StereoView::Left].isValid && eyeGaze.gaze[xr::StereoView::Right].isValid)) {
                 return false;
             }
-            if (!(eyeGaze.gaze[xr::StereoView::Left].gazeConfidence > 0.5f &&
-                  eyeGaze.gaze[xr::StereoView::Right].gazeConfidence > 0.5f)) {
+            const float minimumConfidence = config::GetSettings().minimumConfidence;
+            if (!(eyeGaze.gaze[xr::StereoView::Left].gazeConfidence > minimumConfidence &&
+                  eyeGaze.gaze[xr::StereoView::Right].gazeConfidence > minimumConfidence)) {
                 return false;
             }
 
             return true;
         }
 
-        bool getGaze(XrTime time, XrVector3f& unitVector) override {
+        bool getGaze(XrTime time, GazeSample& sample) override {
             XrEyeGazesInfoFB eyeGazeInfo{XR_TYPE_EYE_GAZES_INFO_FB};
             eyeGazeInfo.baseSpace = m_viewSpace;
             eyeGazeInfo.time = time;
 
             XrEyeGazesFB eyeGaze{XR_TYPE_EYE_GAZES_FB};
-            CHECK_XRCMD(m_openXrApi.xrGetEyeGazesFB(m_eyeTracker, &eyeGazeInfo, &eyeGaze));
+            CHECK_XRCMD(m_openXrApi.OpenXrApi::xrGetEyeGazesFB(m_eyeTracker, &eyeGazeInfo, &eyeGaze));
             TraceLoggingWrite(g_traceProvider,
                               "EyeTrackerFB",
                               TLArg(!!eyeGaze.gaze[xr::StereoView::Left].isValid, "LeftValid"),
@@ -91,8 +95,9 @@ namespace openxr_api_layer {
             if (!(eyeGaze.gaze[xr::StereoView::Left].isValid && eyeGaze.gaze[xr::StereoView::Right].isValid)) {
                 return false;
             }
-            if (!(eyeGaze.gaze[xr::StereoView::Left].gazeConfidence > 0.5f &&
-                  eyeGaze.gaze[xr::StereoView::Right].gazeConfidence > 0.5f)) {
+            const float minimumConfidence = config::GetSettings().minimumConfidence;
+            if (!(eyeGaze.gaze[xr::StereoView::Left].gazeConfidence > minimumConfidence &&
+                  eyeGaze.gaze[xr::StereoView::Right].gazeConfidence > minimumConfidence)) {
                 return false;
             }
             TraceLoggingWrite(
@@ -102,12 +107,15 @@ namespace openxr_api_layer {
                 TLArg(xr::ToString(eyeGaze.gaze[xr::StereoView::Right].gazePose).c_str(), "RightGazePose"));
 
             // Average the poses from both eyes.
-            const auto gaze = xr::math::LoadXrPose(xr::math::Pose::Slerp(
-                eyeGaze.gaze[xr::StereoView::Left].gazePose, eyeGaze.gaze[xr::StereoView::Right].gazePose, 0.5f));
-            const auto gazeProjectedPoint = DirectX::XMVector3Transform(DirectX::XMVectorSet(0.f, 0.f, -1.f, 1.f), gaze);
-
-            unitVector = xr::math::Normalize(
-                {gazeProjectedPoint.m128_f32[0], gazeProjectedPoint.m128_f32[1], gazeProjectedPoint.m128_f32[2]});
+            sample.unitVector = utils::gaze::directionFromEyePoses(eyeGaze.gaze[xr::StereoView::Left].gazePose,
+                                                                   eyeGaze.gaze[xr::StereoView::Right].gazePose);
+            for (uint32_t eye = 0; eye < xr::StereoView::Count; eye++) {
+                sample.eyeUnitVector[eye] =
+                    utils::gaze::directionFromEyePoses(eyeGaze.gaze[eye].gazePose, eyeGaze.gaze[eye].gazePose);
+                sample.isEyeValid[eye] = true;
+            }
+            sample.confidence = std::min(eyeGaze.gaze[xr::StereoView::Left].gazeConfidence,
+                                         eyeGaze.gaze[xr::StereoView::Right].gazeConfidence);
 
             return true;
         }
@@ -0,0 +1,297 @@
+// MIT License
+//
+// Copyright(c) 2022-2023 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "pch.h"
+
+#include "utils.h"
+#include <log.h>
+
+#include "trackers.h"
+#include "utils/capture.h"
+
+namespace openxr_api_layer {
+
+    using namespace log;
+    using namespace utils::capture;
+
+    namespace {
+
+        using clock = std::chrono::high_resolution_clock;
+
+        int64_t nanosecondsBetween(clock::time_point from, clock::time_point to) {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count();
+        }
+
+    } // namespace
+
+    struct GazeRecorder : IEyeTracker {
+        GazeRecorder(std::unique_ptr<IEyeTracker> tracker, const std::filesystem::path& folder)
+            : m_tracker(std::move(tracker)), m_folder(folder) {
+        }
+
+        void start(XrSession session) override {
+            m_tracker->start(session);
+
+            // One capture per session.
+            const std::time_t now = std::time(nullptr);
+            std::tm localNow;
+            localtime_s(&localNow, &now);
+            std::stringstream name;
+            name << "gaze-" << std::put_time(&localNow, "%Y%m%d-%H%M%S") << ".gzcap";
+            const auto path = m_folder / name.str();
+
+            std::unique_lock lock(m_mutex);
+            try {
+                m_writer = createCaptureWriter(path,
+                                               static_cast<uint32_t>(m_tracker->getType()),
+                                               config::GetSettings().recordQuantized ? Encoding::Quantized
+                                                                                     : Encoding::Lossless);
+            } catch (std::exception& exc) {
+                ErrorLog(fmt::format("{}\n", exc.what()));
+                return;
+            }
+            m_recordingStart = clock::now();
+
+            Log(fmt::format("Recording gaze to: {}\n", path.string()));
+        }
+
+        void stop() override {
+            m_tracker->stop();
+
+            std::unique_lock lock(m_mutex);
+            if (m_writer) {
+                m_writer->close();
+
+                const auto duration = std::chrono::duration<double>(clock::now() - m_recordingStart).count();
+                const uint64_t count = m_writer->getRecordCount();
+                const uint64_t size = m_writer->getSize();
+                Log(fmt::format("Recorded {} gaze queries in {:.1f}s: {} bytes, {:.1f} bytes/query, {:.1f} MB/hour\n",
+                                count,
+                                duration,
+                                size,
+                                count ? static_cast<double>(size) / count : 0.0,
+                                duration > 0 ? size / duration * 3600 / (1024 * 1024) : 0.0));
+                m_writer.reset();
+            }
+        }
+
+        bool isGazeAvailable(XrTime time) const override {
+            const auto queryTime = clock::now();
+            const bool result = m_tracker->isGazeAvailable(time);
+
+            Record record{};
+            record.kind = RecordKind::IsGazeAvailable;
+            record.result = result;
+            record.time = time;
+            record.queryOffset = nanosecondsBetween(m_recordingStart, queryTime);
+            record.acquisitionOffset = record.queryOffset;
+            write(record);
+
+            return result;
+        }
+
+        bool getGaze(XrTime time, GazeSample& sample) override {
+            const auto queryTime = clock::now();
+            const bool result = m_tracker->getGaze(time, sample);
+
+            Record record{};
+            record.kind = RecordKind::GetGaze;
+            record.result = result;
+            record.time = time;
+            record.queryOffset = nanosecondsBetween(m_recordingStart, queryTime);
+            record.acquisitionOffset = nanosecondsBetween(m_recordingStart, sample.acquisitionTime);
+            record.unitVector = sample.unitVector;
+            for (uint32_t eye = 0; eye < xr::StereoView::Count; eye++) {
+                record.eyeUnitVector[eye] = sample.eyeUnitVector[eye];
+                record.isEyeValid[eye] = sample.isEyeValid[eye];
+            }
+            record.confidence = sample.confidence;
+            write(record);
+
+            return result;
+        }
+
+        TrackerType getType() const override {
+            // Recording must not change the behavior of the layer.
+            return m_tracker->getType();
+        }
+
+        void setActive(bool active) override {
+            m_tracker->setActive(active);
+        }
+
+        bool hasPublisherExited() override {
+            return m_tracker->hasPublisherExited();
+        }
+
+        void write(const Record& record) const {
+            std::unique_lock lock(m_mutex);
+            if (m_writer) {
+                m_writer->write(record);
+            }
+        }
+
+        const std::unique_ptr<IEyeTracker> m_tracker;
+        const std::filesystem::path m_folder;
+
+        mutable std::mutex m_mutex;
+        std::unique_ptr<ICaptureWriter> m_writer;
+        clock::time_point m_recordingStart;
+    };
+
+    struct ReplayEyeTracker : IEyeTracker {
+        ReplayEyeTracker(const std::filesystem::path& path, bool realTime, std::chrono::seconds startOffset)
+            : m_realTime(realTime) {
+            try {
+                m_reader = openCaptureReader(path);
+            } catch (std::exception& exc) {
+                ErrorLog(fmt::format("{}\n", exc.what()));
+                throw EyeTrackerNotSupportedException();
+            }
+
+            if (m_reader->getRecordCount() && startOffset.count()) {
+                m_firstRecord = m_reader->seek(
+                    m_reader->get(0).time + std::chrono::duration_cast<std::chrono::nanoseconds>(startOffset).count());
+            }
+
+            Log(fmt::format("Replaying {} gaze queries recorded with {} ({}), starting at query {}\n",
+                            m_reader->getRecordCount(),
+                            getTrackerType(static_cast<TrackerType>(m_reader->getTrackerType())),
+                            m_realTime ? "real time" : "as fast as possible",
+                            m_firstRecord));
+        }
+
+        void start(XrSession session) override {
+            // Every session replays the capture from the same point.
+            std::unique_lock lock(m_mutex);
+            m_nextRecord = m_firstRecord;
+            m_replayStart = clock::now();
+            if (m_firstRecord < m_reader->getRecordCount()) {
+                m_replayStart -= std::chrono::nanoseconds(m_reader->get(m_firstRecord).queryOffset);
+            }
+            m_lastGazeAvailable.reset();
+            m_lastGaze.reset();
+            m_reportedEnd = false;
+        }
+
+        void stop() override {
+        }
+
+        bool isGazeAvailable(XrTime time) const override {
+            const auto record = next(RecordKind::IsGazeAvailable);
+            return record && record->result;
+        }
+
+        bool getGaze(XrTime time, GazeSample& sample) override {
+            const auto record = next(RecordKind::GetGaze);
+            if (!record) {
+                return false;
+            }
+
+            sample.unitVector = record->unitVector;
+            for (uint32_t eye = 0; eye < xr::StereoView::Count; eye++) {
+                sample.eyeUnitVector[eye] = record->eyeUnitVector[eye];
+                sample.isEyeValid[eye] = record->isEyeValid[eye];
+            }
+            sample.confidence = record->confidence;
+            if (m_realTime) {
+                sample.acquisitionTime = m_replayStart + std::chrono::nanoseconds(record->acquisitionOffset);
+            }
+
+            return record->result;
+        }
+
+        TrackerType getType() const override {
+            return TrackerType::Replay;
+        }
+
+        // The queries are answered in the order they were recorded, regardless of the requested time. Queries of the
+        // other kind are skipped, in case the application does not query the layer exactly the same way.
+        std::optional<Record> next(RecordKind kind) const {
+            std::unique_lock lock(m_mutex);
+
+            std::optional<Record> record;
+            if (m_realTime) {
+                // The caller may be the render thread, so we never wait for a query to be due: the latest query
+                // recorded at or before the elapsed replay time answers, and it keeps answering until the next one is
+                // due.
+                const int64_t elapsed = nanosecondsBetween(m_replayStart, clock::now());
+                bool isAdvancing = false;
+                while (m_nextRecord < m_reader->getRecordCount()) {
+                    const Record& candidate = m_reader->get(m_nextRecord);
+                    if (candidate.queryOffset > elapsed) {
+                        break;
+                    }
+                    (candidate.kind == RecordKind::GetGaze ? m_lastGaze : m_lastGazeAvailable) = candidate;
+                    m_nextRecord++;
+                    isAdvancing = true;
+                }
+                if (m_nextRecord < m_reader->getRecordCount() || isAdvancing) {
+                    record = kind == RecordKind::GetGaze ? m_lastGaze : m_lastGazeAvailable;
+                }
+            } else {
+                while (m_nextRecord < m_reader->getRecordCount()) {
+                    const Record& candidate = m_reader->get(m_nextRecord++);
+                    if (candidate.kind == kind) {
+                        record = candidate;
+                        break;
+                    }
+                }
+            }
+
+            if (!record && m_nextRecord == m_reader->getRecordCount() && !m_reportedEnd) {
+                Log("End of gaze capture reached\n");
+                m_reportedEnd = true;
+            }
+
+            return record;
+        }
+
+        const bool m_realTime;
+        std::unique_ptr<ICaptureReader> m_reader;
+        uint64_t m_firstRecord{0};
+
+        mutable std::mutex m_mutex;
+        mutable uint64_t m_nextRecord{0};
+        mutable std::optional<Record> m_lastGazeAvailable;
+        mutable std::optional<Record> m_lastGaze;
+        mutable bool m_reportedEnd{false};
+        clock::time_point m_replayStart;
+    };
+
+    std::unique_ptr<IEyeTracker> createGazeRecorder(std::unique_ptr<IEyeTracker> tracker,
+                                                    const std::filesystem::path& folder) {
+        return std::make_unique<GazeRecorder>(std::move(tracker), folder);
+    }
+
+    std::unique_ptr<IEyeTracker> createReplayEyeTracker(const std::filesystem::path& path,
+                                                        bool realTime,
+                                                        std::chrono::seconds startOffset) {
+        try {
+            return std::make_unique<ReplayEyeTracker>(path, realTime, startOffset);
+        } catch (EyeTrackerNotSupportedException&) {
+            return {};
+        }
+    }
+
+} // namespace openxr_api_layer
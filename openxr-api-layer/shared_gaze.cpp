@@ -0,0 +1,310 @@
+// MIT License
+//
+// Copyright(c) 2022-2023 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "utils.h"
+#include <log.h>
+
+#include "trackers.h"
+
+namespace openxr_api_layer {
+
+    using namespace log;
+
+    namespace {
+
+        using clock = std::chrono::high_resolution_clock;
+
+        // Layout of the segment "Local\OpenXR-Eye-Trackers.Gaze". The publisher writes each sample into the next slot
+        // of the ring. A slot is guarded by a sequence number, odd while being written, so that readers copy the latest
+        // sample without locking and retry upon a torn read.
+        constexpr uint32_t k_sharedGazeMagic = 0x5a475258; // "XRGZ"
+        constexpr uint32_t k_sharedGazeVersion = 2;
+        constexpr uint32_t k_slotCount = 16;
+
+        struct SharedGazeSlot {
+            std::atomic<uint64_t> sequence;
+            XrVector3f unitVector;
+            XrVector3f eyeUnitVector[xr::StereoView::Count];
+            uint32_t isEyeValid[xr::StereoView::Count];
+            float confidence;
+            // The clock is the performance counter, which is the same for all processes.
+            int64_t acquisitionTime;
+        };
+
+        struct SharedGaze {
+            std::atomic<uint32_t> magic;
+            uint32_t version;
+            // 0 when no process publishes.
+            std::atomic<uint32_t> publisherProcessId;
+            uint32_t trackerType;
+            // Cleared while the session of the publisher is not visible: its tracker is parked and the latest sample
+            // is getting stale.
+            std::atomic<uint32_t> isPublisherActive;
+            // Samples published so far, the latest one is in slot (writeCount - 1) % k_slotCount.
+            std::atomic<uint64_t> writeCount;
+            SharedGazeSlot slots[k_slotCount];
+        };
+
+        static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+                      "Unexpected atomic layout");
+
+        struct SharedGazeMapping {
+            wil::unique_handle handle;
+            wil::unique_mapview_ptr<SharedGaze> view;
+        };
+
+        // Creates the segment (zero-filled by the system) or opens the existing one.
+        std::optional<SharedGazeMapping> mapSharedGaze() {
+            const std::string name = fmt::format("Local\\{}.Gaze", LayerPrettyName);
+            SharedGazeMapping mapping;
+            *mapping.handle.put() =
+                CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, sizeof(SharedGaze), name.c_str());
+            if (!mapping.handle) {
+                ErrorLog(fmt::format("Failed to create the shared gaze memory: {}\n", GetLastError()));
+                return {};
+            }
+            mapping.view.reset(reinterpret_cast<SharedGaze*>(
+                MapViewOfFile(mapping.handle.get(), FILE_MAP_WRITE, 0, 0, sizeof(SharedGaze))));
+            if (!mapping.view) {
+                ErrorLog(fmt::format("Failed to map the shared gaze memory: {}\n", GetLastError()));
+                return {};
+            }
+            return mapping;
+        }
+
+        bool isProcessAlive(uint32_t processId) {
+            wil::unique_handle process(OpenProcess(SYNCHRONIZE, FALSE, processId));
+            return process && WaitForSingleObject(process.get(), 0) == WAIT_TIMEOUT;
+        }
+
+    } // namespace
+
+    // Forwards to the tracker of the process, and publishes every valid sample for the other processes.
+    struct GazePublisher : IEyeTracker {
+        GazePublisher(std::unique_ptr<IEyeTracker> tracker, SharedGazeMapping mapping)
+            : m_tracker(std::move(tracker)), m_mapping(std::move(mapping)), m_shared(m_mapping.view.get()) {
+        }
+
+        ~GazePublisher() override {
+            m_shared->isPublisherActive.store(0, std::memory_order_release);
+            uint32_t processId = GetCurrentProcessId();
+            m_shared->publisherProcessId.compare_exchange_strong(processId, 0);
+        }
+
+        void start(XrSession session) override {
+            m_tracker->start(session);
+            m_shared->isPublisherActive.store(1, std::memory_order_release);
+        }
+
+        void stop() override {
+            m_shared->isPublisherActive.store(0, std::memory_order_release);
+            m_tracker->stop();
+        }
+
+        bool isGazeAvailable(XrTime time) const override {
+            return m_tracker->isGazeAvailable(time);
+        }
+
+        bool getGaze(XrTime time, GazeSample& sample) override {
+            const bool result = m_tracker->getGaze(time, sample);
+            if (result) {
+                publish(sample);
+            }
+            return result;
+        }
+
+        TrackerType getType() const override {
+            return m_tracker->getType();
+        }
+
+        void setActive(bool active) override {
+            m_shared->isPublisherActive.store(active ? 1 : 0, std::memory_order_release);
+            m_tracker->setActive(active);
+        }
+
+        // Callers are serialized by the layer, so there is a single writer.
+        void publish(const GazeSample& sample) {
+            const uint64_t count = m_shared->writeCount.load(std::memory_order_relaxed);
+            SharedGazeSlot& slot = m_shared->slots[count % k_slotCount];
+
+            slot.sequence.store(2 * count + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            slot.unitVector = sample.unitVector;
+            for (uint32_t eye = 0; eye < xr::StereoView::Count; eye++) {
+                slot.eyeUnitVector[eye] = sample.eyeUnitVector[eye];
+                slot.isEyeValid[eye] = sample.isEyeValid[eye];
+            }
+            slot.confidence = sample.confidence;
+            slot.acquisitionTime =
+                std::chrono::duration_cast<std::chrono::nanoseconds>(sample.acquisitionTime.time_since_epoch()).count();
+            slot.sequence.store(2 * count + 2, std::memory_order_release);
+
+            m_shared->writeCount.store(count + 1, std::memory_order_release);
+        }
+
+        const std::unique_ptr<IEyeTracker> m_tracker;
+        const SharedGazeMapping m_mapping;
+        SharedGaze* const m_shared;
+    };
+
+    // Reads the samples published by the process owning the tracker.
+    struct SharedEyeTracker : IEyeTracker {
+        SharedEyeTracker(SharedGazeMapping mapping) : m_mapping(std::move(mapping)), m_shared(m_mapping.view.get()) {
+        }
+
+        void start(XrSession session) override {
+        }
+
+        void stop() override {
+        }
+
+        bool isGazeAvailable(XrTime time) const override {
+            GazeSample sample;
+            return readLatest(sample) && clock::now() - sample.acquisitionTime < config::GetSettings().sampleTimeout;
+        }
+
+        bool getGaze(XrTime time, GazeSample& sample) override {
+            GazeSample latest;
+            if (!readLatest(latest) || clock::now() - latest.acquisitionTime >= config::GetSettings().sampleTimeout) {
+                return false;
+            }
+            sample = latest;
+            return true;
+        }
+
+        TrackerType getType() const override {
+            return TrackerType::Shared;
+        }
+
+        // Opening the process of the publisher is a system call, it is looked up at most once per second.
+        bool hasPublisherExited() override {
+            const auto now = clock::now();
+            if (now < m_nextPublisherCheck) {
+                return false;
+            }
+            m_nextPublisherCheck = now + std::chrono::seconds(1);
+
+            const uint32_t publisherProcessId = m_shared->publisherProcessId.load();
+            return !publisherProcessId || !isProcessAlive(publisherProcessId);
+        }
+
+        bool readLatest(GazeSample& sample) const {
+            if (!m_shared->isPublisherActive.load(std::memory_order_acquire)) {
+                return false;
+            }
+
+            // A torn read means the publisher went around the ring meanwhile, a retry gets a newer sample.
+            for (uint32_t attempt = 0; attempt < 4; attempt++) {
+                const uint64_t count = m_shared->writeCount.load(std::memory_order_acquire);
+                if (!count) {
+                    return false;
+                }
+                const SharedGazeSlot& slot = m_shared->slots[(count - 1) % k_slotCount];
+
+                const uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+                sample.unitVector = slot.unitVector;
+                for (uint32_t eye = 0; eye < xr::StereoView::Count; eye++) {
+                    sample.eyeUnitVector[eye] = slot.eyeUnitVector[eye];
+                    sample.isEyeValid[eye] = slot.isEyeValid[eye];
+                }
+                sample.confidence = slot.confidence;
+                sample.acquisitionTime = clock::time_point(std::chrono::nanoseconds(slot.acquisitionTime));
+                std::atomic_thread_fence(std::memory_order_acquire);
+
+                if (sequence == 2 * count && slot.sequence.load(std::memory_order_relaxed) == sequence) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        const SharedGazeMapping m_mapping;
+        const SharedGaze* const m_shared;
+        clock::time_point m_nextPublisherCheck{};
+    };
+
+    std::unique_ptr<IEyeTracker> createGazePublisher(std::unique_ptr<IEyeTracker> tracker) {
+        auto mapping = mapSharedGaze();
+        if (!mapping) {
+            return tracker;
+        }
+        SharedGaze* const shared = mapping->view.get();
+
+        if (shared->magic.load(std::memory_order_acquire) != k_sharedGazeMagic) {
+            shared->version = k_sharedGazeVersion;
+            shared->magic.store(k_sharedGazeMagic, std::memory_order_release);
+        } else if (shared->version != k_sharedGazeVersion) {
+            ErrorLog("Gaze is already shared by an incompatible version of the layer\n");
+            return tracker;
+        }
+
+        // Take over from a publisher that exited, but never from a live one (eg: when two processes opened the tracker
+        // at the same time).
+        const uint32_t processId = GetCurrentProcessId();
+        uint32_t publisherProcessId = shared->publisherProcessId.load();
+        while (publisherProcessId != processId) {
+            if (publisherProcessId && isProcessAlive(publisherProcessId)) {
+                // The other process owns the device, release ours and read its samples instead.
+                Log(fmt::format("Gaze is already shared by process {}, attaching to it\n", publisherProcessId));
+                tracker.reset();
+                return std::make_unique<SharedEyeTracker>(std::move(mapping.value()));
+            }
+            if (shared->publisherProcessId.compare_exchange_weak(publisherProcessId, processId)) {
+                break;
+            }
+        }
+
+        shared->trackerType = static_cast<uint32_t>(tracker->getType());
+
+        Log("Sharing gaze with other processes\n");
+        return std::make_unique<GazePublisher>(std::move(tracker), std::move(mapping.value()));
+    }
+
+    std::unique_ptr<IEyeTracker> createSharedEyeTracker() {
+        const auto attachStart = clock::now();
+
+        auto mapping = mapSharedGaze();
+        if (!mapping) {
+            return {};
+        }
+        const SharedGaze* const shared = mapping->view.get();
+
+        if (shared->magic.load(std::memory_order_acquire) != k_sharedGazeMagic ||
+            shared->version != k_sharedGazeVersion) {
+            return {};
+        }
+        const uint32_t publisherProcessId = shared->publisherProcessId.load();
+        if (!publisherProcessId || publisherProcessId == GetCurrentProcessId() || !isProcessAlive(publisherProcessId)) {
+            return {};
+        }
+
+        const auto attachTime = std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - attachStart);
+        Log(fmt::format("Attached to the gaze shared by process {} ({}) in {}us\n",
+                        publisherProcessId,
+                        getTrackerType(static_cast<TrackerType>(shared->trackerType)),
+                        attachTime.count()));
+        return std::make_unique<SharedEyeTracker>(std::move(mapping.value()));
+    }
+
+} // namespace openxr_api_layer
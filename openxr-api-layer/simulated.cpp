@@ -26,6 +26,7 @@
 #include <log.h>
 
 #include "trackers.h"
+#include "utils/gaze.h"
 
 namespace openxr_api_layer {
 
@@ -45,7 +46,7 @@ namespace openxr_api_layer {
             return true;
         }
 
-        bool getGaze(XrTime time, XrVector3f& unitVector) override {
+        bool getGaze(XrTime time, GazeSample& sample) override {
             RECT rect;
             rect.left = 1;
             rect.right = 999;
@@ -57,7 +58,8 @@ namespace openxr_api_layer {
             GetCursorPos(&cursor);
 
             XrVector2f point = {(float)cursor.x / 1000.f, (float)cursor.y / 1000.f};
-            unitVector = xr::math::Normalize({point.x - 0.5f, 0.5f - point.y, -0.35f});
+            namespace vm = utils::vectormath;
+            sample.unitVector = vm::storeVector3(vm::normalize3(vm::set(point.x - 0.5f, 0.5f - point.y, -0.35f)));
 
             return true;
         }
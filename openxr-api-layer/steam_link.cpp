@@ -38,43 +38,88 @@ namespace openxr_api_layer {
 
     struct SteamLinkEyeTracker : IEyeTracker, osc::OscPacketListener {
         // Steam Link allow us to choose between port 9000 (labeled VRChat) and 9015 ("custom"). We put ourselves under
-        // "custom".
-        SteamLinkEyeTracker() : m_socket(IpEndpointName(IpEndpointName::ANY_ADDRESS, 9015), this) {
+        // "custom" by default (SteamLinkPort setting).
+        SteamLinkEyeTracker()
+            : m_port(config::GetSettings().steamLinkPort),
+              m_socket(std::make_unique<UdpListeningReceiveSocket>(IpEndpointName(IpEndpointName::ANY_ADDRESS, m_port),
+                                                                   this)) {
         }
 
         ~SteamLinkEyeTracker() override {
-            if (m_started) {
-                m_socket.AsynchronousBreak();
-                m_listeningThread.join();
-            }
+            setActive(false);
         }
 
         void start(XrSession session) override {
-            m_listeningThread = std::thread([&]() { m_socket.Run(); });
-            m_started = true;
+            setActive(true);
         }
 
         void stop() override {
+            setActive(false);
         }
 
         bool isGazeAvailable(XrTime time) const override {
             const auto now = std::chrono::high_resolution_clock::now();
             {
-                std::unique_lock lock(m_mutex);
-                return (now - m_lastReceivedTime).count() < 1'000'000'000;
+                auto lock = lockTrackerState(m_mutex);
+                return now - m_lastReceivedTime < config::GetSettings().sampleTimeout;
             }
         }
 
-        bool getGaze(XrTime time, XrVector3f& unitVector) override {
+        bool getGaze(XrTime time, GazeSample& sample) override {
             if (!isGazeAvailable(time)) {
                 return false;
             }
 
-            std::unique_lock lock(m_mutex);
-            unitVector = m_latestGaze;
+            auto lock = lockTrackerState(m_mutex);
+            sample.unitVector = m_latestGaze;
+            sample.acquisitionTime = m_lastReceivedTime;
             return true;
         }
 
+        // Parking stops the receive loop. Messages received meanwhile are buffered by the socket, and processed upon
+        // resuming.
+        void setActive(bool active) override {
+            std::unique_lock lock(m_listeningMutex);
+            if (active == m_listeningThread.joinable()) {
+                return;
+            }
+
+            TraceLoggingWrite(g_traceProvider, "SteamLinkEyeTracker_SetActive", TLArg(active, "Active"));
+
+            if (active) {
+                // The port may have been changed in the settings.
+                const uint16_t port = config::GetSettings().steamLinkPort;
+                if (port != m_port) {
+                    try {
+                        m_socket = std::make_unique<UdpListeningReceiveSocket>(
+                            IpEndpointName(IpEndpointName::ANY_ADDRESS, port), this);
+                        m_port = port;
+                        Log(fmt::format("Steam Link: listening on port {}\n", m_port));
+                    } catch (std::exception& exc) {
+                        ErrorLog(fmt::format("Steam Link: cannot listen on port {}: {}\n", port, exc.what()));
+                    }
+                }
+
+                m_isListening = true;
+                m_listeningThread = std::thread([&]() {
+                    const auto policy = applyAcquisitionThreadPolicy("Steam Link");
+                    m_socket->Run();
+                    {
+                        std::unique_lock lock(m_listeningMutex);
+                        m_isListening = false;
+                    }
+                    m_listeningExited.notify_all();
+                });
+            } else {
+                // A break requested before the receive loop is entered is lost, so keep requesting until it exits.
+                while (m_isListening) {
+                    m_socket->AsynchronousBreak();
+                    m_listeningExited.wait_for(lock, std::chrono::milliseconds(1), [&] { return !m_isListening; });
+                }
+                m_listeningThread.join();
+            }
+        }
+
         TrackerType getType() const override {
             return TrackerType::SteamLink;
         }
@@ -93,7 +138,7 @@ namespace openxr_api_layer {
                                       TLArg(xr::ToString(gaze).c_str(), "EyeTrackedGazePoint"));
 
                     if (!(std::isnan(gaze.x) || std::isnan(gaze.y) || std::isnan(gaze.z))) {
-                        std::unique_lock lock(m_mutex);
+                        auto lock = lockTrackerState(m_mutex);
                         m_latestGaze = gaze;
                         m_lastReceivedTime = now;
                     }
@@ -103,9 +148,12 @@ namespace openxr_api_layer {
             }
         }
 
-        bool m_started{false};
+        std::mutex m_listeningMutex;
+        std::condition_variable m_listeningExited;
+        bool m_isListening{false};
         std::thread m_listeningThread;
-        UdpListeningReceiveSocket m_socket;
+        uint16_t m_port;
+        std::unique_ptr<UdpListeningReceiveSocket> m_socket;
         mutable std::mutex m_mutex;
         XrVector3f m_latestGaze{};
         std::chrono::high_resolution_clock::time_point m_lastReceivedTime{};
@@ -22,6 +22,10 @@
 
 #pragma once
 
+#include <config.h>
+#include <metrics.h>
+#include <stats.h>
+
 namespace openxr_api_layer {
 
     struct EyeTrackerNotSupportedException : public std::exception {
@@ -45,6 +49,9 @@ namespace openxr_api_layer {
         OpenXr,
         Psvr2Toolkit,
         VRChatOSC,
+        Replay,
+        // Samples published by another process (see ShareTracker setting).
+        Shared,
     };
 
     static inline std::string getTrackerType(TrackerType type) {
@@ -75,20 +82,81 @@ namespace openxr_api_layer {
             return "PSVR2 Toolkit";
         case TrackerType::VRChatOSC:
             return "VRChat OSC";
+        case TrackerType::Replay:
+            return "Replay";
+        case TrackerType::Shared:
+            return "Shared";
         }
         return "<Unknown>";
     }
 
+    struct GazeSample {
+        XrVector3f unitVector{};
+
+        // Per-eye gaze, for trackers that report it.
+        XrVector3f eyeUnitVector[xr::StereoView::Count]{};
+        bool isEyeValid[xr::StereoView::Count]{};
+
+        // Confidence reported by the tracker (0 to 1), or 1 if the tracker does not report it.
+        float confidence{1.f};
+
+        // When the sample was acquired. Initialized by the caller of getGaze() with the time of the call, trackers that
+        // receive samples asynchronously must overwrite it with the time of reception.
+        std::chrono::high_resolution_clock::time_point acquisitionTime{};
+    };
+
     struct IEyeTracker {
         virtual ~IEyeTracker() = default;
 
         virtual void start(XrSession session) = 0;
         virtual void stop() = 0;
         virtual bool isGazeAvailable(XrTime time) const = 0;
-        virtual bool getGaze(XrTime time, XrVector3f& unitVector) = 0;
+        virtual bool getGaze(XrTime time, GazeSample& sample) = 0;
         virtual TrackerType getType() const = 0;
+
+        // Hint that the gaze is not needed while the session is not visible. Trackers acquiring samples on their own
+        // threads park them when inactive, and must be able to deliver samples again within a frame of resuming.
+        virtual void setActive(bool active) {
+        }
+
+        // For readers of the gaze shared by another process, checked after a failed query: whether that process stopped
+        // publishing, so that the layer may open the tracker itself.
+        virtual bool hasPublisherExited() {
+            return false;
+        }
     };
 
+    // Latency statistics for the gaze samples consumed by the layer during a session. All durations are in nanoseconds.
+    struct GazeLatencyStats {
+        // From the acquisition of the sample to its consumption by the layer.
+        stats::LatencyHistogram sampleAge;
+        // From the consumption of the sample to the predicted display time of the frame (requires
+        // XR_KHR_win32_convert_performance_counter_time).
+        stats::LatencyHistogram displayHorizon;
+        // Duration of the IEyeTracker::getGaze() call.
+        stats::LatencyHistogram acquisitionCost;
+        // Samples consumed after the predicted display time of the frame.
+        std::atomic<uint64_t> lateSamples{0};
+    };
+
+    // Returns the statistics of the current session, or of the last session if none is running. Valid until the next
+    // session is created.
+    const GazeLatencyStats* getGazeLatencyStats();
+
+    // Lock protecting the state of a tracker, with contention reported in the metrics.
+    static inline std::unique_lock<std::mutex> lockTrackerState(std::mutex& mutex) {
+        return metrics::LockMeasuringContention<std::unique_lock>(
+            mutex, metrics::Counter::TrackerLockContended, metrics::Histogram::TrackerLockWait);
+    }
+
+    // Apply the AcquisitionThreadPriority and AcquisitionThreadAffinity settings to the calling thread, for as long as
+    // the returned object lives.
+    static inline std::unique_ptr<utils::general::IThreadPolicy> applyAcquisitionThreadPolicy(const char* name) {
+        const config::Settings& settings = config::GetSettings();
+        return utils::general::applyThreadPolicy(
+            name, settings.acquisitionThreadPriority, settings.acquisitionThreadAffinity);
+    }
+
     std::unique_ptr<IEyeTracker> createSimulatedEyeTracker();
 #ifdef _WIN64
     std::unique_ptr<IEyeTracker> createOmniceptEyeTracker();
@@ -101,4 +169,19 @@ namespace openxr_api_layer {
     std::unique_ptr<IEyeTracker> createPsvr2ToolkitEyeTracker();
     std::unique_ptr<IEyeTracker> createVRChatOSCEyeTracker();
 
+    // Wraps a tracker and records every query and its result into a file in the given folder.
+    std::unique_ptr<IEyeTracker> createGazeRecorder(std::unique_ptr<IEyeTracker> tracker,
+                                                    const std::filesystem::path& folder);
+    // Plays back a recording from the given offset, either paced like the original session or as fast as it is queried.
+    std::unique_ptr<IEyeTracker> createReplayEyeTracker(const std::filesystem::path& path,
+                                                        bool realTime,
+                                                        std::chrono::seconds startOffset);
+
+    // Wraps a tracker and publishes its samples for the other processes. When another process already does, the tracker
+    // is released and a reader of the shared samples is returned instead.
+    std::unique_ptr<IEyeTracker> createGazePublisher(std::unique_ptr<IEyeTracker> tracker);
+    // Reads the samples published by another process, if any. The layer opens the tracker itself once that process
+    // exits (see IEyeTracker::hasPublisherExited()).
+    std::unique_ptr<IEyeTracker> createSharedEyeTracker();
+
 } // namespace openxr_api_layer
@@ -42,6 +42,36 @@ namespace openxr_api_layer::utilities {
         return data;
     }
 
+    static std::optional<std::wstring> RegGetString(HKEY hKey, const std::string& subKey, const std::string& value) {
+        const std::wstring wideSubKey(subKey.begin(), subKey.end());
+        const std::wstring wideValue(value.begin(), value.end());
+        DWORD dataSize = 0;
+        LONG retCode = ::RegGetValue(hKey,
+                                     wideSubKey.c_str(),
+                                     wideValue.c_str(),
+                                     RRF_SUBKEY_WOW6464KEY | RRF_RT_REG_SZ,
+                                     nullptr,
+                                     nullptr,
+                                     &dataSize);
+        if (retCode != ERROR_SUCCESS || !dataSize) {
+            return {};
+        }
+
+        std::wstring data(dataSize / sizeof(wchar_t), L'\0');
+        retCode = ::RegGetValue(hKey,
+                                wideSubKey.c_str(),
+                                wideValue.c_str(),
+                                RRF_SUBKEY_WOW6464KEY | RRF_RT_REG_SZ,
+                                nullptr,
+                                data.data(),
+                                &dataSize);
+        if (retCode != ERROR_SUCCESS) {
+            return {};
+        }
+        data.resize(wcslen(data.c_str()));
+        return data;
+    }
+
     // https://stackoverflow.com/questions/7808085/how-to-get-the-status-of-a-service-programmatically-running-stopped
     static bool IsServiceRunning(const std::string& name) {
         SC_HANDLE theService, scm;
@@ -0,0 +1,612 @@
+// MIT License
+//
+// Copyright(c) 2022-2023 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "pch.h"
+
+#include "capture.h"
+#include "gaze.h"
+
+namespace {
+
+    using namespace openxr_api_layer::utils;
+    using namespace openxr_api_layer::utils::capture;
+
+    constexpr char k_fileMagic[8] = {'G', 'A', 'Z', 'E', 'C', 'A', 'P', '\0'};
+    constexpr uint32_t k_fileVersion = 3;
+    constexpr uint32_t k_chunkMagic = 0x4b435a47; // "GZCK"
+    constexpr uint32_t k_indexMagic = 0x58495a47; // "GZIX"
+
+    enum Column {
+        // 4 bits per record: kind, result, left eye valid, right eye valid.
+        Flags = 0,
+        // Delta-of-delta, zig-zag varint.
+        Times,
+        QueryOffsets,
+        // Zig-zag varint of the difference between query and acquisition (GetGaze records only).
+        AcquisitionLags,
+        // Float X, Y and Z, or quantized yaw, pitch and length (GetGaze records only).
+        Gazes,
+        // Float X, Y and Z, or quantized yaw and pitch (GetGaze records only, for each valid eye).
+        EyeGazes,
+        // Float, or 8-bit (GetGaze records only).
+        Confidences,
+
+        ColumnCount
+    };
+
+    struct FileHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t trackerType;
+        Encoding encoding;
+    };
+
+    struct ChunkHeader {
+        uint32_t magic;
+        uint32_t recordCount;
+        // Size of the columns following the header.
+        uint32_t size;
+        uint32_t columnOffsets[ColumnCount];
+        XrTime firstTime;
+        XrTime maxTime;
+    };
+
+    struct IndexEntry {
+        XrTime firstTime;
+        XrTime maxTime;
+        uint64_t offset;
+        uint64_t firstRecord;
+    };
+
+    struct Footer {
+        uint64_t indexOffset;
+        uint32_t indexCount;
+        uint32_t magic;
+    };
+
+    constexpr float k_pi = 3.14159265358979f;
+
+    [[noreturn]] void throwCorrupted() {
+        throw std::runtime_error("Gaze capture is corrupted");
+    }
+
+    uint64_t zigzag(int64_t value) {
+        return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    }
+
+    int64_t unzigzag(uint64_t value) {
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+    void writeVarint(std::vector<uint8_t>& column, uint64_t value) {
+        while (value >= 0x80) {
+            column.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        column.push_back(static_cast<uint8_t>(value));
+    }
+
+    template <typename T>
+    void writeValue(std::vector<uint8_t>& column, T value) {
+        const auto bytes = reinterpret_cast<const uint8_t*>(&value);
+        column.insert(column.end(), bytes, bytes + sizeof(value));
+    }
+
+    int16_t quantize(float value, float range) {
+        return static_cast<int16_t>(std::lround(std::clamp(value / range, -1.f, 1.f) * 32767.f));
+    }
+
+    float dequantize(int16_t value, float range) {
+        return value / 32767.f * range;
+    }
+
+    // Quantized directions are stored as angles. The length is only stored when requested, since the combined gaze of
+    // some trackers is not normalized.
+    void writeDirection(std::vector<uint8_t>& column, const XrVector3f& direction, bool withLength, Encoding encoding) {
+        if (encoding == Encoding::Lossless) {
+            writeValue(column, direction.x);
+            writeValue(column, direction.y);
+            writeValue(column, direction.z);
+            return;
+        }
+
+        const float length = vectormath::length3(vectormath::load(direction));
+        const float yaw = length > 0.f ? std::atan2(direction.x, -direction.z) : 0.f;
+        const float pitch = length > 0.f ? std::asin(std::clamp(direction.y / length, -1.f, 1.f)) : 0.f;
+        writeValue(column, quantize(yaw, k_pi));
+        writeValue(column, quantize(pitch, k_pi / 2));
+        if (withLength) {
+            writeValue(column, static_cast<uint16_t>(std::lround(std::clamp(length, 0.f, 2.f) / 2.f * 65535.f)));
+        }
+    }
+
+    // Delta-of-delta coding of a mostly-periodic series. Arithmetic wraps around, so that any sequence round-trips.
+    struct DeltaOfDelta {
+        uint64_t encode(int64_t value) {
+            const uint64_t delta = static_cast<uint64_t>(value) - m_previous;
+            const uint64_t deltaOfDelta = delta - m_previousDelta;
+            m_previous = static_cast<uint64_t>(value);
+            m_previousDelta = delta;
+            return zigzag(static_cast<int64_t>(deltaOfDelta));
+        }
+
+        int64_t decode(uint64_t encoded) {
+            m_previousDelta += static_cast<uint64_t>(unzigzag(encoded));
+            m_previous += m_previousDelta;
+            return static_cast<int64_t>(m_previous);
+        }
+
+        uint64_t m_previous{0};
+        uint64_t m_previousDelta{0};
+    };
+
+    // Reads a column in place from the mapped file.
+    class ColumnReader {
+      public:
+        ColumnReader(const uint8_t* begin, const uint8_t* end) : m_cursor(begin), m_end(end) {
+        }
+
+        uint64_t readVarint() {
+            uint64_t value = 0;
+            for (uint32_t shift = 0; shift < 64; shift += 7) {
+                if (m_cursor >= m_end) {
+                    throwCorrupted();
+                }
+                const uint8_t byte = *m_cursor++;
+                value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+                if (!(byte & 0x80)) {
+                    return value;
+                }
+            }
+            throwCorrupted();
+        }
+
+        uint8_t readByte() {
+            if (m_cursor >= m_end) {
+                throwCorrupted();
+            }
+            return *m_cursor++;
+        }
+
+        template <typename T>
+        T readValue() {
+            if (m_end - m_cursor < static_cast<ptrdiff_t>(sizeof(T))) {
+                throwCorrupted();
+            }
+            T value;
+            memcpy(&value, m_cursor, sizeof(T));
+            m_cursor += sizeof(T);
+            return value;
+        }
+
+        XrVector3f readDirection(bool withLength, Encoding encoding) {
+            if (encoding == Encoding::Lossless) {
+                XrVector3f direction;
+                direction.x = readValue<float>();
+                direction.y = readValue<float>();
+                direction.z = readValue<float>();
+                return direction;
+            }
+
+            const float yaw = dequantize(readValue<int16_t>(), k_pi);
+            const float pitch = dequantize(readValue<int16_t>(), k_pi / 2);
+            XrVector3f direction = gaze::directionFromAngles(yaw, pitch);
+            if (withLength) {
+                const float length = readValue<uint16_t>() / 65535.f * 2.f;
+                direction = {direction.x * length, direction.y * length, direction.z * length};
+            }
+            return direction;
+        }
+
+      private:
+        const uint8_t* m_cursor;
+        const uint8_t* const m_end;
+    };
+
+    class CaptureWriter : public ICaptureWriter {
+      public:
+        CaptureWriter(const std::filesystem::path& path, uint32_t trackerType, Encoding encoding)
+            : m_encoding(encoding) {
+            m_file.open(path, std::ios::binary | std::ios::trunc);
+            if (!m_file.is_open()) {
+                throw std::runtime_error(fmt::format("Failed to create gaze capture: {}", path.string()));
+            }
+
+            FileHeader header{};
+            std::copy(std::begin(k_fileMagic), std::end(k_fileMagic), header.magic);
+            header.version = k_fileVersion;
+            header.trackerType = trackerType;
+            header.encoding = encoding;
+            m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            m_size = sizeof(header);
+
+            m_pending.reserve(k_chunkCapacity);
+        }
+
+        ~CaptureWriter() override {
+            try {
+                close();
+            } catch (std::exception&) {
+            }
+        }
+
+        void write(const Record& record) override {
+            if (m_closed) {
+                return;
+            }
+
+            m_pending.push_back(record);
+            m_recordCount++;
+            if (m_pending.size() == k_chunkCapacity) {
+                writeChunk();
+            }
+        }
+
+        void close() override {
+            if (m_closed) {
+                return;
+            }
+            m_closed = true;
+
+            writeChunk();
+
+            Footer footer{};
+            footer.indexOffset = m_size;
+            footer.indexCount = static_cast<uint32_t>(m_index.size());
+            footer.magic = k_indexMagic;
+            m_file.write(reinterpret_cast<const char*>(m_index.data()), m_index.size() * sizeof(IndexEntry));
+            m_file.write(reinterpret_cast<const char*>(&footer), sizeof(footer));
+            m_size += m_index.size() * sizeof(IndexEntry) + sizeof(footer);
+            m_file.close();
+        }
+
+        uint64_t getRecordCount() const override {
+            return m_recordCount;
+        }
+
+        uint64_t getSize() const override {
+            return m_size;
+        }
+
+      private:
+        void writeChunk() {
+            if (m_pending.empty()) {
+                return;
+            }
+
+            for (auto& column : m_columns) {
+                column.clear();
+            }
+
+            DeltaOfDelta times;
+            DeltaOfDelta queryOffsets;
+            XrTime maxTime = m_pending.front().time;
+            for (size_t i = 0; i < m_pending.size(); i++) {
+                const Record& record = m_pending[i];
+                maxTime = std::max(maxTime, record.time);
+
+                const uint8_t flags = (record.kind == RecordKind::GetGaze ? 1 : 0) | (record.result ? 2 : 0) |
+                                      (record.isEyeValid[xr::StereoView::Left] ? 4 : 0) |
+                                      (record.isEyeValid[xr::StereoView::Right] ? 8 : 0);
+                if (i % 2 == 0) {
+                    m_columns[Flags].push_back(flags);
+                } else {
+                    m_columns[Flags].back() |= flags << 4;
+                }
+
+                writeVarint(m_columns[Times], times.encode(record.time));
+                writeVarint(m_columns[QueryOffsets], queryOffsets.encode(record.queryOffset));
+
+                if (record.kind == RecordKind::GetGaze) {
+                    writeVarint(m_columns[AcquisitionLags], zigzag(record.queryOffset - record.acquisitionOffset));
+                    writeDirection(m_columns[Gazes], record.unitVector, true, m_encoding);
+                    for (uint32_t eye = 0; eye < xr::StereoView::Count; eye++) {
+                        if (record.isEyeValid[eye]) {
+                            writeDirection(m_columns[EyeGazes], record.eyeUnitVector[eye], false, m_encoding);
+                        }
+                    }
+                    if (m_encoding == Encoding::Lossless) {
+                        writeValue(m_columns[Confidences], record.confidence);
+                    } else {
+                        m_columns[Confidences].push_back(
+                            static_cast<uint8_t>(std::lround(std::clamp(record.confidence, 0.f, 1.f) * 255.f)));
+                    }
+                }
+            }
+
+            ChunkHeader header{};
+            header.magic = k_chunkMagic;
+            header.recordCount = static_cast<uint32_t>(m_pending.size());
+            header.firstTime = m_pending.front().time;
+            header.maxTime = maxTime;
+            for (uint32_t i = 0; i < ColumnCount; i++) {
+                header.columnOffsets[i] = header.size;
+                header.size += static_cast<uint32_t>(m_columns[i].size());
+            }
+
+            m_index.push_back({header.firstTime, header.maxTime, m_size, m_recordCount - m_pending.size()});
+
+            m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            for (const auto& column : m_columns) {
+                m_file.write(reinterpret_cast<const char*>(column.data()), column.size());
+            }
+            m_size += sizeof(header) + header.size;
+
+            m_pending.clear();
+        }
+
+        const Encoding m_encoding;
+        std::ofstream m_file;
+        bool m_closed{false};
+        uint64_t m_size{0};
+        uint64_t m_recordCount{0};
+
+        std::vector<Record> m_pending;
+        std::vector<uint8_t> m_columns[ColumnCount];
+        std::vector<IndexEntry> m_index;
+    };
+
+    class CaptureReader : public ICaptureReader {
+      public:
+        CaptureReader(const std::filesystem::path& path) {
+            m_file.reset(CreateFileW(path.c_str(),
+                                     GENERIC_READ,
+                                     FILE_SHARE_READ | FILE_SHARE_WRITE,
+                                     nullptr,
+                                     OPEN_EXISTING,
+                                     FILE_ATTRIBUTE_NORMAL,
+                                     nullptr));
+            if (!m_file) {
+                throw std::runtime_error(fmt::format("Failed to open gaze capture: {}", path.string()));
+            }
+
+            LARGE_INTEGER size{};
+            GetFileSizeEx(m_file.get(), &size);
+            m_size = static_cast<uint64_t>(size.QuadPart);
+            FileHeader header{};
+            if (m_size < sizeof(header)) {
+                throwCorrupted();
+            }
+
+            *m_mapping.put() = CreateFileMappingW(m_file.get(), nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (m_mapping) {
+                m_view = reinterpret_cast<const uint8_t*>(MapViewOfFile(m_mapping.get(), FILE_MAP_READ, 0, 0, 0));
+            }
+            if (!m_view) {
+                throw std::runtime_error(fmt::format("Failed to map gaze capture: {}", path.string()));
+            }
+
+            memcpy(&header, m_view, sizeof(header));
+            if (!std::equal(std::begin(k_fileMagic), std::end(k_fileMagic), header.magic) ||
+                header.version != k_fileVersion) {
+                throw std::runtime_error(fmt::format("Unsupported gaze capture: {}", path.string()));
+            }
+            m_trackerType = header.trackerType;
+            m_encoding = header.encoding;
+            if (m_encoding != Encoding::Lossless && m_encoding != Encoding::Quantized) {
+                throw std::runtime_error(fmt::format("Unsupported gaze capture: {}", path.string()));
+            }
+
+            if (!loadIndex()) {
+                // The capture was not closed properly.
+                scanChunks();
+            }
+
+            m_runningMaxTimes.reserve(m_index.size());
+            for (const IndexEntry& entry : m_index) {
+                m_runningMaxTimes.push_back(
+                    m_runningMaxTimes.empty() ? entry.maxTime : std::max(m_runningMaxTimes.back(), entry.maxTime));
+            }
+        }
+
+        ~CaptureReader() override {
+            if (m_view) {
+                UnmapViewOfFile(m_view);
+            }
+        }
+
+        uint32_t getTrackerType() const override {
+            return m_trackerType;
+        }
+
+        Encoding getEncoding() const override {
+            return m_encoding;
+        }
+
+        uint64_t getRecordCount() const override {
+            return m_recordCount;
+        }
+
+        uint64_t seek(XrTime time) override {
+            // The running maximum of the times is non-decreasing even when the times are not: the first chunk where it
+            // reaches the requested time is the first one with a record at or after that time.
+            const auto it = std::lower_bound(m_runningMaxTimes.cbegin(), m_runningMaxTimes.cend(), time);
+            if (it == m_runningMaxTimes.cend()) {
+                return m_recordCount;
+            }
+            const size_t chunk = it - m_runningMaxTimes.cbegin();
+            decodeChunk(chunk);
+
+            const auto record = std::find_if(
+                m_decoded.cbegin(), m_decoded.cend(), [&](const Record& record) { return record.time >= time; });
+            return m_index[chunk].firstRecord + (record - m_decoded.cbegin());
+        }
+
+        const Record& get(uint64_t index) override {
+            if (index >= m_recordCount) {
+                throw std::out_of_range("Record index out of range");
+            }
+
+            if (m_decodedChunk == SIZE_MAX || index < m_index[m_decodedChunk].firstRecord ||
+                index >= m_index[m_decodedChunk].firstRecord + m_decoded.size()) {
+                const auto it = std::upper_bound(
+                    m_index.cbegin(), m_index.cend(), index, [](uint64_t index, const IndexEntry& entry) {
+                        return index < entry.firstRecord;
+                    });
+                decodeChunk((it - m_index.cbegin()) - 1);
+            }
+
+            return m_decoded[index - m_index[m_decodedChunk].firstRecord];
+        }
+
+      private:
+        ChunkHeader readChunkHeader(uint64_t offset) const {
+            ChunkHeader header{};
+            if (offset + sizeof(header) > m_size) {
+                throwCorrupted();
+            }
+            memcpy(&header, m_view + offset, sizeof(header));
+            if (header.magic != k_chunkMagic || offset + sizeof(header) + header.size > m_size) {
+                throwCorrupted();
+            }
+            return header;
+        }
+
+        bool loadIndex() {
+            Footer footer{};
+            if (m_size < sizeof(FileHeader) + sizeof(footer)) {
+                return false;
+            }
+            memcpy(&footer, m_view + m_size - sizeof(footer), sizeof(footer));
+            if (footer.magic != k_indexMagic ||
+                footer.indexOffset + footer.indexCount * sizeof(IndexEntry) + sizeof(footer) != m_size) {
+                return false;
+            }
+
+            m_index.resize(footer.indexCount);
+            memcpy(m_index.data(), m_view + footer.indexOffset, footer.indexCount * sizeof(IndexEntry));
+            if (!m_index.empty()) {
+                m_recordCount = m_index.back().firstRecord + readChunkHeader(m_index.back().offset).recordCount;
+            }
+            return true;
+        }
+
+        void scanChunks() {
+            uint64_t offset = sizeof(FileHeader);
+            while (offset + sizeof(ChunkHeader) <= m_size) {
+                ChunkHeader header{};
+                memcpy(&header, m_view + offset, sizeof(header));
+                if (header.magic != k_chunkMagic || offset + sizeof(header) + header.size > m_size) {
+                    // Truncated chunk.
+                    break;
+                }
+
+                m_index.push_back({header.firstTime, header.maxTime, offset, m_recordCount});
+                m_recordCount += header.recordCount;
+                offset += sizeof(header) + header.size;
+            }
+        }
+
+        void decodeChunk(size_t chunk) {
+            if (chunk == m_decodedChunk) {
+                return;
+            }
+
+            const ChunkHeader header = readChunkHeader(m_index[chunk].offset);
+            const uint8_t* const columns = m_view + m_index[chunk].offset + sizeof(header);
+            const auto getColumn = [&](uint32_t column) {
+                const uint32_t begin = header.columnOffsets[column];
+                const uint32_t end = column + 1 < ColumnCount ? header.columnOffsets[column + 1] : header.size;
+                if (begin > end || end > header.size) {
+                    throwCorrupted();
+                }
+                return ColumnReader(columns + begin, columns + end);
+            };
+
+            ColumnReader flags = getColumn(Flags);
+            ColumnReader times = getColumn(Times);
+            ColumnReader queryOffsets = getColumn(QueryOffsets);
+            ColumnReader acquisitionLags = getColumn(AcquisitionLags);
+            ColumnReader gazes = getColumn(Gazes);
+            ColumnReader eyeGazes = getColumn(EyeGazes);
+            ColumnReader confidences = getColumn(Confidences);
+
+            // Invalidate the cache first, in case decoding fails midway.
+            m_decodedChunk = SIZE_MAX;
+            m_decoded.resize(header.recordCount);
+
+            DeltaOfDelta timeDecoder;
+            DeltaOfDelta queryOffsetDecoder;
+            uint8_t flagsByte = 0;
+            for (uint32_t i = 0; i < header.recordCount; i++) {
+                if (i % 2 == 0) {
+                    flagsByte = flags.readByte();
+                }
+                const uint8_t recordFlags = (i % 2 == 0) ? (flagsByte & 0xf) : (flagsByte >> 4);
+
+                Record& record = m_decoded[i];
+                record = {};
+                record.kind = (recordFlags & 1) ? RecordKind::GetGaze : RecordKind::IsGazeAvailable;
+                record.result = recordFlags & 2;
+                record.isEyeValid[xr::StereoView::Left] = recordFlags & 4;
+                record.isEyeValid[xr::StereoView::Right] = recordFlags & 8;
+                record.time = timeDecoder.decode(times.readVarint());
+                record.queryOffset = queryOffsetDecoder.decode(queryOffsets.readVarint());
+                record.acquisitionOffset = record.queryOffset;
+
+                if (record.kind == RecordKind::GetGaze) {
+                    record.acquisitionOffset -= unzigzag(acquisitionLags.readVarint());
+                    record.unitVector = gazes.readDirection(true, m_encoding);
+                    for (uint32_t eye = 0; eye < xr::StereoView::Count; eye++) {
+                        if (record.isEyeValid[eye]) {
+                            record.eyeUnitVector[eye] = eyeGazes.readDirection(false, m_encoding);
+                        }
+                    }
+                    record.confidence = m_encoding == Encoding::Lossless ? confidences.readValue<float>()
+                                                                         : confidences.readByte() / 255.f;
+                }
+            }
+
+            m_decodedChunk = chunk;
+        }
+
+        wil::unique_hfile m_file;
+        wil::unique_handle m_mapping;
+        const uint8_t* m_view{nullptr};
+        uint64_t m_size{0};
+
+        uint32_t m_trackerType{0};
+        Encoding m_encoding{Encoding::Lossless};
+        uint64_t m_recordCount{0};
+        std::vector<IndexEntry> m_index;
+        std::vector<XrTime> m_runningMaxTimes;
+
+        size_t m_decodedChunk{SIZE_MAX};
+        std::vector<Record> m_decoded;
+    };
+
+} // namespace
+
+namespace openxr_api_layer::utils::capture {
+
+    std::unique_ptr<ICaptureWriter> createCaptureWriter(const std::filesystem::path& path,
+                                                        uint32_t trackerType,
+                                                        Encoding encoding) {
+        return std::make_unique<CaptureWriter>(path, trackerType, encoding);
+    }
+
+    std::unique_ptr<ICaptureReader> openCaptureReader(const std::filesystem::path& path) {
+        return std::make_unique<CaptureReader>(path);
+    }
+
+} // namespace openxr_api_layer::utils::capture
@@ -0,0 +1,100 @@
+// MIT License
+//
+// Copyright(c) 2022-2023 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+// A compact, seekable format for long gaze captures.
+//
+// Records are grouped in chunks of up to k_chunkCapacity records. Within a chunk, each field is stored in its own
+// column: times as zig-zag varints of their delta-of-delta, gaze directions as floats (or as 16-bit quantized angles,
+// see Encoding), and flags bit-packed. Chunks are self-describing, and an index of the time range of each chunk is
+// appended when the capture is closed, allowing to seek in O(log n). A capture that was not closed properly can still
+// be read by scanning the chunks.
+namespace openxr_api_layer::utils::capture {
+
+    constexpr uint32_t k_chunkCapacity = 4096;
+
+    enum class Encoding : uint32_t {
+        // Every field is restored bit for bit, so that a replay reproduces the session exactly.
+        Lossless = 0,
+        // Directions are stored as 16-bit angles (within 0.005 degrees) and confidences as 8 bits, which makes
+        // GetGaze records less than half as large. Replays are no longer bit-identical to the session.
+        Quantized,
+    };
+
+    enum class RecordKind : uint8_t {
+        IsGazeAvailable = 0,
+        GetGaze,
+    };
+
+    // One query made to the eye tracker and its answer.
+    struct Record {
+        RecordKind kind{RecordKind::IsGazeAvailable};
+        bool result{false};
+        XrTime time{0};
+
+        // Nanoseconds since the beginning of the capture.
+        int64_t queryOffset{0};
+        int64_t acquisitionOffset{0};
+
+        // Only meaningful for GetGaze records. Per-eye directions are only stored when valid.
+        XrVector3f unitVector{};
+        XrVector3f eyeUnitVector[xr::StereoView::Count]{};
+        bool isEyeValid[xr::StereoView::Count]{};
+        float confidence{1.f};
+    };
+
+    struct ICaptureWriter {
+        virtual ~ICaptureWriter() = default;
+
+        virtual void write(const Record& record) = 0;
+
+        // Write the pending records and the index. No more records may be written afterwards.
+        virtual void close() = 0;
+
+        virtual uint64_t getRecordCount() const = 0;
+        virtual uint64_t getSize() const = 0;
+    };
+
+    // The reader maps the whole file in memory and decodes one chunk at a time.
+    struct ICaptureReader {
+        virtual ~ICaptureReader() = default;
+
+        virtual uint32_t getTrackerType() const = 0;
+        virtual Encoding getEncoding() const = 0;
+        virtual uint64_t getRecordCount() const = 0;
+
+        // Index of the first record, in capture order, whose time is at or after the given time, or the record count if
+        // there is none. Times do not need to be monotonic: applications may query the gaze for past or future times.
+        virtual uint64_t seek(XrTime time) = 0;
+
+        // Sequential access only decodes each chunk once.
+        virtual const Record& get(uint64_t index) = 0;
+    };
+
+    std::unique_ptr<ICaptureWriter> createCaptureWriter(const std::filesystem::path& path,
+                                                        uint32_t trackerType,
+                                                        Encoding encoding = Encoding::Lossless);
+    std::unique_ptr<ICaptureReader> openCaptureReader(const std::filesystem::path& path);
+
+} // namespace openxr_api_layer::utils::capture
@@ -24,8 +24,9 @@
 
 #include "graphics.h"
 #include "log.h"
+#include "metrics.h"
 
-#if defined(XR_USE_GRAPHICS_API_D3D11) || defined(XR_USE_GRAPHICS_API_D3D12)
+#if defined(XR_USE_GRAPHICS_API_D3D11) || defined(XR_USE_GRAPHICS_API_D3D12) || defined(XR_USE_GRAPHICS_API_CPU)
 
 namespace xr {
 
@@ -40,6 +41,10 @@ namespace xr {
 #ifdef XR_USE_GRAPHICS_API_D3D12
         case Api::D3D12:
             return "D3D12";
+#endif
+#ifdef XR_USE_GRAPHICS_API_CPU
+        case Api::CPU:
+            return "CPU";
 #endif
         };
 
@@ -51,6 +56,10 @@ namespace xr {
 #ifdef XR_USE_GRAPHICS_API_D3D11
         case CompositionApi::D3D11:
             return "D3D11";
+#endif
+#ifdef XR_USE_GRAPHICS_API_CPU
+        case CompositionApi::CPU:
+            return "CPU";
 #endif
         };
 
@@ -63,6 +72,11 @@ namespace {
 
     using namespace openxr_api_layer::log;
     using namespace openxr_api_layer::utils::graphics;
+    namespace metrics = openxr_api_layer::metrics;
+
+#ifdef XR_USE_GRAPHICS_API_CPU
+    std::atomic<bool> g_isCpuSwapchainImageShareable{true};
+#endif
 
     bool isSRGBFormat(DXGI_FORMAT format) {
         return format == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB || format == DXGI_FORMAT_B8G8R8A8_UNORM_SRGB ||
@@ -76,6 +90,90 @@ namespace {
                format == DXGI_FORMAT_D32_FLOAT || format == DXGI_FORMAT_D32_FLOAT_S8X24_UINT;
     }
 
+    // Fences shared by a composition framework and its swapchains to serialize work between the application device and
+    // the composition device. Swapchain operations only record work to serialize, so that all swapchains are serialized
+    // with a single fence round-trip in each direction per frame, at serializePreComposition() and
+    // serializePostComposition().
+    struct DeviceSynchronizer {
+        DeviceSynchronizer(IGraphicsDevice* applicationDevice, IGraphicsDevice* compositionDevice) {
+            m_fenceOnCompositionDevice = compositionDevice->createFence();
+            m_fenceOnApplicationDevice = applicationDevice->openFence(m_fenceOnCompositionDevice->getFenceHandle());
+        }
+
+        // Record work on the application device that the composition device must wait for. During composition, the
+        // composition device might access the result right away, so we serialize immediately.
+        void recordApplicationWork() {
+            std::unique_lock lock(m_mutex);
+
+            m_hasApplicationWork = true;
+            if (m_isComposing) {
+                serializeApplicationToComposition();
+            }
+        }
+
+        // Serialize the composition work before the application device (or the runtime) accesses its result. The
+        // composition device is only used during composition, and serializePostComposition() covers everything after.
+        void flushCompositionWork() {
+            std::unique_lock lock(m_mutex);
+
+            if (m_isComposing) {
+                serializeCompositionToApplication();
+            }
+        }
+
+        void beginComposition() {
+            std::unique_lock lock(m_mutex);
+
+            serializeApplicationToComposition();
+            m_isComposing = true;
+        }
+
+        void endComposition() {
+            std::unique_lock lock(m_mutex);
+
+            serializeCompositionToApplication();
+            m_isComposing = false;
+        }
+
+        void waitForIdle() {
+            std::unique_lock lock(m_mutex);
+
+            m_fenceOnApplicationDevice->waitOnCpu(m_fenceValue);
+            m_fenceOnCompositionDevice->waitOnCpu(m_fenceValue);
+        }
+
+      private:
+        void serializeApplicationToComposition() {
+            m_fenceValue++;
+            m_fenceOnApplicationDevice->signal(m_fenceValue);
+            m_fenceOnCompositionDevice->waitOnDevice(m_fenceValue);
+            m_hasApplicationWork = false;
+
+            metrics::Increment(metrics::Counter::ApplicationToCompositionSyncs);
+            TraceLoggingWrite(g_traceProvider,
+                              "DeviceSynchronizer_ApplicationToComposition",
+                              TLArg(m_fenceValue, "FenceValue"));
+        }
+
+        void serializeCompositionToApplication() {
+            m_fenceValue++;
+            m_fenceOnCompositionDevice->signal(m_fenceValue);
+            m_fenceOnApplicationDevice->waitOnDevice(m_fenceValue);
+
+            metrics::Increment(metrics::Counter::CompositionToApplicationSyncs);
+            TraceLoggingWrite(g_traceProvider,
+                              "DeviceSynchronizer_CompositionToApplication",
+                              TLArg(m_fenceValue, "FenceValue"));
+        }
+
+        std::mutex m_mutex;
+        std::shared_ptr<IGraphicsFence> m_fenceOnApplicationDevice;
+        std::shared_ptr<IGraphicsFence> m_fenceOnCompositionDevice;
+        uint64_t m_fenceValue{0};
+        bool m_hasApplicationWork{false};
+        bool m_isComposing{false};
+    };
+
     struct SwapchainImage : ISwapchainImage {
         SwapchainImage(std::shared_ptr<IGraphicsTexture> textureOnApplicationDevice,
                        std::shared_ptr<IGraphicsTexture> textureOnCompositionDevice,
@@ -113,14 +211,15 @@ namespace {
                              const XrSwapchainCreateInfo& infoOnApplicationDevice,
                              IGraphicsDevice* applicationDevice,
                              IGraphicsDevice* compositionDevice,
+                             std::shared_ptr<DeviceSynchronizer> synchronizer,
                              SwapchainMode mode,
                              std::optional<bool> overrideShareable = {},
                              bool hasOwnership = true)
             : m_swapchain(swapchain), m_infoOnCompositionDevice(infoOnApplicationDevice),
               m_formatOnApplicationDevice(infoOnApplicationDevice.format), m_applicationDevice(applicationDevice),
-              m_compositionDevice(compositionDevice),
+              m_compositionDevice(compositionDevice), m_synchronizer(synchronizer),
               m_accessForRead((mode & SwapchainMode::Read) == SwapchainMode::Read),
-              m_accessForWrite((mode & SwapchainMode::Write) == SwapchainMode::Write) {
+              m_accessForWrite((mode & SwapchainMode::Write) == SwapchainMode::Write), m_hasOwnership(hasOwnership) {
             TraceLocalActivity(local);
             TraceLoggingWriteStart(
                 local, "Swapchain_Create", TLArg("Submittable", "Type"), TLArg(hasOwnership, "HasOwnership"));
@@ -171,6 +270,16 @@ namespace {
                     textures.push_back(m_applicationDevice->openTexture<D3D12>(image.texture, infoOnApplicationDevice));
                 }
             } break;
+#endif
+#ifdef XR_USE_GRAPHICS_API_CPU
+            case Api::CPU: {
+                // There is no OpenXR swapchain image type for system memory, so the images only exist in the layer.
+                // Overriding their shareability exercises the bounce buffer copies.
+                for (uint32_t i = 0; i < imagesCount; i++) {
+                    textures.push_back(m_applicationDevice->createTexture(infoOnApplicationDevice,
+                                                                          overrideShareable.value_or(true)));
+                }
+            } break;
 #endif
             default:
                 throw std::runtime_error("Composition graphics API is not supported");
@@ -206,10 +315,6 @@ namespace {
                 index++;
             }
 
-            // A fence to be used to synchronize between the application/runtime and the composition device.
-            m_fenceOnCompositionDevice = m_compositionDevice->createFence();
-            m_fenceOnApplicationDevice = m_applicationDevice->openFence(m_fenceOnCompositionDevice->getFenceHandle());
-
             TraceLoggingWriteStop(local, "Swapchain_Create", TLPArg(this, "Swapchain"));
         }
 
@@ -217,12 +322,7 @@ namespace {
             TraceLocalActivity(local);
             TraceLoggingWriteStart(local, "Swapchain_Destroy", TLPArg(this, "Swapchain"));
 
-            if (m_fenceOnApplicationDevice) {
-                m_fenceOnApplicationDevice->waitOnCpu(m_fenceValue);
-            }
-            if (m_fenceOnCompositionDevice) {
-                m_fenceOnCompositionDevice->waitOnCpu(m_fenceValue);
-            }
+            m_synchronizer->waitForIdle();
             if (xrDestroySwapchain) {
                 xrDestroySwapchain(m_swapchain);
             }
@@ -245,10 +345,8 @@ namespace {
             }
 
             // Serialize the operations on the application device that might have occurred when acquiring the swapchain
-            // image.
-            m_fenceValue++;
-            m_fenceOnApplicationDevice->signal(m_fenceValue);
-            m_fenceOnCompositionDevice->waitOnDevice(m_fenceValue);
+            // image. Outside of composition, this is deferred to serializePreComposition().
+            m_synchronizer->recordApplicationWork();
 
             m_acquiredImages.push_back(index);
 
@@ -289,10 +387,83 @@ namespace {
 
             m_lastReleasedImage = m_acquiredImages.front();
             m_acquiredImages.pop_front();
+            m_imageInBounceBuffer.reset();
+
+            // The application rendered into the image, that we are going to read.
+            if (m_accessForRead) {
+                m_synchronizer->recordApplicationWork();
+            }
 
             TraceLoggingWriteStop(local, "Swapchain_ReleaseImage", TLArg(m_lastReleasedImage.value(), "ReleasedIndex"));
         }
 
+        XrResult acquireApplicationImage(const XrSwapchainImageAcquireInfo* acquireInfo, uint32_t* index) override {
+            TraceLocalActivity(local);
+            TraceLoggingWriteStart(local, "Swapchain_AcquireApplicationImage", TLPArg(this, "Swapchain"));
+
+            if (m_hasOwnership) {
+                throw std::runtime_error("Not an application swapchain");
+            }
+
+            std::unique_lock lock(m_mutex);
+
+            const XrResult result = xrAcquireSwapchainImage(m_swapchain, acquireInfo, index);
+            if (XR_SUCCEEDED(result)) {
+                m_synchronizer->recordApplicationWork();
+                m_acquiredImages.push_back(*index);
+
+                TraceLoggingWriteTagged(local, "Swapchain_AcquireApplicationImage", TLArg(*index, "AcquiredIndex"));
+            }
+
+            TraceLoggingWriteStop(
+                local, "Swapchain_AcquireApplicationImage", TLArg(xr::ToCString(result), "Result"));
+
+            return result;
+        }
+
+        XrResult releaseApplicationImage(const XrSwapchainImageReleaseInfo* releaseInfo) override {
+            TraceLocalActivity(local);
+            TraceLoggingWriteStart(local, "Swapchain_ReleaseApplicationImage", TLPArg(this, "Swapchain"));
+
+            if (m_hasOwnership) {
+                throw std::runtime_error("Not an application swapchain");
+            }
+
+            std::unique_lock lock(m_mutex);
+
+            // The image released last is held until commitLastReleasedImage(), so that the runtime cannot hand it back
+            // to the application while the composition reads it. Releasing another image in the meantime releases the
+            // held one instead, which is the oldest image acquired from the runtime.
+            XrResult result = XR_SUCCESS;
+            if (m_acquiredImages.empty()) {
+                // The held image is not the application's to release. Otherwise the image was acquired before the
+                // swapchain was wrapped, and the runtime decides.
+                result = m_lastReleasedImage.has_value() ? XR_ERROR_CALL_ORDER_INVALID
+                                                         : xrReleaseSwapchainImage(m_swapchain, releaseInfo);
+            } else {
+                if (m_lastReleasedImage.has_value()) {
+                    result = xrReleaseSwapchainImage(m_swapchain, releaseInfo);
+                }
+                if (XR_SUCCEEDED(result)) {
+                    m_lastReleasedImage = m_acquiredImages.front();
+                    m_acquiredImages.pop_front();
+                    m_imageInBounceBuffer.reset();
+
+                    // The application rendered into the image, that we are going to read.
+                    if (m_accessForRead) {
+                        m_synchronizer->recordApplicationWork();
+                    }
+                }
+            }
+
+            TraceLoggingWriteStop(local,
+                                  "Swapchain_ReleaseApplicationImage",
+                                  TLArg(xr::ToCString(result), "Result"),
+                                  TLArg(m_lastReleasedImage.value_or(-1), "HeldIndex"));
+
+            return result;
+        }
+
         ISwapchainImage* getLastReleasedImage() const override {
             TraceLocalActivity(local);
             TraceLoggingWriteStart(local,
@@ -304,20 +475,10 @@ namespace {
                 throw std::runtime_error("Not a readable swapchain");
             }
 
+            // The copy is serialized by serializePreComposition(), or right away during composition.
             ISwapchainImage* image = nullptr;
             if (m_lastReleasedImage.has_value()) {
-                if (m_bounceBufferOnApplicationDevice) {
-                    // The swapchain image wasn't shareable and we must perform a copy to a shareable texture accessible
-                    // on the composition device.
-                    m_applicationDevice->copyTexture(m_images[m_lastReleasedImage.value()]->getApplicationTexture(),
-                                                     m_bounceBufferOnApplicationDevice.get());
-                }
-
-                // Serialize the operations on the application device before accessing from the composition device.
-                m_fenceValue++;
-                m_fenceOnApplicationDevice->signal(m_fenceValue);
-                m_fenceOnCompositionDevice->waitOnDevice(m_fenceValue);
-
+                updateBounceBuffer();
                 image = m_images[m_lastReleasedImage.value()].get();
             }
 
@@ -333,18 +494,14 @@ namespace {
                                    TLPArg(this, "Swapchain"),
                                    TLArg(m_lastReleasedImage.value_or(-1), "Index"));
 
-            if (!m_accessForWrite) {
-                throw std::runtime_error("Not a writable swapchain");
-            }
+            std::unique_lock lock(m_mutex);
 
             if (m_lastReleasedImage.has_value()) {
                 // Serialize the operations on the composition device before copying to the application device or
-                // releasing the swapchain image.
-                m_fenceValue++;
-                m_fenceOnCompositionDevice->signal(m_fenceValue);
-                m_fenceOnApplicationDevice->waitOnDevice(m_fenceValue);
+                // releasing the swapchain image. Already done if serializePostComposition() was called.
+                m_synchronizer->flushCompositionWork();
 
-                if (m_bounceBufferOnApplicationDevice) {
+                if (m_accessForWrite && m_bounceBufferOnApplicationDevice) {
                     // The swapchain image wasn't shareable and we must perform a copy from a shareable texture written
                     // on the composition device.
                     m_applicationDevice->copyTexture(m_bounceBufferOnApplicationDevice.get(),
@@ -353,11 +510,26 @@ namespace {
 
                 CHECK_XRCMD(xrReleaseSwapchainImage(m_swapchain, nullptr));
                 m_lastReleasedImage = {};
+                m_imageInBounceBuffer.reset();
             }
 
             TraceLoggingWriteStop(local, "Swapchain_CommitLastReleasedImage");
         }
 
+        // If the swapchain image wasn't shareable, we must perform a copy to a shareable texture accessible on the
+        // composition device. Only the swapchains read by the frame are copied.
+        void updateBounceBuffer() const {
+            if (!m_accessForRead || !m_bounceBufferOnApplicationDevice || !m_lastReleasedImage.has_value() ||
+                m_imageInBounceBuffer == m_lastReleasedImage) {
+                return;
+            }
+
+            m_applicationDevice->copyTexture(m_images[m_lastReleasedImage.value()]->getApplicationTexture(),
+                                             m_bounceBufferOnApplicationDevice.get());
+            m_imageInBounceBuffer = m_lastReleasedImage;
+            m_synchronizer->recordApplicationWork();
+        }
+
         const XrSwapchainCreateInfo& getInfoOnCompositionDevice() const override {
             return m_infoOnCompositionDevice;
         }
@@ -394,6 +566,7 @@ namespace {
         IGraphicsDevice* const m_applicationDevice;
         const bool m_accessForRead;
         const bool m_accessForWrite;
+        const bool m_hasOwnership;
 
         PFN_xrAcquireSwapchainImage xrAcquireSwapchainImage{nullptr};
         PFN_xrWaitSwapchainImage xrWaitSwapchainImage{nullptr};
@@ -406,13 +579,12 @@ namespace {
         std::vector<std::unique_ptr<ISwapchainImage>> m_images;
         std::shared_ptr<IGraphicsTexture> m_bounceBufferOnApplicationDevice;
         std::shared_ptr<IGraphicsTexture> m_bounceBufferOnCompositionDevice;
-        std::shared_ptr<IGraphicsFence> m_fenceOnApplicationDevice;
-        std::shared_ptr<IGraphicsFence> m_fenceOnCompositionDevice;
-        mutable uint64_t m_fenceValue{0};
+        const std::shared_ptr<DeviceSynchronizer> m_synchronizer;
 
         std::mutex m_mutex;
         std::deque<uint32_t> m_acquiredImages;
         std::optional<uint32_t> m_lastReleasedImage{};
+        mutable std::optional<uint32_t> m_imageInBounceBuffer{};
     };
 
     // A non-submittable swapchain must be accessible on both the application & composition device, however because it
@@ -509,6 +681,14 @@ namespace {
             TraceLoggingWriteStop(local, "Swapchain_ReleaseImage", TLArg(m_lastReleasedImage, "ReleasedIndex"));
         }
 
+        XrResult acquireApplicationImage(const XrSwapchainImageAcquireInfo* acquireInfo, uint32_t* index) override {
+            throw std::runtime_error("Not an application swapchain");
+        }
+
+        XrResult releaseApplicationImage(const XrSwapchainImageReleaseInfo* releaseInfo) override {
+            throw std::runtime_error("Not an application swapchain");
+        }
+
         ISwapchainImage* getLastReleasedImage() const override {
             TraceLocalActivity(local);
             TraceLoggingWriteStart(local,
@@ -634,6 +814,14 @@ namespace {
 #endif
                 entry = entry->next;
             }
+#ifdef XR_USE_GRAPHICS_API_CPU
+            if (!m_applicationDevice && (compositionApi == CompositionApi::CPU || !sessionInfo.next)) {
+                // A session without graphics bindings, the application device is a CPU device and so is the
+                // composition device, since there is no GPU to match.
+                m_applicationDevice = internal::createCpuGraphicsDevice();
+                compositionApi = CompositionApi::CPU;
+            }
+#endif
 
             if (!m_applicationDevice) {
                 throw std::runtime_error("Application graphics API is not supported");
@@ -645,13 +833,17 @@ namespace {
             case CompositionApi::D3D11:
                 m_compositionDevice = internal::createD3D11CompositionDevice(m_applicationDevice->getAdapterLuid());
                 break;
+#endif
+#ifdef XR_USE_GRAPHICS_API_CPU
+            case CompositionApi::CPU:
+                m_compositionDevice = internal::createCpuGraphicsDevice();
+                break;
 #endif
             default:
                 throw std::runtime_error("Composition graphics API is not supported");
             }
 
-            m_fenceOnCompositionDevice = m_compositionDevice->createFence();
-            m_fenceOnApplicationDevice = m_applicationDevice->openFence(m_fenceOnCompositionDevice->getFenceHandle());
+            m_synchronizer = std::make_shared<DeviceSynchronizer>(m_applicationDevice.get(), m_compositionDevice.get());
 
             // Check for quirks.
             PFN_xrGetInstanceProperties xrGetInstanceProperties;
@@ -669,6 +861,11 @@ namespace {
                 m_overrideShareable = false;
             }
 #endif
+#ifdef XR_USE_GRAPHICS_API_CPU
+            if (m_applicationDevice->getApi() == Api::CPU && !g_isCpuSwapchainImageShareable) {
+                m_overrideShareable = false;
+            }
+#endif
 
             // Get the preferred formats for swapchains.
             PFN_xrEnumerateSwapchainFormats xrEnumerateSwapchainFormats;
@@ -708,8 +905,8 @@ namespace {
             TraceLocalActivity(local);
             TraceLoggingWriteStart(local, "CompositionFramework_Destroy", TLXArg(m_session, "Session"));
 
-            if (m_fenceOnCompositionDevice) {
-                m_fenceOnCompositionDevice->waitOnCpu(m_fenceValue);
+            if (m_synchronizer) {
+                m_synchronizer->waitForIdle();
             }
 
             TraceLoggingWriteStop(local, "CompositionFramework_Destroy");
@@ -764,6 +961,7 @@ namespace {
                                                                 infoOnApplicationDevice,
                                                                 m_applicationDevice.get(),
                                                                 m_compositionDevice.get(),
+                                                                m_synchronizer,
                                                                 mode,
                                                                 m_overrideShareable);
             } else {
@@ -776,15 +974,48 @@ namespace {
             return result;
         }
 
+        std::shared_ptr<ISwapchain> wrapApplicationSwapchain(XrSwapchain swapchain,
+                                                             const XrSwapchainCreateInfo& infoOnApplicationDevice,
+                                                             SwapchainMode mode) override {
+            TraceLocalActivity(local);
+            TraceLoggingWriteStart(local,
+                                   "CompositionFramework_WrapApplicationSwapchain",
+                                   TLXArg(m_session, "Session"),
+                                   TLXArg(swapchain, "Swapchain"),
+                                   TLArg(infoOnApplicationDevice.arraySize, "ArraySize"),
+                                   TLArg(infoOnApplicationDevice.width, "Width"),
+                                   TLArg(infoOnApplicationDevice.height, "Height"),
+                                   TLArg(infoOnApplicationDevice.format, "Format"),
+                                   TLArg(infoOnApplicationDevice.usageFlags, "UsageFlags"),
+                                   TLArg((int)mode, "Mode"));
+
+            // The application may submit the images itself: writing them would change what it submits.
+            if ((mode & SwapchainMode::Write) == SwapchainMode::Write) {
+                throw std::runtime_error("Application swapchains cannot be written");
+            }
+
+            const std::shared_ptr<ISwapchain> wrappedSwapchain =
+                std::make_shared<SubmittableSwapchain>(xrGetInstanceProcAddr,
+                                                       m_instance,
+                                                       swapchain,
+                                                       infoOnApplicationDevice,
+                                                       m_applicationDevice.get(),
+                                                       m_compositionDevice.get(),
+                                                       m_synchronizer,
+                                                       mode,
+                                                       m_overrideShareable,
+                                                       false /* hasOwnership */);
+            TraceLoggingWriteStop(
+                local, "CompositionFramework_WrapApplicationSwapchain", TLPArg(wrappedSwapchain.get(), "Swapchain"));
+
+            return wrappedSwapchain;
+        }
+
         void serializePreComposition() override {
             TraceLocalActivity(local);
             TraceLoggingWriteStart(local, "CompositionFramework_SerializePreComposition", TLXArg(m_session, "Session"));
 
-            std::unique_lock lock(m_fenceMutex);
-
-            m_fenceValue++;
-            m_fenceOnApplicationDevice->signal(m_fenceValue);
-            m_fenceOnCompositionDevice->waitOnDevice(m_fenceValue);
+            m_synchronizer->beginComposition();
 
             TraceLoggingWriteStop(local, "CompositionFramework_SerializePreComposition");
         }
@@ -794,11 +1025,7 @@ namespace {
             TraceLoggingWriteStart(
                 local, "CompositionFramework_SerializePostComposition", TLXArg(m_session, "Session"));
 
-            std::unique_lock lock(m_fenceMutex);
-
-            m_fenceValue++;
-            m_fenceOnCompositionDevice->signal(m_fenceValue);
-            m_fenceOnApplicationDevice->waitOnDevice(m_fenceValue);
+            m_synchronizer->endComposition();
 
             TraceLoggingWriteStop(local, "CompositionFramework_SerializePostComposition");
         }
@@ -834,14 +1061,9 @@ namespace {
         DXGI_FORMAT m_preferredSRGBColorFormat{DXGI_FORMAT_UNKNOWN};
         DXGI_FORMAT m_preferredDepthFormat{DXGI_FORMAT_UNKNOWN};
 
-        std::mutex m_fenceMutex;
-        std::shared_ptr<IGraphicsFence> m_fenceOnApplicationDevice;
-        std::shared_ptr<IGraphicsFence> m_fenceOnCompositionDevice;
-        uint64_t m_fenceValue{0};
+        std::shared_ptr<DeviceSynchronizer> m_synchronizer;
 
-#ifdef XR_USE_GRAPHICS_API_D3D12
         std::optional<bool> m_overrideShareable;
-#endif
 
         PFN_xrCreateSwapchain xrCreateSwapchain{nullptr};
     };
@@ -1005,6 +1227,16 @@ namespace openxr_api_layer::utils::graphics {
             instanceInfo, instance, xrGetInstanceProcAddr, compositionApi);
     }
 
+#ifdef XR_USE_GRAPHICS_API_CPU
+    namespace internal {
+
+        void setCpuSwapchainImagesShareable(bool shareable) {
+            g_isCpuSwapchainImageShareable = shareable;
+        }
+
+    } // namespace internal
+#endif
+
 } // namespace openxr_api_layer::utils::graphics
 
 #endif
@@ -0,0 +1,662 @@
+// MIT License
+//
+// Copyright(c) 2022-2023 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#ifdef XR_USE_GRAPHICS_API_CPU
+
+#include "log.h"
+#include "graphics.h"
+#include "util.h"
+
+namespace {
+
+    using namespace openxr_api_layer::log;
+    using namespace openxr_api_layer::utils::graphics;
+
+    struct CpuQueue;
+
+    // The value of a fence, shared with the fences opened from it.
+    struct CpuTimeline : std::enable_shared_from_this<CpuTimeline> {
+        // Returns false and remembers the queue if the value is not reached yet. The queue will resume execution once
+        // the value is signaled.
+        bool isReached(uint64_t target, const std::shared_ptr<CpuQueue>& queue) {
+            std::unique_lock lock(mutex);
+            if (value.load() >= target) {
+                return true;
+            }
+            if (std::find_if(waitingQueues.cbegin(), waitingQueues.cend(), [&](const std::weak_ptr<CpuQueue>& entry) {
+                    return entry.lock() == queue;
+                }) == waitingQueues.cend()) {
+                waitingQueues.push_back(queue);
+            }
+            return false;
+        }
+
+        void signal(uint64_t newValue);
+
+        void waitOnCpu(uint64_t target) {
+            std::unique_lock lock(mutex);
+            completion.wait(lock, [&] { return value.load() >= target; });
+        }
+
+        std::mutex mutex;
+        std::condition_variable completion;
+        std::atomic<uint64_t> value{0};
+        std::vector<std::weak_ptr<CpuQueue>> waitingQueues;
+    };
+
+    // Executes the commands of a device in order, on the thread submitting them or on the thread signaling the fence
+    // they wait for. Like on a GPU queue, waiting for a fence on the device only holds the commands behind the wait,
+    // never the caller.
+    struct CpuQueue : std::enable_shared_from_this<CpuQueue> {
+        void submit(std::function<void()> command) {
+            {
+                std::unique_lock lock(m_mutex);
+                m_commands.push_back({std::move(command), nullptr, 0});
+            }
+            execute();
+        }
+
+        void submitWait(std::shared_ptr<CpuTimeline> timeline, uint64_t value) {
+            {
+                std::unique_lock lock(m_mutex);
+                m_commands.push_back({nullptr, std::move(timeline), value});
+            }
+            execute();
+        }
+
+        void execute() {
+            std::unique_lock lock(m_mutex);
+
+            // Only one thread executes at a time, the other ones leave their request to it.
+            m_isExecutionRequested = true;
+            if (m_isExecuting) {
+                return;
+            }
+            m_isExecuting = true;
+
+            while (m_isExecutionRequested) {
+                m_isExecutionRequested = false;
+                while (!m_commands.empty()) {
+                    Command& command = m_commands.front();
+                    if (command.waitTimeline) {
+                        if (!command.waitTimeline->isReached(command.waitValue, shared_from_this())) {
+                            break;
+                        }
+                        m_commands.pop_front();
+                        continue;
+                    }
+
+                    const std::function<void()> function = std::move(command.execute);
+                    m_commands.pop_front();
+                    lock.unlock();
+                    function();
+                    lock.lock();
+                }
+            }
+
+            m_isExecuting = false;
+        }
+
+        struct Command {
+            std::function<void()> execute;
+            std::shared_ptr<CpuTimeline> waitTimeline;
+            uint64_t waitValue;
+        };
+
+        std::mutex m_mutex;
+        std::deque<Command> m_commands;
+        bool m_isExecuting{false};
+        bool m_isExecutionRequested{false};
+    };
+
+    void CpuTimeline::signal(uint64_t newValue) {
+        std::vector<std::weak_ptr<CpuQueue>> resumedQueues;
+        {
+            std::unique_lock lock(mutex);
+            value.store(newValue);
+            resumedQueues.swap(waitingQueues);
+        }
+        completion.notify_all();
+
+        for (const std::weak_ptr<CpuQueue>& entry : resumedQueues) {
+            if (const std::shared_ptr<CpuQueue> queue = entry.lock()) {
+                queue->execute();
+            }
+        }
+    }
+
+    // Texels of all the subresources, shared with the textures opened from it.
+    struct CpuTextureMemory : std::enable_shared_from_this<CpuTextureMemory> {
+        explicit CpuTextureMemory(size_t size) : storage(size), data(storage.data()), size(size) {
+        }
+
+        CpuTextureMemory(uint8_t* externalData, size_t size) : data(externalData), size(size) {
+        }
+
+        std::vector<uint8_t> storage;
+        uint8_t* const data;
+        const size_t size;
+    };
+
+    size_t getBytesPerPixel(DXGI_FORMAT format) {
+        switch (format) {
+        case DXGI_FORMAT_R32G32B32A32_FLOAT:
+        case DXGI_FORMAT_R32G32B32A32_UINT:
+            return 16;
+
+        case DXGI_FORMAT_R16G16B16A16_FLOAT:
+        case DXGI_FORMAT_R16G16B16A16_UNORM:
+        case DXGI_FORMAT_R32G32_FLOAT:
+        case DXGI_FORMAT_D32_FLOAT_S8X24_UINT:
+            return 8;
+
+        case DXGI_FORMAT_R8G8B8A8_UNORM:
+        case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+        case DXGI_FORMAT_B8G8R8A8_UNORM:
+        case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+        case DXGI_FORMAT_B8G8R8X8_UNORM:
+        case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+        case DXGI_FORMAT_R10G10B10A2_UNORM:
+        case DXGI_FORMAT_R11G11B10_FLOAT:
+        case DXGI_FORMAT_R32_FLOAT:
+        case DXGI_FORMAT_D32_FLOAT:
+        case DXGI_FORMAT_D24_UNORM_S8_UINT:
+            return 4;
+
+        case DXGI_FORMAT_R16_FLOAT:
+        case DXGI_FORMAT_R16_UNORM:
+        case DXGI_FORMAT_D16_UNORM:
+            return 2;
+
+        case DXGI_FORMAT_R8_UNORM:
+            return 1;
+
+        default:
+            throw std::runtime_error(fmt::format("Unsupported format: {}", (int)format));
+        }
+    }
+
+    size_t getTextureSize(const XrSwapchainCreateInfo& info) {
+        size_t size = 0;
+        for (uint32_t mip = 0; mip < std::max(info.mipCount, 1u); mip++) {
+            size += std::max(info.width >> mip, 1u) * std::max(info.height >> mip, 1u);
+        }
+        return size * std::max(info.arraySize, 1u) * std::max(info.faceCount, 1u) * std::max(info.sampleCount, 1u) *
+               getBytesPerPixel((DXGI_FORMAT)info.format);
+    }
+
+    // Offset of the first mip level of an array slice.
+    size_t getSliceOffset(const XrSwapchainCreateInfo& info, uint32_t slice) {
+        XrSwapchainCreateInfo sliceInfo = info;
+        sliceInfo.arraySize = 1;
+        return getTextureSize(sliceInfo) * slice;
+    }
+
+    // Bilinear filtering of 8-bit 4-channel texels, in the stored encoding. Sampling follows the same conventions as a
+    // GPU sampler with the coordinates clamped half a texel inside the source region.
+    void blitTexels(const uint8_t* source,
+                    uint32_t sourceRowPitch,
+                    const XrRect2Di& fromRect,
+                    uint8_t* destination,
+                    uint32_t destinationRowPitch,
+                    const XrRect2Di& toRect) {
+        const float scaleX = (float)fromRect.extent.width / toRect.extent.width;
+        const float scaleY = (float)fromRect.extent.height / toRect.extent.height;
+        const int32_t maxX = fromRect.offset.x + fromRect.extent.width - 1;
+        const int32_t maxY = fromRect.offset.y + fromRect.extent.height - 1;
+
+        for (int32_t y = 0; y < toRect.extent.height; y++) {
+            const float sourceY = std::clamp(
+                fromRect.offset.y + (y + 0.5f) * scaleY - 0.5f, (float)fromRect.offset.y, (float)maxY);
+            const int32_t y0 = (int32_t)sourceY;
+            const int32_t y1 = std::min(y0 + 1, maxY);
+            const float fy = sourceY - y0;
+            const uint8_t* const row0 = source + (size_t)y0 * sourceRowPitch;
+            const uint8_t* const row1 = source + (size_t)y1 * sourceRowPitch;
+            uint8_t* const output = destination + (size_t)(toRect.offset.y + y) * destinationRowPitch;
+
+            for (int32_t x = 0; x < toRect.extent.width; x++) {
+                const float sourceX = std::clamp(
+                    fromRect.offset.x + (x + 0.5f) * scaleX - 0.5f, (float)fromRect.offset.x, (float)maxX);
+                const int32_t x0 = (int32_t)sourceX;
+                const int32_t x1 = std::min(x0 + 1, maxX);
+                const float fx = sourceX - x0;
+
+                uint8_t* const texel = output + (size_t)(toRect.offset.x + x) * 4;
+                for (uint32_t c = 0; c < 4; c++) {
+                    const float top = row0[x0 * 4 + c] + (row0[x1 * 4 + c] - row0[x0 * 4 + c]) * fx;
+                    const float bottom = row1[x0 * 4 + c] + (row1[x1 * 4 + c] - row1[x0 * 4 + c]) * fx;
+                    texel[c] = (uint8_t)(top + (bottom - top) * fy + 0.5f);
+                }
+            }
+        }
+    }
+
+    // Measures the wall time between the execution of start() and stop() on the queue.
+    struct CpuTimer : IGraphicsTimer {
+        CpuTimer(std::shared_ptr<CpuQueue> queue) : m_queue(queue) {
+            TraceLocalActivity(local);
+            TraceLoggingWriteStart(local, "CpuTimer_Create");
+            TraceLoggingWriteStop(local, "CpuTimer_Create", TLPArg(this, "Timer"));
+        }
+
+        ~CpuTimer() override {
+            TraceLocalActivity(local);
+            TraceLoggingWriteStart(local, "CpuTimer_Destroy", TLPArg(this, "Timer"));
+            TraceLoggingWriteStop(local, "CpuTimer_Destroy");
+        }
+
+        Api getApi() const override {
+            return Api::CPU;
+        }
+
+        void start() override {
+            TraceLocalActivity(local);
+            TraceLoggingWriteStart(local, "CpuTimer_Start", TLPArg(this, "Timer"));
+
+            m_isComplete = false;
+            m_queue->submit([this] { m_start = std::chrono::steady_clock::now(); });
+
+            TraceLoggingWriteStop(local, "CpuTimer_Start");
+        }
+
+        void stop() override {
+            TraceLocalActivity(local);
+            TraceLoggingWriteStart(local, "CpuTimer_Stop", TLPArg(this, "Timer"));
+
+            m_queue->submit([this] {
+                m_end = std::chrono::steady_clock::now();
+                m_isComplete = true;
+            });
+
+            TraceLoggingWriteStop(local, "CpuTimer_Stop");
+        }
+
+        uint64_t query() const override {
+            TraceLocalActivity(local);
+            TraceLoggingWriteStart(
+                local, "CpuTimer_Query", TLPArg(this, "Timer"), TLArg(m_isComplete.load(), "Complete"));
+
+            uint64_t duration = 0;
+            if (m_isComplete.exchange(false)) {
+                duration = std::chrono::duration_cast<std::chrono::microseconds>(m_end - m_start).count();
+            }
+
+            TraceLoggingWriteStop(local, "CpuTimer_Query", TLArg(duration, "Duration"));
+
+            return duration;
+        }
+
+        const std::shared_ptr<CpuQueue> m_queue;
+
+        std::chrono::steady_clock::time_point m_start;
+        std::chrono::steady_clock::time_point m_end;
+        mutable std::atomic<bool> m_isComplete{false};
+    };
+
+    struct CpuFence : IGraphicsFence {
+        CpuFence(std::shared_ptr<CpuQueue> queue, std::shared_ptr<CpuTimeline> timeline, bool shareable)
+            : m_queue(queue), m_timeline(timeline), m_isShareable(shareable) {
+            TraceLocalActivity(local);
+            TraceLoggingWriteStart(
+                local, "CpuFence_Create", TLPArg(timeline.get(), "Timeline"), TLArg(shareable, "Shareable"));
+            TraceLoggingWriteStop(local, "CpuFence_Create", TLPArg(this, "Fence"));
+        }
+
+        ~CpuFence() override {
+            TraceLocalActivity(local);
+            TraceLoggingWriteStart(local, "CpuFence_Destroy", TLPArg(this, "Fence"));
+            TraceLoggingWriteStop(local, "CpuFence_Destroy");
+        }
+
+        Api getApi() const override {
+            return Api::CPU;
+        }
+
+        void* getNativeFencePtr() const override {
+            return &m_timeline->value;
+        }
+
+        ShareableHandle getFenceHandle() const override {
+            TraceLocalActivity(local);
+            TraceLoggingWriteStart(local, "CpuFence_Export", TLPArg(this, "Fence"));
+
+            if (!m_isShareable) {
+                throw std::runtime_error("Fence is not shareable");
+            }
+
+            // The handle is only meaningful within the process, like the textures and fences it refers to.
+            ShareableHandle handle{};
+            handle.handle = m_timeline.get();
+            handle.origin = Api::CPU;
+
+            TraceLoggingWriteStop(local, "CpuFence_Export", TLPArg(handle.handle, "Handle"));
+
+            return handle;
+        }
+
+        void signal(uint64_t value) override {
+            TraceLocalActivity(local);
+            TraceLoggingWriteStart(local, "CpuFence_Signal", TLPArg(this, "Fence"), TLArg(value, "Value"));
+
+            m_queue->submit([timeline = m_timeline, value] { timeline->signal(value); });
+
+            TraceLoggingWriteStop(local, "CpuFence_Signal");
+        }
+
+        void waitOnDevice(uint64_t value) override {
+            TraceLocalActivity(local);
+            TraceLoggingWriteStart(
+                local, "CpuFence_Wait", TLPArg(this, "Fence"), TLArg("Device", "WaitType"), TLArg(value, "Value"));
+
+            m_queue->submitWait(m_timeline, value);
+
+            TraceLoggingWriteStop(local, "CpuFence_Wait");
+        }
+
+        void waitOnCpu(uint64_t value) override {
+            TraceLocalActivity(local);
+            TraceLoggingWriteStart(
+                local, "CpuFence_Wait", TLPArg(this, "Fence"), TLArg("Host", "WaitType"), TLArg(value, "Value"));
+
+            // Like the D3D implementations, signal the value once the pending commands complete, then wait for it.
+            signal(value);
+            m_timeline->waitOnCpu(value);
+
+            TraceLoggingWriteStop(local, "CpuFence_Wait");
+        }
+
+        bool isShareable() const override {
+            return m_isShareable;
+        }
+
+        const std::shared_ptr<CpuQueue> m_queue;
+        const std::shared_ptr<CpuTimeline> m_timeline;
+        const bool m_isShareable;
+    };
+
+    struct CpuTexture : IGraphicsTexture {
+        CpuTexture(std::shared_ptr<CpuTextureMemory> memory, const XrSwapchainCreateInfo& info, bool shareable)
+            : m_memory(memory), m_info(info), m_isShareable(shareable) {
+            TraceLocalActivity(local);
+            TraceLoggingWriteStart(local,
+                                   "CpuTexture_Create",
+                                   TLPArg(memory->data, "Data"),
+                                   TLArg(memory->size, "Size"),
+                                   TLArg(info.width, "Width"),
+                                   TLArg(info.height, "Height"),
+                                   TLArg(info.arraySize, "ArraySize"),
+                                   TLArg(info.mipCount, "MipCount"),
+                                   TLArg(info.sampleCount, "SampleCount"),
+                                   TLArg(info.format, "Format"));
+
+            m_info.type = XR_TYPE_UNKNOWN;
+            m_info.next = nullptr;
+
+            TraceLoggingWriteStop(
+                local, "CpuTexture_Create", TLPArg(this, "Texture"), TLArg(m_isShareable, "Shareable"));
+        }
+
+        ~CpuTexture() override {
+            TraceLocalActivity(local);
+            TraceLoggingWriteStart(local, "CpuTexture_Destroy", TLPArg(this, "Texture"));
+            TraceLoggingWriteStop(local, "CpuTexture_Destroy");
+        }
+
+        Api getApi() const override {
+            return Api::CPU;
+        }
+
+        void* getNativeTexturePtr() const override {
+            return m_memory->data;
+        }
+
+        ShareableHandle getTextureHandle() const override {
+            TraceLocalActivity(local);
+            TraceLoggingWriteStart(local, "CpuTexture_Export", TLPArg(this, "Texture"));
+
+            if (!m_isShareable) {
+                throw std::runtime_error("Texture is not shareable");
+            }
+
+            ShareableHandle handle{};
+            handle.handle = m_memory.get();
+            handle.origin = Api::CPU;
+
+            TraceLoggingWriteStop(local, "CpuTexture_Export", TLPArg(handle.handle, "Handle"));
+
+            return handle;
+        }
+
+        const XrSwapchainCreateInfo& getInfo() const override {
+            return m_info;
+        }
+
+        bool isShareable() const override {
+            return m_isShareable;
+        }
+
+        const std::shared_ptr<CpuTextureMemory> m_memory;
+
+        XrSwapchainCreateInfo m_info;
+        const bool m_isShareable;
+    };
+
+    struct CpuGraphicsDevice : IGraphicsDevice {
+        CpuGraphicsDevice() : m_queue(std::make_shared<CpuQueue>()) {
+            TraceLocalActivity(local);
+            TraceLoggingWriteStart(local, "CpuGraphicsDevice_Create");
+            TraceLoggingWriteStop(local, "CpuGraphicsDevice_Create", TLPArg(this, "Device"));
+        }
+
+        ~CpuGraphicsDevice() override {
+            TraceLocalActivity(local);
+            TraceLoggingWriteStart(local, "CpuGraphicsDevice_Destroy", TLPArg(this, "Device"));
+            TraceLoggingWriteStop(local, "CpuGraphicsDevice_Destroy");
+        }
+
+        Api getApi() const override {
+            return Api::CPU;
+        }
+
+        void* getNativeDevicePtr() const override {
+            return const_cast<CpuGraphicsDevice*>(this);
+        }
+
+        void* getNativeContextPtr() const override {
+            return m_queue.get();
+        }
+
+        std::shared_ptr<IGraphicsTimer> createTimer() override {
+            return std::make_shared<CpuTimer>(m_queue);
+        }
+
+        std::shared_ptr<IGraphicsFence> createFence(bool shareable) override {
+            return std::make_shared<CpuFence>(m_queue, std::make_shared<CpuTimeline>(), shareable);
+        }
+
+        std::shared_ptr<IGraphicsFence> openFence(const ShareableHandle& handle) override {
+            TraceLocalActivity(local);
+            TraceLoggingWriteStart(local, "CpuFence_Import", TLPArg(handle.handle, "Handle"));
+
+            if (handle.origin != Api::CPU || !handle.handle) {
+                throw std::runtime_error("Not a CPU fence");
+            }
+
+            // The timeline is owned by the exporting fence, which must outlive the import (like an NT handle would).
+            std::shared_ptr<IGraphicsFence> result = std::make_shared<CpuFence>(
+                m_queue, reinterpret_cast<CpuTimeline*>(handle.handle)->shared_from_this(), false /* shareable */);
+
+            TraceLoggingWriteStop(local, "CpuFence_Import", TLPArg(result.get(), "Fence"));
+
+            return result;
+        }
+
+        std::shared_ptr<IGraphicsTexture> createTexture(const XrSwapchainCreateInfo& info, bool shareable) override {
+            return std::make_shared<CpuTexture>(
+                std::make_shared<CpuTextureMemory>(getTextureSize(info)), info, shareable);
+        }
+
+        std::shared_ptr<IGraphicsTexture> openTexture(const ShareableHandle& handle,
+                                                      const XrSwapchainCreateInfo& info) override {
+            TraceLocalActivity(local);
+            TraceLoggingWriteStart(local, "CpuTexture_Import", TLPArg(handle.handle, "Handle"));
+
+            if (handle.origin != Api::CPU || !handle.handle) {
+                throw std::runtime_error("Not a CPU texture");
+            }
+
+            std::shared_ptr<CpuTextureMemory> memory =
+                reinterpret_cast<CpuTextureMemory*>(handle.handle)->shared_from_this();
+            if (memory->size != getTextureSize(info)) {
+                throw std::runtime_error("Texture size mismatch");
+            }
+            std::shared_ptr<IGraphicsTexture> result =
+                std::make_shared<CpuTexture>(std::move(memory), info, false /* shareable */);
+
+            TraceLoggingWriteStop(local, "CpuTexture_Import", TLPArg(result.get(), "Texture"));
+
+            return result;
+        }
+
+        std::shared_ptr<IGraphicsTexture> openTexturePtr(void* nativeTexturePtr,
+                                                         const XrSwapchainCreateInfo& info) override {
+            TraceLocalActivity(local);
+            TraceLoggingWriteStart(local, "CpuTexture_Import", TLPArg(nativeTexturePtr, "Data"));
+
+            // The caller keeps ownership of the memory.
+            std::shared_ptr<IGraphicsTexture> result = std::make_shared<CpuTexture>(
+                std::make_shared<CpuTextureMemory>(reinterpret_cast<uint8_t*>(nativeTexturePtr), getTextureSize(info)),
+                info,
+                false /* shareable */);
+
+            TraceLoggingWriteStop(local, "CpuTexture_Import", TLPArg(result.get(), "Texture"));
+
+            return result;
+        }
+
+        void copyTexture(IGraphicsTexture* from, IGraphicsTexture* to) override {
+            TraceLocalActivity(local);
+            TraceLoggingWriteStart(local, "CpuTexture_Copy", TLPArg(from, "Source"), TLPArg(to, "Destination"));
+
+            const CpuTexture* const source = dynamic_cast<const CpuTexture*>(from);
+            const CpuTexture* const destination = dynamic_cast<const CpuTexture*>(to);
+            if (!source || !destination) {
+                throw std::runtime_error("Api mismatch");
+            }
+            if (source->m_memory->size != destination->m_memory->size) {
+                throw std::runtime_error("Texture size mismatch");
+            }
+
+            m_queue->submit([source = source->m_memory, destination = destination->m_memory] {
+                memcpy(destination->data, source->data, destination->size);
+            });
+
+            TraceLoggingWriteStop(local, "CpuTexture_Copy");
+        }
+
+        void blitTexture(IGraphicsTexture* from,
+                         const XrRect2Di& fromRect,
+                         uint32_t fromSlice,
+                         IGraphicsTexture* to,
+                         const XrRect2Di& toRect,
+                         uint32_t toSlice) override {
+            TraceLocalActivity(local);
+            TraceLoggingWriteStart(local,
+                                   "CpuTexture_Blit",
+                                   TLPArg(from, "Source"),
+                                   TLArg(xr::ToString(fromRect).c_str(), "SourceRect"),
+                                   TLArg(fromSlice, "SourceSlice"),
+                                   TLPArg(to, "Destination"),
+                                   TLArg(xr::ToString(toRect).c_str(), "DestinationRect"),
+                                   TLArg(toSlice, "DestinationSlice"));
+
+            const CpuTexture* const source = dynamic_cast<const CpuTexture*>(from);
+            const CpuTexture* const destination = dynamic_cast<const CpuTexture*>(to);
+            if (!source || !destination) {
+                throw std::runtime_error("Api mismatch");
+            }
+            const XrSwapchainCreateInfo& sourceInfo = source->getInfo();
+            const XrSwapchainCreateInfo& destinationInfo = destination->getInfo();
+            if (getBytesPerPixel((DXGI_FORMAT)sourceInfo.format) != 4 ||
+                getBytesPerPixel((DXGI_FORMAT)destinationInfo.format) != 4 ||
+                sourceInfo.format == DXGI_FORMAT_R10G10B10A2_UNORM ||
+                sourceInfo.format == DXGI_FORMAT_R11G11B10_FLOAT || sourceInfo.format == DXGI_FORMAT_R32_FLOAT) {
+                throw std::runtime_error("Unsupported blit format");
+            }
+            if (fromRect.offset.x < 0 || fromRect.offset.y < 0 || fromRect.extent.width <= 0 ||
+                fromRect.extent.height <= 0 || fromRect.offset.x + fromRect.extent.width > (int32_t)sourceInfo.width ||
+                fromRect.offset.y + fromRect.extent.height > (int32_t)sourceInfo.height || toRect.offset.x < 0 ||
+                toRect.offset.y < 0 || toRect.offset.x + toRect.extent.width > (int32_t)destinationInfo.width ||
+                toRect.offset.y + toRect.extent.height > (int32_t)destinationInfo.height ||
+                fromSlice >= std::max(sourceInfo.arraySize, 1u) ||
+                toSlice >= std::max(destinationInfo.arraySize, 1u)) {
+                throw std::runtime_error("Blit region out of bounds");
+            }
+
+            m_queue->submit([source = source->m_memory,
+                             sourceOffset = getSliceOffset(sourceInfo, fromSlice),
+                             sourceRowPitch = sourceInfo.width * 4,
+                             fromRect,
+                             destination = destination->m_memory,
+                             destinationOffset = getSliceOffset(destinationInfo, toSlice),
+                             destinationRowPitch = destinationInfo.width * 4,
+                             toRect] {
+                blitTexels(source->data + sourceOffset,
+                           sourceRowPitch,
+                           fromRect,
+                           destination->data + destinationOffset,
+                           destinationRowPitch,
+                           toRect);
+            });
+
+            TraceLoggingWriteStop(local, "CpuTexture_Blit");
+        }
+
+        GenericFormat translateToGenericFormat(int64_t format) const override {
+            return (DXGI_FORMAT)format;
+        }
+
+        int64_t translateFromGenericFormat(GenericFormat format) const override {
+            return (int64_t)format;
+        }
+
+        LUID getAdapterLuid() const override {
+            return {};
+        }
+
+        const std::shared_ptr<CpuQueue> m_queue;
+    };
+
+} // namespace
+
+namespace openxr_api_layer::utils::graphics::internal {
+
+    std::shared_ptr<IGraphicsDevice> createCpuGraphicsDevice() {
+        return std::make_shared<CpuGraphicsDevice>();
+    }
+
+} // namespace openxr_api_layer::utils::graphics::internal
+
+#endif
@@ -26,9 +26,11 @@
 
 #include "log.h"
 #include "graphics.h"
+#include "util.h"
 
 #pragma comment(lib, "dxgi.lib")
 #pragma comment(lib, "d3d11.lib")
+#pragma comment(lib, "d3dcompiler.lib")
 
 namespace {
 
@@ -37,6 +39,56 @@ namespace {
 
     constexpr bool PreferNtHandle = false;
 
+    // Draw a triangle covering the viewport, and sample the source region of the texture with the UVs of the viewport.
+    // The sampling coordinates are clamped half a texel inside the source region, so that the bilinear filter never
+    // reads outside of it.
+    const std::string_view BlitShaders = R"_(
+cbuffer BlitConstants : register(b0) {
+    float4 SourceRect;
+    float4 SourceClamp;
+};
+Texture2DArray Source : register(t0);
+SamplerState LinearSampler : register(s0);
+
+void vsMain(uint id : SV_VertexID, out float4 position : SV_Position, out float2 uv : TEXCOORD0) {
+    uv = float2((id << 1) & 2, id & 2);
+    position = float4(uv * float2(2, -2) + float2(-1, 1), 0, 1);
+}
+
+float4 psMain(float4 position : SV_Position, float2 uv : TEXCOORD0) : SV_Target {
+    const float2 sourceUv = clamp(SourceRect.xy + uv * SourceRect.zw, SourceClamp.xy, SourceClamp.zw);
+    return Source.SampleLevel(LinearSampler, float3(sourceUv, 0), 0);
+}
+)_";
+
+    struct BlitConstants {
+        float sourceRect[4];
+        float sourceClamp[4];
+    };
+
+    ComPtr<ID3DBlob> compileShader(const std::string_view& source, const char* entryPoint, const char* target) {
+        ComPtr<ID3DBlob> shaderBytes;
+        ComPtr<ID3DBlob> errors;
+        const HRESULT hr = D3DCompile(source.data(),
+                                      source.size(),
+                                      nullptr,
+                                      nullptr,
+                                      nullptr,
+                                      entryPoint,
+                                      target,
+                                      D3DCOMPILE_OPTIMIZATION_LEVEL3,
+                                      0,
+                                      shaderBytes.ReleaseAndGetAddressOf(),
+                                      errors.ReleaseAndGetAddressOf());
+        if (FAILED(hr)) {
+            if (errors) {
+                ErrorLog("%s\n", (const char*)errors->GetBufferPointer());
+            }
+            CHECK_HRCMD(hr);
+        }
+        return shaderBytes;
+    }
+
     struct D3D11Timer : IGraphicsTimer {
         D3D11Timer(ID3D11Device* device) {
             TraceLocalActivity(local);
@@ -214,7 +266,7 @@ namespace {
     };
 
     struct D3D11Texture : IGraphicsTexture {
-        D3D11Texture(ID3D11Texture2D* texture) : m_texture(texture) {
+        D3D11Texture(ID3D11Texture2D* texture, const XrSwapchainCreateInfo* info = nullptr) : m_texture(texture) {
             TraceLocalActivity(local);
             TraceLoggingWriteStart(local, "D3D11Texture_Create", TLPArg(texture, "D3D11Texture"));
 
@@ -233,8 +285,9 @@ namespace {
                                     TLArg(desc.CPUAccessFlags, "CPUAccessFlags"),
                                     TLArg(desc.MiscFlags, "MiscFlags"));
 
-            // Construct the API-agnostic info descriptor.
-            m_info.format = (int64_t)desc.Format;
+            // Construct the API-agnostic info descriptor. Swapchain images are often typeless: keep the format of the
+            // swapchain, which is the one to use for views.
+            m_info.format = info ? info->format : (int64_t)desc.Format;
             m_info.width = desc.Width;
             m_info.height = desc.Height;
             m_info.arraySize = desc.ArraySize;
@@ -317,11 +370,50 @@ namespace {
             return m_isShareable;
         }
 
+        // Views are created upon first use and kept with the texture.
+        ID3D11ShaderResourceView* getShaderResourceView(ID3D11Device* device, uint32_t slice) {
+            if (m_shaderResourceViews.size() <= slice) {
+                m_shaderResourceViews.resize(slice + 1);
+            }
+            if (!m_shaderResourceViews[slice]) {
+                D3D11_SHADER_RESOURCE_VIEW_DESC desc{};
+                desc.Format = (DXGI_FORMAT)m_info.format;
+                desc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
+                desc.Texture2DArray.MostDetailedMip = 0;
+                desc.Texture2DArray.MipLevels = 1;
+                desc.Texture2DArray.FirstArraySlice = slice;
+                desc.Texture2DArray.ArraySize = 1;
+                CHECK_HRCMD(device->CreateShaderResourceView(
+                    m_texture.Get(), &desc, m_shaderResourceViews[slice].ReleaseAndGetAddressOf()));
+            }
+            return m_shaderResourceViews[slice].Get();
+        }
+
+        ID3D11RenderTargetView* getRenderTargetView(ID3D11Device* device, uint32_t slice) {
+            if (m_renderTargetViews.size() <= slice) {
+                m_renderTargetViews.resize(slice + 1);
+            }
+            if (!m_renderTargetViews[slice]) {
+                D3D11_RENDER_TARGET_VIEW_DESC desc{};
+                desc.Format = (DXGI_FORMAT)m_info.format;
+                desc.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE2DARRAY;
+                desc.Texture2DArray.MipSlice = 0;
+                desc.Texture2DArray.FirstArraySlice = slice;
+                desc.Texture2DArray.ArraySize = 1;
+                CHECK_HRCMD(device->CreateRenderTargetView(
+                    m_texture.Get(), &desc, m_renderTargetViews[slice].ReleaseAndGetAddressOf()));
+            }
+            return m_renderTargetViews[slice].Get();
+        }
+
         const ComPtr<ID3D11Texture2D> m_texture;
 
         XrSwapchainCreateInfo m_info{};
         bool m_isShareable{false};
         bool m_useNtHandle{false};
+
+        std::vector<ComPtr<ID3D11ShaderResourceView>> m_shaderResourceViews;
+        std::vector<ComPtr<ID3D11RenderTargetView>> m_renderTargetViews;
     };
 
     struct D3D11GraphicsDevice : IGraphicsDevice {
@@ -453,7 +545,7 @@ namespace {
                     handle.ntHandle.get(), IID_PPV_ARGS(texture.ReleaseAndGetAddressOf())));
             }
 
-            std::shared_ptr<IGraphicsTexture> result = std::make_shared<D3D11Texture>(texture.Get());
+            std::shared_ptr<IGraphicsTexture> result = std::make_shared<D3D11Texture>(texture.Get(), &info);
 
             TraceLoggingWriteStop(local, "D3D11Texture_Import", TLPArg(result.get(), "Texture"));
 
@@ -467,7 +559,7 @@ namespace {
 
             ID3D11Texture2D* texture = reinterpret_cast<ID3D11Texture2D*>(nativeTexturePtr);
 
-            std::shared_ptr<IGraphicsTexture> result = std::make_shared<D3D11Texture>(texture);
+            std::shared_ptr<IGraphicsTexture> result = std::make_shared<D3D11Texture>(texture, &info);
 
             TraceLoggingWriteStop(local, "D3D11Texture_Import", TLPArg(result.get(), "Texture"));
 
@@ -483,6 +575,107 @@ namespace {
             TraceLoggingWriteStop(local, "D3D11Texture_Copy");
         }
 
+        void blitTexture(IGraphicsTexture* from,
+                         const XrRect2Di& fromRect,
+                         uint32_t fromSlice,
+                         IGraphicsTexture* to,
+                         const XrRect2Di& toRect,
+                         uint32_t toSlice) override {
+            TraceLocalActivity(local);
+            TraceLoggingWriteStart(local,
+                                   "D3D11Texture_Blit",
+                                   TLPArg(from, "Source"),
+                                   TLArg(xr::ToString(fromRect).c_str(), "SourceRect"),
+                                   TLArg(fromSlice, "SourceSlice"),
+                                   TLPArg(to, "Destination"),
+                                   TLArg(xr::ToString(toRect).c_str(), "DestinationRect"),
+                                   TLArg(toSlice, "DestinationSlice"));
+
+            if (!m_blitVertexShader) {
+                initializeBlit();
+            }
+
+            D3D11Texture* const source = dynamic_cast<D3D11Texture*>(from);
+            D3D11Texture* const destination = dynamic_cast<D3D11Texture*>(to);
+            if (!source || !destination) {
+                throw std::runtime_error("Api mismatch");
+            }
+
+            {
+                const float width = (float)source->getInfo().width;
+                const float height = (float)source->getInfo().height;
+                D3D11_MAPPED_SUBRESOURCE mappedResource;
+                CHECK_HRCMD(m_context->Map(m_blitConstants.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource));
+                BlitConstants* const constants = reinterpret_cast<BlitConstants*>(mappedResource.pData);
+                constants->sourceRect[0] = fromRect.offset.x / width;
+                constants->sourceRect[1] = fromRect.offset.y / height;
+                constants->sourceRect[2] = fromRect.extent.width / width;
+                constants->sourceRect[3] = fromRect.extent.height / height;
+                constants->sourceClamp[0] = (fromRect.offset.x + 0.5f) / width;
+                constants->sourceClamp[1] = (fromRect.offset.y + 0.5f) / height;
+                constants->sourceClamp[2] = (fromRect.offset.x + fromRect.extent.width - 0.5f) / width;
+                constants->sourceClamp[3] = (fromRect.offset.y + fromRect.extent.height - 0.5f) / height;
+                m_context->Unmap(m_blitConstants.Get(), 0);
+            }
+
+            ID3D11RenderTargetView* const renderTargetView =
+                destination->getRenderTargetView(m_device.Get(), toSlice);
+            ID3D11ShaderResourceView* const shaderResourceView =
+                source->getShaderResourceView(m_device.Get(), fromSlice);
+
+            D3D11_VIEWPORT viewport{};
+            viewport.TopLeftX = (float)toRect.offset.x;
+            viewport.TopLeftY = (float)toRect.offset.y;
+            viewport.Width = (float)toRect.extent.width;
+            viewport.Height = (float)toRect.extent.height;
+            viewport.MaxDepth = 1.f;
+
+            m_context->ClearState();
+            m_context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+            m_context->VSSetShader(m_blitVertexShader.Get(), nullptr, 0);
+            m_context->PSSetShader(m_blitPixelShader.Get(), nullptr, 0);
+            m_context->PSSetConstantBuffers(0, 1, m_blitConstants.GetAddressOf());
+            m_context->PSSetSamplers(0, 1, m_linearClampSampler.GetAddressOf());
+            m_context->PSSetShaderResources(0, 1, &shaderResourceView);
+            m_context->OMSetRenderTargets(1, &renderTargetView, nullptr);
+            m_context->RSSetViewports(1, &viewport);
+            m_context->Draw(3, 0);
+
+            // Unbind the views, since the textures are often used as a source and a destination in turn.
+            ID3D11ShaderResourceView* const nullShaderResourceView = nullptr;
+            m_context->PSSetShaderResources(0, 1, &nullShaderResourceView);
+            m_context->OMSetRenderTargets(0, nullptr, nullptr);
+
+            TraceLoggingWriteStop(local, "D3D11Texture_Blit");
+        }
+
+        void initializeBlit() {
+            const ComPtr<ID3DBlob> vertexShaderBytes = compileShader(BlitShaders, "vsMain", "vs_5_0");
+            CHECK_HRCMD(m_device->CreateVertexShader(vertexShaderBytes->GetBufferPointer(),
+                                                     vertexShaderBytes->GetBufferSize(),
+                                                     nullptr,
+                                                     m_blitVertexShader.ReleaseAndGetAddressOf()));
+            const ComPtr<ID3DBlob> pixelShaderBytes = compileShader(BlitShaders, "psMain", "ps_5_0");
+            CHECK_HRCMD(m_device->CreatePixelShader(pixelShaderBytes->GetBufferPointer(),
+                                                    pixelShaderBytes->GetBufferSize(),
+                                                    nullptr,
+                                                    m_blitPixelShader.ReleaseAndGetAddressOf()));
+
+            D3D11_BUFFER_DESC bufferDesc{};
+            bufferDesc.ByteWidth = sizeof(BlitConstants);
+            bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+            bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+            bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+            CHECK_HRCMD(m_device->CreateBuffer(&bufferDesc, nullptr, m_blitConstants.ReleaseAndGetAddressOf()));
+
+            D3D11_SAMPLER_DESC samplerDesc{};
+            samplerDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+            samplerDesc.AddressU = samplerDesc.AddressV = samplerDesc.AddressW = D3D11_TEXTURE_ADDRESS_CLAMP;
+            samplerDesc.ComparisonFunc = D3D11_COMPARISON_NEVER;
+            samplerDesc.MaxLOD = D3D11_FLOAT32_MAX;
+            CHECK_HRCMD(m_device->CreateSamplerState(&samplerDesc, m_linearClampSampler.ReleaseAndGetAddressOf()));
+        }
+
         GenericFormat translateToGenericFormat(int64_t format) const override {
             return (DXGI_FORMAT)format;
         }
@@ -500,6 +693,11 @@ namespace {
 
         ComPtr<ID3D11Device5> m_deviceForFencesAndNtHandles;
         ComPtr<ID3D11DeviceContext> m_context;
+
+        ComPtr<ID3D11VertexShader> m_blitVertexShader;
+        ComPtr<ID3D11PixelShader> m_blitPixelShader;
+        ComPtr<ID3D11Buffer> m_blitConstants;
+        ComPtr<ID3D11SamplerState> m_linearClampSampler;
     };
 
 } // namespace
@@ -528,6 +528,16 @@ namespace {
             TraceLoggingWriteStop(local, "D3D12Texture_Copy");
         }
 
+        void blitTexture(IGraphicsTexture* from,
+                         const XrRect2Di& fromRect,
+                         uint32_t fromSlice,
+                         IGraphicsTexture* to,
+                         const XrRect2Di& toRect,
+                         uint32_t toSlice) override {
+            // D3D12 is only used on the application side, where the layer never draws.
+            throw std::runtime_error("Blit is not supported on D3D12 devices");
+        }
+
         GenericFormat translateToGenericFormat(int64_t format) const override {
             return (DXGI_FORMAT)format;
         }
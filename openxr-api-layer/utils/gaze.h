@@ -0,0 +1,224 @@
+// MIT License
+//
+// Copyright(c) 2022-2023 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "vectormath.h"
+
+// The batched kernels use 8 lanes when the processor supports AVX2 (see gaze_avx2.cpp). MSVC allows to build that one
+// file for AVX2 and to pick it at runtime.
+#if defined(VECTORMATH_SSE2) && defined(_MSC_VER)
+#define GAZE_AVX2
+#include <intrin.h>
+#endif
+
+// The per-frame gaze math used by the trackers and the layer. Kept together so that each kernel can be measured and
+// optimized in isolation.
+namespace openxr_api_layer::utils::gaze {
+
+    // Computed in double precision, then rounded once.
+    static inline float degreesToRadians(float degrees) {
+        return static_cast<float>(degrees * M_PI / 180.0);
+    }
+
+    // Unit vector for a direction given by its horizontal angle (positive to the right) and its vertical angle
+    // (positive upward), in radians. Forward is -Z.
+    static inline XrVector3f directionFromAngles(float horizontal, float vertical) {
+        return {
+            std::sin(horizontal) * std::cos(vertical),
+            std::sin(vertical),
+            -std::cos(horizontal) * std::cos(vertical),
+        };
+    }
+
+    // Average (not re-normalized) of the directions of both eyes.
+    static inline XrVector3f averageDirections(const XrVector3f& left, const XrVector3f& right) {
+        return {
+            (left.x + right.x) / 2.f,
+            (left.y + right.y) / 2.f,
+            (left.z + right.z) / 2.f,
+        };
+    }
+
+    // Gaze direction from the poses of both eyes: the point 1 meter ahead of the average pose.
+    static inline XrVector3f directionFromEyePoses(const XrPosef& left, const XrPosef& right) {
+        namespace vm = vectormath;
+
+        const vm::Pose gaze = vm::slerpPoses(vm::load(left), vm::load(right), 0.5f);
+        const vm::Vector gazeProjectedPoint = vm::transformPoint(gaze, vm::set(0.f, 0.f, -1.f));
+
+        return vm::storeVector3(vm::normalize3(gazeProjectedPoint));
+    }
+
+    // Projection of a direction (relative to a view, forward is -Z) onto the image plane of the view, in normalized
+    // device coordinates: (-1, -1) at the bottom left corner of the field of view and (1, 1) at its top right corner.
+    // The result is not clamped to the field of view. Returns false for directions that are not in front of the view.
+    static inline bool projectToView(const XrVector3f& direction, const XrFovf& fov, XrVector2f& ndc) {
+        if (!(direction.z < 0.f)) {
+            return false;
+        }
+
+        const float tanLeft = std::tan(fov.angleLeft);
+        const float tanRight = std::tan(fov.angleRight);
+        const float tanUp = std::tan(fov.angleUp);
+        const float tanDown = std::tan(fov.angleDown);
+        if (!(tanRight > tanLeft) || !(tanUp > tanDown)) {
+            return false;
+        }
+
+        // Same mapping as the off-center projection matrix built from the field of view.
+        const float tanX = direction.x / -direction.z;
+        const float tanY = direction.y / -direction.z;
+        ndc.x = (2.f * tanX - (tanRight + tanLeft)) / (tanRight - tanLeft);
+        ndc.y = (2.f * tanY - (tanUp + tanDown)) / (tanUp - tanDown);
+
+        return true;
+    }
+
+    // Field of view of a focus view covering the given fractions of the tangent extents of a field of view, centered on
+    // a point in normalized device coordinates (see projectToView()). The focus view is moved back inside the field of
+    // view when the point is too close to its edges.
+    static inline XrFovf
+    focusFov(const XrFovf& fov, const XrVector2f& center, float widthFraction, float heightFraction) {
+        const float tanLeft = std::tan(fov.angleLeft);
+        const float tanRight = std::tan(fov.angleRight);
+        const float tanUp = std::tan(fov.angleUp);
+        const float tanDown = std::tan(fov.angleDown);
+
+        // A fraction of the extent is the half-size of the focus view in normalized device coordinates.
+        const float centerX = std::clamp(center.x, widthFraction - 1.f, 1.f - widthFraction);
+        const float centerY = std::clamp(center.y, heightFraction - 1.f, 1.f - heightFraction);
+
+        // Inverse of the mapping in projectToView().
+        const auto toTanX = [&](float ndc) { return (ndc * (tanRight - tanLeft) + (tanRight + tanLeft)) / 2.f; };
+        const auto toTanY = [&](float ndc) { return (ndc * (tanUp - tanDown) + (tanUp + tanDown)) / 2.f; };
+
+        return {
+            std::atan(toTanX(centerX - widthFraction)),
+            std::atan(toTanX(centerX + widthFraction)),
+            std::atan(toTanY(centerY + heightFraction)),
+            std::atan(toTanY(centerY - heightFraction)),
+        };
+    }
+
+    // Orientation of the gaze pose relative to the view space: the shortest-arc rotation taking the forward axis onto
+    // the gaze direction, which does not need to be normalized. For a direction d = (x, y, z), this is the quaternion
+    // ((0, 0, -1) x d, |d| + (0, 0, -1) . d) = (y, -x, 0, |d| - z) once normalized. The W component only loses
+    // precision for directions pointing behind the viewer.
+    static inline XrQuaternionf orientationFromDirection(const XrVector3f& direction) {
+        namespace vm = vectormath;
+
+        const float w = vm::length3(vm::load(direction)) - direction.z;
+        if (!(w > 0.f)) {
+            // Null direction, or looking straight backward where any half-turn is valid.
+            return direction.z > 0.f ? XrQuaternionf{0.f, 1.f, 0.f, 0.f} : XrQuaternionf{0.f, 0.f, 0.f, 1.f};
+        }
+
+        return vm::storeQuaternion(vm::normalize4(vm::set(direction.y, -direction.x, 0.f, w)));
+    }
+
+    namespace detail {
+
+        // Four directions per iteration, one per lane, with the same operations as orientationFromDirection(). The
+        // count must be a multiple of 4, and the degenerate directions (W not positive) must be fixed by the caller.
+        static inline void orientationsFromDirections4(const XrVector3f* directions,
+                                                       XrQuaternionf* orientations,
+                                                       size_t count) {
+            namespace vm = vectormath;
+
+            for (size_t i = 0; i < count; i += 4) {
+                const XrVector3f* const d = directions + i;
+                const vm::Vector x = vm::set(d[0].x, d[1].x, d[2].x, d[3].x);
+                const vm::Vector y = vm::set(d[0].y, d[1].y, d[2].y, d[3].y);
+                const vm::Vector z = vm::set(d[0].z, d[1].z, d[2].z, d[3].z);
+
+                const vm::Vector xx = vm::multiply(x, x);
+                const vm::Vector yy = vm::multiply(y, y);
+                const vm::Vector length = vm::squareRoot(vm::add(vm::add(xx, yy), vm::multiply(z, z)));
+                const vm::Vector w = vm::subtract(length, z);
+                const vm::Vector norm = vm::squareRoot(vm::add(vm::add(yy, xx), vm::multiply(w, w)));
+
+                const vm::Vector qx = vm::divide(y, norm);
+                const vm::Vector qy = vm::negate(vm::divide(x, norm));
+                const vm::Vector qw = vm::divide(w, norm);
+                orientations[i + 0] = {vm::getX(qx), vm::getX(qy), 0.f, vm::getX(qw)};
+                orientations[i + 1] = {vm::getY(qx), vm::getY(qy), 0.f, vm::getY(qw)};
+                orientations[i + 2] = {vm::getZ(qx), vm::getZ(qy), 0.f, vm::getZ(qw)};
+                orientations[i + 3] = {vm::getW(qx), vm::getW(qy), 0.f, vm::getW(qw)};
+            }
+        }
+
+#if defined(GAZE_AVX2)
+        // Same as orientationsFromDirections4(), with eight lanes. The count must be a multiple of 8. Only call when
+        // isAVX2Supported().
+        void orientationsFromDirections8(const XrVector3f* directions, XrQuaternionf* orientations, size_t count);
+
+        static inline bool isAVX2Supported() {
+            static const bool isSupported = [] {
+                int info[4];
+                __cpuid(info, 0);
+                if (info[0] < 7) {
+                    return false;
+                }
+
+                // The OS must save the YMM registers (OSXSAVE and AVX, then XCR0).
+                __cpuid(info, 1);
+                const bool hasAvx = (info[2] & (1 << 27)) && (info[2] & (1 << 28));
+                if (!hasAvx || (_xgetbv(0) & 0x6) != 0x6) {
+                    return false;
+                }
+
+                __cpuidex(info, 7, 0);
+                return (info[1] & (1 << 5)) != 0;
+            }();
+            return isSupported;
+        }
+#endif
+
+    } // namespace detail
+
+    // Batched form of orientationFromDirection(), for locating several gaze spaces at once, with identical results.
+    static inline void orientationsFromDirections(const XrVector3f* directions,
+                                                  XrQuaternionf* orientations,
+                                                  size_t count) {
+        size_t i = 0;
+#if defined(GAZE_AVX2)
+        if (count >= 8 && detail::isAVX2Supported()) {
+            i = count / 8 * 8;
+            detail::orientationsFromDirections8(directions, orientations, i);
+        }
+#endif
+        const size_t batched = i + (count - i) / 4 * 4;
+        detail::orientationsFromDirections4(directions + i, orientations + i, batched - i);
+
+        // Take the slow path for the degenerate directions, and for the remainder.
+        for (i = 0; i < batched; i++) {
+            if (!(orientations[i].w > 0.f)) {
+                orientations[i] = orientationFromDirection(directions[i]);
+            }
+        }
+        for (; i < count; i++) {
+            orientations[i] = orientationFromDirection(directions[i]);
+        }
+    }
+
+} // namespace openxr_api_layer::utils::gaze
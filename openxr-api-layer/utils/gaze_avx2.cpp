@@ -0,0 +1,65 @@
+// MIT License
+//
+// Copyright(c) 2022-2023 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Built with /arch:AVX2 and without the precompiled header, which is built without it. Nothing in this file may run
+// before checking that the processor supports AVX2 (see gaze::detail::isAVX2Supported()).
+
+#include <algorithm>
+#define _USE_MATH_DEFINES
+#include <cmath>
+#include <immintrin.h>
+
+#define XR_NO_PROTOTYPES
+#include <openxr/openxr.h>
+
+#include "gaze.h"
+
+namespace openxr_api_layer::utils::gaze::detail {
+
+    void orientationsFromDirections8(const XrVector3f* directions, XrQuaternionf* orientations, size_t count) {
+        for (size_t i = 0; i < count; i += 8) {
+            const XrVector3f* const d = directions + i;
+            const __m256 x = _mm256_setr_ps(d[0].x, d[1].x, d[2].x, d[3].x, d[4].x, d[5].x, d[6].x, d[7].x);
+            const __m256 y = _mm256_setr_ps(d[0].y, d[1].y, d[2].y, d[3].y, d[4].y, d[5].y, d[6].y, d[7].y);
+            const __m256 z = _mm256_setr_ps(d[0].z, d[1].z, d[2].z, d[3].z, d[4].z, d[5].z, d[6].z, d[7].z);
+
+            // Same operations, in the same order, as orientationsFromDirections4(). No multiply-add, which would
+            // round differently.
+            const __m256 xx = _mm256_mul_ps(x, x);
+            const __m256 yy = _mm256_mul_ps(y, y);
+            const __m256 length = _mm256_sqrt_ps(_mm256_add_ps(_mm256_add_ps(xx, yy), _mm256_mul_ps(z, z)));
+            const __m256 w = _mm256_sub_ps(length, z);
+            const __m256 norm = _mm256_sqrt_ps(_mm256_add_ps(_mm256_add_ps(yy, xx), _mm256_mul_ps(w, w)));
+
+            alignas(32) float qx[8];
+            alignas(32) float qy[8];
+            alignas(32) float qw[8];
+            _mm256_store_ps(qx, _mm256_div_ps(y, norm));
+            _mm256_store_ps(qy, _mm256_xor_ps(_mm256_div_ps(x, norm), _mm256_set1_ps(-0.f)));
+            _mm256_store_ps(qw, _mm256_div_ps(w, norm));
+            for (size_t j = 0; j < 8; j++) {
+                orientations[i + j] = {qx[j], qy[j], 0.f, qw[j]};
+            }
+        }
+    }
+
+} // namespace openxr_api_layer::utils::gaze::detail
@@ -22,12 +22,18 @@
 
 #include "pch.h"
 
+#include <avrt.h>
+
 #include "general.h"
+#include "hittest.h"
+#include "log.h"
+#include "vectormath.h"
 
 namespace {
 
+    using namespace openxr_api_layer::log;
     using namespace openxr_api_layer::utils;
-    using namespace DirectX;
+    namespace vm = openxr_api_layer::utils::vectormath;
 
     class CpuTimer : public general::ITimer {
         using clock = std::chrono::high_resolution_clock;
@@ -52,37 +58,85 @@ namespace {
         mutable clock::duration m_duration{0};
     };
 
-    // Taken from
-    // https://github.com/microsoft/OpenXR-MixedReality/blob/main/samples/SceneUnderstandingUwp/Scene_Placement.cpp
-    bool XM_CALLCONV rayIntersectQuad(DirectX::FXMVECTOR rayPosition,
-                                      DirectX::FXMVECTOR rayDirection,
-                                      DirectX::FXMVECTOR v0,
-                                      DirectX::FXMVECTOR v1,
-                                      DirectX::FXMVECTOR v2,
-                                      DirectX::FXMVECTOR v3,
-                                      XrPosef* hitPose,
-                                      float& distance) {
-        // Not optimal. Should be possible to determine which triangle to test.
-        bool hit = TriangleTests::Intersects(rayPosition, rayDirection, v0, v1, v2, distance);
-        if (!hit) {
-            hit = TriangleTests::Intersects(rayPosition, rayDirection, v3, v2, v0, distance);
+    class ThreadPolicy : public general::IThreadPolicy {
+      public:
+        ThreadPolicy(const char* name,
+                     general::ThreadPriority priority,
+                     uint64_t affinityMask,
+                     const wchar_t* mmcssTask) {
+            TraceLoggingWrite(g_traceProvider,
+                              "ThreadPolicy_Apply",
+                              TLArg(name, "Thread"),
+                              TLArg((int)priority, "Priority"),
+                              TLArg(affinityMask, "AffinityMask"));
+
+            if (priority == general::ThreadPriority::Mmcss) {
+                DWORD taskIndex = 0;
+                m_mmcssTask = AvSetMmThreadCharacteristicsW(mmcssTask, &taskIndex);
+                if (m_mmcssTask) {
+                    AvSetMmThreadPriority(m_mmcssTask, AVRT_PRIORITY_HIGH);
+                } else {
+                    ErrorLog(fmt::format(
+                        "{}: MMCSS is not available ({}), using the highest priority instead\n", name, GetLastError()));
+                    priority = general::ThreadPriority::Highest;
+                }
+            }
+
+            if (!m_mmcssTask && priority != general::ThreadPriority::Normal) {
+                if (SetThreadPriority(GetCurrentThread(), getWin32Priority(priority))) {
+                    m_isPriorityRaised = true;
+                } else {
+                    ErrorLog(fmt::format("{}: SetThreadPriority() failed ({})\n", name, GetLastError()));
+                }
+            }
+
+            if (affinityMask) {
+                // Processors outside of the affinity of the process cannot be used.
+                DWORD_PTR processMask = 0, systemMask = 0;
+                GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask);
+                const DWORD_PTR mask = static_cast<DWORD_PTR>(affinityMask) & processMask;
+                if (mask) {
+                    m_previousAffinityMask = SetThreadAffinityMask(GetCurrentThread(), mask);
+                    if (!m_previousAffinityMask) {
+                        ErrorLog(fmt::format("{}: SetThreadAffinityMask() failed ({})\n", name, GetLastError()));
+                    }
+                } else {
+                    ErrorLog(fmt::format(
+                        "{}: affinity mask {:#x} excludes all the processors of the process\n", name, affinityMask));
+                }
+            }
         }
-        if (hit && hitPose != nullptr) {
-            FXMVECTOR hitPosition = XMVectorAdd(rayPosition, XMVectorScale(rayDirection, distance));
-            FXMVECTOR plane = XMPlaneFromPoints(v0, v2, v1);
-
-            // p' = p - (n . p + d) * n
-            // Project the ray position onto the plane
-            float t = XMVectorGetX(XMVector3Dot(plane, rayPosition)) + XMVectorGetW(plane);
-            FXMVECTOR projPoint = XMVectorSubtract(rayPosition, XMVectorMultiply(XMVectorSet(t, t, t, 0), plane));
-
-            // From the projected ray position, look towards the hit position and make the plane's normal "up"
-            FXMVECTOR forward = XMVectorSubtract(hitPosition, projPoint);
-            XMMATRIX virtualToGazeOrientation = XMMatrixLookToRH(hitPosition, forward, plane);
-            xr::math::StoreXrPose(hitPose, XMMatrixInverse(nullptr, virtualToGazeOrientation));
+
+        ~ThreadPolicy() override {
+            if (m_previousAffinityMask) {
+                SetThreadAffinityMask(GetCurrentThread(), m_previousAffinityMask);
+            }
+            if (m_mmcssTask) {
+                AvRevertMmThreadCharacteristics(m_mmcssTask);
+            }
+            if (m_isPriorityRaised) {
+                SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_NORMAL);
+            }
+        }
+
+      private:
+        static int getWin32Priority(general::ThreadPriority priority) {
+            switch (priority) {
+            case general::ThreadPriority::AboveNormal:
+                return THREAD_PRIORITY_ABOVE_NORMAL;
+            case general::ThreadPriority::Highest:
+                return THREAD_PRIORITY_HIGHEST;
+            case general::ThreadPriority::TimeCritical:
+                return THREAD_PRIORITY_TIME_CRITICAL;
+            default:
+                return THREAD_PRIORITY_NORMAL;
+            }
         }
-        return hit;
-    }
+
+        HANDLE m_mmcssTask{nullptr};
+        bool m_isPriorityRaised{false};
+        DWORD_PTR m_previousAffinityMask{0};
+    };
 
 } // namespace
 
@@ -92,53 +146,40 @@ namespace openxr_api_layer::utils::general {
         return std::make_shared<CpuTimer>();
     }
 
+    std::unique_ptr<IThreadPolicy> applyThreadPolicy(const char* name,
+                                                     ThreadPriority priority,
+                                                     uint64_t affinityMask,
+                                                     const wchar_t* mmcssTask) {
+        return std::make_unique<ThreadPolicy>(name, priority, affinityMask, mmcssTask);
+    }
+
     bool hitTest(const XrPosef& ray, const XrPosef& quadCenter, const XrExtent2Df& quadSize, XrPosef& hitPose) {
-        using namespace DirectX;
-
-        // Taken from
-        // https://github.com/microsoft/OpenXR-MixedReality/blob/main/samples/SceneUnderstandingUwp/Scene_Placement.cpp
-
-        // Clockwise order
-        const float halfWidth = quadSize.width / 2.0f;
-        const float halfHeight = quadSize.height / 2.0f;
-        auto v0 = XMVectorSet(-halfWidth, -halfHeight, 0, 1);
-        auto v1 = XMVectorSet(-halfWidth, halfHeight, 0, 1);
-        auto v2 = XMVectorSet(halfWidth, halfHeight, 0, 1);
-        auto v3 = XMVectorSet(halfWidth, -halfHeight, 0, 1);
-        const auto matrix = xr::math::LoadXrPose(quadCenter);
-        v0 = XMVector4Transform(v0, matrix);
-        v1 = XMVector4Transform(v1, matrix);
-        v2 = XMVector4Transform(v2, matrix);
-        v3 = XMVector4Transform(v3, matrix);
-
-        XMVECTOR rayPosition = xr::math::LoadXrVector3(ray.position);
-
-        const auto forward = XMVectorSet(0, 0, -1, 0);
-        const auto rotation = xr::math::LoadXrQuaternion(ray.orientation);
-        XMVECTOR rayDirection = XMVector3Rotate(forward, rotation);
-
-        float distance = 0.0f;
-        return rayIntersectQuad(rayPosition, rayDirection, v0, v1, v2, v3, &hitPose, distance);
+        hittest::Hit hit;
+        if (!hittest::hitTestQuad(ray, quadCenter, quadSize, hit)) {
+            return false;
+        }
+        hitPose = hit.pose;
+        return true;
     }
 
     // https://gamedev.stackexchange.com/questions/136652/uv-world-mapping-in-shader-with-unity/136720#136720
     XrVector2f getUVCoordinates(const XrVector3f& point, const XrPosef& quadCenter, const XrExtent2Df& quadSize) {
-        using namespace xr::math;
-
-        const XrVector3f normal =
-            Pose::Multiply(Pose::MakePose(quadCenter.orientation, XrVector3f{}), Pose::Translation({0, 0, 1})).position;
-
-        XrVector3f uDirection, vDirection;
-        vDirection = {0, 0, 1};
-        if (std::abs(normal.y) < 1.0f) {
-            vDirection = Normalize(XrVector3f{0, 1, 0} - normal.y * normal);
+        const vm::Pose orientation{vm::load(quadCenter.orientation), vm::set(0, 0, 0)};
+        const vm::Pose translation{vm::set(0, 0, 0, 1), vm::set(0, 0, 1)};
+        const vm::Vector normal = vm::multiplyPoses(orientation, translation).position;
+
+        vm::Vector uDirection, vDirection;
+        vDirection = vm::set(0, 0, 1);
+        if (std::abs(vm::getY(normal)) < 1.0f) {
+            vDirection = vm::normalize3(vm::subtract(vm::set(0, 1, 0), vm::scale(normal, vm::getY(normal))));
         }
 
-        uDirection = Normalize(Cross(normal, vDirection));
+        uDirection = vm::normalize3(vm::cross3(normal, vDirection));
 
+        const vm::Vector p = vm::load(point);
         return {
-            (-Dot(uDirection, point) + (quadSize.width / 2.f)) / quadSize.width,
-            (-Dot(vDirection, point) + (quadSize.height / 2.f)) / quadSize.height,
+            (-vm::dot3(uDirection, p) + (quadSize.width / 2.f)) / quadSize.width,
+            (-vm::dot3(vDirection, p) + (quadSize.height / 2.f)) / quadSize.height,
         };
     }
 
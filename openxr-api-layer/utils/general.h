@@ -22,18 +22,6 @@
 
 #pragma once
 
-namespace xr::math {
-
-    static inline XrVector3f Cross(const XrVector3f& a, const XrVector3f& b) {
-        return {
-            a.y * b.z - a.z * b.y,
-            a.z * b.x - a.x * b.z,
-            a.x * b.y - a.y * b.x,
-        };
-    }
-
-} // namespace xr::math
-
 namespace openxr_api_layer::utils::general {
 
     struct ITimer {
@@ -47,6 +35,27 @@ namespace openxr_api_layer::utils::general {
 
     std::shared_ptr<ITimer> createTimer();
 
+    enum class ThreadPriority {
+        Normal,
+        AboveNormal,
+        Highest,
+        TimeCritical,
+        // Multimedia Class Scheduler Service ("Pro Audio" task), falls back to Highest when the service is unavailable.
+        Mmcss,
+    };
+
+    struct IThreadPolicy {
+        virtual ~IThreadPolicy() = default;
+    };
+
+    // Raise the priority of the calling thread and restrict it to the processors of the mask (0 for no restriction)
+    // until the returned object is destroyed, on the same thread. Failures are logged and leave the thread unchanged.
+    // The MMCSS task can be overridden for testing.
+    std::unique_ptr<IThreadPolicy> applyThreadPolicy(const char* name,
+                                                     ThreadPriority priority,
+                                                     uint64_t affinityMask,
+                                                     const wchar_t* mmcssTask = L"Pro Audio");
+
     static inline bool startsWith(const std::string& str, const std::string& substr) {
         return str.find(substr) == 0;
     }
@@ -56,7 +65,7 @@ namespace openxr_api_layer::utils::general {
         return pos != std::string::npos && pos == str.size() - substr.size();
     }
 
-    // Both ray and quadCenter poses must be located using the same base space.
+    // Both ray and quadCenter poses must be located using the same base space. See hittest.h to test many quads.
     bool hitTest(const XrPosef& ray, const XrPosef& quadCenter, const XrExtent2Df& quadSize, XrPosef& hitPose);
 
     // Get UV coordinates for a point on quad.
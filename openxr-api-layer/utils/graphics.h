@@ -32,11 +32,17 @@ namespace openxr_api_layer::utils::graphics {
 #endif
 #ifdef XR_USE_GRAPHICS_API_D3D12
         D3D12,
+#endif
+#ifdef XR_USE_GRAPHICS_API_CPU
+        CPU,
 #endif
     };
     enum class CompositionApi {
 #ifdef XR_USE_GRAPHICS_API_D3D11
         D3D11,
+#endif
+#ifdef XR_USE_GRAPHICS_API_CPU
+        CPU,
 #endif
     };
 
@@ -64,6 +70,20 @@ namespace openxr_api_layer::utils::graphics {
     };
 #endif
 
+#ifdef XR_USE_GRAPHICS_API_CPU
+    // Commands execute on the CPU, in submission order, and textures live in system memory.
+    struct CPU {
+        static constexpr Api Api = Api::CPU;
+
+        using Device = void*;
+        using Context = void*;
+        // The texels of all subresources, tightly packed (mips of each array slice one after the other).
+        using Texture = uint8_t*;
+        // The last signaled value.
+        using Fence = std::atomic<uint64_t>*;
+    };
+#endif
+
     // We (arbitrarily) use DXGI as a common conversion point for all graphics APIs.
     using GenericFormat = DXGI_FORMAT;
 
@@ -144,6 +164,16 @@ namespace openxr_api_layer::utils::graphics {
 
         virtual void copyTexture(IGraphicsTexture* from, IGraphicsTexture* to) = 0;
 
+        // Copy a region of an array slice of a texture into a region of an array slice of another texture, with
+        // bilinear filtering when the sizes differ. Texels outside of the source region are never sampled. Only
+        // available on composition devices, and it does not preserve the state of the execution context.
+        virtual void blitTexture(IGraphicsTexture* from,
+                                 const XrRect2Di& fromRect,
+                                 uint32_t fromSlice,
+                                 IGraphicsTexture* to,
+                                 const XrRect2Di& toRect,
+                                 uint32_t toSlice) = 0;
+
         virtual GenericFormat translateToGenericFormat(int64_t format) const = 0;
         virtual int64_t translateFromGenericFormat(GenericFormat format) const = 0;
 
@@ -197,12 +227,22 @@ namespace openxr_api_layer::utils::graphics {
     struct ISwapchain {
         virtual ~ISwapchain() = default;
 
-        // Only for manipulating swapchains created through createSwapchain().
+        // Only for manipulating swapchains created through createSwapchain() or wrapApplicationSwapchain().
+        // Images acquired outside of composition can be accessed on the composition device after the next
+        // serializePreComposition(). Acquiring them beforehand lets their synchronization be batched with the frame's.
         virtual ISwapchainImage* acquireImage(bool wait = true) = 0;
         virtual void waitImage() = 0;
         virtual void releaseImage() = 0;
 
+        // Only for swapchains created through wrapApplicationSwapchain(), in place of the application's calls. The
+        // result of the runtime is returned unchanged.
+        virtual XrResult acquireApplicationImage(const XrSwapchainImageAcquireInfo* acquireInfo, uint32_t* index) = 0;
+        virtual XrResult releaseApplicationImage(const XrSwapchainImageReleaseInfo* releaseInfo) = 0;
+
+        // Images obtained before serializePreComposition() are copied to the composition device along with the frame,
+        // only the swapchains that are read pay for a copy.
         virtual ISwapchainImage* getLastReleasedImage() const = 0;
+        // Releases the last released image to the runtime, after the composition wrote to it (if writable).
         virtual void commitLastReleasedImage() = 0;
 
         virtual const XrSwapchainCreateInfo& getInfoOnCompositionDevice() const = 0;
@@ -246,12 +286,25 @@ namespace openxr_api_layer::utils::graphics {
         virtual std::shared_ptr<ISwapchain> createSwapchain(const XrSwapchainCreateInfo& infoOnApplicationDevice,
                                                             SwapchainMode mode) = 0;
 
+        // Wrap a swapchain created by the application, in order to read its images during composition. The application
+        // keeps ownership of the XrSwapchain handle, and the layer must route the application's
+        // xrAcquireSwapchainImage() and xrReleaseSwapchainImage() calls to acquireApplicationImage() and
+        // releaseApplicationImage(). The image released last is held until commitLastReleasedImage(), which the layer
+        // must call after composition and before the upstream xrEndFrame() implementation.
+        virtual std::shared_ptr<ISwapchain>
+        wrapApplicationSwapchain(XrSwapchain swapchain,
+                                 const XrSwapchainCreateInfo& infoOnApplicationDevice,
+                                 SwapchainMode mode) = 0;
+
         // Must be called at the beginning of the layer's xrEndFrame() implementation to serialize application commands
-        // prior to composition.
+        // prior to composition. This includes the pending operations of all swapchains and the copies made by
+        // ISwapchain::getLastReleasedImage(), so that a frame only needs a single synchronization from the application
+        // device to the composition device.
         virtual void serializePreComposition() = 0;
 
         // Must be called before chaining to the upstream xrEndFrame() implementation to serialize composition commands
-        // prior to submission.
+        // prior to submission. Calling ISwapchain::commitLastReleasedImage() afterwards avoids additional
+        // synchronizations from the composition device to the application device.
         virtual void serializePostComposition() = 0;
 
         virtual IGraphicsDevice* getCompositionDevice() const = 0;
@@ -294,6 +347,16 @@ namespace openxr_api_layer::utils::graphics {
         std::shared_ptr<IGraphicsDevice> wrapApplicationDevice(const XrGraphicsBindingD3D12KHR& bindings);
 #endif
 
+#ifdef XR_USE_GRAPHICS_API_CPU
+        // Serves as both the composition device and the application device of sessions without graphics bindings (eg:
+        // XR_MND_headless). Textures and fences can only be shared with other CPU devices.
+        std::shared_ptr<IGraphicsDevice> createCpuGraphicsDevice();
+
+        // Whether the swapchain images of the CPU sessions created afterwards are shareable with the composition device
+        // (the default). When they are not, they are read and written through bounce buffers, like on D3D12.
+        void setCpuSwapchainImagesShareable(bool shareable);
+#endif
+
     } // namespace internal
 
 } // namespace openxr_api_layer::utils::graphics
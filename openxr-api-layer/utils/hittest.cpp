@@ -0,0 +1,603 @@
+// MIT License
+//
+// Copyright(c) 2022-2023 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "hittest.h"
+#include "vectormath.h"
+
+namespace {
+
+    using namespace openxr_api_layer::utils::hittest;
+    namespace vm = openxr_api_layer::utils::vectormath;
+
+    constexpr uint32_t k_none = ~0u;
+    constexpr uint32_t k_packetSize = 4;
+    constexpr uint32_t k_maxDepth = 64;
+
+    // Rebuild the hierarchy once refitting grew the total surface of its bounding boxes by this factor.
+    constexpr float k_maxRefitGrowth = 2.f;
+
+    // Rays this close to parallel to a quad never hit it.
+    constexpr float k_parallelEpsilon = 1e-6f;
+
+    // Up to k_packetSize quads, one per lane of the SIMD test.
+    struct Packet {
+        float centerX[k_packetSize]{};
+        float centerY[k_packetSize]{};
+        float centerZ[k_packetSize]{};
+        float rightX[k_packetSize]{};
+        float rightY[k_packetSize]{};
+        float rightZ[k_packetSize]{};
+        float upX[k_packetSize]{};
+        float upY[k_packetSize]{};
+        float upZ[k_packetSize]{};
+        float normalX[k_packetSize]{};
+        float normalY[k_packetSize]{};
+        float normalZ[k_packetSize]{};
+
+        // Unused lanes have a negative half width, so they never hit.
+        float halfWidth[k_packetSize]{-1.f, -1.f, -1.f, -1.f};
+        float halfHeight[k_packetSize]{};
+
+        uint32_t quadIds[k_packetSize]{k_none, k_none, k_none, k_none};
+    };
+
+    // Axis-aligned. The W components are unused and only there for loading into vectors.
+    struct Box {
+        float min[4]{INFINITY, INFINITY, INFINITY, 0.f};
+        float max[4]{-INFINITY, -INFINITY, -INFINITY, 0.f};
+
+        bool isEmpty() const {
+            return min[0] > max[0];
+        }
+
+        float getSurfaceArea() const {
+            if (isEmpty()) {
+                return 0.f;
+            }
+            const float x = max[0] - min[0], y = max[1] - min[1], z = max[2] - min[2];
+            return 2.f * (x * y + y * z + z * x);
+        }
+
+        void merge(const Box& other) {
+            vm::store4(min, vm::minimum(vm::load4(min), vm::load4(other.min)));
+            vm::store4(max, vm::maximum(vm::load4(max), vm::load4(other.max)));
+        }
+
+        bool operator==(const Box& other) const {
+            return !memcmp(this, &other, sizeof(Box));
+        }
+    };
+
+    struct Node {
+        Box box;
+        uint32_t parent{k_none};
+        uint32_t children[2]{k_none, k_none};
+
+        // Only for leaves.
+        uint32_t packet{k_none};
+        bool isDirty{false};
+    };
+
+    struct Quad {
+        XrPosef pose{};
+        XrExtent2Df size{};
+        bool isActive{false};
+
+        // Location in the hierarchy, if it was built since the quad was added.
+        uint32_t leaf{k_none};
+        uint32_t lane{0};
+    };
+
+    struct Ray {
+        vm::Vector origin;
+        vm::Vector direction;
+        vm::Vector inverseDirection;
+    };
+
+    // Closest hit so far, in the coordinates of the quad.
+    struct Candidate {
+        uint32_t quadId{k_none};
+        float distance{INFINITY};
+        float x{0.f};
+        float y{0.f};
+    };
+
+    Ray makeRay(const XrPosef& pose) {
+        Ray ray;
+        ray.origin = vm::load(pose.position);
+        ray.direction = vm::rotate(vm::set(0.f, 0.f, -1.f), vm::load(pose.orientation));
+
+        // Avoid infinities (and NaN in the slab test) for axis-aligned rays.
+        const auto safeInverse = [](float value) {
+            return 1.f / (std::abs(value) < 1e-12f ? std::copysign(1e-12f, value) : value);
+        };
+        ray.inverseDirection = vm::set(safeInverse(vm::getX(ray.direction)),
+                                       safeInverse(vm::getY(ray.direction)),
+                                       safeInverse(vm::getZ(ray.direction)));
+        return ray;
+    }
+
+    void setLane(Packet& packet, uint32_t lane, uint32_t quadId, const XrPosef& pose, const XrExtent2Df& size) {
+        const vm::Vector orientation = vm::load(pose.orientation);
+        const XrVector3f right = vm::storeVector3(vm::rotate(vm::set(1.f, 0.f, 0.f), orientation));
+        const XrVector3f up = vm::storeVector3(vm::rotate(vm::set(0.f, 1.f, 0.f), orientation));
+        const XrVector3f normal = vm::storeVector3(vm::rotate(vm::set(0.f, 0.f, 1.f), orientation));
+
+        packet.centerX[lane] = pose.position.x;
+        packet.centerY[lane] = pose.position.y;
+        packet.centerZ[lane] = pose.position.z;
+        packet.rightX[lane] = right.x;
+        packet.rightY[lane] = right.y;
+        packet.rightZ[lane] = right.z;
+        packet.upX[lane] = up.x;
+        packet.upY[lane] = up.y;
+        packet.upZ[lane] = up.z;
+        packet.normalX[lane] = normal.x;
+        packet.normalY[lane] = normal.y;
+        packet.normalZ[lane] = normal.z;
+        packet.halfWidth[lane] = size.width / 2.f;
+        packet.halfHeight[lane] = size.height / 2.f;
+        packet.quadIds[lane] = quadId;
+    }
+
+    void clearLane(Packet& packet, uint32_t lane) {
+        packet.halfWidth[lane] = -1.f;
+        packet.quadIds[lane] = k_none;
+    }
+
+    Box getPacketBox(const Packet& packet) {
+        Box box;
+        for (uint32_t lane = 0; lane < k_packetSize; lane++) {
+            const float halfWidth = packet.halfWidth[lane];
+            const float halfHeight = packet.halfHeight[lane];
+            if (halfWidth < 0.f) {
+                continue;
+            }
+
+            const float extent[3] = {
+                halfWidth * std::abs(packet.rightX[lane]) + halfHeight * std::abs(packet.upX[lane]),
+                halfWidth * std::abs(packet.rightY[lane]) + halfHeight * std::abs(packet.upY[lane]),
+                halfWidth * std::abs(packet.rightZ[lane]) + halfHeight * std::abs(packet.upZ[lane]),
+            };
+            const float center[3] = {packet.centerX[lane], packet.centerY[lane], packet.centerZ[lane]};
+            for (uint32_t axis = 0; axis < 3; axis++) {
+                box.min[axis] = std::min(box.min[axis], center[axis] - extent[axis]);
+                box.max[axis] = std::max(box.max[axis], center[axis] + extent[axis]);
+            }
+        }
+        return box;
+    }
+
+    // Slab test, only accepting intersections closer than maxDistance.
+    bool intersectBox(const Box& box, const Ray& ray, float maxDistance) {
+        if (box.isEmpty()) {
+            return false;
+        }
+
+        const vm::Vector t1 = vm::multiply(vm::subtract(vm::load4(box.min), ray.origin), ray.inverseDirection);
+        const vm::Vector t2 = vm::multiply(vm::subtract(vm::load4(box.max), ray.origin), ray.inverseDirection);
+        const vm::Vector tNear = vm::minimum(t1, t2);
+        const vm::Vector tFar = vm::maximum(t1, t2);
+
+        const float nearest = std::max({vm::getX(tNear), vm::getY(tNear), vm::getZ(tNear), 0.f});
+        const float farthest = std::min({vm::getX(tFar), vm::getY(tFar), vm::getZ(tFar), maxDistance});
+        return nearest <= farthest;
+    }
+
+    // Test the ray against all quads of a packet at once, and update the closest hit.
+    void testPacket(const Packet& packet, const Ray& ray, Candidate& closest) {
+        const vm::Vector dx = vm::splat(vm::getX(ray.direction));
+        const vm::Vector dy = vm::splat(vm::getY(ray.direction));
+        const vm::Vector dz = vm::splat(vm::getZ(ray.direction));
+
+        // Vectors from the origin of the ray to the center of each quad.
+        const vm::Vector cx = vm::subtract(vm::load4(packet.centerX), vm::splat(vm::getX(ray.origin)));
+        const vm::Vector cy = vm::subtract(vm::load4(packet.centerY), vm::splat(vm::getY(ray.origin)));
+        const vm::Vector cz = vm::subtract(vm::load4(packet.centerZ), vm::splat(vm::getZ(ray.origin)));
+
+        // Distance to the plane of each quad.
+        const vm::Vector nx = vm::load4(packet.normalX);
+        const vm::Vector ny = vm::load4(packet.normalY);
+        const vm::Vector nz = vm::load4(packet.normalZ);
+        const vm::Vector cosine =
+            vm::add(vm::add(vm::multiply(nx, dx), vm::multiply(ny, dy)), vm::multiply(nz, dz));
+        const vm::Vector distance =
+            vm::divide(vm::add(vm::add(vm::multiply(nx, cx), vm::multiply(ny, cy)), vm::multiply(nz, cz)), cosine);
+
+        // Intersection with each plane, relative to the center of the quad and projected on its axes.
+        const vm::Vector px = vm::subtract(vm::multiply(distance, dx), cx);
+        const vm::Vector py = vm::subtract(vm::multiply(distance, dy), cy);
+        const vm::Vector pz = vm::subtract(vm::multiply(distance, dz), cz);
+        const vm::Vector x = vm::add(
+            vm::add(vm::multiply(vm::load4(packet.rightX), px), vm::multiply(vm::load4(packet.rightY), py)),
+            vm::multiply(vm::load4(packet.rightZ), pz));
+        const vm::Vector y =
+            vm::add(vm::add(vm::multiply(vm::load4(packet.upX), px), vm::multiply(vm::load4(packet.upY), py)),
+                    vm::multiply(vm::load4(packet.upZ), pz));
+
+        float cosines[k_packetSize], distances[k_packetSize], xs[k_packetSize], ys[k_packetSize];
+        vm::store4(cosines, cosine);
+        vm::store4(distances, distance);
+        vm::store4(xs, x);
+        vm::store4(ys, y);
+        for (uint32_t lane = 0; lane < k_packetSize; lane++) {
+            if (std::abs(cosines[lane]) > k_parallelEpsilon && distances[lane] >= 0.f &&
+                distances[lane] < closest.distance && std::abs(xs[lane]) <= packet.halfWidth[lane] &&
+                std::abs(ys[lane]) <= packet.halfHeight[lane]) {
+                closest = {packet.quadIds[lane], distances[lane], xs[lane], ys[lane]};
+            }
+        }
+    }
+
+    // Located at the hit position. From the projection of the ray's origin on the tangent plane, look towards the hit
+    // position, with the surface's normal "up". When the ray is perpendicular to the surface, look towards the given
+    // "up" direction of the surface instead.
+    XrPosef makeHitPose(const Ray& ray, vm::Vector position, vm::Vector normal, vm::Vector up) {
+        const vm::Vector toOrigin = vm::subtract(ray.origin, position);
+        const vm::Vector projectedOrigin = vm::subtract(ray.origin, vm::scale(normal, vm::dot3(normal, toOrigin)));
+        vm::Vector forward = vm::subtract(position, projectedOrigin);
+        if (vm::length3(forward) < 1e-6f) {
+            forward = up;
+        }
+        const vm::Vector zAxis = vm::normalize3(vm::negate(forward));
+        const vm::Vector xAxis = vm::normalize3(vm::cross3(normal, zAxis));
+        const vm::Vector yAxis = vm::cross3(zAxis, xAxis);
+        return vm::storePose({vm::quaternionFromAxes(xAxis, yAxis, zAxis), position});
+    }
+
+    Hit makeHit(const Ray& ray, const XrPosef& quadPose, const XrExtent2Df& quadSize, const Candidate& candidate) {
+        Hit hit;
+        hit.quadId = candidate.quadId;
+        hit.distance = candidate.distance;
+        hit.uv = {candidate.x / quadSize.width + 0.5f, 0.5f - candidate.y / quadSize.height};
+
+        const vm::Vector orientation = vm::load(quadPose.orientation);
+        hit.pose = makeHitPose(ray,
+                               vm::add(ray.origin, vm::scale(ray.direction, candidate.distance)),
+                               vm::rotate(vm::set(0.f, 0.f, 1.f), orientation),
+                               vm::rotate(vm::set(0.f, 1.f, 0.f), orientation));
+
+        return hit;
+    }
+
+    class HitTester : public IHitTester {
+      public:
+        uint32_t addQuad(const XrPosef& pose, const XrExtent2Df& size) override {
+            uint32_t quadId;
+            if (!m_freeQuadIds.empty()) {
+                quadId = m_freeQuadIds.back();
+                m_freeQuadIds.pop_back();
+            } else {
+                quadId = static_cast<uint32_t>(m_quads.size());
+                m_quads.emplace_back();
+            }
+
+            Quad& quad = m_quads[quadId];
+            quad.pose = pose;
+            quad.size = size;
+            quad.isActive = true;
+            m_quadCount++;
+
+            // Fitting the new quad into the existing hierarchy would degrade it quickly, and adding quads is rare.
+            m_needsRebuild = true;
+
+            return quadId;
+        }
+
+        void moveQuad(uint32_t quadId, const XrPosef& pose, const XrExtent2Df& size) override {
+            Quad& quad = getQuad(quadId);
+            quad.pose = pose;
+            quad.size = size;
+            if (quad.leaf != k_none) {
+                setLane(m_packets[m_nodes[quad.leaf].packet], quad.lane, quadId, pose, size);
+                markDirty(quad.leaf);
+            }
+        }
+
+        void removeQuad(uint32_t quadId) override {
+            Quad& quad = getQuad(quadId);
+            if (quad.leaf != k_none) {
+                clearLane(m_packets[m_nodes[quad.leaf].packet], quad.lane);
+                markDirty(quad.leaf);
+            }
+            quad = {};
+            m_freeQuadIds.push_back(quadId);
+            m_quadCount--;
+        }
+
+        void clear() override {
+            m_quads.clear();
+            m_freeQuadIds.clear();
+            m_quadCount = 0;
+            m_nodes.clear();
+            m_packets.clear();
+            m_dirtyLeaves.clear();
+            m_surfaceArea = m_builtSurfaceArea = 0.f;
+            m_needsRebuild = false;
+        }
+
+        uint32_t getQuadCount() const override {
+            return m_quadCount;
+        }
+
+        bool hitTest(const XrPosef& pose, Hit& hit) override {
+            update();
+            if (m_nodes.empty()) {
+                return false;
+            }
+
+            const Ray ray = makeRay(pose);
+            Candidate closest;
+
+            uint32_t stack[k_maxDepth];
+            uint32_t depth = 0;
+            stack[depth++] = 0;
+            while (depth) {
+                const Node& node = m_nodes[stack[--depth]];
+                if (!intersectBox(node.box, ray, closest.distance)) {
+                    continue;
+                }
+
+                if (node.packet != k_none) {
+                    testPacket(m_packets[node.packet], ray, closest);
+                } else {
+                    stack[depth++] = node.children[0];
+                    stack[depth++] = node.children[1];
+                }
+            }
+
+            if (closest.quadId == k_none) {
+                return false;
+            }
+
+            const Quad& quad = m_quads[closest.quadId];
+            hit = makeHit(ray, quad.pose, quad.size, closest);
+            return true;
+        }
+
+      private:
+        Quad& getQuad(uint32_t quadId) {
+            if (quadId >= m_quads.size() || !m_quads[quadId].isActive) {
+                throw std::out_of_range("Invalid quad identifier");
+            }
+            return m_quads[quadId];
+        }
+
+        void markDirty(uint32_t leaf) {
+            if (!m_nodes[leaf].isDirty) {
+                m_nodes[leaf].isDirty = true;
+                m_dirtyLeaves.push_back(leaf);
+            }
+        }
+
+        void update() {
+            if (m_needsRebuild) {
+                rebuild();
+                return;
+            }
+
+            for (const uint32_t leaf : m_dirtyLeaves) {
+                refit(leaf);
+            }
+            m_dirtyLeaves.clear();
+
+            if (m_surfaceArea > k_maxRefitGrowth * m_builtSurfaceArea) {
+                rebuild();
+            }
+        }
+
+        // Recompute the box of a leaf, and of its ancestors until one of them does not change.
+        void refit(uint32_t leaf) {
+            m_nodes[leaf].isDirty = false;
+
+            Box box = getPacketBox(m_packets[m_nodes[leaf].packet]);
+            uint32_t index = leaf;
+            while (index != k_none) {
+                Node& node = m_nodes[index];
+                if (node.packet == k_none) {
+                    box = m_nodes[node.children[0]].box;
+                    box.merge(m_nodes[node.children[1]].box);
+                }
+                if (box == node.box) {
+                    break;
+                }
+
+                m_surfaceArea += box.getSurfaceArea() - node.box.getSurfaceArea();
+                node.box = box;
+                index = node.parent;
+            }
+        }
+
+        void rebuild() {
+            m_nodes.clear();
+            m_packets.clear();
+            m_dirtyLeaves.clear();
+            m_surfaceArea = 0.f;
+
+            std::vector<uint32_t> quadIds;
+            quadIds.reserve(m_quadCount);
+            for (uint32_t i = 0; i < m_quads.size(); i++) {
+                m_quads[i].leaf = k_none;
+                if (m_quads[i].isActive) {
+                    quadIds.push_back(i);
+                }
+            }
+            if (!quadIds.empty()) {
+                m_nodes.reserve(2 * (quadIds.size() / k_packetSize + 1));
+                build(quadIds.data(), quadIds.size(), k_none, 0);
+            }
+
+            m_builtSurfaceArea = m_surfaceArea;
+            m_needsRebuild = false;
+        }
+
+        // Top-down, splitting at the median of the centers along the axis where they are the most spread.
+        uint32_t build(uint32_t* quadIds, size_t count, uint32_t parent, uint32_t depth) {
+            const uint32_t index = static_cast<uint32_t>(m_nodes.size());
+            m_nodes.emplace_back();
+            m_nodes[index].parent = parent;
+
+            if (count <= k_packetSize) {
+                const uint32_t packetIndex = static_cast<uint32_t>(m_packets.size());
+                Packet& packet = m_packets.emplace_back();
+                for (uint32_t lane = 0; lane < count; lane++) {
+                    Quad& quad = m_quads[quadIds[lane]];
+                    setLane(packet, lane, quadIds[lane], quad.pose, quad.size);
+                    quad.leaf = index;
+                    quad.lane = lane;
+                }
+                m_nodes[index].packet = packetIndex;
+                m_nodes[index].box = getPacketBox(packet);
+            } else {
+                const auto getCenter = [&](uint32_t quadId, uint32_t axis) {
+                    const XrVector3f& position = m_quads[quadId].pose.position;
+                    return axis == 0 ? position.x : axis == 1 ? position.y : position.z;
+                };
+
+                float spread[3];
+                for (uint32_t axis = 0; axis < 3; axis++) {
+                    const auto [minIt, maxIt] =
+                        std::minmax_element(quadIds, quadIds + count, [&](uint32_t a, uint32_t b) {
+                            return getCenter(a, axis) < getCenter(b, axis);
+                        });
+                    spread[axis] = getCenter(*maxIt, axis) - getCenter(*minIt, axis);
+                }
+                const uint32_t axis = static_cast<uint32_t>(std::max_element(spread, spread + 3) - spread);
+
+                const size_t half = count / 2;
+                std::nth_element(quadIds, quadIds + half, quadIds + count, [&](uint32_t a, uint32_t b) {
+                    return getCenter(a, axis) < getCenter(b, axis);
+                });
+
+                // The depth is logarithmic in the number of quads, so the traversal stack cannot overflow.
+                assert(depth + 1 < k_maxDepth);
+                const uint32_t left = build(quadIds, half, index, depth + 1);
+                const uint32_t right = build(quadIds + half, count - half, index, depth + 1);
+
+                Node& node = m_nodes[index];
+                node.children[0] = left;
+                node.children[1] = right;
+                node.box = m_nodes[left].box;
+                node.box.merge(m_nodes[right].box);
+            }
+
+            m_surfaceArea += m_nodes[index].box.getSurfaceArea();
+            return index;
+        }
+
+        std::vector<Quad> m_quads;
+        std::vector<uint32_t> m_freeQuadIds;
+        uint32_t m_quadCount{0};
+
+        // The root is the first node, and parents always come before their children.
+        std::vector<Node> m_nodes;
+        std::vector<Packet> m_packets;
+        std::vector<uint32_t> m_dirtyLeaves;
+        bool m_needsRebuild{false};
+
+        // Sum of the surfaces of all boxes, now and right after the last build.
+        float m_surfaceArea{0.f};
+        float m_builtSurfaceArea{0.f};
+    };
+
+} // namespace
+
+namespace openxr_api_layer::utils::hittest {
+
+    std::shared_ptr<IHitTester> createHitTester() {
+        return std::make_shared<HitTester>();
+    }
+
+    bool hitTestQuad(const XrPosef& ray, const XrPosef& quadCenter, const XrExtent2Df& quadSize, Hit& hit) {
+        Packet packet;
+        setLane(packet, 0, 0, quadCenter, quadSize);
+
+        const Ray r = makeRay(ray);
+        Candidate closest;
+        testPacket(packet, r, closest);
+        if (closest.quadId == k_none) {
+            return false;
+        }
+
+        hit = makeHit(r, quadCenter, quadSize, closest);
+        return true;
+    }
+
+    bool hitTestCylinder(const XrPosef& ray,
+                         const XrPosef& cylinderCenter,
+                         float radius,
+                         float centralAngle,
+                         float aspectRatio,
+                         Hit& hit) {
+        const Ray r = makeRay(ray);
+
+        // Intersect with the infinite cylinder, in the space of the cylinder.
+        const vm::Pose cylinder = vm::load(cylinderCenter);
+        const vm::Pose toCylinder = vm::invertPose(cylinder);
+        const vm::Vector origin = vm::transformPoint(toCylinder, r.origin);
+        const vm::Vector direction = vm::rotate(r.direction, toCylinder.orientation);
+        const float ox = vm::getX(origin), oz = vm::getZ(origin);
+        const float dx = vm::getX(direction), dz = vm::getZ(direction);
+        const float a = dx * dx + dz * dz;
+        if (a < k_parallelEpsilon * k_parallelEpsilon) {
+            return false;
+        }
+        const float halfB = ox * dx + oz * dz;
+        const float c = ox * ox + oz * oz - radius * radius;
+        const float discriminant = halfB * halfB - a * c;
+        if (discriminant < 0.f) {
+            return false;
+        }
+
+        // Then check the closest intersection within the visible arc.
+        const float height = radius * centralAngle / aspectRatio;
+        const float root = std::sqrt(discriminant);
+        for (const float distance : {(-halfB - root) / a, (-halfB + root) / a}) {
+            if (distance < 0.f) {
+                continue;
+            }
+
+            const vm::Vector point = vm::add(origin, vm::scale(direction, distance));
+            const float angle = std::atan2(vm::getX(point), -vm::getZ(point));
+            if (std::abs(angle) > centralAngle / 2.f || std::abs(vm::getY(point)) > height / 2.f) {
+                continue;
+            }
+
+            hit.quadId = 0;
+            hit.distance = distance;
+            hit.uv = {angle / centralAngle + 0.5f, 0.5f - vm::getY(point) / height};
+
+            // The visible side is the inside of the cylinder.
+            const vm::Vector normal = vm::set(-vm::getX(point) / radius, 0.f, -vm::getZ(point) / radius);
+            hit.pose = makeHitPose(r,
+                                   vm::add(r.origin, vm::scale(r.direction, distance)),
+                                   vm::rotate(normal, cylinder.orientation),
+                                   vm::rotate(vm::set(0.f, 1.f, 0.f), cylinder.orientation));
+            return true;
+        }
+
+        return false;
+    }
+
+} // namespace openxr_api_layer::utils::hittest
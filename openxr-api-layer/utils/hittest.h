@@ -0,0 +1,77 @@
+// MIT License
+//
+// Copyright(c) 2022-2023 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+// Gaze hit-testing against many quads, such as the panels of a gaze-driven UI.
+//
+// Quads are grouped by 4 in the leaves of a bounding volume hierarchy, and each leaf is tested against the ray with one
+// pass of SIMD operations (one quad per lane). Moving or removing a quad only refits the bounding boxes on the path to
+// the root. The hierarchy is rebuilt when quads are added, or when refitting made it too loose.
+namespace openxr_api_layer::utils::hittest {
+
+    struct Hit {
+        uint32_t quadId{0};
+
+        // Distance from the origin of the ray, in meters.
+        float distance{0.f};
+
+        // Located on the surface, with Y along the surface's normal and Z pointing back towards the projection of the
+        // ray's origin on the surface.
+        XrPosef pose{};
+
+        // Position on the surface, from (0, 0) at the top left corner to (1, 1) at the bottom right corner.
+        XrVector2f uv{};
+    };
+
+    struct IHitTester {
+        virtual ~IHitTester() = default;
+
+        // Quads are centered on their pose and face +Z. Identifiers of removed quads are reused.
+        virtual uint32_t addQuad(const XrPosef& pose, const XrExtent2Df& size) = 0;
+        virtual void moveQuad(uint32_t quadId, const XrPosef& pose, const XrExtent2Df& size) = 0;
+        virtual void removeQuad(uint32_t quadId) = 0;
+        virtual void clear() = 0;
+
+        virtual uint32_t getQuadCount() const = 0;
+
+        // Closest quad (from either side) along the -Z axis of the ray. The ray and the quads must be located in the
+        // same space.
+        virtual bool hitTest(const XrPosef& ray, Hit& hit) = 0;
+    };
+
+    std::shared_ptr<IHitTester> createHitTester();
+
+    // Test a single quad, with the same math as the hit tester. The quad identifier of the hit is always 0.
+    bool hitTestQuad(const XrPosef& ray, const XrPosef& quadCenter, const XrExtent2Df& quadSize, Hit& hit);
+
+    // Test the visible part of a cylinder, as described for XrCompositionLayerCylinderKHR: an arc of centralAngle
+    // radians around the Y axis of the pose, centered on -Z, with a height of radius * centralAngle / aspectRatio. The
+    // UV coordinates follow the same convention as for quads, when looking from inside the cylinder.
+    bool hitTestCylinder(const XrPosef& ray,
+                         const XrPosef& cylinderCenter,
+                         float radius,
+                         float centralAngle,
+                         float aspectRatio,
+                         Hit& hit);
+
+} // namespace openxr_api_layer::utils::hittest
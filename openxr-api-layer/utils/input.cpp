@@ -374,7 +374,12 @@ namespace {
             if (XR_SUCCEEDED(result)) {
                 std::unique_lock lock(m_frameMutex);
 
-                m_waitedFrameTime.push_back(frameState->predictedDisplayTime);
+                if (m_waitedFrameCount == std::size(m_waitedFrameTime)) {
+                    // Only with an application waiting frames without beginning them: forget the oldest.
+                    std::copy(std::begin(m_waitedFrameTime) + 1, std::end(m_waitedFrameTime), m_waitedFrameTime);
+                    m_waitedFrameCount--;
+                }
+                m_waitedFrameTime[m_waitedFrameCount++] = frameState->predictedDisplayTime;
             }
 
             TraceLoggingWriteStop(local,
@@ -483,8 +488,11 @@ namespace {
                 }
 
                 // We keep track of the current frame time in order to query the tracking information for that frame.
-                m_currentFrameTime = m_waitedFrameTime.front();
-                m_waitedFrameTime.pop_front();
+                if (m_waitedFrameCount) {
+                    m_currentFrameTime = m_waitedFrameTime[0];
+                    std::copy(m_waitedFrameTime + 1, m_waitedFrameTime + m_waitedFrameCount, m_waitedFrameTime);
+                    m_waitedFrameCount--;
+                }
             }
 
             TraceLoggingWriteStop(local, "InputFramework_BeginFrame", TLArg(xr::ToCString(result), "Result"));
@@ -577,7 +585,10 @@ namespace {
         bool m_isInteractionProfileValid{false};
 
         std::mutex m_frameMutex;
-        std::deque<XrTime> m_waitedFrameTime;
+        // Frames waited but not begun yet, oldest first. A fixed queue, since a deque allocates as it rolls over. The
+        // runtime does not let more than a couple of frames be waited ahead of xrBeginFrame().
+        XrTime m_waitedFrameTime[4]{};
+        uint32_t m_waitedFrameCount{0};
         XrTime m_currentFrameTime{0};
 
         PFN_xrPollEvent xrPollEvent{nullptr};
@@ -0,0 +1,528 @@
+// MIT License
+//
+// Copyright(c) 2022-2023 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cmath>
+
+// A small vector, quaternion and pose library for the gaze pipeline, so that it does not depend on DirectXMath and
+// builds on any compiler. Conventions follow xr::math: multiplyQuaternions(a, b) and multiplyPoses(a, b) apply a then
+// b, and forward is -Z.
+//
+// All backends evaluate every operation in the same order and only use operations that are correctly rounded in
+// IEEE-754 (add, subtract, multiply, divide, square root), so they produce bit-identical results, provided that the
+// compiler does not contract multiply-adds (MSVC /fp:precise does not, GCC and Clang need -ffp-contract=off on ARM).
+// The only exception is minimum() and maximum() with NaN inputs on NEON.
+// Compared to DirectXMath, results differ in the last bit or two due to a different order of operations, and by up
+// to 1e-6 where DirectXMath uses polynomial approximations of sin/cos/acos (slerp and roll/pitch/yaw rotations).
+//
+// Define VECTORMATH_FORCE_SCALAR to use the scalar backend on any architecture.
+#if defined(VECTORMATH_FORCE_SCALAR)
+#define VECTORMATH_SCALAR
+#elif defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VECTORMATH_SSE2
+#include <emmintrin.h>
+#elif defined(_M_ARM64) || defined(__ARM_NEON)
+#define VECTORMATH_NEON
+#include <arm_neon.h>
+#else
+#define VECTORMATH_SCALAR
+#endif
+
+namespace openxr_api_layer::utils::vectormath {
+
+    // Backend primitives. Everything below the backends is written in terms of these only.
+#if defined(VECTORMATH_SSE2)
+    using Vector = __m128;
+
+    static inline Vector set(float x, float y, float z, float w = 0.f) {
+        return _mm_set_ps(w, z, y, x);
+    }
+
+    static inline Vector splat(float value) {
+        return _mm_set1_ps(value);
+    }
+
+    static inline Vector load4(const float* values) {
+        return _mm_loadu_ps(values);
+    }
+
+    static inline void store4(float* values, Vector v) {
+        _mm_storeu_ps(values, v);
+    }
+
+    static inline float getX(Vector v) {
+        return _mm_cvtss_f32(v);
+    }
+
+    static inline float getY(Vector v) {
+        return _mm_cvtss_f32(_mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)));
+    }
+
+    static inline float getZ(Vector v) {
+        return _mm_cvtss_f32(_mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2)));
+    }
+
+    static inline float getW(Vector v) {
+        return _mm_cvtss_f32(_mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3)));
+    }
+
+    static inline Vector add(Vector a, Vector b) {
+        return _mm_add_ps(a, b);
+    }
+
+    static inline Vector subtract(Vector a, Vector b) {
+        return _mm_sub_ps(a, b);
+    }
+
+    static inline Vector multiply(Vector a, Vector b) {
+        return _mm_mul_ps(a, b);
+    }
+
+    static inline Vector divide(Vector a, Vector b) {
+        return _mm_div_ps(a, b);
+    }
+
+    static inline Vector negate(Vector v) {
+        return _mm_xor_ps(v, _mm_set1_ps(-0.f));
+    }
+
+    static inline Vector squareRoot(Vector v) {
+        return _mm_sqrt_ps(v);
+    }
+
+    // Per lane a < b ? a : b.
+    static inline Vector minimum(Vector a, Vector b) {
+        return _mm_min_ps(a, b);
+    }
+
+    // Per lane a > b ? a : b.
+    static inline Vector maximum(Vector a, Vector b) {
+        return _mm_max_ps(a, b);
+    }
+
+    // (y, z, x, w)
+    static inline Vector swizzleYZX(Vector v) {
+        return _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 0, 2, 1));
+    }
+
+    // (z, x, y, w)
+    static inline Vector swizzleZXY(Vector v) {
+        return _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 1, 0, 2));
+    }
+
+    // (x * x' + y * y') + z * z'
+    static inline float dot3(Vector a, Vector b) {
+        const __m128 products = _mm_mul_ps(a, b);
+        const __m128 sum = _mm_add_ss(products, _mm_shuffle_ps(products, products, _MM_SHUFFLE(1, 1, 1, 1)));
+        return _mm_cvtss_f32(_mm_add_ss(sum, _mm_shuffle_ps(products, products, _MM_SHUFFLE(2, 2, 2, 2))));
+    }
+
+    // ((x * x' + y * y') + z * z') + w * w'
+    static inline float dot4(Vector a, Vector b) {
+        const __m128 products = _mm_mul_ps(a, b);
+        __m128 sum = _mm_add_ss(products, _mm_shuffle_ps(products, products, _MM_SHUFFLE(1, 1, 1, 1)));
+        sum = _mm_add_ss(sum, _mm_shuffle_ps(products, products, _MM_SHUFFLE(2, 2, 2, 2)));
+        return _mm_cvtss_f32(_mm_add_ss(sum, _mm_shuffle_ps(products, products, _MM_SHUFFLE(3, 3, 3, 3))));
+    }
+#elif defined(VECTORMATH_NEON)
+    using Vector = float32x4_t;
+
+    static inline Vector set(float x, float y, float z, float w = 0.f) {
+        const float values[4] = {x, y, z, w};
+        return vld1q_f32(values);
+    }
+
+    static inline Vector splat(float value) {
+        return vdupq_n_f32(value);
+    }
+
+    static inline Vector load4(const float* values) {
+        return vld1q_f32(values);
+    }
+
+    static inline void store4(float* values, Vector v) {
+        vst1q_f32(values, v);
+    }
+
+    static inline float getX(Vector v) {
+        return vgetq_lane_f32(v, 0);
+    }
+
+    static inline float getY(Vector v) {
+        return vgetq_lane_f32(v, 1);
+    }
+
+    static inline float getZ(Vector v) {
+        return vgetq_lane_f32(v, 2);
+    }
+
+    static inline float getW(Vector v) {
+        return vgetq_lane_f32(v, 3);
+    }
+
+    static inline Vector add(Vector a, Vector b) {
+        return vaddq_f32(a, b);
+    }
+
+    static inline Vector subtract(Vector a, Vector b) {
+        return vsubq_f32(a, b);
+    }
+
+    static inline Vector multiply(Vector a, Vector b) {
+        return vmulq_f32(a, b);
+    }
+
+    static inline Vector divide(Vector a, Vector b) {
+        return vdivq_f32(a, b);
+    }
+
+    static inline Vector negate(Vector v) {
+        return vnegq_f32(v);
+    }
+
+    static inline Vector squareRoot(Vector v) {
+        return vsqrtq_f32(v);
+    }
+
+    // Per lane a < b ? a : b (except for NaN, which propagates).
+    static inline Vector minimum(Vector a, Vector b) {
+        return vminq_f32(a, b);
+    }
+
+    // Per lane a > b ? a : b (except for NaN, which propagates).
+    static inline Vector maximum(Vector a, Vector b) {
+        return vmaxq_f32(a, b);
+    }
+
+    // (y, z, x, w)
+    static inline Vector swizzleYZX(Vector v) {
+        // (y, z, w, x) with the last two lanes swapped back.
+        const Vector rotated = vextq_f32(v, v, 1);
+        return vsetq_lane_f32(getW(v), vsetq_lane_f32(getX(v), rotated, 2), 3);
+    }
+
+    // (z, x, y, w)
+    static inline Vector swizzleZXY(Vector v) {
+        // (z, w, x, y) with the second lane moved to the end.
+        const Vector rotated = vextq_f32(v, v, 2);
+        return vsetq_lane_f32(getW(v), vsetq_lane_f32(getX(v), vsetq_lane_f32(getY(v), rotated, 2), 1), 3);
+    }
+
+    // (x * x' + y * y') + z * z'
+    static inline float dot3(Vector a, Vector b) {
+        const float32x4_t products = vmulq_f32(a, b);
+        return (vgetq_lane_f32(products, 0) + vgetq_lane_f32(products, 1)) + vgetq_lane_f32(products, 2);
+    }
+
+    // ((x * x' + y * y') + z * z') + w * w'
+    static inline float dot4(Vector a, Vector b) {
+        const float32x4_t products = vmulq_f32(a, b);
+        return ((vgetq_lane_f32(products, 0) + vgetq_lane_f32(products, 1)) + vgetq_lane_f32(products, 2)) +
+               vgetq_lane_f32(products, 3);
+    }
+#else
+    struct Vector {
+        float x, y, z, w;
+    };
+
+    static inline Vector set(float x, float y, float z, float w = 0.f) {
+        return {x, y, z, w};
+    }
+
+    static inline Vector splat(float value) {
+        return {value, value, value, value};
+    }
+
+    static inline Vector load4(const float* values) {
+        return {values[0], values[1], values[2], values[3]};
+    }
+
+    static inline void store4(float* values, Vector v) {
+        values[0] = v.x;
+        values[1] = v.y;
+        values[2] = v.z;
+        values[3] = v.w;
+    }
+
+    static inline float getX(Vector v) {
+        return v.x;
+    }
+
+    static inline float getY(Vector v) {
+        return v.y;
+    }
+
+    static inline float getZ(Vector v) {
+        return v.z;
+    }
+
+    static inline float getW(Vector v) {
+        return v.w;
+    }
+
+    static inline Vector add(Vector a, Vector b) {
+        return {a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w};
+    }
+
+    static inline Vector subtract(Vector a, Vector b) {
+        return {a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w};
+    }
+
+    static inline Vector multiply(Vector a, Vector b) {
+        return {a.x * b.x, a.y * b.y, a.z * b.z, a.w * b.w};
+    }
+
+    static inline Vector divide(Vector a, Vector b) {
+        return {a.x / b.x, a.y / b.y, a.z / b.z, a.w / b.w};
+    }
+
+    static inline Vector negate(Vector v) {
+        return {-v.x, -v.y, -v.z, -v.w};
+    }
+
+    static inline Vector squareRoot(Vector v) {
+        return {std::sqrt(v.x), std::sqrt(v.y), std::sqrt(v.z), std::sqrt(v.w)};
+    }
+
+    // Per lane a < b ? a : b.
+    static inline Vector minimum(Vector a, Vector b) {
+        return {a.x < b.x ? a.x : b.x, a.y < b.y ? a.y : b.y, a.z < b.z ? a.z : b.z, a.w < b.w ? a.w : b.w};
+    }
+
+    // Per lane a > b ? a : b.
+    static inline Vector maximum(Vector a, Vector b) {
+        return {a.x > b.x ? a.x : b.x, a.y > b.y ? a.y : b.y, a.z > b.z ? a.z : b.z, a.w > b.w ? a.w : b.w};
+    }
+
+    // (y, z, x, w)
+    static inline Vector swizzleYZX(Vector v) {
+        return {v.y, v.z, v.x, v.w};
+    }
+
+    // (z, x, y, w)
+    static inline Vector swizzleZXY(Vector v) {
+        return {v.z, v.x, v.y, v.w};
+    }
+
+    // (x * x' + y * y') + z * z'
+    static inline float dot3(Vector a, Vector b) {
+        const Vector products = multiply(a, b);
+        return (products.x + products.y) + products.z;
+    }
+
+    // ((x * x' + y * y') + z * z') + w * w'
+    static inline float dot4(Vector a, Vector b) {
+        const Vector products = multiply(a, b);
+        return ((products.x + products.y) + products.z) + products.w;
+    }
+#endif
+
+    static inline Vector scale(Vector v, float factor) {
+        return multiply(v, splat(factor));
+    }
+
+    static inline Vector load(const XrVector3f& v, float w = 0.f) {
+        return set(v.x, v.y, v.z, w);
+    }
+
+    static inline Vector load(const XrQuaternionf& q) {
+        return set(q.x, q.y, q.z, q.w);
+    }
+
+    static inline XrVector3f storeVector3(Vector v) {
+        return {getX(v), getY(v), getZ(v)};
+    }
+
+    static inline XrQuaternionf storeQuaternion(Vector q) {
+        return {getX(q), getY(q), getZ(q), getW(q)};
+    }
+
+    // The W component of the result is 0.
+    static inline Vector cross3(Vector a, Vector b) {
+        return subtract(multiply(swizzleYZX(a), swizzleZXY(b)), multiply(swizzleZXY(a), swizzleYZX(b)));
+    }
+
+    static inline float length3(Vector v) {
+        return std::sqrt(dot3(v, v));
+    }
+
+    // A null vector is returned unchanged.
+    static inline Vector normalize3(Vector v) {
+        const float length = length3(v);
+        return length > 0.f ? divide(v, splat(length)) : v;
+    }
+
+    // A null vector is returned unchanged.
+    static inline Vector normalize4(Vector v) {
+        const float length = std::sqrt(dot4(v, v));
+        return length > 0.f ? divide(v, splat(length)) : v;
+    }
+
+    static inline Vector lerp(Vector a, Vector b, float alpha) {
+        return add(a, scale(subtract(b, a), alpha));
+    }
+
+    // The rotation a followed by the rotation b (the Hamilton product b * a), same as xr::math::Quaternion::Multiply.
+    static inline Vector multiplyQuaternions(Vector a, Vector b) {
+        const float aw = getW(a);
+        const float bw = getW(b);
+        const Vector v = add(add(scale(a, bw), scale(b, aw)), cross3(b, a));
+        const float w = aw * bw - dot3(b, a);
+        return set(getX(v), getY(v), getZ(v), w);
+    }
+
+    // Inverse of a unit quaternion.
+    static inline Vector conjugate(Vector q) {
+        return multiply(q, set(-1.f, -1.f, -1.f, 1.f));
+    }
+
+    // Rotate a vector by a unit quaternion: v + w * t + q x t, with t = 2 * (q x v).
+    static inline Vector rotate(Vector v, Vector q) {
+        const Vector t = scale(cross3(q, v), 2.f);
+        return add(add(v, scale(t, getW(q))), cross3(q, t));
+    }
+
+    // Spherical interpolation along the shortest arc, falling back to linear interpolation for nearly identical
+    // rotations (with the same threshold as DirectX::XMQuaternionSlerp).
+    static inline Vector slerp(Vector a, Vector b, float alpha) {
+        float cosOmega = dot4(a, b);
+        if (cosOmega < 0.f) {
+            b = negate(b);
+            cosOmega = -cosOmega;
+        }
+
+        float scaleA = 1.f - alpha;
+        float scaleB = alpha;
+        if (cosOmega < 1.f - 0.00001f) {
+            const float omega = std::acos(cosOmega);
+            const float sinOmega = std::sin(omega);
+            scaleA = std::sin(scaleA * omega) / sinOmega;
+            scaleB = std::sin(scaleB * omega) / sinOmega;
+        }
+        return add(scale(a, scaleA), scale(b, scaleB));
+    }
+
+    // Rotation by roll (around Z), then pitch (around X), then yaw (around Y), in radians. Same convention as
+    // DirectX::XMQuaternionRotationRollPitchYaw.
+    static inline Vector quaternionFromRollPitchYaw(float pitch, float yaw, float roll) {
+        const float sp = std::sin(pitch / 2.f), cp = std::cos(pitch / 2.f);
+        const float sy = std::sin(yaw / 2.f), cy = std::cos(yaw / 2.f);
+        const float sr = std::sin(roll / 2.f), cr = std::cos(roll / 2.f);
+        return set(sp * cy * cr + cp * sy * sr,
+                   cp * sy * cr - sp * cy * sr,
+                   cp * cy * sr - sp * sy * cr,
+                   cp * cy * cr + sp * sy * sr);
+    }
+
+    // Rotation mapping the X, Y and Z axes onto the given orthonormal basis.
+    static inline Vector quaternionFromAxes(Vector xAxis, Vector yAxis, Vector zAxis) {
+        const float m00 = getX(xAxis), m10 = getY(xAxis), m20 = getZ(xAxis);
+        const float m01 = getX(yAxis), m11 = getY(yAxis), m21 = getZ(yAxis);
+        const float m02 = getX(zAxis), m12 = getY(zAxis), m22 = getZ(zAxis);
+
+        // Pick the largest component to divide by, for numerical stability.
+        const float trace = m00 + m11 + m22;
+        if (trace > 0.f) {
+            const float s = std::sqrt(trace + 1.f) * 2.f;
+            return set((m21 - m12) / s, (m02 - m20) / s, (m10 - m01) / s, s / 4.f);
+        } else if (m00 > m11 && m00 > m22) {
+            const float s = std::sqrt(1.f + m00 - m11 - m22) * 2.f;
+            return set(s / 4.f, (m01 + m10) / s, (m02 + m20) / s, (m21 - m12) / s);
+        } else if (m11 > m22) {
+            const float s = std::sqrt(1.f + m11 - m00 - m22) * 2.f;
+            return set((m01 + m10) / s, s / 4.f, (m12 + m21) / s, (m02 - m20) / s);
+        } else {
+            const float s = std::sqrt(1.f + m22 - m00 - m11) * 2.f;
+            return set((m02 + m20) / s, (m12 + m21) / s, s / 4.f, (m10 - m01) / s);
+        }
+    }
+
+    struct Pose {
+        Vector orientation;
+        Vector position;
+    };
+
+    static inline Pose load(const XrPosef& pose) {
+        return {load(pose.orientation), load(pose.position)};
+    }
+
+    static inline XrPosef storePose(const Pose& pose) {
+        return {storeQuaternion(pose.orientation), storeVector3(pose.position)};
+    }
+
+    // The pose a followed by the pose b, same as xr::math::Pose::Multiply.
+    static inline Pose multiplyPoses(const Pose& a, const Pose& b) {
+        return {multiplyQuaternions(a.orientation, b.orientation), add(rotate(a.position, b.orientation), b.position)};
+    }
+
+    static inline Pose invertPose(const Pose& pose) {
+        const Vector orientation = conjugate(pose.orientation);
+        return {orientation, rotate(negate(pose.position), orientation)};
+    }
+
+    static inline Vector transformPoint(const Pose& pose, Vector point) {
+        return add(rotate(point, pose.orientation), pose.position);
+    }
+
+    // Same as xr::math::Pose::Slerp.
+    static inline Pose slerpPoses(const Pose& a, const Pose& b, float alpha) {
+        return {slerp(a.orientation, b.orientation, alpha), lerp(a.position, b.position, alpha)};
+    }
+
+    // Double-sided ray/triangle intersection (Moller-Trumbore). Only hits in front of the origin are reported, with
+    // their distance in multiples of the direction's length.
+    static inline bool intersectRayTriangle(
+        Vector origin, Vector direction, Vector v0, Vector v1, Vector v2, float& distance) {
+        // Same threshold as DirectX::TriangleTests::Intersects() for parallel rays.
+        constexpr float k_epsilon = 1e-20f;
+
+        const Vector edge1 = subtract(v1, v0);
+        const Vector edge2 = subtract(v2, v0);
+        const Vector p = cross3(direction, edge2);
+        const float determinant = dot3(edge1, p);
+        if (std::abs(determinant) < k_epsilon) {
+            return false;
+        }
+
+        const Vector s = subtract(origin, v0);
+        const float u = dot3(s, p) / determinant;
+        if (u < 0.f || u > 1.f) {
+            return false;
+        }
+
+        const Vector q = cross3(s, edge1);
+        const float v = dot3(direction, q) / determinant;
+        if (v < 0.f || u + v > 1.f) {
+            return false;
+        }
+
+        const float t = dot3(edge2, q) / determinant;
+        if (t < 0.f) {
+            return false;
+        }
+
+        distance = t;
+        return true;
+    }
+
+} // namespace openxr_api_layer::utils::vectormath
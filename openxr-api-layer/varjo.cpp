@@ -27,6 +27,7 @@
 #include <util.h>
 
 #include "trackers.h"
+#include "utils/gaze.h"
 
 namespace openxr_api_layer {
 
@@ -103,7 +104,7 @@ namespace openxr_api_layer {
             return true;
         }
 
-        bool getGaze(XrTime time, XrVector3f& unitVector) override {
+        bool getGaze(XrTime time, GazeSample& sample) override {
             const auto gaze = varjo_GetGaze(m_varjoSession);
             TraceLoggingWrite(g_traceProvider,
                               "VarjoEyeTracker_GetGaze",
@@ -126,9 +127,12 @@ namespace openxr_api_layer {
                                         .c_str(),
                                     "RightForward"));
 
-            unitVector.x = (float)(gaze.leftEye.forward[0] + gaze.rightEye.forward[0]) / 2.f;
-            unitVector.y = (float)(gaze.leftEye.forward[1] + gaze.rightEye.forward[1]) / 2.f;
-            unitVector.z = (float)(gaze.leftEye.forward[2] + gaze.rightEye.forward[2]) / 2.f;
+            sample.unitVector = utils::gaze::averageDirections(XrVector3f{(float)gaze.leftEye.forward[0],
+                                                                   (float)gaze.leftEye.forward[1],
+                                                                   (float)gaze.leftEye.forward[2]},
+                                                        XrVector3f{(float)gaze.rightEye.forward[0],
+                                                                   (float)gaze.rightEye.forward[1],
+                                                                   (float)gaze.rightEye.forward[2]});
 
             return true;
         }
@@ -27,6 +27,7 @@
 #include <util.h>
 
 #include "trackers.h"
+#include "utils/gaze.h"
 
 #include "BodyState.h"
 
@@ -77,14 +78,16 @@ namespace openxr_api_layer {
             if (!(m_sharedState->LeftEyeIsValid && m_sharedState->RightEyeIsValid)) {
                 return false;
             }
-            if (!(m_sharedState->LeftEyeConfidence > 0.5f && m_sharedState->RightEyeConfidence > 0.5f)) {
+            const float minimumConfidence = config::GetSettings().minimumConfidence;
+            if (!(m_sharedState->LeftEyeConfidence > minimumConfidence &&
+                  m_sharedState->RightEyeConfidence > minimumConfidence)) {
                 return false;
             }
 
             return true;
         }
 
-        bool getGaze(XrTime time, XrVector3f& unitVector) override {
+        bool getGaze(XrTime time, GazeSample& sample) override {
             if (!isGazeAvailable(time)) {
                 return false;
             }
@@ -112,13 +115,8 @@ namespace openxr_api_layer {
                               TLArg(xr::ToString(eyeGaze[xr::StereoView::Right]).c_str(), "RightGazePose"));
 
             // Average the poses from both eyes.
-            const auto gaze = xr::math::LoadXrPose(
-                xr::math::Pose::Slerp(eyeGaze[xr::StereoView::Left], eyeGaze[xr::StereoView::Right], 0.5f));
-            const auto gazeProjectedPoint =
-                DirectX::XMVector3Transform(DirectX::XMVectorSet(0.f, 0.f, -1.f, 1.f), gaze);
-
-            unitVector = xr::math::Normalize(
-                {gazeProjectedPoint.m128_f32[0], gazeProjectedPoint.m128_f32[1], gazeProjectedPoint.m128_f32[2]});
+            sample.unitVector =
+                utils::gaze::directionFromEyePoses(eyeGaze[xr::StereoView::Left], eyeGaze[xr::StereoView::Right]);
 
             return true;
         }
@@ -27,6 +27,7 @@
 #include <util.h>
 
 #include "trackers.h"
+#include "utils/gaze.h"
 
 #include <osc/OscReceivedElements.h>
 #include <osc/OscPacketListener.h>
@@ -37,43 +38,88 @@ namespace openxr_api_layer {
     using namespace log;
 
     struct VRChatOSCEyeTracker : IEyeTracker, osc::OscPacketListener {
-          //VRChat's packets run over port 9000. This can be set to other ports if the software supports, we're using port 9020 here.
-        VRChatOSCEyeTracker() : m_socket(IpEndpointName(IpEndpointName::ANY_ADDRESS, 9020), this) {
+          //VRChat's packets run over port 9000. This can be set to other ports if the software supports, we're using port 9020 by default (VRChatOSCPort setting).
+        VRChatOSCEyeTracker()
+            : m_port(config::GetSettings().vrchatOscPort),
+              m_socket(std::make_unique<UdpListeningReceiveSocket>(IpEndpointName(IpEndpointName::ANY_ADDRESS, m_port),
+                                                                   this)) {
         }
 
         ~VRChatOSCEyeTracker() override {
-            if (m_started) {
-                m_socket.AsynchronousBreak();
-                m_listeningThread.join();
-            }
+            setActive(false);
         }
 
         void start(XrSession session) override {
-            m_listeningThread = std::thread([&]() { m_socket.Run(); });
-            m_started = true;
+            setActive(true);
         }
 
         void stop() override {
+            setActive(false);
         }
 
         bool isGazeAvailable(XrTime time) const override {
             const auto now = std::chrono::high_resolution_clock::now();
             {
-                std::unique_lock lock(m_mutex);
-                return (now - m_lastReceivedTime).count() < 1'000'000'000;
+                auto lock = lockTrackerState(m_mutex);
+                return now - m_lastReceivedTime < config::GetSettings().sampleTimeout;
             }
         }
 
-        bool getGaze(XrTime time, XrVector3f& unitVector) override {
+        bool getGaze(XrTime time, GazeSample& sample) override {
             if (!isGazeAvailable(time)) {
                 return false;
             }
 
-            std::unique_lock lock(m_mutex);
-            unitVector = m_latestGaze;
+            auto lock = lockTrackerState(m_mutex);
+            sample.unitVector = m_latestGaze;
+            sample.acquisitionTime = m_lastReceivedTime;
             return true;
         }
 
+        // Parking stops the receive loop. Messages received meanwhile are buffered by the socket, and processed upon
+        // resuming.
+        void setActive(bool active) override {
+            std::unique_lock lock(m_listeningMutex);
+            if (active == m_listeningThread.joinable()) {
+                return;
+            }
+
+            TraceLoggingWrite(g_traceProvider, "VRChatOSCEyeTracker_SetActive", TLArg(active, "Active"));
+
+            if (active) {
+                // The port may have been changed in the settings.
+                const uint16_t port = config::GetSettings().vrchatOscPort;
+                if (port != m_port) {
+                    try {
+                        m_socket = std::make_unique<UdpListeningReceiveSocket>(
+                            IpEndpointName(IpEndpointName::ANY_ADDRESS, port), this);
+                        m_port = port;
+                        Log(fmt::format("VRChat OSC: listening on port {}\n", m_port));
+                    } catch (std::exception& exc) {
+                        ErrorLog(fmt::format("VRChat OSC: cannot listen on port {}: {}\n", port, exc.what()));
+                    }
+                }
+
+                m_isListening = true;
+                m_listeningThread = std::thread([&]() {
+                    const auto policy = applyAcquisitionThreadPolicy("VRChat OSC");
+                    m_socket->Run();
+                    {
+                        std::unique_lock lock(m_listeningMutex);
+                        m_isListening = false;
+                    }
+                    m_listeningExited.notify_all();
+                });
+            } else {
+                // A break requested before the receive loop is entered is lost, so keep requesting until it exits.
+                while (m_isListening) {
+                    m_socket->AsynchronousBreak();
+                    m_listeningExited.wait_for(lock, std::chrono::milliseconds(1), [&] { return !m_isListening; });
+                }
+                m_listeningThread.join();
+            }
+        }
+
         TrackerType getType() const override {
             return TrackerType::VRChatOSC;
         }
@@ -93,16 +139,11 @@ namespace openxr_api_layer {
 
                     // Convert degrees to radians for trigonometric functions
                     // Need to invert pitch because that's what mbucchia's code wants
-                    const float leftPitchRad = leftPitch * M_PI / 180.0f * -1.0f;
-                    const float leftYawRad = leftYaw * M_PI / 180.0f;
-                    const float rightPitchRad = rightPitch * M_PI / 180.0f * -1.0f;
-                    const float rightYawRad = rightYaw * M_PI / 180.0f;
-
-                    XrVector3f unitVector = {
-                        (sin(leftYawRad) * cos(leftPitchRad) + sin(rightYawRad) * cos(rightPitchRad)) / 2,
-                        (sin(leftPitchRad) + sin(rightPitchRad)) / 2,
-                        (-cos(leftYawRad) * cos(leftPitchRad) - cos(rightYawRad) * cos(rightPitchRad)) / 2
-                    };
+                    const XrVector3f unitVector = utils::gaze::averageDirections(
+                        utils::gaze::directionFromAngles(utils::gaze::degreesToRadians(leftYaw),
+                                                         -utils::gaze::degreesToRadians(leftPitch)),
+                        utils::gaze::directionFromAngles(utils::gaze::degreesToRadians(rightYaw),
+                                                         -utils::gaze::degreesToRadians(rightPitch)));
                    
                     TraceLoggingWrite(g_traceProvider,
                                         "VRChatOSCEyeTracker_ProcessMessage",
@@ -112,7 +153,7 @@ namespace openxr_api_layer {
                                         TLArg(rightYaw, "RightYaw"));
 
                     if (!(std::isnan(leftPitch) || std::isnan(leftYaw) || std::isnan(rightPitch) || std::isnan(rightYaw))) {
-                        std::unique_lock lock(m_mutex);
+                        auto lock = lockTrackerState(m_mutex);
                         m_latestGaze = unitVector;
                         m_lastReceivedTime = now;
                     }
@@ -122,9 +163,12 @@ namespace openxr_api_layer {
             }
         }
 
-        bool m_started{false};
+        std::mutex m_listeningMutex;
+        std::condition_variable m_listeningExited;
+        bool m_isListening{false};
         std::thread m_listeningThread;
-        UdpListeningReceiveSocket m_socket;
+        uint16_t m_port;
+        std::unique_ptr<UdpListeningReceiveSocket> m_socket;
         mutable std::mutex m_mutex;
         XrVector3f m_latestGaze{};
         std::chrono::high_resolution_clock::time_point m_lastReceivedTime{};
@@ -0,0 +1,99 @@
+# Polls the live metrics exported by the layer in an OpenXR application.
+# Usage: Watch-Metrics.ps1 -ProcessName <name> | -Id <pid> [-Interval <seconds>] [-Once]
+param(
+	[string]$ProcessName,
+	[int]$Id,
+	[double]$Interval = 1,
+	[switch]$Once
+)
+
+Add-Type -AssemblyName System.Core
+
+If (-not $Id) {
+	If (-not $ProcessName) {
+		Write-Error "Specify -ProcessName or -Id"
+		exit 1
+	}
+	$Id = (Get-Process -Name $ProcessName -ErrorAction Stop | Select-Object -First 1).Id
+}
+
+$SegmentName = "Local\OpenXR-Eye-Trackers.Metrics.$Id"
+Try {
+	$Mapping = [System.IO.MemoryMappedFiles.MemoryMappedFile]::OpenExisting($SegmentName, [System.IO.MemoryMappedFiles.MemoryMappedFileRights]::Read)
+} Catch {
+	Write-Error "No metrics found for process $Id (is the layer active?)"
+	exit 1
+}
+$View = $Mapping.CreateViewAccessor(0, 0, [System.IO.MemoryMappedFiles.MemoryMappedFileAccess]::Read)
+
+# See framework\metrics.h for the layout.
+If ($View.ReadUInt32(0) -ne 0x544d5258 -or $View.ReadUInt32(4) -ne 2) {
+	Write-Error "Unsupported metrics version"
+	exit 1
+}
+$NameSize = $View.ReadUInt32(12)
+$CounterCount = $View.ReadUInt32(16)
+$GaugeCount = $View.ReadUInt32(20)
+$HistogramCount = $View.ReadUInt32(24)
+$BucketCount = $View.ReadUInt32(28)
+$NamesOffset = $View.ReadUInt32(32)
+$CountersOffset = $View.ReadUInt32(36)
+$GaugesOffset = $View.ReadUInt32(40)
+$HistogramsOffset = $View.ReadUInt32(44)
+$HistogramSize = (2 + $BucketCount) * 8
+
+$Names = @()
+For ($i = 0; $i -lt $CounterCount + $GaugeCount + $HistogramCount; $i++) {
+	$Bytes = New-Object byte[] $NameSize
+	[void]$View.ReadArray($NamesOffset + $i * $NameSize, $Bytes, 0, $NameSize)
+	$Names += [System.Text.Encoding]::ASCII.GetString($Bytes).TrimEnd([char]0)
+}
+
+# Upper bound (in milliseconds) of the bucket containing the given percentile.
+function Get-Percentile($Offset, $Count, $Percentile) {
+	$Target = [Math]::Max([Math]::Ceiling($Count * $Percentile / 100), 1)
+	$Accumulated = 0
+	For ($b = 0; $b -lt $BucketCount; $b++) {
+		$Accumulated += $View.ReadUInt64($Offset + 16 + $b * 8)
+		If ($Accumulated -ge $Target) {
+			return [Math]::Pow(2, $b + 1) / 1e6
+		}
+	}
+	return [double]::PositiveInfinity
+}
+
+$Previous = @{}
+While ($true) {
+	$Lines = @("Metrics for process $Id at $(Get-Date -Format 'HH:mm:ss')", "")
+	For ($i = 0; $i -lt $CounterCount; $i++) {
+		$Value = $View.ReadUInt64($CountersOffset + $i * 8)
+		$Rate = If ($Previous.ContainsKey($i)) { ($Value - $Previous[$i]) / $Interval } Else { 0 }
+		$Previous[$i] = $Value
+		$Lines += "{0,-24} {1,12} {2,10:N1}/s" -f $Names[$i], $Value, $Rate
+	}
+	$Lines += ""
+	For ($i = 0; $i -lt $GaugeCount; $i++) {
+		$Lines += "{0,-24} {1,12}" -f $Names[$CounterCount + $i], $View.ReadInt64($GaugesOffset + $i * 8)
+	}
+	$Lines += ""
+	For ($i = 0; $i -lt $HistogramCount; $i++) {
+		$Offset = $HistogramsOffset + $i * $HistogramSize
+		$Count = $View.ReadUInt64($Offset)
+		$Mean = If ($Count) { $View.ReadUInt64($Offset + 8) / $Count / 1e6 } Else { 0 }
+		$P50 = If ($Count) { Get-Percentile $Offset $Count 50 } Else { 0 }
+		$P99 = If ($Count) { Get-Percentile $Offset $Count 99 } Else { 0 }
+		$Lines += "{0,-24} count={1} mean={2:N3}ms p50<{3:N3}ms p99<{4:N3}ms" -f $Names[$CounterCount + $GaugeCount + $i], $Count, $Mean, $P50, $P99
+	}
+
+	If (-not $Once) {
+		Clear-Host
+	}
+	$Lines | Write-Output
+	If ($Once) {
+		break
+	}
+	Start-Sleep -Milliseconds ($Interval * 1000)
+}
+
+$View.Dispose()
+$Mapping.Dispose()
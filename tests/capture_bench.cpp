@@ -0,0 +1,140 @@
+// MIT License
+//
+// Copyright(c) 2022-2023 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "layer_fixture.h"
+
+#include <utils/capture.h>
+
+namespace {
+
+    using namespace openxr_api_layer::testing;
+    using namespace openxr_api_layer::tests;
+    using namespace openxr_api_layer::utils::capture;
+
+    // Records the layer would write for a session at the given tracker rate: one IsGazeAvailable and one GetGaze query
+    // per sample, for predicted display times, with a gaze wandering around the center of the view.
+    std::filesystem::path writeSession(Encoding encoding, uint32_t rate, std::chrono::seconds duration) {
+        const auto path =
+            GetTemporaryFolder() / fmt::format("session-{}-{}.gzcap", static_cast<uint32_t>(encoding), rate);
+        const auto writer = createCaptureWriter(path, 0, encoding);
+
+        std::mt19937 generator(1234);
+        std::normal_distribution<float> saccade(0.f, 0.2f);
+        std::normal_distribution<float> jitter(0.f, 0.002f);
+        std::normal_distribution<float> latency(2e6f, 3e5f);
+        std::uniform_real_distribution<float> confidence(0.8f, 1.f);
+
+        const int64_t period = 1'000'000'000 / rate;
+        const int64_t sampleCount = duration.count() * rate;
+        XrTime time = 1'000'000'000;
+        float yaw = 0.f;
+        float pitch = 0.f;
+        for (int64_t i = 0; i < sampleCount; i++) {
+            const int64_t queryOffset = i * period;
+            time += period;
+
+            Record record{};
+            record.kind = RecordKind::IsGazeAvailable;
+            record.result = true;
+            record.time = time;
+            record.queryOffset = queryOffset;
+            record.acquisitionOffset = queryOffset;
+            writer->write(record);
+
+            // A saccade every 300ms or so, with some noise in-between.
+            if (i % (rate * 3 / 10) == 0) {
+                yaw = std::clamp(yaw + saccade(generator), -0.5f, 0.5f);
+                pitch = std::clamp(pitch + saccade(generator), -0.4f, 0.4f);
+            }
+            const float sampleYaw = yaw + jitter(generator);
+            const float samplePitch = pitch + jitter(generator);
+            const XrVector3f direction{std::sin(sampleYaw) * std::cos(samplePitch),
+                                       std::sin(samplePitch),
+                                       -std::cos(sampleYaw) * std::cos(samplePitch)};
+
+            record.kind = RecordKind::GetGaze;
+            record.acquisitionOffset = queryOffset - static_cast<int64_t>(latency(generator));
+            record.unitVector = direction;
+            for (uint32_t eye = 0; eye < xr::StereoView::Count; eye++) {
+                record.eyeUnitVector[eye] = direction;
+                record.isEyeValid[eye] = true;
+            }
+            record.confidence = confidence(generator);
+            writer->write(record);
+        }
+        writer->close();
+
+        return path;
+    }
+
+} // namespace
+
+// Size of the captures per hour of session, and cost of reading them: random seeks by time, and sequential reads.
+// Sessions of 10 minutes are captured, and the sizes extrapolated.
+BENCHMARK(CaptureStorageAndSeek) {
+    constexpr auto duration = 10min;
+
+    for (const Encoding encoding : {Encoding::Lossless, Encoding::Quantized}) {
+        for (const uint32_t rate : {120u, 1000u}) {
+            const auto label = fmt::format("{}, {}Hz", encoding == Encoding::Lossless ? "lossless" : "quantized", rate);
+
+            const auto path = writeSession(encoding, rate, duration);
+            const double size = static_cast<double>(std::filesystem::file_size(path));
+            const auto reader = openCaptureReader(path);
+            const uint64_t recordCount = reader->getRecordCount();
+            CHECK(recordCount == 2 * rate * std::chrono::seconds(duration).count());
+
+            Report(fmt::format("{}: storage", label), size / recordCount, "bytes/query");
+            Report(fmt::format("{}: storage per hour", label), size * (1h / duration) / (1024 * 1024), "MB");
+            Report(fmt::format("{}: storage per hour, uncompressed records", label),
+                   static_cast<double>(recordCount * sizeof(Record)) * (1h / duration) / (1024 * 1024),
+                   "MB");
+
+            const XrTime firstTime = reader->get(0).time;
+            const XrTime lastTime = reader->get(recordCount - 1).time;
+            std::mt19937 generator(5678);
+            std::uniform_int_distribution<XrTime> times(firstTime, lastTime);
+            double checksum = 0;
+            Report(fmt::format("{}: random seek + get", label),
+                   MeasureNanoseconds(
+                       [&] {
+                           const uint64_t index = reader->seek(times(generator));
+                           if (index < recordCount) {
+                               checksum += reader->get(index).unitVector.x;
+                           }
+                       },
+                       100),
+                   "ns");
+
+            uint64_t index = 0;
+            Report(fmt::format("{}: sequential get", label),
+                   MeasureNanoseconds([&] {
+                       checksum += reader->get(index).unitVector.x;
+                       index = (index + 1) % recordCount;
+                   }),
+                   "ns");
+            Consume(checksum);
+        }
+    }
+}
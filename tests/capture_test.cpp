@@ -0,0 +1,179 @@
+// MIT License
+//
+// Copyright(c) 2022-2023 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "layer_fixture.h"
+
+#include <utils/capture.h>
+
+namespace {
+
+    using namespace openxr_api_layer::tests;
+    using namespace openxr_api_layer::utils::capture;
+
+    // Records with arbitrary values, spanning several chunks. Times mostly increase, but one in 8 goes back in time,
+    // like an application querying the gaze for a past frame.
+    std::vector<Record> generateRecords(size_t count) {
+        std::mt19937 generator(42);
+        std::uniform_real_distribution<float> component(-1.5f, 1.5f);
+        std::uniform_real_distribution<float> unit(0.f, 1.f);
+        std::uniform_int_distribution<int64_t> step(1'000'000, 20'000'000);
+
+        std::vector<Record> records(count);
+        XrTime time = 1'000'000'000;
+        int64_t queryOffset = 0;
+        for (size_t i = 0; i < count; i++) {
+            Record& record = records[i];
+            record.kind = i % 3 ? RecordKind::GetGaze : RecordKind::IsGazeAvailable;
+            record.result = unit(generator) > 0.1f;
+            time += step(generator);
+            record.time = i % 8 == 7 ? time - 200'000'000 : time;
+            queryOffset += step(generator) / 2;
+            record.queryOffset = queryOffset;
+            record.acquisitionOffset = queryOffset;
+            if (record.kind == RecordKind::GetGaze) {
+                record.acquisitionOffset -= step(generator);
+                record.unitVector = {component(generator), component(generator), component(generator)};
+                for (uint32_t eye = 0; eye < xr::StereoView::Count; eye++) {
+                    record.isEyeValid[eye] = unit(generator) > 0.2f;
+                    if (record.isEyeValid[eye]) {
+                        record.eyeUnitVector[eye] = {component(generator), component(generator), component(generator)};
+                    }
+                }
+                record.confidence = unit(generator);
+            }
+        }
+        return records;
+    }
+
+    std::filesystem::path writeCapture(const std::vector<Record>& records, Encoding encoding) {
+        const auto path = GetTemporaryFolder() / fmt::format("records-{}.gzcap", static_cast<uint32_t>(encoding));
+        const auto writer = createCaptureWriter(path, 0, encoding);
+        for (const Record& record : records) {
+            writer->write(record);
+        }
+        writer->close();
+        return path;
+    }
+
+    bool isBitIdentical(const XrVector3f& a, const XrVector3f& b) {
+        return memcmp(&a, &b, sizeof(a)) == 0;
+    }
+
+} // namespace
+
+TEST(CaptureIsLossless) {
+    const auto records = generateRecords(k_chunkCapacity * 3 + 17);
+    const auto reader = openCaptureReader(writeCapture(records, Encoding::Lossless));
+    CHECK(reader->getEncoding() == Encoding::Lossless);
+    CHECK(reader->getRecordCount() == records.size());
+
+    for (size_t i = 0; i < records.size(); i++) {
+        const Record& expected = records[i];
+        const Record& actual = reader->get(i);
+        CHECK(actual.kind == expected.kind);
+        CHECK(actual.result == expected.result);
+        CHECK(actual.time == expected.time);
+        CHECK(actual.queryOffset == expected.queryOffset);
+        CHECK(actual.acquisitionOffset == expected.acquisitionOffset);
+        if (expected.kind == RecordKind::GetGaze) {
+            CHECK(isBitIdentical(actual.unitVector, expected.unitVector));
+            for (uint32_t eye = 0; eye < xr::StereoView::Count; eye++) {
+                CHECK(actual.isEyeValid[eye] == expected.isEyeValid[eye]);
+                if (expected.isEyeValid[eye]) {
+                    CHECK(isBitIdentical(actual.eyeUnitVector[eye], expected.eyeUnitVector[eye]));
+                }
+            }
+            CHECK(memcmp(&actual.confidence, &expected.confidence, sizeof(float)) == 0);
+        }
+    }
+}
+
+TEST(CaptureQuantizedIsAccurate) {
+    auto records = generateRecords(k_chunkCapacity + 5);
+    for (Record& record : records) {
+        // Quantization is meant for unit directions.
+        const auto normalize = [](XrVector3f& v) {
+            const float length = std::sqrt(v.x * v.x + v.y * v.y + v.z * v.z);
+            v = {v.x / length, v.y / length, v.z / length};
+        };
+        normalize(record.unitVector);
+        for (uint32_t eye = 0; eye < xr::StereoView::Count; eye++) {
+            if (record.isEyeValid[eye]) {
+                normalize(record.eyeUnitVector[eye]);
+            }
+        }
+    }
+    const auto reader = openCaptureReader(writeCapture(records, Encoding::Quantized));
+    CHECK(reader->getEncoding() == Encoding::Quantized);
+    CHECK(reader->getRecordCount() == records.size());
+
+    // In degrees, from the chord between the directions (acos() of their dot product is too imprecise here).
+    const auto getAngle = [](const XrVector3f& a, const XrVector3f& b) {
+        const double lengthA = std::sqrt((double)a.x * a.x + (double)a.y * a.y + (double)a.z * a.z);
+        const double lengthB = std::sqrt((double)b.x * b.x + (double)b.y * b.y + (double)b.z * b.z);
+        const double dx = a.x / lengthA - b.x / lengthB;
+        const double dy = a.y / lengthA - b.y / lengthB;
+        const double dz = a.z / lengthA - b.z / lengthB;
+        return 2 * std::asin(std::sqrt(dx * dx + dy * dy + dz * dz) / 2) * 180 / M_PI;
+    };
+    for (size_t i = 0; i < records.size(); i++) {
+        const Record& expected = records[i];
+        const Record& actual = reader->get(i);
+        CHECK(actual.time == expected.time);
+        CHECK(actual.queryOffset == expected.queryOffset);
+        if (expected.kind == RecordKind::GetGaze) {
+            CHECK_NEAR(getAngle(actual.unitVector, expected.unitVector), 0, 0.005);
+            for (uint32_t eye = 0; eye < xr::StereoView::Count; eye++) {
+                if (expected.isEyeValid[eye]) {
+                    CHECK_NEAR(getAngle(actual.eyeUnitVector[eye], expected.eyeUnitVector[eye]), 0, 0.005);
+                }
+            }
+            CHECK_NEAR(actual.confidence, expected.confidence, 0.5 / 255 + 1e-6);
+        }
+    }
+}
+
+TEST(CaptureSeekWithNonMonotonicTimes) {
+    const auto records = generateRecords(k_chunkCapacity * 4 + 100);
+    const auto reader = openCaptureReader(writeCapture(records, Encoding::Lossless));
+
+    const auto expectedSeek = [&](XrTime time) {
+        const auto it = std::find_if(
+            records.cbegin(), records.cend(), [&](const Record& record) { return record.time >= time; });
+        return static_cast<uint64_t>(it - records.cbegin());
+    };
+
+    std::mt19937 generator(7);
+    std::uniform_int_distribution<XrTime> times(records.front().time - 1'000'000'000,
+                                                records.back().time + 1'000'000'000);
+    for (uint32_t i = 0; i < 1000; i++) {
+        const XrTime time = times(generator);
+        CHECK(reader->seek(time) == expectedSeek(time));
+    }
+    // Around the boundaries of the chunks.
+    const size_t indices[] = {0, 7, k_chunkCapacity - 1, k_chunkCapacity, k_chunkCapacity + 7, records.size() - 1};
+    for (const size_t i : indices) {
+        CHECK(reader->seek(records[i].time) == expectedSeek(records[i].time));
+    }
+}
@@ -0,0 +1,277 @@
+// MIT License
+//
+// Copyright(c) 2022-2023 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "pch.h"
+
+#include <metrics.h>
+
+#include "mock_runtime.h"
+
+namespace {
+
+    using namespace openxr_api_layer;
+    using namespace openxr_api_layer::tests;
+    using namespace openxr_api_layer::utils::graphics;
+
+    // A session without graphics bindings on the mock runtime (without the layer), with its composition framework on
+    // the CPU device. The swapchain images are shared with the composition device, or go through bounce buffers.
+    struct CompositionFixture {
+        explicit CompositionFixture(bool isShareable) {
+            mock_runtime::Reset();
+            internal::setCpuSwapchainImagesShareable(isShareable);
+
+            XrInstanceCreateInfo instanceInfo{XR_TYPE_INSTANCE_CREATE_INFO};
+            CHECK_XR(mock_runtime::xrCreateApiLayerInstance(&instanceInfo, nullptr, &instance));
+            factory = createCompositionFrameworkFactory(
+                instanceInfo, instance, mock_runtime::xrGetInstanceProcAddr, CompositionApi::CPU);
+
+            const auto xrGetSystem = getFunction<PFN_xrGetSystem>("xrGetSystem");
+            XrSystemGetInfo systemInfo{XR_TYPE_SYSTEM_GET_INFO};
+            systemInfo.formFactor = XR_FORM_FACTOR_HEAD_MOUNTED_DISPLAY;
+            XrSystemId systemId;
+            CHECK_XR(xrGetSystem(instance, &systemInfo, &systemId));
+
+            const auto xrCreateSession = getFunction<PFN_xrCreateSession>("xrCreateSession");
+            XrSessionCreateInfo sessionInfo{XR_TYPE_SESSION_CREATE_INFO};
+            sessionInfo.systemId = systemId;
+            CHECK_XR(xrCreateSession(instance, &sessionInfo, &session));
+            framework = factory->getCompositionFramework(session);
+            CHECK(framework);
+        }
+
+        ~CompositionFixture() {
+            swapchains.clear();
+            getFunction<PFN_xrDestroySession>("xrDestroySession")(session);
+            factory.reset();
+            getFunction<PFN_xrDestroyInstance>("xrDestroyInstance")(instance);
+            internal::setCpuSwapchainImagesShareable(true);
+        }
+
+        // Resolves a function of the runtime, through the hooks of the composition framework.
+        template <typename Function>
+        Function getFunction(const char* name) {
+            PFN_xrVoidFunction function;
+            CHECK_XR(mock_runtime::xrGetInstanceProcAddr(instance, name, &function));
+            factory->xrGetInstanceProcAddr_post(instance, name, &function);
+            return reinterpret_cast<Function>(function);
+        }
+
+        ISwapchain* createSwapchain(SwapchainMode mode) {
+            XrSwapchainCreateInfo info{XR_TYPE_SWAPCHAIN_CREATE_INFO};
+            info.usageFlags = XR_SWAPCHAIN_USAGE_COLOR_ATTACHMENT_BIT | XR_SWAPCHAIN_USAGE_SAMPLED_BIT;
+            info.format = framework->getPreferredSwapchainFormatOnApplicationDevice(info.usageFlags, false);
+            info.width = 64;
+            info.height = 32;
+            info.arraySize = 1;
+            info.mipCount = 1;
+            info.sampleCount = 1;
+            info.faceCount = 1;
+            swapchains.push_back(framework->createSwapchain(info, mode));
+            return swapchains.back().get();
+        }
+
+        // A swapchain created by the application, read by the composition.
+        ISwapchain* wrapApplicationSwapchain(XrSwapchain& handle) {
+            XrSwapchainCreateInfo info{XR_TYPE_SWAPCHAIN_CREATE_INFO};
+            info.usageFlags = XR_SWAPCHAIN_USAGE_COLOR_ATTACHMENT_BIT | XR_SWAPCHAIN_USAGE_SAMPLED_BIT;
+            info.format = framework->getPreferredSwapchainFormatOnApplicationDevice(info.usageFlags, false);
+            info.width = 64;
+            info.height = 32;
+            info.arraySize = 1;
+            info.mipCount = 1;
+            info.sampleCount = 1;
+            info.faceCount = 1;
+            CHECK_XR(getFunction<PFN_xrCreateSwapchain>("xrCreateSwapchain")(session, &info, &handle));
+            swapchains.push_back(framework->wrapApplicationSwapchain(handle, info, SwapchainMode::Read));
+            return swapchains.back().get();
+        }
+
+        XrInstance instance{XR_NULL_HANDLE};
+        XrSession session{XR_NULL_HANDLE};
+        std::shared_ptr<ICompositionFrameworkFactory> factory;
+        ICompositionFramework* framework{nullptr};
+        std::vector<std::shared_ptr<ISwapchain>> swapchains;
+    };
+
+    // Completes the commands submitted to the device.
+    void flush(IGraphicsDevice* device) {
+        device->createFence(false /* shareable */)->waitOnCpu(1);
+    }
+
+    uint8_t* getTexels(const IGraphicsTexture* texture) {
+        return texture->getNativeTexture<CPU>();
+    }
+
+    bool isFilledWith(const IGraphicsTexture* texture, uint8_t value) {
+        const uint8_t* const texels = getTexels(texture);
+        const XrSwapchainCreateInfo& info = texture->getInfo();
+        return std::all_of(
+            texels, texels + info.width * info.height * 4, [&](uint8_t texel) { return texel == value; });
+    }
+
+    // The application renders a frame, the composition reads it and writes over it, and the result is submitted.
+    void checkRoundTrip(bool isShareable) {
+        CompositionFixture fixture(isShareable);
+        ISwapchain* const swapchain =
+            fixture.createSwapchain(SwapchainMode::Submit | SwapchainMode::Read | SwapchainMode::Write);
+        IGraphicsDevice* const applicationDevice = fixture.framework->getApplicationDevice();
+        IGraphicsDevice* const compositionDevice = fixture.framework->getCompositionDevice();
+        const std::shared_ptr<IGraphicsTexture> overlay =
+            compositionDevice->createTexture(swapchain->getInfoOnCompositionDevice(), false /* shareable */);
+        const size_t size = 64 * 32 * 4;
+
+        constexpr uint32_t frameCount = 10;
+        for (uint32_t frame = 0; frame < frameCount; frame++) {
+            const uint8_t applicationValue = static_cast<uint8_t>(2 * frame + 1);
+            const uint8_t compositionValue = static_cast<uint8_t>(2 * frame + 2);
+
+            ISwapchainImage* const image = swapchain->acquireImage();
+            IGraphicsTexture* const applicationTexture = image->getApplicationTexture();
+            memset(getTexels(applicationTexture), applicationValue, size);
+            swapchain->releaseImage();
+
+            CHECK(swapchain->getLastReleasedImage() == image);
+            fixture.framework->serializePreComposition();
+            IGraphicsTexture* const textureForRead = image->getTextureForRead();
+            CHECK((getTexels(textureForRead) == getTexels(applicationTexture)) == isShareable);
+            flush(compositionDevice);
+            CHECK(isFilledWith(textureForRead, applicationValue));
+
+            memset(getTexels(overlay.get()), compositionValue, size);
+            compositionDevice->copyTexture(overlay.get(), image->getTextureForWrite());
+            fixture.framework->serializePostComposition();
+            swapchain->commitLastReleasedImage();
+
+            flush(applicationDevice);
+            CHECK(isFilledWith(applicationTexture, compositionValue));
+        }
+
+        CHECK(mock_runtime::GetCallCount(mock_runtime::Call::AcquireSwapchainImage) == frameCount);
+        CHECK(mock_runtime::GetCallCount(mock_runtime::Call::ReleaseSwapchainImage) == frameCount);
+    }
+
+    uint64_t readCounter(metrics::Counter counter) {
+        return metrics::internal::g_registry.counters[static_cast<uint32_t>(counter)].load();
+    }
+
+    // Every frame, the application renders into the given number of readable swapchains, and the composition reads
+    // them all. There should be a single synchronization in each direction per frame, whatever the number of
+    // swapchains.
+    void checkSynchronizationsPerFrame(bool isShareable, uint32_t swapchainCount) {
+        CompositionFixture fixture(isShareable);
+        std::vector<ISwapchain*> swapchains;
+        for (uint32_t i = 0; i < swapchainCount; i++) {
+            swapchains.push_back(fixture.createSwapchain(SwapchainMode::Submit | SwapchainMode::Read));
+        }
+
+        for (uint32_t frame = 0; frame < 10; frame++) {
+            const uint64_t applicationToCompositionSyncs = readCounter(metrics::Counter::ApplicationToCompositionSyncs);
+            const uint64_t compositionToApplicationSyncs = readCounter(metrics::Counter::CompositionToApplicationSyncs);
+
+            for (ISwapchain* swapchain : swapchains) {
+                swapchain->acquireImage();
+                swapchain->releaseImage();
+            }
+            for (ISwapchain* swapchain : swapchains) {
+                CHECK(swapchain->getLastReleasedImage());
+            }
+            fixture.framework->serializePreComposition();
+            fixture.framework->serializePostComposition();
+
+            CHECK(readCounter(metrics::Counter::ApplicationToCompositionSyncs) - applicationToCompositionSyncs == 1);
+            CHECK(readCounter(metrics::Counter::CompositionToApplicationSyncs) - compositionToApplicationSyncs == 1);
+        }
+    }
+
+} // namespace
+
+TEST(CompositionRoundTripWithSharedImages) {
+    checkRoundTrip(true);
+}
+
+TEST(CompositionRoundTripThroughBounceBuffers) {
+    checkRoundTrip(false);
+}
+
+TEST(CompositionSynchronizesOncePerFrame) {
+    for (const bool isShareable : {true, false}) {
+        for (const uint32_t swapchainCount : {1u, 4u, 16u}) {
+            checkSynchronizationsPerFrame(isShareable, swapchainCount);
+        }
+    }
+}
+
+// Without shareable images, only the swapchains read by the frame are copied to the composition device.
+TEST(CompositionBouncesOnlyTheReadSwapchains) {
+    CompositionFixture fixture(false /* isShareable */);
+    ISwapchain* const readSwapchain = fixture.createSwapchain(SwapchainMode::Submit | SwapchainMode::Read);
+    ISwapchain* const unreadSwapchain = fixture.createSwapchain(SwapchainMode::Submit | SwapchainMode::Read);
+    const size_t size = 64 * 32 * 4;
+
+    for (ISwapchain* swapchain : {readSwapchain, unreadSwapchain}) {
+        memset(getTexels(swapchain->acquireImage()->getApplicationTexture()), 1, size);
+        swapchain->releaseImage();
+    }
+
+    ISwapchainImage* const image = readSwapchain->getLastReleasedImage();
+    fixture.framework->serializePreComposition();
+    flush(fixture.framework->getCompositionDevice());
+    CHECK(isFilledWith(image->getTextureForRead(), 1));
+    CHECK(isFilledWith(unreadSwapchain->getImage(0)->getTextureForRead(), 0));
+    fixture.framework->serializePostComposition();
+}
+
+// The image released by the application is handed to the runtime after composition, and the results of the runtime
+// are returned to the application unchanged.
+TEST(CompositionHoldsApplicationImagesUntilCommit) {
+    CompositionFixture fixture(false /* isShareable */);
+    XrSwapchain handle;
+    ISwapchain* const swapchain = fixture.wrapApplicationSwapchain(handle);
+    const auto xrWaitSwapchainImage = fixture.getFunction<PFN_xrWaitSwapchainImage>("xrWaitSwapchainImage");
+    XrSwapchainImageWaitInfo waitInfo{XR_TYPE_SWAPCHAIN_IMAGE_WAIT_INFO};
+    waitInfo.timeout = XR_INFINITE_DURATION;
+
+    constexpr uint32_t frameCount = 10;
+    for (uint32_t frame = 0; frame < frameCount; frame++) {
+        uint32_t index;
+        CHECK_XR(swapchain->acquireApplicationImage(nullptr, &index));
+        CHECK_XR(xrWaitSwapchainImage(handle, &waitInfo));
+        CHECK_XR(swapchain->releaseApplicationImage(nullptr));
+        CHECK(mock_runtime::GetCallCount(mock_runtime::Call::ReleaseSwapchainImage) == frame);
+
+        CHECK(swapchain->getLastReleasedImage() == swapchain->getImage(index));
+        fixture.framework->serializePreComposition();
+        fixture.framework->serializePostComposition();
+        swapchain->commitLastReleasedImage();
+        CHECK(mock_runtime::GetCallCount(mock_runtime::Call::ReleaseSwapchainImage) == frame + 1);
+    }
+    CHECK(mock_runtime::GetCallCount(mock_runtime::Call::AcquireSwapchainImage) == frameCount);
+
+    // Nothing to release, and the runtime has no more images to acquire.
+    CHECK(swapchain->releaseApplicationImage(nullptr) == XR_ERROR_CALL_ORDER_INVALID);
+    uint32_t index;
+    for (uint32_t i = 0; i < 3; i++) {
+        CHECK_XR(swapchain->acquireApplicationImage(nullptr, &index));
+    }
+    CHECK(swapchain->acquireApplicationImage(nullptr, &index) == XR_ERROR_CALL_ORDER_INVALID);
+}
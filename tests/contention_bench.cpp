@@ -0,0 +1,207 @@
+// MIT License
+//
+// Copyright(c) 2022-2023 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "layer_fixture.h"
+
+namespace {
+
+    using namespace openxr_api_layer;
+    using namespace openxr_api_layer::tests;
+    using namespace openxr_api_layer::testing;
+
+    // Lock metrics of the layer, to report their increase over a run.
+    struct LockMetrics {
+        uint64_t actionsAndSpacesContended;
+        uint64_t actionsAndSpacesWaitCount;
+        uint64_t actionsAndSpacesWaitSum;
+        uint64_t trackerContended;
+        uint64_t trackerWaitCount;
+        uint64_t trackerWaitSum;
+
+        static LockMetrics read() {
+            const metrics::SharedHistogram& actionsAndSpacesWait =
+                ReadHistogram(metrics::Histogram::ActionsAndSpacesLockWait);
+            const metrics::SharedHistogram& trackerWait = ReadHistogram(metrics::Histogram::TrackerLockWait);
+            return {ReadCounter(metrics::Counter::ActionsAndSpacesLockContended),
+                    actionsAndSpacesWait.count.load(),
+                    actionsAndSpacesWait.sum.load(),
+                    ReadCounter(metrics::Counter::TrackerLockContended),
+                    trackerWait.count.load(),
+                    trackerWait.sum.load()};
+        }
+    };
+
+    double getMean(uint64_t sum, uint64_t count) {
+        return count ? static_cast<double>(sum) / count : 0.0;
+    }
+
+    // Returns the given percentile of the sorted latencies.
+    double getPercentile(const std::vector<uint32_t>& sortedLatencies, double percentile) {
+        if (sortedLatencies.empty()) {
+            return 0.0;
+        }
+        const size_t index = std::min(static_cast<size_t>(percentile / 100.0 * sortedLatencies.size()),
+                                      sortedLatencies.size() - 1);
+        return sortedLatencies[index];
+    }
+
+} // namespace
+
+// The calls made by the job threads of an engine, from 1 to 32 threads at once: each thread locates the eye gaze space
+// (1 call in 4), the LOCAL space (1 in 2), and queries the gaze action state or syncs the actions. Meanwhile, another
+// thread keeps creating and destroying action spaces, like an engine spawning objects. The runtime spends 2us in each
+// xrLocateSpace, so that the calls have a chance to overlap.
+BENCHMARK(LocateSpaceContention) {
+    using clock = std::chrono::steady_clock;
+
+    mock_runtime::Options options;
+    options.locateSpaceCost = 2us;
+    options.syncActionsCost = 5us;
+    LayerFixture fixture(GetReplaySettings(), options);
+    for (uint32_t i = 0; i < 200; i++) {
+        fixture.runFrame();
+    }
+
+    const XrTime time = fixture.lastDisplayTime;
+    const auto callOnce = [&](uint32_t index) {
+        XrResult result;
+        switch (index % 8) {
+        case 0:
+        case 4: {
+            XrSpaceLocation location{XR_TYPE_SPACE_LOCATION};
+            result = fixture.xr.xrLocateSpace(fixture.gazeSpace, fixture.localSpace, time, &location);
+            break;
+        }
+        case 6: {
+            XrActionStateGetInfo getInfo{XR_TYPE_ACTION_STATE_GET_INFO};
+            getInfo.action = fixture.gazeAction;
+            XrActionStatePose state{XR_TYPE_ACTION_STATE_POSE};
+            result = fixture.xr.xrGetActionStatePose(fixture.session, &getInfo, &state);
+            break;
+        }
+        case 7: {
+            const XrActiveActionSet activeActionSet{fixture.actionSet, XR_NULL_PATH};
+            XrActionsSyncInfo syncInfo{XR_TYPE_ACTIONS_SYNC_INFO};
+            syncInfo.countActiveActionSets = 1;
+            syncInfo.activeActionSets = &activeActionSet;
+            result = fixture.xr.xrSyncActions(fixture.session, &syncInfo);
+            break;
+        }
+        default: {
+            XrSpaceLocation location{XR_TYPE_SPACE_LOCATION};
+            result = fixture.xr.xrLocateSpace(fixture.localSpace, fixture.localSpace, time, &location);
+            break;
+        }
+        }
+        return result;
+    };
+
+    double singleThreadThroughput = 0;
+    for (const uint32_t threadCount : {1u, 2u, 4u, 8u, 16u, 32u}) {
+        std::atomic<bool> isStopping{false};
+        std::atomic<uint32_t> failures{0};
+        std::vector<std::vector<uint32_t>> latencies(threadCount);
+
+        const LockMetrics before = LockMetrics::read();
+
+        std::thread churn([&] {
+            while (!isStopping.load(std::memory_order_relaxed)) {
+                XrActionSpaceCreateInfo actionSpaceInfo{XR_TYPE_ACTION_SPACE_CREATE_INFO};
+                actionSpaceInfo.action = fixture.gazeAction;
+                actionSpaceInfo.poseInActionSpace = xr::math::Pose::Identity();
+                XrSpace space;
+                if (XR_SUCCEEDED(fixture.xr.xrCreateActionSpace(fixture.session, &actionSpaceInfo, &space))) {
+                    fixture.xr.xrDestroySpace(space);
+                }
+                std::this_thread::sleep_for(1ms);
+            }
+        });
+
+        const auto start = clock::now();
+        std::vector<std::thread> threads;
+        for (uint32_t i = 0; i < threadCount; i++) {
+            threads.emplace_back([&, i] {
+                std::vector<uint32_t>& threadLatencies = latencies[i];
+                threadLatencies.reserve(1 << 18);
+
+                // Offset the mix on each thread, so that the threads do not all make the same call at once.
+                uint32_t index = i;
+                while (!isStopping.load(std::memory_order_relaxed)) {
+                    const auto callStart = clock::now();
+                    if (XR_FAILED(callOnce(index++))) {
+                        failures++;
+                    }
+                    threadLatencies.push_back(static_cast<uint32_t>(
+                        std::min<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - callStart)
+                                              .count(),
+                                          UINT32_MAX)));
+                }
+            });
+        }
+
+        std::this_thread::sleep_for(500ms);
+        isStopping = true;
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        const auto elapsed = std::chrono::duration<double>(clock::now() - start).count();
+        churn.join();
+
+        const LockMetrics after = LockMetrics::read();
+
+        std::vector<uint32_t> allLatencies;
+        for (const auto& threadLatencies : latencies) {
+            allLatencies.insert(allLatencies.end(), threadLatencies.cbegin(), threadLatencies.cend());
+        }
+        std::sort(allLatencies.begin(), allLatencies.end());
+
+        const double throughput = allLatencies.size() / elapsed;
+        if (threadCount == 1) {
+            singleThreadThroughput = throughput;
+        }
+
+        fmt::print("    {} thread(s):\n", threadCount);
+        Report("  throughput", throughput / 1e6, "Mcalls/s");
+        Report("  scaling over 1 thread", throughput / singleThreadThroughput, "x");
+        Report("  latency p50", getPercentile(allLatencies, 50), "ns");
+        Report("  latency p99", getPercentile(allLatencies, 99), "ns");
+        Report("  latency p99.9", getPercentile(allLatencies, 99.9), "ns");
+        Report("  latency max", allLatencies.empty() ? 0.0 : allLatencies.back(), "ns");
+        Report("  actions and spaces lock, contended acquisitions",
+               static_cast<double>(after.actionsAndSpacesContended - before.actionsAndSpacesContended),
+               "");
+        Report("  actions and spaces lock, mean wait",
+               getMean(after.actionsAndSpacesWaitSum - before.actionsAndSpacesWaitSum,
+                       after.actionsAndSpacesWaitCount - before.actionsAndSpacesWaitCount),
+               "ns");
+        Report("  tracker lock, contended acquisitions",
+               static_cast<double>(after.trackerContended - before.trackerContended),
+               "");
+        Report("  tracker lock, mean wait",
+               getMean(after.trackerWaitSum - before.trackerWaitSum, after.trackerWaitCount - before.trackerWaitCount),
+               "ns");
+
+        CHECK(failures == 0);
+    }
+}
@@ -0,0 +1,126 @@
+// MIT License
+//
+// Copyright(c) 2022-2023 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "pch.h"
+
+namespace {
+
+    using namespace openxr_api_layer::utils::graphics;
+
+    XrSwapchainCreateInfo getTextureInfo() {
+        XrSwapchainCreateInfo info{XR_TYPE_SWAPCHAIN_CREATE_INFO};
+        info.format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        info.width = 16;
+        info.height = 16;
+        info.arraySize = 1;
+        info.mipCount = 1;
+        info.sampleCount = 1;
+        info.faceCount = 1;
+        return info;
+    }
+
+    bool isFilledWith(const IGraphicsTexture* texture, uint8_t value) {
+        const uint8_t* const texels = texture->getNativeTexture<CPU>();
+        const XrSwapchainCreateInfo& info = texture->getInfo();
+        return std::all_of(
+            texels, texels + info.width * info.height * 4, [&](uint8_t texel) { return texel == value; });
+    }
+
+    // Two devices sharing a timeline and a texture, the way the composition framework shares them between the
+    // application device and the composition device.
+    struct SharedTimeline {
+        SharedTimeline()
+            : device(internal::createCpuGraphicsDevice()), otherDevice(internal::createCpuGraphicsDevice()),
+              fence(device->createFence()), otherFence(otherDevice->openFence(fence->getFenceHandle())),
+              source(device->createTexture(getTextureInfo())),
+              otherSource(otherDevice->openTexture(source->getTextureHandle(), getTextureInfo())),
+              destination(otherDevice->createTexture(getTextureInfo(), false /* shareable */)) {
+        }
+
+        std::shared_ptr<IGraphicsDevice> device;
+        std::shared_ptr<IGraphicsDevice> otherDevice;
+        std::shared_ptr<IGraphicsFence> fence;
+        std::shared_ptr<IGraphicsFence> otherFence;
+        std::shared_ptr<IGraphicsTexture> source;
+        std::shared_ptr<IGraphicsTexture> otherSource;
+        std::shared_ptr<IGraphicsTexture> destination;
+    };
+
+} // namespace
+
+TEST(CpuFenceIsSharedWithOpenedFences) {
+    SharedTimeline timeline;
+    CHECK(timeline.otherFence->getNativeFence<CPU>() == timeline.fence->getNativeFence<CPU>());
+    CHECK(!timeline.otherFence->isShareable());
+
+    timeline.fence->signal(3);
+    CHECK(timeline.otherFence->getNativeFence<CPU>()->load() == 3);
+
+    // Like D3D, waiting on the CPU signals the value once the pending commands are done.
+    timeline.otherFence->waitOnCpu(5);
+    CHECK(timeline.fence->getNativeFence<CPU>()->load() == 5);
+}
+
+TEST(CpuFenceWaitOnDeviceHoldsLaterCommandsOnly) {
+    SharedTimeline timeline;
+    memset(timeline.source->getNativeTexture<CPU>(), 0x11, 16 * 16 * 4);
+
+    // The copy is held behind the wait, but the caller is not.
+    timeline.otherFence->waitOnDevice(1);
+    timeline.otherDevice->copyTexture(timeline.otherSource.get(), timeline.destination.get());
+    CHECK(isFilledWith(timeline.destination.get(), 0));
+
+    // Signaling the value resumes the other device.
+    timeline.fence->signal(1);
+    CHECK(isFilledWith(timeline.destination.get(), 0x11));
+
+    // Waiting for a value that was already reached does not hold anything.
+    memset(timeline.source->getNativeTexture<CPU>(), 0x22, 16 * 16 * 4);
+    timeline.otherFence->waitOnDevice(1);
+    timeline.otherDevice->copyTexture(timeline.otherSource.get(), timeline.destination.get());
+    CHECK(isFilledWith(timeline.destination.get(), 0x22));
+}
+
+TEST(CpuFenceWaitOnCpuFollowsDeviceWaits) {
+    SharedTimeline timeline;
+
+    // The CPU wait on the other device completes after the commands before it, which wait for the first device.
+    timeline.otherFence->waitOnDevice(2);
+    std::atomic<bool> isWaitComplete{false};
+    std::thread waiter([&] {
+        timeline.otherFence->waitOnCpu(3);
+        isWaitComplete = true;
+    });
+
+    std::this_thread::sleep_for(50ms);
+    const bool isCompleteBeforeSignal = isWaitComplete;
+    timeline.fence->signal(1);
+    std::this_thread::sleep_for(50ms);
+    const bool isCompleteBeforeValueReached = isWaitComplete;
+
+    timeline.fence->signal(2);
+    waiter.join();
+    CHECK(!isCompleteBeforeSignal);
+    CHECK(!isCompleteBeforeValueReached);
+    CHECK(timeline.fence->getNativeFence<CPU>()->load() == 3);
+}
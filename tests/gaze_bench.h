@@ -0,0 +1,197 @@
+// MIT License
+//
+// Copyright(c) 2022-2023 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <utils/gaze.h>
+
+// Benchmark of the kernels of utils/gaze.h. The vectormath backend is chosen at compile time, so this body is compiled
+// once per backend (see gaze_bench*.cpp), each translation unit getting its own copy of the inline kernels. The
+// kernels that were replaced are measured alongside, as the baseline.
+namespace openxr_api_layer::utils::gaze::bench {
+
+    // Previous implementations, on top of DirectXMath.
+    namespace reference {
+
+        static inline float degreesToRadians(float degrees) {
+            return degrees * (float)M_PI / 180.f;
+        }
+
+        static inline XrVector3f directionFromEyePoses(const XrPosef& left, const XrPosef& right) {
+            const auto gaze = xr::math::LoadXrPose(xr::math::Pose::Slerp(left, right, 0.5f));
+            const auto gazeProjectedPoint =
+                DirectX::XMVector3Transform(DirectX::XMVectorSet(0.f, 0.f, -1.f, 1.f), gaze);
+
+            return xr::math::Normalize(
+                {gazeProjectedPoint.m128_f32[0], gazeProjectedPoint.m128_f32[1], gazeProjectedPoint.m128_f32[2]});
+        }
+
+        static inline XrQuaternionf orientationFromDirection(const XrVector3f& unitVector) {
+            return xr::math::Quaternion::RotationRollPitchYaw({tan(unitVector.y), -tan(unitVector.x), 0.f});
+        }
+
+    } // namespace reference
+
+    // Realistic inputs: gaze within 30 degrees of forward, eyes 64mm apart and converging, typical headset fields of
+    // view. Generated with a fixed seed so that every backend sees the same values.
+    struct Inputs {
+        static constexpr size_t Count = 1024;
+
+        std::vector<float> yawDegrees;
+        std::vector<float> pitchDegrees;
+        std::vector<XrVector3f> directions;
+        std::vector<XrPosef> leftEyes;
+        std::vector<XrPosef> rightEyes;
+        std::vector<XrPosef> views;
+        std::vector<XrFovf> fovs;
+        std::vector<XrVector2f> centers;
+
+        Inputs() {
+            std::mt19937 generator(1234);
+            std::uniform_real_distribution<float> yaw(-30.f, 30.f);
+            std::uniform_real_distribution<float> pitch(-20.f, 20.f);
+            std::uniform_real_distribution<float> vergence(0.f, 3.f);
+            std::uniform_real_distribution<float> fovJitter(-0.05f, 0.05f);
+            std::uniform_real_distribution<float> ndc(-1.f, 1.f);
+
+            for (size_t i = 0; i < Count; i++) {
+                yawDegrees.push_back(yaw(generator));
+                pitchDegrees.push_back(pitch(generator));
+                const float yawRadians = reference::degreesToRadians(yawDegrees.back());
+                const float pitchRadians = reference::degreesToRadians(pitchDegrees.back());
+                directions.push_back(directionFromAngles(yawRadians, pitchRadians));
+
+                const float halfVergence = reference::degreesToRadians(vergence(generator)) / 2.f;
+                leftEyes.push_back({xr::math::Quaternion::RotationRollPitchYaw(
+                                        {pitchRadians, -(yawRadians - halfVergence), 0.f}),
+                                    {-0.032f, 0.f, 0.f}});
+                rightEyes.push_back({xr::math::Quaternion::RotationRollPitchYaw(
+                                         {pitchRadians, -(yawRadians + halfVergence), 0.f}),
+                                     {0.032f, 0.f, 0.f}});
+                views.push_back({xr::math::Quaternion::RotationRollPitchYaw({pitchRadians, yawRadians, 0.f}),
+                                 {i % 2 ? 0.032f : -0.032f, 1.6f, 0.f}});
+
+                fovs.push_back({-0.9f + fovJitter(generator),
+                                0.8f + fovJitter(generator),
+                                0.85f + fovJitter(generator),
+                                -0.9f + fovJitter(generator)});
+                centers.push_back({ndc(generator), ndc(generator)});
+            }
+        }
+    };
+
+    // Reports the time per call and the throughput of a kernel, called on each input in turn.
+    template <typename Kernel>
+    static inline void measureKernel(std::string_view name, Kernel&& kernel) {
+        double sum = 0;
+        size_t i = 0;
+        const double nanoseconds = testing::MeasureNanoseconds([&] {
+            sum += kernel(i);
+            i = (i + 1) % Inputs::Count;
+        });
+        testing::Consume(sum);
+
+        testing::Report(fmt::format("{} (ns/op)", name), nanoseconds, "ns");
+        testing::Report(fmt::format("{} (throughput)", name), 1e3 / nanoseconds, "Mop/s");
+    }
+
+    static inline void runGazeKernels(const char* backend) {
+        namespace vm = vectormath;
+        using namespace testing;
+
+        fmt::print("    Backend: {}\n", backend);
+
+        const Inputs inputs;
+
+        measureKernel("degreesToRadians + directionFromAngles (before)", [&](size_t i) {
+            return directionFromAngles(reference::degreesToRadians(inputs.yawDegrees[i]),
+                                       reference::degreesToRadians(inputs.pitchDegrees[i]))
+                .x;
+        });
+        measureKernel("degreesToRadians + directionFromAngles", [&](size_t i) {
+            return directionFromAngles(degreesToRadians(inputs.yawDegrees[i]), degreesToRadians(inputs.pitchDegrees[i]))
+                .x;
+        });
+
+        measureKernel("averageDirections", [&](size_t i) {
+            return averageDirections(inputs.directions[i], inputs.directions[(i + 1) % Inputs::Count]).x;
+        });
+
+        measureKernel("directionFromEyePoses (before)", [&](size_t i) {
+            return reference::directionFromEyePoses(inputs.leftEyes[i], inputs.rightEyes[i]).x;
+        });
+        measureKernel("directionFromEyePoses",
+                      [&](size_t i) { return directionFromEyePoses(inputs.leftEyes[i], inputs.rightEyes[i]).x; });
+
+        measureKernel("orientationFromDirection (before)",
+                      [&](size_t i) { return reference::orientationFromDirection(inputs.directions[i]).x; });
+        measureKernel("orientationFromDirection",
+                      [&](size_t i) { return orientationFromDirection(inputs.directions[i]).x; });
+        {
+            // One call for all the gaze spaces and eyes located in a frame. Reported per direction.
+            constexpr size_t BatchSize = 8;
+            const auto measureBatch = [&](std::string_view name, auto&& kernel) {
+                XrQuaternionf orientations[BatchSize];
+                double sum = 0;
+                size_t i = 0;
+                const double nanoseconds = MeasureNanoseconds([&] {
+                    kernel(&inputs.directions[i], orientations, BatchSize);
+                    sum += orientations[0].x;
+                    i = (i + BatchSize) % Inputs::Count;
+                }) / BatchSize;
+                Consume(sum);
+
+                Report(fmt::format("{}, batches of 8 (ns/op)", name), nanoseconds, "ns");
+                Report(fmt::format("{}, batches of 8 (throughput)", name), 1e3 / nanoseconds, "Mop/s");
+            };
+
+            measureBatch("orientationsFromDirections", orientationsFromDirections);
+            measureBatch("orientationsFromDirections, 4 lanes", detail::orientationsFromDirections4);
+#if defined(GAZE_AVX2)
+            if (detail::isAVX2Supported()) {
+                measureBatch("orientationsFromDirections, 8 lanes", detail::orientationsFromDirections8);
+            }
+#endif
+        }
+
+        measureKernel("Pose multiply + invert (xr::math)", [&](size_t i) {
+            const XrPosef pose = xr::math::Pose::Multiply(
+                inputs.leftEyes[i], xr::math::Pose::Invert(inputs.views[(i + 1) % Inputs::Count]));
+            return pose.position.x;
+        });
+        measureKernel("Pose multiply + invert (vectormath)", [&](size_t i) {
+            const vm::Pose view = vm::load(inputs.views[(i + 1) % Inputs::Count]);
+            const vm::Pose pose = vm::multiplyPoses(vm::load(inputs.leftEyes[i]), vm::invertPose(view));
+            return vm::getX(pose.position);
+        });
+
+        measureKernel("projectToView", [&](size_t i) {
+            XrVector2f ndc{};
+            projectToView(inputs.directions[i], inputs.fovs[i], ndc);
+            return ndc.x;
+        });
+        measureKernel("focusFov", [&](size_t i) {
+            return focusFov(inputs.fovs[i], inputs.centers[i], 0.4f, 0.4f).angleLeft;
+        });
+    }
+
+} // namespace openxr_api_layer::utils::gaze::bench
@@ -0,0 +1,159 @@
+// MIT License
+//
+// Copyright(c) 2022-2023 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "pch.h"
+
+#include <utils/gaze.h>
+
+namespace {
+
+    using namespace openxr_api_layer::utils::gaze;
+
+    // Directions of any length, including the degenerate ones (null, or straight backward).
+    std::vector<XrVector3f> generateDirections(size_t count) {
+        std::mt19937 generator(61);
+        std::uniform_real_distribution<float> component(-2.f, 2.f);
+
+        std::vector<XrVector3f> directions(count);
+        for (size_t i = 0; i < count; i++) {
+            directions[i] = {component(generator), component(generator), component(generator)};
+            if (i % 16 == 5) {
+                directions[i] = {0.f, 0.f, 0.f};
+            } else if (i % 16 == 11) {
+                directions[i] = {0.f, 0.f, directions[i].z < 0 ? -directions[i].z : directions[i].z};
+            }
+        }
+        return directions;
+    }
+
+    bool isBitIdentical(const XrQuaternionf& a, const XrQuaternionf& b) {
+        return memcmp(&a, &b, sizeof(a)) == 0;
+    }
+
+    // Unit directions at the given eccentricity from forward, all around it.
+    std::vector<XrVector3f> generateDirectionsAtEccentricity(float minDegrees, float maxDegrees, size_t count) {
+        std::mt19937 generator(62);
+        std::uniform_real_distribution<float> eccentricity(minDegrees * (float)M_PI / 180.f,
+                                                           maxDegrees * (float)M_PI / 180.f);
+        std::uniform_real_distribution<float> azimuth(0.f, 2.f * (float)M_PI);
+
+        std::vector<XrVector3f> directions(count);
+        for (size_t i = 0; i < count; i++) {
+            const float e = eccentricity(generator);
+            const float a = azimuth(generator);
+            directions[i] = {std::sin(e) * std::cos(a), std::sin(e) * std::sin(a), -std::cos(e)};
+        }
+        return directions;
+    }
+
+    // Angle between two vectors in degrees, from their chord (acos is imprecise for small angles).
+    double angleDegrees(const XrVector3f& a, const XrVector3f& b) {
+        const double aLength = std::sqrt((double)a.x * a.x + (double)a.y * a.y + (double)a.z * a.z);
+        const double bLength = std::sqrt((double)b.x * b.x + (double)b.y * b.y + (double)b.z * b.z);
+        const double dx = a.x / aLength - b.x / bLength;
+        const double dy = a.y / aLength - b.y / bLength;
+        const double dz = a.z / aLength - b.z / bLength;
+        return 2 * std::asin(std::min(std::sqrt(dx * dx + dy * dy + dz * dz) / 2, 1.0)) * 180 / M_PI;
+    }
+
+    XrVector3f getForward(const XrQuaternionf& orientation) {
+        XrVector3f forward;
+        xr::math::StoreXrVector3(&forward,
+                                 DirectX::XMVector3Rotate(DirectX::XMVectorSet(0, 0, -1, 0),
+                                                          xr::math::LoadXrQuaternion(orientation)));
+        return forward;
+    }
+
+    // The kernel replaced by orientationFromDirection(), which treated the components as angles.
+    XrQuaternionf previousOrientationFromDirection(const XrVector3f& unitVector) {
+        return xr::math::Quaternion::RotationRollPitchYaw({tan(unitVector.y), -tan(unitVector.x), 0.f});
+    }
+
+} // namespace
+
+// Every count, so that the 8-wide, 4-wide and single forms each handle a part of the batch.
+TEST(OrientationsFromDirectionsMatchSingleForm) {
+    const std::vector<XrVector3f> directions = generateDirections(64);
+
+    for (size_t count = 0; count <= directions.size(); count++) {
+        std::vector<XrQuaternionf> orientations(count);
+        orientationsFromDirections(directions.data(), orientations.data(), count);
+        for (size_t i = 0; i < count; i++) {
+            CHECK(isBitIdentical(orientations[i], orientationFromDirection(directions[i])));
+        }
+    }
+}
+
+TEST(OrientationsFromDirectionsAVX2MatchSSE2) {
+#if defined(GAZE_AVX2)
+    if (!detail::isAVX2Supported()) {
+        fmt::print("    Skipped: AVX2 is not supported by this processor\n");
+        return;
+    }
+
+    const std::vector<XrVector3f> directions = generateDirections(4096);
+    std::vector<XrQuaternionf> orientations4(directions.size());
+    std::vector<XrQuaternionf> orientations8(directions.size());
+    detail::orientationsFromDirections4(directions.data(), orientations4.data(), directions.size());
+    detail::orientationsFromDirections8(directions.data(), orientations8.data(), directions.size());
+    for (size_t i = 0; i < directions.size(); i++) {
+        CHECK(isBitIdentical(orientations8[i], orientations4[i]));
+    }
+#else
+    fmt::print("    Skipped: no AVX2 kernel in this build\n");
+#endif
+}
+
+// The orientation points forward along the direction, and is the shortest arc from forward: no roll, and a rotation
+// by exactly the eccentricity.
+TEST(OrientationFromDirectionIsShortestArc) {
+    for (float eccentricity = 0.f; eccentricity < 60.f; eccentricity += 5.f) {
+        for (const XrVector3f& direction : generateDirectionsAtEccentricity(eccentricity, eccentricity + 5.f, 10000)) {
+            const XrQuaternionf orientation = orientationFromDirection(direction);
+            CHECK(angleDegrees(getForward(orientation), direction) < 1e-4);
+
+            CHECK(orientation.z == 0.f);
+            const double rotationDegrees =
+                2 *
+                std::atan2(std::sqrt((double)orientation.x * orientation.x + (double)orientation.y * orientation.y),
+                           (double)orientation.w) *
+                180 / M_PI;
+            CHECK_NEAR(rotationDegrees, angleDegrees(XrVector3f{0.f, 0.f, -1.f}, direction), 1e-4);
+        }
+    }
+}
+
+// Near forward, the previous kernel gave the same gaze. Further out, it drifted (about 10 degrees at 60 degrees of
+// eccentricity) and the new kernel is always closer to the tracked direction.
+TEST(OrientationFromDirectionMatchesPreviousKernelNearForward) {
+    for (const XrVector3f& direction : generateDirectionsAtEccentricity(0.f, 2.f, 10000)) {
+        CHECK(angleDegrees(getForward(orientationFromDirection(direction)),
+                           getForward(previousOrientationFromDirection(direction))) < 0.01);
+    }
+
+    for (const XrVector3f& direction : generateDirectionsAtEccentricity(2.f, 60.f, 10000)) {
+        const double error = angleDegrees(getForward(orientationFromDirection(direction)), direction);
+        const double previousError = angleDegrees(getForward(previousOrientationFromDirection(direction)), direction);
+        CHECK(error <= previousError);
+    }
+}
@@ -0,0 +1,104 @@
+// MIT License
+//
+// Copyright(c) 2022-2023 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "pch.h"
+
+#include <utils/general.h>
+
+namespace {
+
+    using namespace openxr_api_layer::utils::general;
+
+    // Runs the function on a new thread (with the default priority and affinity), and reports its failures on the
+    // calling thread.
+    void runOnNewThread(const std::function<void()>& function) {
+        std::exception_ptr failure;
+        std::thread([&] {
+            try {
+                function();
+            } catch (...) {
+                failure = std::current_exception();
+            }
+        }).join();
+        if (failure) {
+            std::rethrow_exception(failure);
+        }
+    }
+
+    DWORD_PTR getProcessAffinity() {
+        DWORD_PTR processMask = 0, systemMask = 0;
+        CHECK(GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask));
+        return processMask;
+    }
+
+    // There is no getter for the affinity of a thread: set it, then put back the previous one.
+    DWORD_PTR getThreadAffinity() {
+        const DWORD_PTR affinityMask = SetThreadAffinityMask(GetCurrentThread(), getProcessAffinity());
+        CHECK(affinityMask);
+        SetThreadAffinityMask(GetCurrentThread(), affinityMask);
+        return affinityMask;
+    }
+
+} // namespace
+
+TEST(ThreadPolicyFallsBackToHighestWithoutMmcss) {
+    runOnNewThread([] {
+        auto policy = applyThreadPolicy("Test", ThreadPriority::Mmcss, 0, L"Not a task");
+        CHECK(GetThreadPriority(GetCurrentThread()) == THREAD_PRIORITY_HIGHEST);
+
+        policy.reset();
+        CHECK(GetThreadPriority(GetCurrentThread()) == THREAD_PRIORITY_NORMAL);
+    });
+}
+
+TEST(ThreadPolicyIgnoresAffinityWithoutUsableProcessor) {
+    const DWORD_PTR unusableMask = ~getProcessAffinity();
+    if (!unusableMask) {
+        // The process may run on any of 64 processors.
+        return;
+    }
+
+    runOnNewThread([&] {
+        const DWORD_PTR affinityMask = getThreadAffinity();
+
+        const auto policy = applyThreadPolicy("Test", ThreadPriority::Normal, unusableMask);
+        CHECK(getThreadAffinity() == affinityMask);
+        CHECK(GetThreadPriority(GetCurrentThread()) == THREAD_PRIORITY_NORMAL);
+    });
+}
+
+TEST(ThreadPolicyRestoredOnDestruction) {
+    runOnNewThread([] {
+        const DWORD_PTR affinityMask = getThreadAffinity();
+        const DWORD_PTR processMask = getProcessAffinity();
+        const DWORD_PTR firstProcessor = processMask & (~processMask + 1);
+
+        auto policy = applyThreadPolicy("Test", ThreadPriority::Highest, firstProcessor);
+        CHECK(GetThreadPriority(GetCurrentThread()) == THREAD_PRIORITY_HIGHEST);
+        CHECK(getThreadAffinity() == firstProcessor);
+
+        policy.reset();
+        CHECK(GetThreadPriority(GetCurrentThread()) == THREAD_PRIORITY_NORMAL);
+        CHECK(getThreadAffinity() == affinityMask);
+    });
+}
@@ -0,0 +1,145 @@
+// MIT License
+//
+// Copyright(c) 2022-2023 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "pch.h"
+
+#include <utils/gaze.h>
+#include <utils/hittest.h>
+
+namespace {
+
+    using namespace openxr_api_layer::testing;
+    using namespace openxr_api_layer::utils;
+    using namespace openxr_api_layer::utils::hittest;
+
+    // Panels of a gaze-driven UI, on the walls 2 to 5 meters around the user and facing them.
+    struct Scene {
+        std::vector<XrPosef> poses;
+        std::vector<XrExtent2Df> sizes;
+        std::vector<XrPosef> rays;
+
+        Scene(size_t quadCount) {
+            std::mt19937 generator(63);
+            std::uniform_real_distribution<float> azimuth(-(float)M_PI, (float)M_PI);
+            std::uniform_real_distribution<float> distance(2.f, 5.f);
+            std::uniform_real_distribution<float> height(-2.f, 2.f);
+            std::uniform_real_distribution<float> width(0.05f, 0.4f);
+            std::uniform_real_distribution<float> aspect(0.5f, 1.f);
+            std::uniform_real_distribution<float> unit(-1.f, 1.f);
+
+            for (size_t i = 0; i < quadCount; i++) {
+                const float a = azimuth(generator);
+                const float r = distance(generator);
+                const XrVector3f position{r * std::sin(a), height(generator), -r * std::cos(a)};
+
+                // Facing +Z towards the user: the orientation of a gaze looking away from the user.
+                poses.push_back({gaze::orientationFromDirection({position.x, 0.f, position.z}), position});
+                sizes.push_back({width(generator), 0.f});
+                sizes.back().height = sizes.back().width * aspect(generator);
+            }
+
+            // Gazes from around the head, in any horizontal direction.
+            for (size_t i = 0; i < 1024; i++) {
+                rays.push_back({gaze::orientationFromDirection({unit(generator), unit(generator) / 2, unit(generator)}),
+                                {unit(generator) / 5, unit(generator) / 5, unit(generator) / 5}});
+            }
+        }
+    };
+
+} // namespace
+
+// Cost of a gaze query with the hit tester, against testing every quad in turn. The hierarchy is refit when quads move,
+// so the per-frame cost with moving panels is reported too.
+BENCHMARK(HitTestQuads) {
+    for (const size_t quadCount : {10, 100, 1000, 10000}) {
+        Scene scene(quadCount);
+        double checksum = 0;
+
+        const auto tester = createHitTester();
+        std::vector<uint32_t> quadIds;
+        const double buildNanoseconds = MeasureNanoseconds(
+            [&] {
+                tester->clear();
+                quadIds.clear();
+                for (size_t i = 0; i < quadCount; i++) {
+                    quadIds.push_back(tester->addQuad(scene.poses[i], scene.sizes[i]));
+                }
+
+                // The hierarchy is built on the first query.
+                Hit hit;
+                checksum += tester->hitTest(scene.rays[0], hit);
+            },
+            1);
+
+        size_t rayIndex = 0;
+        const double queryNanoseconds = MeasureNanoseconds([&] {
+            Hit hit;
+            if (tester->hitTest(scene.rays[rayIndex], hit)) {
+                checksum += hit.distance;
+            }
+            rayIndex = (rayIndex + 1) % scene.rays.size();
+        });
+
+        // A tenth of the panels slide up and down every frame.
+        std::mt19937 generator(64);
+        std::uniform_real_distribution<float> slide(-0.01f, 0.01f);
+        std::uniform_int_distribution<size_t> quadIndex(0, quadCount - 1);
+        const double moveAndQueryNanoseconds = MeasureNanoseconds(
+            [&] {
+                for (size_t i = 0; i < quadCount / 10 + 1; i++) {
+                    const size_t index = quadIndex(generator);
+                    scene.poses[index].position.y += slide(generator);
+                    tester->moveQuad(quadIds[index], scene.poses[index], scene.sizes[index]);
+                }
+
+                Hit hit;
+                if (tester->hitTest(scene.rays[rayIndex], hit)) {
+                    checksum += hit.distance;
+                }
+                rayIndex = (rayIndex + 1) % scene.rays.size();
+            },
+            10);
+
+        const double scanNanoseconds = MeasureNanoseconds(
+            [&] {
+                float closest = INFINITY;
+                for (size_t i = 0; i < quadCount; i++) {
+                    Hit hit;
+                    if (hitTestQuad(scene.rays[rayIndex], scene.poses[i], scene.sizes[i], hit)) {
+                        closest = std::min(closest, hit.distance);
+                    }
+                }
+                if (closest < INFINITY) {
+                    checksum += closest;
+                }
+                rayIndex = (rayIndex + 1) % scene.rays.size();
+            },
+            10);
+
+        Report(fmt::format("{} quads, build", quadCount), buildNanoseconds / 1e3, "us");
+        Report(fmt::format("{} quads, query", quadCount), queryNanoseconds, "ns");
+        Report(fmt::format("{} quads, move 10% and query", quadCount), moveAndQueryNanoseconds, "ns");
+        Report(fmt::format("{} quads, test every quad", quadCount), scanNanoseconds, "ns");
+        Consume(checksum);
+    }
+}
@@ -0,0 +1,159 @@
+// MIT License
+//
+// Copyright(c) 2022-2023 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "pch.h"
+
+#include <utils/gaze.h>
+#include <utils/hittest.h>
+
+namespace {
+
+    using namespace openxr_api_layer::utils;
+    using namespace openxr_api_layer::utils::hittest;
+
+    // The quads of the hit tester, mirrored to test them one by one.
+    struct Scene {
+        std::shared_ptr<IHitTester> tester{createHitTester()};
+        std::vector<XrPosef> poses;
+        std::vector<XrExtent2Df> sizes;
+        std::vector<uint32_t> quadIds;
+        std::vector<bool> isActive;
+
+        std::mt19937 generator{63};
+
+        float uniform(float min, float max) {
+            return std::uniform_real_distribution<float>(min, max)(generator);
+        }
+
+        // A panel on the walls 2 to 5 meters around the user, facing them.
+        XrPosef randomPanel() {
+            const float azimuth = uniform(-(float)M_PI, (float)M_PI);
+            const float distance = uniform(2.f, 5.f);
+            const XrVector3f position{distance * std::sin(azimuth), uniform(-2.f, 2.f), -distance * std::cos(azimuth)};
+            return {gaze::orientationFromDirection({position.x, 0.f, position.z}), position};
+        }
+
+        void add(size_t index) {
+            poses[index] = randomPanel();
+            sizes[index] = {uniform(0.05f, 0.4f), uniform(0.05f, 0.3f)};
+            quadIds[index] = tester->addQuad(poses[index], sizes[index]);
+            isActive[index] = true;
+        }
+
+        void move(size_t index, float amplitude) {
+            poses[index].position.x += uniform(-amplitude, amplitude);
+            poses[index].position.y += uniform(-amplitude, amplitude);
+            poses[index].position.z += uniform(-amplitude, amplitude);
+            tester->moveQuad(quadIds[index], poses[index], sizes[index]);
+        }
+
+        void remove(size_t index) {
+            tester->removeQuad(quadIds[index]);
+            isActive[index] = false;
+        }
+
+        explicit Scene(size_t quadCount)
+            : poses(quadCount), sizes(quadCount), quadIds(quadCount), isActive(quadCount) {
+            for (size_t i = 0; i < quadCount; i++) {
+                add(i);
+            }
+        }
+
+        bool scan(const XrPosef& ray, Hit& closest) const {
+            bool isHit = false;
+            for (size_t i = 0; i < poses.size(); i++) {
+                Hit hit;
+                if (isActive[i] && hitTestQuad(ray, poses[i], sizes[i], hit) &&
+                    (!isHit || hit.distance < closest.distance)) {
+                    closest = hit;
+                    closest.quadId = quadIds[i];
+                    isHit = true;
+                }
+            }
+            return isHit;
+        }
+
+        // Returns the number of rays that hit a quad.
+        uint32_t checkAgainstScan() {
+            uint32_t hitCount = 0;
+            for (uint32_t i = 0; i < 1000; i++) {
+                const XrPosef ray{
+                    gaze::orientationFromDirection({uniform(-1.f, 1.f), uniform(-0.5f, 0.5f), uniform(-1.f, 1.f)}),
+                    {uniform(-0.2f, 0.2f), uniform(-0.2f, 0.2f), uniform(-0.2f, 0.2f)}};
+
+                Hit hit, expected;
+                const bool isHit = tester->hitTest(ray, hit);
+                CHECK(isHit == scan(ray, expected));
+                if (isHit) {
+                    CHECK(hit.quadId == expected.quadId);
+                    CHECK(hit.distance == expected.distance);
+                    CHECK(hit.uv.x == expected.uv.x && hit.uv.y == expected.uv.y);
+                    hitCount++;
+                }
+            }
+            return hitCount;
+        }
+    };
+
+} // namespace
+
+// The hierarchy must return the same closest hit as testing every quad, as it is refit, rebuilt and emptied.
+TEST(HitTesterMatchesScan) {
+    for (const size_t quadCount : {1, 10, 100, 1000}) {
+        Scene scene(quadCount);
+        CHECK(scene.tester->getQuadCount() == quadCount);
+        const uint32_t hitCount = scene.checkAgainstScan();
+        CHECK(quadCount < 100 || hitCount > 0);
+
+        // Small moves only refit the boxes.
+        for (size_t i = 0; i < quadCount; i += 3) {
+            scene.move(i, 0.1f);
+        }
+        scene.checkAgainstScan();
+
+        // Holes in the leaves.
+        for (size_t i = 0; i < quadCount; i += 5) {
+            scene.remove(i);
+        }
+        CHECK(scene.tester->getQuadCount() == quadCount - (quadCount + 4) / 5);
+        scene.checkAgainstScan();
+
+        // New quads reuse the identifiers of the removed ones, and trigger a rebuild.
+        for (size_t i = 0; i < quadCount; i += 5) {
+            scene.add(i);
+        }
+        CHECK(scene.tester->getQuadCount() == quadCount);
+        scene.checkAgainstScan();
+
+        // Large moves make the refit boxes loose enough to trigger a rebuild.
+        for (size_t i = 0; i < quadCount; i++) {
+            scene.move(i, 2.f);
+        }
+        scene.checkAgainstScan();
+
+        scene.tester->clear();
+        CHECK(scene.tester->getQuadCount() == 0);
+        Hit hit;
+        CHECK(!scene.tester->hitTest(scene.poses[0], hit));
+    }
+}
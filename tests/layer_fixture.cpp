@@ -0,0 +1,480 @@
+// MIT License
+//
+// Copyright(c) 2022-2023 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "pch.h"
+
+#include "layer_fixture.h"
+
+#include <utils/capture.h>
+
+namespace {
+
+    using namespace openxr_api_layer;
+    using namespace openxr_api_layer::tests;
+
+    // See TrackerType::Simulated in trackers.h.
+    constexpr uint32_t k_simulatedTrackerType = 2;
+
+    struct Layer {
+        wil::unique_hmodule module;
+        PFN_xrGetInstanceProcAddr getInstanceProcAddr{nullptr};
+        PFN_xrCreateApiLayerInstance createApiLayerInstance{nullptr};
+    };
+
+    // Loads and negotiates with the layer, like the loader does.
+    const Layer& getLayer() {
+        static const Layer layer = [] {
+            // The layer reads it during the negotiation.
+            _putenv_s("LOCALAPPDATA", GetTemporaryFolder().string().c_str());
+
+            wchar_t executablePath[MAX_PATH];
+            GetModuleFileNameW(nullptr, executablePath, MAX_PATH);
+            const auto layerPath = std::filesystem::path(executablePath).parent_path() / LAYER_BINARY;
+
+            Layer layer;
+            layer.module.reset(LoadLibraryW(layerPath.c_str()));
+            if (!layer.module) {
+                throw std::runtime_error(fmt::format("Failed to load {}", layerPath.string()));
+            }
+
+            const auto xrNegotiateLoaderApiLayerInterface = reinterpret_cast<PFN_xrNegotiateLoaderApiLayerInterface>(
+                GetProcAddress(layer.module.get(), "xrNegotiateLoaderApiLayerInterface"));
+            if (!xrNegotiateLoaderApiLayerInterface) {
+                throw std::runtime_error("xrNegotiateLoaderApiLayerInterface is not exported");
+            }
+
+            XrNegotiateLoaderInfo loaderInfo{};
+            loaderInfo.structType = XR_LOADER_INTERFACE_STRUCT_LOADER_INFO;
+            loaderInfo.structVersion = XR_LOADER_INFO_STRUCT_VERSION;
+            loaderInfo.structSize = sizeof(XrNegotiateLoaderInfo);
+            loaderInfo.minInterfaceVersion = XR_CURRENT_LOADER_API_LAYER_VERSION;
+            loaderInfo.maxInterfaceVersion = XR_CURRENT_LOADER_API_LAYER_VERSION;
+            loaderInfo.minApiVersion = XR_CURRENT_API_VERSION;
+            loaderInfo.maxApiVersion = XR_CURRENT_API_VERSION;
+
+            XrNegotiateApiLayerRequest apiLayerRequest{};
+            apiLayerRequest.structType = XR_LOADER_INTERFACE_STRUCT_API_LAYER_REQUEST;
+            apiLayerRequest.structVersion = XR_API_LAYER_INFO_STRUCT_VERSION;
+            apiLayerRequest.structSize = sizeof(XrNegotiateApiLayerRequest);
+
+            const XrResult result = xrNegotiateLoaderApiLayerInterface(&loaderInfo, LAYER_NAME, &apiLayerRequest);
+            if (XR_FAILED(result)) {
+                throw std::runtime_error(
+                    fmt::format("xrNegotiateLoaderApiLayerInterface failed with {}", xr::ToCString(result)));
+            }
+            layer.getInstanceProcAddr = apiLayerRequest.getInstanceProcAddr;
+            layer.createApiLayerInstance = apiLayerRequest.createApiLayerInstance;
+
+            return layer;
+        }();
+        return layer;
+    }
+
+    struct MetricsView {
+        wil::unique_handle mapping;
+        wil::unique_mapview_ptr<uint8_t> view;
+    };
+
+    const metrics::MetricsHeader& getMetricsHeader() {
+        static const MetricsView metrics = [] {
+            // The segment is created during the negotiation.
+            getLayer();
+
+            MetricsView metrics;
+            const auto name = fmt::format("Local\\OpenXR-Eye-Trackers.Metrics.{}", GetCurrentProcessId());
+            metrics.mapping.reset(OpenFileMappingA(FILE_MAP_READ, FALSE, name.c_str()));
+            if (!metrics.mapping) {
+                throw std::runtime_error("The layer did not export its metrics");
+            }
+            metrics.view.reset(static_cast<uint8_t*>(MapViewOfFile(metrics.mapping.get(), FILE_MAP_READ, 0, 0, 0)));
+            if (!metrics.view) {
+                throw std::runtime_error("Failed to map the metrics");
+            }
+
+            const auto& header = *reinterpret_cast<const metrics::MetricsHeader*>(metrics.view.get());
+            if (header.magic != metrics::k_metricsMagic || header.version != metrics::k_metricsVersion ||
+                header.counterCount != static_cast<uint32_t>(metrics::Counter::Count) ||
+                header.gaugeCount != static_cast<uint32_t>(metrics::Gauge::Count) ||
+                header.histogramCount != static_cast<uint32_t>(metrics::Histogram::Count)) {
+                throw std::runtime_error("The metrics of the layer do not match the tests");
+            }
+
+            return metrics;
+        }();
+        return *reinterpret_cast<const metrics::MetricsHeader*>(metrics.view.get());
+    }
+
+    void writeSettings(const std::vector<std::string>& settings) {
+        const auto folder = GetTemporaryFolder() / "OpenXR-Eye-Trackers";
+        std::filesystem::create_directories(folder);
+
+        std::ofstream file(folder / "settings.ini", std::ios::trunc);
+        for (const std::string& setting : settings) {
+            file << setting << "\n";
+        }
+    }
+
+    // Both eyes look in the direction of the combined gaze.
+    void setGaze(utils::capture::Record& record, const XrVector3f& direction) {
+        record.unitVector = direction;
+        for (uint32_t eye = 0; eye < xr::StereoView::Count; eye++) {
+            record.eyeUnitVector[eye] = direction;
+            record.isEyeValid[eye] = true;
+        }
+    }
+
+    XrVector3f normalize(const XrVector3f& vector) {
+        XrVector3f normalized;
+        xr::math::StoreXrVector3(&normalized, DirectX::XMVector3Normalize(xr::math::LoadXrVector3(vector)));
+        return normalized;
+    }
+
+    // Writes a capture of 10 minutes with both queries answered every 10 milliseconds. The gaze is given by its offset
+    // from the start of the capture: the function fills the gaze of the record, or returns false when the gaze is
+    // unavailable.
+    std::filesystem::path writeCapture(
+        const std::string& name,
+        const std::function<bool(int64_t offset, utils::capture::Record& record)>& getGaze) {
+        using namespace utils::capture;
+
+        const auto path = GetTemporaryFolder() / name;
+        const auto writer = createCaptureWriter(path, k_simulatedTrackerType);
+
+        constexpr int64_t period = std::chrono::nanoseconds(10ms).count();
+        constexpr int64_t duration = std::chrono::nanoseconds(10min).count();
+        constexpr XrTime startTime = 1'000'000'000;
+        for (int64_t offset = 0; offset < duration; offset += period) {
+            Record gaze{};
+            gaze.kind = RecordKind::GetGaze;
+            gaze.time = startTime + offset;
+            gaze.queryOffset = offset;
+            gaze.acquisitionOffset = offset;
+            gaze.result = getGaze(offset, gaze);
+
+            Record record = gaze;
+            record.kind = RecordKind::IsGazeAvailable;
+            writer->write(record);
+            writer->write(gaze);
+        }
+        writer->close();
+
+        return path;
+    }
+
+    template <typename Function>
+    void resolve(XrInstance instance, const char* name, Function& function) {
+        CHECK_XR(getLayer().getInstanceProcAddr(instance, name, reinterpret_cast<PFN_xrVoidFunction*>(&function)));
+    }
+
+} // namespace
+
+namespace openxr_api_layer::tests {
+
+    LayerFixture::LayerFixture(const std::vector<std::string>& settings,
+                               const mock_runtime::Options& options,
+                               const ApplicationOptions& application)
+        : viewConfigurationType(application.viewConfigurationType) {
+        const Layer& layer = getLayer();
+        mock_runtime::Reset(options);
+        writeSettings(settings);
+
+        try {
+            {
+                XrApiLayerNextInfo nextInfo{};
+                nextInfo.structType = XR_LOADER_INTERFACE_STRUCT_API_LAYER_NEXT_INFO;
+                nextInfo.structVersion = XR_API_LAYER_NEXT_INFO_STRUCT_VERSION;
+                nextInfo.structSize = sizeof(XrApiLayerNextInfo);
+                strcpy_s(nextInfo.layerName, LAYER_NAME);
+                nextInfo.nextGetInstanceProcAddr = mock_runtime::xrGetInstanceProcAddr;
+                nextInfo.nextCreateApiLayerInstance = mock_runtime::xrCreateApiLayerInstance;
+
+                XrApiLayerCreateInfo apiLayerInfo{};
+                apiLayerInfo.structType = XR_LOADER_INTERFACE_STRUCT_API_LAYER_CREATE_INFO;
+                apiLayerInfo.structVersion = XR_API_LAYER_CREATE_INFO_STRUCT_VERSION;
+                apiLayerInfo.structSize = sizeof(XrApiLayerCreateInfo);
+                apiLayerInfo.nextInfo = &nextInfo;
+
+                std::vector<const char*> extensions{XR_EXT_EYE_GAZE_INTERACTION_EXTENSION_NAME};
+                extensions.insert(extensions.end(), application.extensions.cbegin(), application.extensions.cend());
+                XrInstanceCreateInfo createInfo{XR_TYPE_INSTANCE_CREATE_INFO};
+                strcpy_s(createInfo.applicationInfo.applicationName, "tests");
+                createInfo.applicationInfo.apiVersion = XR_CURRENT_API_VERSION;
+                createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+                createInfo.enabledExtensionNames = extensions.data();
+                CHECK_XR(layer.createApiLayerInstance(&createInfo, &apiLayerInfo, &instance));
+            }
+
+            xr.xrGetInstanceProcAddr = layer.getInstanceProcAddr;
+            resolve(instance, "xrDestroyInstance", xr.xrDestroyInstance);
+            resolve(instance, "xrPollEvent", xr.xrPollEvent);
+            resolve(instance, "xrGetSystem", xr.xrGetSystem);
+            resolve(instance, "xrGetSystemProperties", xr.xrGetSystemProperties);
+            resolve(instance, "xrEnumerateViewConfigurations", xr.xrEnumerateViewConfigurations);
+            resolve(instance, "xrEnumerateViewConfigurationViews", xr.xrEnumerateViewConfigurationViews);
+            resolve(instance, "xrStringToPath", xr.xrStringToPath);
+            resolve(instance, "xrCreateSession", xr.xrCreateSession);
+            resolve(instance, "xrDestroySession", xr.xrDestroySession);
+            resolve(instance, "xrBeginSession", xr.xrBeginSession);
+            resolve(instance, "xrEndSession", xr.xrEndSession);
+            resolve(instance, "xrCreateReferenceSpace", xr.xrCreateReferenceSpace);
+            resolve(instance, "xrCreateActionSpace", xr.xrCreateActionSpace);
+            resolve(instance, "xrDestroySpace", xr.xrDestroySpace);
+            resolve(instance, "xrLocateSpace", xr.xrLocateSpace);
+            resolve(instance, "xrLocateViews", xr.xrLocateViews);
+            resolve(instance, "xrWaitFrame", xr.xrWaitFrame);
+            resolve(instance, "xrBeginFrame", xr.xrBeginFrame);
+            resolve(instance, "xrEndFrame", xr.xrEndFrame);
+            resolve(instance, "xrCreateSwapchain", xr.xrCreateSwapchain);
+            resolve(instance, "xrDestroySwapchain", xr.xrDestroySwapchain);
+            resolve(instance, "xrAcquireSwapchainImage", xr.xrAcquireSwapchainImage);
+            resolve(instance, "xrWaitSwapchainImage", xr.xrWaitSwapchainImage);
+            resolve(instance, "xrReleaseSwapchainImage", xr.xrReleaseSwapchainImage);
+            resolve(instance, "xrCreateActionSet", xr.xrCreateActionSet);
+            resolve(instance, "xrCreateAction", xr.xrCreateAction);
+            resolve(instance, "xrSuggestInteractionProfileBindings", xr.xrSuggestInteractionProfileBindings);
+            resolve(instance, "xrAttachSessionActionSets", xr.xrAttachSessionActionSets);
+            resolve(instance, "xrSyncActions", xr.xrSyncActions);
+            resolve(instance, "xrGetActionStatePose", xr.xrGetActionStatePose);
+
+            {
+                XrSystemGetInfo getInfo{XR_TYPE_SYSTEM_GET_INFO};
+                getInfo.formFactor = XR_FORM_FACTOR_HEAD_MOUNTED_DISPLAY;
+                CHECK_XR(xr.xrGetSystem(instance, &getInfo, &systemId));
+            }
+
+            {
+                XrActionSetCreateInfo actionSetInfo{XR_TYPE_ACTION_SET_CREATE_INFO};
+                strcpy_s(actionSetInfo.actionSetName, "gameplay");
+                strcpy_s(actionSetInfo.localizedActionSetName, "Gameplay");
+                CHECK_XR(xr.xrCreateActionSet(instance, &actionSetInfo, &actionSet));
+
+                XrActionCreateInfo actionInfo{XR_TYPE_ACTION_CREATE_INFO};
+                actionInfo.actionType = XR_ACTION_TYPE_POSE_INPUT;
+                strcpy_s(actionInfo.actionName, "gaze");
+                strcpy_s(actionInfo.localizedActionName, "Gaze");
+                CHECK_XR(xr.xrCreateAction(actionSet, &actionInfo, &gazeAction));
+
+                XrPath interactionProfile;
+                CHECK_XR(
+                    xr.xrStringToPath(instance, "/interaction_profiles/ext/eye_gaze_interaction", &interactionProfile));
+                XrActionSuggestedBinding binding{gazeAction};
+                CHECK_XR(xr.xrStringToPath(instance, "/user/eyes_ext/input/gaze_ext/pose", &binding.binding));
+                XrInteractionProfileSuggestedBinding suggestedBindings{XR_TYPE_INTERACTION_PROFILE_SUGGESTED_BINDING};
+                suggestedBindings.interactionProfile = interactionProfile;
+                suggestedBindings.countSuggestedBindings = 1;
+                suggestedBindings.suggestedBindings = &binding;
+                CHECK_XR(xr.xrSuggestInteractionProfileBindings(instance, &suggestedBindings));
+            }
+
+            {
+                XrSessionCreateInfo sessionInfo{XR_TYPE_SESSION_CREATE_INFO};
+                sessionInfo.systemId = systemId;
+                CHECK_XR(xr.xrCreateSession(instance, &sessionInfo, &session));
+
+                XrSessionActionSetsAttachInfo attachInfo{XR_TYPE_SESSION_ACTION_SETS_ATTACH_INFO};
+                attachInfo.countActionSets = 1;
+                attachInfo.actionSets = &actionSet;
+                CHECK_XR(xr.xrAttachSessionActionSets(session, &attachInfo));
+
+                XrActionSpaceCreateInfo actionSpaceInfo{XR_TYPE_ACTION_SPACE_CREATE_INFO};
+                actionSpaceInfo.action = gazeAction;
+                actionSpaceInfo.poseInActionSpace = xr::math::Pose::Identity();
+                CHECK_XR(xr.xrCreateActionSpace(session, &actionSpaceInfo, &gazeSpace));
+
+                XrReferenceSpaceCreateInfo referenceSpaceInfo{XR_TYPE_REFERENCE_SPACE_CREATE_INFO};
+                referenceSpaceInfo.referenceSpaceType = XR_REFERENCE_SPACE_TYPE_LOCAL;
+                referenceSpaceInfo.poseInReferenceSpace = xr::math::Pose::Identity();
+                CHECK_XR(xr.xrCreateReferenceSpace(session, &referenceSpaceInfo, &localSpace));
+
+                XrSessionBeginInfo beginInfo{XR_TYPE_SESSION_BEGIN_INFO};
+                beginInfo.primaryViewConfigurationType = viewConfigurationType;
+                CHECK_XR(xr.xrBeginSession(session, &beginInfo));
+
+                // Go through the state changes up to focused.
+                XrEventDataBuffer event{XR_TYPE_EVENT_DATA_BUFFER};
+                while (xr.xrPollEvent(instance, &event) == XR_SUCCESS) {
+                    event = {XR_TYPE_EVENT_DATA_BUFFER};
+                }
+            }
+        } catch (...) {
+            destroy();
+            throw;
+        }
+    }
+
+    LayerFixture::~LayerFixture() {
+        destroy();
+    }
+
+    void LayerFixture::destroy() {
+        // The layer is a singleton, it must be released even when a test fails.
+        if (gazeSpace != XR_NULL_HANDLE) {
+            xr.xrDestroySpace(gazeSpace);
+            gazeSpace = XR_NULL_HANDLE;
+        }
+        if (localSpace != XR_NULL_HANDLE) {
+            xr.xrDestroySpace(localSpace);
+            localSpace = XR_NULL_HANDLE;
+        }
+        if (session != XR_NULL_HANDLE) {
+            xr.xrEndSession(session);
+            xr.xrDestroySession(session);
+            session = XR_NULL_HANDLE;
+        }
+        if (instance != XR_NULL_HANDLE) {
+            if (xr.xrDestroyInstance) {
+                xr.xrDestroyInstance(instance);
+            }
+            instance = XR_NULL_HANDLE;
+        }
+    }
+
+    XrSpaceLocation LayerFixture::runFrame(const std::vector<const XrCompositionLayerBaseHeader*>& layers) {
+        XrFrameState frameState{XR_TYPE_FRAME_STATE};
+        CHECK_XR(xr.xrWaitFrame(session, nullptr, &frameState));
+        CHECK_XR(xr.xrBeginFrame(session, nullptr));
+        lastDisplayTime = frameState.predictedDisplayTime;
+
+        XrActiveActionSet activeActionSet{actionSet, XR_NULL_PATH};
+        XrActionsSyncInfo syncInfo{XR_TYPE_ACTIONS_SYNC_INFO};
+        syncInfo.countActiveActionSets = 1;
+        syncInfo.activeActionSets = &activeActionSet;
+        CHECK_XR(xr.xrSyncActions(session, &syncInfo));
+
+        XrActionStateGetInfo getInfo{XR_TYPE_ACTION_STATE_GET_INFO};
+        getInfo.action = gazeAction;
+        XrActionStatePose actionState{XR_TYPE_ACTION_STATE_POSE};
+        CHECK_XR(xr.xrGetActionStatePose(session, &getInfo, &actionState));
+
+        XrViewLocateInfo viewLocateInfo{XR_TYPE_VIEW_LOCATE_INFO};
+        viewLocateInfo.viewConfigurationType = viewConfigurationType;
+        viewLocateInfo.displayTime = frameState.predictedDisplayTime;
+        viewLocateInfo.space = localSpace;
+        XrViewState viewState{XR_TYPE_VIEW_STATE};
+        views.fill({XR_TYPE_VIEW});
+        CHECK_XR(xr.xrLocateViews(
+            session, &viewLocateInfo, &viewState, static_cast<uint32_t>(views.size()), &viewCount, views.data()));
+
+        const XrSpaceLocation gaze = locateGaze(frameState.predictedDisplayTime);
+
+        XrFrameEndInfo frameEndInfo{XR_TYPE_FRAME_END_INFO};
+        frameEndInfo.displayTime = frameState.predictedDisplayTime;
+        frameEndInfo.environmentBlendMode = XR_ENVIRONMENT_BLEND_MODE_OPAQUE;
+        frameEndInfo.layerCount = static_cast<uint32_t>(layers.size());
+        frameEndInfo.layers = layers.data();
+        CHECK_XR(xr.xrEndFrame(session, &frameEndInfo));
+
+        return gaze;
+    }
+
+    XrSpaceLocation LayerFixture::locateGaze(XrTime time) const {
+        XrSpaceLocation location{XR_TYPE_SPACE_LOCATION};
+        CHECK_XR(xr.xrLocateSpace(gazeSpace, localSpace, time, &location));
+        return location;
+    }
+
+    const std::filesystem::path& GetTemporaryFolder() {
+        static const std::filesystem::path folder = [] {
+            const auto folder = std::filesystem::temp_directory_path() /
+                                fmt::format("OpenXR-Eye-Trackers-tests-{}", GetCurrentProcessId());
+            std::filesystem::create_directories(folder);
+            return folder;
+        }();
+        return folder;
+    }
+
+    const std::filesystem::path& GetGazeCapture() {
+        static const std::filesystem::path path =
+            writeCapture("sweep.gzcap", [](int64_t offset, utils::capture::Record& record) {
+                const double phase = 2 * M_PI * offset / std::chrono::nanoseconds(2s).count();
+                const float yaw = static_cast<float>(k_gazeCaptureAmplitude * M_PI / 180 * std::sin(phase));
+                setGaze(record, {std::sin(yaw), 0, -std::cos(yaw)});
+                return true;
+            });
+        return path;
+    }
+
+    const std::filesystem::path& GetFixedGazeCapture() {
+        static const std::filesystem::path path =
+            writeCapture("fixed.gzcap", [](int64_t offset, utils::capture::Record& record) {
+                if (offset >= std::chrono::nanoseconds(std::chrono::seconds(k_fixedGazeLostSeconds)).count()) {
+                    return false;
+                }
+                setGaze(record, normalize(k_fixedGazeDirection));
+                return true;
+            });
+        return path;
+    }
+
+    const std::filesystem::path& GetConvergedGazeCapture() {
+        static const std::filesystem::path path =
+            writeCapture("converged.gzcap", [](int64_t offset, utils::capture::Record& record) {
+                setGaze(record, {0, 0, -1});
+                for (uint32_t eye = 0; eye < xr::StereoView::Count; eye++) {
+                    record.eyeUnitVector[eye] = GetConvergedEyeDirection(eye);
+                }
+                record.confidence = k_convergedGazeConfidence;
+                return true;
+            });
+        return path;
+    }
+
+    XrVector3f GetConvergedEyeDirection(uint32_t eye) {
+        return normalize({eye == xr::StereoView::Left ? k_convergedGazeEyeOffset : -k_convergedGazeEyeOffset,
+                          0,
+                          -k_convergedGazeDistance});
+    }
+
+    std::vector<std::string> GetReplaySettings(const std::filesystem::path& capture, uint32_t startSeconds) {
+        return {
+            fmt::format("ReplayTracker = {}", capture.u8string()),
+            "ReplayRealTime = 1",
+            fmt::format("ReplayStartSeconds = {}", startSeconds),
+            "RecordTracker = 0",
+            "ShareTracker = 0",
+            "GazeLayerPicking = 0",
+        };
+    }
+
+    uint64_t ReadCounter(metrics::Counter counter) {
+        const auto& header = getMetricsHeader();
+        const auto counters = reinterpret_cast<const std::atomic<uint64_t>*>(
+            reinterpret_cast<const uint8_t*>(&header) + header.countersOffset);
+        return counters[static_cast<uint32_t>(counter)].load(std::memory_order_relaxed);
+    }
+
+    int64_t ReadGauge(metrics::Gauge gauge) {
+        const auto& header = getMetricsHeader();
+        const auto gauges = reinterpret_cast<const std::atomic<int64_t>*>(reinterpret_cast<const uint8_t*>(&header) +
+                                                                          header.gaugesOffset);
+        return gauges[static_cast<uint32_t>(gauge)].load(std::memory_order_relaxed);
+    }
+
+    const metrics::SharedHistogram& ReadHistogram(metrics::Histogram histogram) {
+        const auto& header = getMetricsHeader();
+        const auto histograms = reinterpret_cast<const metrics::SharedHistogram*>(
+            reinterpret_cast<const uint8_t*>(&header) + header.histogramsOffset);
+        return histograms[static_cast<uint32_t>(histogram)];
+    }
+
+} // namespace openxr_api_layer::tests
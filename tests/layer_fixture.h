@@ -0,0 +1,145 @@
+// MIT License
+//
+// Copyright(c) 2022-2023 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <metrics.h>
+
+#include "mock_runtime.h"
+
+// Drives the layer on top of the mock runtime (see mock_runtime.h), the way an application does through the loader. The
+// layer DLL is loaded from the folder of the executable once per process, with LOCALAPPDATA redirected to a temporary
+// folder so that the settings and the log of the user are left untouched.
+namespace openxr_api_layer::tests {
+
+    // The functions resolved through the layer, as seen by the application.
+    struct Dispatch {
+        PFN_xrGetInstanceProcAddr xrGetInstanceProcAddr{nullptr};
+        PFN_xrDestroyInstance xrDestroyInstance{nullptr};
+        PFN_xrPollEvent xrPollEvent{nullptr};
+        PFN_xrGetSystem xrGetSystem{nullptr};
+        PFN_xrGetSystemProperties xrGetSystemProperties{nullptr};
+        PFN_xrEnumerateViewConfigurations xrEnumerateViewConfigurations{nullptr};
+        PFN_xrEnumerateViewConfigurationViews xrEnumerateViewConfigurationViews{nullptr};
+        PFN_xrStringToPath xrStringToPath{nullptr};
+        PFN_xrCreateSession xrCreateSession{nullptr};
+        PFN_xrDestroySession xrDestroySession{nullptr};
+        PFN_xrBeginSession xrBeginSession{nullptr};
+        PFN_xrEndSession xrEndSession{nullptr};
+        PFN_xrCreateReferenceSpace xrCreateReferenceSpace{nullptr};
+        PFN_xrCreateActionSpace xrCreateActionSpace{nullptr};
+        PFN_xrDestroySpace xrDestroySpace{nullptr};
+        PFN_xrLocateSpace xrLocateSpace{nullptr};
+        PFN_xrLocateViews xrLocateViews{nullptr};
+        PFN_xrWaitFrame xrWaitFrame{nullptr};
+        PFN_xrBeginFrame xrBeginFrame{nullptr};
+        PFN_xrEndFrame xrEndFrame{nullptr};
+        PFN_xrCreateSwapchain xrCreateSwapchain{nullptr};
+        PFN_xrDestroySwapchain xrDestroySwapchain{nullptr};
+        PFN_xrAcquireSwapchainImage xrAcquireSwapchainImage{nullptr};
+        PFN_xrWaitSwapchainImage xrWaitSwapchainImage{nullptr};
+        PFN_xrReleaseSwapchainImage xrReleaseSwapchainImage{nullptr};
+        PFN_xrCreateActionSet xrCreateActionSet{nullptr};
+        PFN_xrCreateAction xrCreateAction{nullptr};
+        PFN_xrSuggestInteractionProfileBindings xrSuggestInteractionProfileBindings{nullptr};
+        PFN_xrAttachSessionActionSets xrAttachSessionActionSets{nullptr};
+        PFN_xrSyncActions xrSyncActions{nullptr};
+        PFN_xrGetActionStatePose xrGetActionStatePose{nullptr};
+    };
+
+    // What the application requests besides the eye gaze interaction extension.
+    struct ApplicationOptions {
+        std::vector<const char*> extensions;
+        XrViewConfigurationType viewConfigurationType{XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO};
+    };
+
+    // An application with the eye gaze interaction extension: the instance, a running session, the gaze action and its
+    // space, and a LOCAL reference space. Only one fixture may exist at a time, like the layer only handles one
+    // instance at a time.
+    struct LayerFixture {
+        // The settings are written to the settings file of the layer, one "Name = value" per entry.
+        explicit LayerFixture(const std::vector<std::string>& settings,
+                              const mock_runtime::Options& options = {},
+                              const ApplicationOptions& application = {});
+        ~LayerFixture();
+
+        LayerFixture(const LayerFixture&) = delete;
+        LayerFixture& operator=(const LayerFixture&) = delete;
+
+        // Runs one frame like an engine does, submitting the given layers, and returns the gaze located during the
+        // frame.
+        XrSpaceLocation runFrame(const std::vector<const XrCompositionLayerBaseHeader*>& layers = {});
+
+        XrSpaceLocation locateGaze(XrTime time) const;
+
+        Dispatch xr;
+        XrInstance instance{XR_NULL_HANDLE};
+        XrSystemId systemId{XR_NULL_SYSTEM_ID};
+        XrSession session{XR_NULL_HANDLE};
+        XrActionSet actionSet{XR_NULL_HANDLE};
+        XrAction gazeAction{XR_NULL_HANDLE};
+        XrSpace gazeSpace{XR_NULL_HANDLE};
+        XrSpace localSpace{XR_NULL_HANDLE};
+        XrTime lastDisplayTime{0};
+        XrViewConfigurationType viewConfigurationType{XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO};
+        // The views located during the last frame.
+        uint32_t viewCount{0};
+        std::array<XrView, 4> views{};
+
+      private:
+        void destroy();
+    };
+
+    // The temporary folder used as LOCALAPPDATA by the layer.
+    const std::filesystem::path& GetTemporaryFolder();
+
+    // A capture of 10 minutes, where the gaze sweeps 30 degrees left and right every 2 seconds, with both queries
+    // answered every 10 milliseconds.
+    const std::filesystem::path& GetGazeCapture();
+    constexpr float k_gazeCaptureAmplitude = 30.f;
+
+    // A capture of 10 minutes, where the gaze holds still in the given direction (not normalized), then is lost after
+    // 5 minutes.
+    const std::filesystem::path& GetFixedGazeCapture();
+    constexpr XrVector3f k_fixedGazeDirection{0.2f, -0.1f, -1.f};
+    constexpr uint32_t k_fixedGazeLostSeconds = 300;
+
+    // A capture of 10 minutes, where the gaze holds straight ahead and each eye converges on a point at the given
+    // distance, from eyes at the given offset on each side of the head. Each sample has the given confidence.
+    const std::filesystem::path& GetConvergedGazeCapture();
+    constexpr float k_convergedGazeDistance = 1.f;
+    constexpr float k_convergedGazeEyeOffset = 0.032f;
+    constexpr float k_convergedGazeConfidence = 0.75f;
+    XrVector3f GetConvergedEyeDirection(uint32_t eye);
+
+    // Settings to replay a gaze capture in real time from the given offset, and to disable the features that depend on
+    // the machine.
+    std::vector<std::string> GetReplaySettings(const std::filesystem::path& capture = GetGazeCapture(),
+                                               uint32_t startSeconds = 0);
+
+    // The live metrics of the layer, read from the shared memory like a monitoring tool does.
+    uint64_t ReadCounter(metrics::Counter counter);
+    int64_t ReadGauge(metrics::Gauge gauge);
+    const metrics::SharedHistogram& ReadHistogram(metrics::Histogram histogram);
+
+} // namespace openxr_api_layer::tests
@@ -0,0 +1,573 @@
+// MIT License
+//
+// Copyright(c) 2022-2023 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "pch.h"
+
+#include "layer_fixture.h"
+
+namespace {
+
+    using namespace openxr_api_layer;
+    using namespace openxr_api_layer::tests;
+    using namespace openxr_api_layer::testing;
+
+    XrVector3f getForward(const XrQuaternionf& orientation) {
+        XrVector3f forward;
+        xr::math::StoreXrVector3(&forward,
+                                 DirectX::XMVector3Rotate(DirectX::XMVectorSet(0, 0, -1, 0),
+                                                          xr::math::LoadXrQuaternion(orientation)));
+        return forward;
+    }
+
+    template <typename Function>
+    Function getRuntimeFunction(XrInstance instance, const char* name) {
+        Function function = nullptr;
+        CHECK_XR(
+            mock_runtime::xrGetInstanceProcAddr(instance, name, reinterpret_cast<PFN_xrVoidFunction*>(&function)));
+        return function;
+    }
+
+    // The functions of extensions, as seen by the application.
+    template <typename Function>
+    Function getLayerFunction(const LayerFixture& fixture, const char* name) {
+        Function function = nullptr;
+        CHECK_XR(fixture.xr.xrGetInstanceProcAddr(
+            fixture.instance, name, reinterpret_cast<PFN_xrVoidFunction*>(&function)));
+        return function;
+    }
+
+    XrFoveationEyeTrackedStateMETA getFoveationState(const LayerFixture& fixture) {
+        const auto xrGetFoveationEyeTrackedStateMETA =
+            getLayerFunction<PFN_xrGetFoveationEyeTrackedStateMETA>(fixture, "xrGetFoveationEyeTrackedStateMETA");
+
+        XrFoveationEyeTrackedStateMETA state{XR_TYPE_FOVEATION_EYE_TRACKED_STATE_META};
+        CHECK_XR(xrGetFoveationEyeTrackedStateMETA(fixture.session, &state));
+        return state;
+    }
+
+    // The settings to replay the fixed gaze capture with gazed layer picking enabled.
+    std::vector<std::string> getPickingSettings() {
+        std::vector<std::string> settings = GetReplaySettings(GetFixedGazeCapture());
+        std::replace(settings.begin(),
+                     settings.end(),
+                     std::string("GazeLayerPicking = 0"),
+                     std::string("GazeLayerPicking = 1"));
+        return settings;
+    }
+
+    XrCompositionLayerQuad makeQuad(XrSpace space, const XrVector3f& position, const XrExtent2Df& size) {
+        XrCompositionLayerQuad quad{XR_TYPE_COMPOSITION_LAYER_QUAD};
+        quad.space = space;
+        quad.subImage.imageRect.extent = {512, 512};
+        quad.pose = {xr::math::Quaternion::Identity(), position};
+        quad.size = size;
+        return quad;
+    }
+
+    XrCompositionLayerCylinderKHR makeCylinder(XrSpace space, float yaw, float radius, float centralAngle) {
+        XrCompositionLayerCylinderKHR cylinder{XR_TYPE_COMPOSITION_LAYER_CYLINDER_KHR};
+        cylinder.space = space;
+        cylinder.subImage.imageRect.extent = {1024, 512};
+        xr::math::StoreXrQuaternion(&cylinder.pose.orientation, DirectX::XMQuaternionRotationRollPitchYaw(0, yaw, 0));
+        cylinder.radius = radius;
+        cylinder.centralAngle = centralAngle;
+        cylinder.aspectRatio = 1.f;
+        return cylinder;
+    }
+
+} // namespace
+
+TEST(LayerAdvertisesEyeGazeInteraction) {
+    LayerFixture fixture(GetReplaySettings());
+
+    XrSystemEyeGazeInteractionPropertiesEXT eyeGazeProperties{XR_TYPE_SYSTEM_EYE_GAZE_INTERACTION_PROPERTIES_EXT};
+    XrSystemProperties systemProperties{XR_TYPE_SYSTEM_PROPERTIES, &eyeGazeProperties};
+    CHECK_XR(fixture.xr.xrGetSystemProperties(fixture.instance, fixture.systemId, &systemProperties));
+    CHECK(eyeGazeProperties.supportsEyeGazeInteraction);
+
+    // The runtime does not know the interaction profile, the layer keeps the bindings to itself.
+    CHECK(mock_runtime::GetCallCount(mock_runtime::Call::SuggestInteractionProfileBindings) == 0);
+}
+
+TEST(EyeGazeIsReplayed) {
+    LayerFixture fixture(GetReplaySettings());
+
+    const uint64_t locatesBefore = ReadCounter(metrics::Counter::EyeGazeLocateSpace);
+    const uint64_t validSamplesBefore = ReadCounter(metrics::Counter::GazeValidSamples);
+
+    constexpr uint32_t frameCount = 10;
+    for (uint32_t i = 0; i < frameCount; i++) {
+        const XrSpaceLocation gaze = fixture.runFrame();
+        CHECK(xr::math::Pose::IsPoseValid(gaze.locationFlags));
+
+        // The runtime locates every space at the identity, so the gaze is the one of the capture.
+        const XrVector3f forward = getForward(gaze.pose.orientation);
+        CHECK_NEAR(forward.y, 0.f, 1e-5f);
+        CHECK(forward.z < 0);
+        CHECK(std::abs(std::atan2(forward.x, -forward.z)) <= k_gazeCaptureAmplitude * M_PI / 180 + 1e-4);
+    }
+
+    // The gaze is composed with the view space, which the runtime locates.
+    CHECK(mock_runtime::GetCallCount(mock_runtime::Call::LocateSpace) == frameCount);
+    CHECK(mock_runtime::GetCallCount(mock_runtime::Call::WaitFrame) == frameCount);
+    CHECK(ReadCounter(metrics::Counter::EyeGazeLocateSpace) - locatesBefore == frameCount);
+    CHECK(ReadCounter(metrics::Counter::GazeValidSamples) - validSamplesBefore == frameCount);
+}
+
+TEST(OtherSpacesArePassedThrough) {
+    LayerFixture fixture(GetReplaySettings());
+
+    fixture.runFrame();
+    const uint64_t locatesBefore = mock_runtime::GetCallCount(mock_runtime::Call::LocateSpace);
+
+    XrSpaceLocation location{XR_TYPE_SPACE_LOCATION};
+    CHECK_XR(fixture.xr.xrLocateSpace(fixture.localSpace, fixture.localSpace, fixture.lastDisplayTime, &location));
+    CHECK(xr::math::Pose::IsPoseValid(location.locationFlags));
+    CHECK(mock_runtime::GetCallCount(mock_runtime::Call::LocateSpace) == locatesBefore + 1);
+}
+
+// The foveation centers are the gaze projected into each view, with views that are canted outward and whose field of
+// view is asymmetric, like on most headsets. They are checked against the off-center projection of DirectXMath.
+TEST(FoveationCentersFollowTheGaze) {
+    constexpr float cant = static_cast<float>(10 * M_PI / 180);
+    mock_runtime::Options options;
+    for (uint32_t eye = 0; eye < xr::StereoView::Count; eye++) {
+        const float yaw = eye == xr::StereoView::Left ? cant : -cant;
+        xr::math::StoreXrQuaternion(&options.viewPoses[eye].orientation,
+                                    DirectX::XMQuaternionRotationRollPitchYaw(0, yaw, 0));
+    }
+    options.viewFovs = {XrFovf{-0.9f, 0.7f, 0.8f, -0.6f}, XrFovf{-0.7f, 0.9f, 0.8f, -0.6f}};
+    ApplicationOptions application;
+    application.extensions = {XR_META_FOVEATION_EYE_TRACKED_EXTENSION_NAME};
+
+    {
+        LayerFixture fixture(GetReplaySettings(GetFixedGazeCapture()), options, application);
+
+        const DirectX::XMVECTOR gaze = DirectX::XMVector3Normalize(xr::math::LoadXrVector3(k_fixedGazeDirection));
+        for (uint32_t frame = 0; frame < 10; frame++) {
+            fixture.runFrame();
+
+            const XrFoveationEyeTrackedStateMETA state = getFoveationState(fixture);
+            CHECK(state.flags & XR_FOVEATION_EYE_TRACKED_STATE_VALID_BIT_META);
+            for (uint32_t eye = 0; eye < xr::StereoView::Count; eye++) {
+                const XrFovf& fov = options.viewFovs[eye];
+                constexpr float nearZ = 0.1f;
+                const DirectX::XMMATRIX projection =
+                    DirectX::XMMatrixPerspectiveOffCenterRH(nearZ * std::tan(fov.angleLeft),
+                                                            nearZ * std::tan(fov.angleRight),
+                                                            nearZ * std::tan(fov.angleDown),
+                                                            nearZ * std::tan(fov.angleUp),
+                                                            nearZ,
+                                                            100.f);
+                const DirectX::XMVECTOR gazeInEye = DirectX::XMVector3InverseRotate(
+                    gaze, xr::math::LoadXrQuaternion(options.viewPoses[eye].orientation));
+                XrVector3f expected;
+                xr::math::StoreXrVector3(&expected, DirectX::XMVector3TransformCoord(gazeInEye, projection));
+
+                CHECK_NEAR(state.foveationCenter[eye].x, expected.x, 1e-5f);
+                CHECK_NEAR(state.foveationCenter[eye].y, expected.y, 1e-5f);
+            }
+
+            // The cant moves the gaze toward the nose in each view.
+            CHECK(state.foveationCenter[xr::StereoView::Left].x > state.foveationCenter[xr::StereoView::Right].x);
+        }
+    }
+
+    // Once the gaze is lost, the centers are no longer valid.
+    {
+        LayerFixture fixture(
+            GetReplaySettings(GetFixedGazeCapture(), k_fixedGazeLostSeconds + 10), options, application);
+        for (uint32_t frame = 0; frame < 10; frame++) {
+            fixture.runFrame();
+
+            const XrFoveationEyeTrackedStateMETA state = getFoveationState(fixture);
+            CHECK(!(state.flags & XR_FOVEATION_EYE_TRACKED_STATE_VALID_BIT_META));
+        }
+    }
+}
+
+// The layer emulates XR_FB_eye_tracking_social on top of the replayed capture: each eye gazes from its view towards the
+// point where the eyes converge, with the confidence and the acquisition time of the sample.
+TEST(EyeTrackingSocialIsEmulated) {
+    ApplicationOptions application;
+    application.extensions = {XR_FB_EYE_TRACKING_SOCIAL_EXTENSION_NAME};
+    LayerFixture fixture(GetReplaySettings(GetConvergedGazeCapture()), {}, application);
+
+    XrSystemEyeTrackingPropertiesFB eyeTrackingProperties{XR_TYPE_SYSTEM_EYE_TRACKING_PROPERTIES_FB};
+    XrSystemProperties systemProperties{XR_TYPE_SYSTEM_PROPERTIES, &eyeTrackingProperties};
+    CHECK_XR(fixture.xr.xrGetSystemProperties(fixture.instance, fixture.systemId, &systemProperties));
+    CHECK(eyeTrackingProperties.supportsEyeTracking);
+
+    const auto xrCreateEyeTrackerFB = getLayerFunction<PFN_xrCreateEyeTrackerFB>(fixture, "xrCreateEyeTrackerFB");
+    const auto xrDestroyEyeTrackerFB = getLayerFunction<PFN_xrDestroyEyeTrackerFB>(fixture, "xrDestroyEyeTrackerFB");
+    const auto xrGetEyeGazesFB = getLayerFunction<PFN_xrGetEyeGazesFB>(fixture, "xrGetEyeGazesFB");
+
+    XrEyeTrackerCreateInfoFB createInfo{XR_TYPE_EYE_TRACKER_CREATE_INFO_FB};
+    XrEyeTrackerFB eyeTracker{XR_NULL_HANDLE};
+    CHECK_XR(xrCreateEyeTrackerFB(fixture.session, &createInfo, &eyeTracker));
+    CHECK(eyeTracker != XR_NULL_HANDLE);
+
+    XrEyeGazesInfoFB gazeInfo{XR_TYPE_EYE_GAZES_INFO_FB};
+    gazeInfo.baseSpace = fixture.localSpace;
+    const uint64_t queriesBefore = ReadCounter(metrics::Counter::EyeGazesFB);
+    constexpr uint32_t frameCount = 10;
+    for (uint32_t i = 0; i < frameCount; i++) {
+        fixture.runFrame();
+
+        gazeInfo.time = fixture.lastDisplayTime;
+        XrEyeGazesFB eyeGazes{XR_TYPE_EYE_GAZES_FB};
+        CHECK_XR(xrGetEyeGazesFB(eyeTracker, &gazeInfo, &eyeGazes));
+
+        // The runtime locates every space at the identity, so the gazes are relative to the views.
+        for (uint32_t eye = 0; eye < xr::StereoView::Count; eye++) {
+            const XrEyeGazeFB& gaze = eyeGazes.gaze[eye];
+            CHECK(gaze.isValid);
+            CHECK_NEAR(gaze.gazePose.position.x, fixture.views[eye].pose.position.x, 1e-6f);
+            CHECK_NEAR(gaze.gazePose.position.y, fixture.views[eye].pose.position.y, 1e-6f);
+            CHECK_NEAR(gaze.gazePose.position.z, fixture.views[eye].pose.position.z, 1e-6f);
+
+            const XrVector3f forward = getForward(gaze.gazePose.orientation);
+            const XrVector3f expected = GetConvergedEyeDirection(eye);
+            CHECK_NEAR(forward.x, expected.x, 1e-5f);
+            CHECK_NEAR(forward.y, expected.y, 1e-5f);
+            CHECK_NEAR(forward.z, expected.z, 1e-5f);
+            CHECK(gaze.gazeConfidence == k_convergedGazeConfidence);
+        }
+
+        // The sample was acquired before the frame is displayed.
+        CHECK(eyeGazes.time <= fixture.lastDisplayTime);
+        CHECK(eyeGazes.time > fixture.lastDisplayTime - std::chrono::nanoseconds(1s).count());
+    }
+    CHECK(ReadCounter(metrics::Counter::EyeGazesFB) - queriesBefore == frameCount);
+
+    // The runtime has no eye tracker to call.
+    CHECK(mock_runtime::GetCallCount(mock_runtime::Call::CreateEyeTracker) == 0);
+    CHECK(mock_runtime::GetCallCount(mock_runtime::Call::GetEyeGazes) == 0);
+
+    CHECK_XR(xrDestroyEyeTrackerFB(eyeTracker));
+    XrEyeGazesFB eyeGazes{XR_TYPE_EYE_GAZES_FB};
+    CHECK(xrGetEyeGazesFB(eyeTracker, &gazeInfo, &eyeGazes) == XR_ERROR_HANDLE_INVALID);
+}
+
+// On Quest Pro, the runtime implements XR_FB_eye_tracking_social: the layer reads the gaze from it for its other
+// extensions, and leaves the eye trackers of the application to the runtime.
+TEST(EyeTrackingSocialIsPassedThroughOnQuestPro) {
+    mock_runtime::Options options;
+    options.supportsEyeTrackingSocial = true;
+    options.eyeGazePoses[xr::StereoView::Left].orientation = {0.1f, 0.f, 0.f, 0.995f};
+    options.eyeGazeConfidence = 0.6f;
+    ApplicationOptions application;
+    application.extensions = {XR_FB_EYE_TRACKING_SOCIAL_EXTENSION_NAME};
+    LayerFixture fixture({"RecordTracker = 0", "ShareTracker = 0", "GazeLayerPicking = 0"}, options, application);
+
+    // The eye tracker of the layer.
+    CHECK(mock_runtime::GetCallCount(mock_runtime::Call::CreateEyeTracker) == 1);
+    CHECK(xr::math::Pose::IsPoseValid(fixture.runFrame().locationFlags));
+
+    const auto xrCreateEyeTrackerFB = getLayerFunction<PFN_xrCreateEyeTrackerFB>(fixture, "xrCreateEyeTrackerFB");
+    const auto xrDestroyEyeTrackerFB = getLayerFunction<PFN_xrDestroyEyeTrackerFB>(fixture, "xrDestroyEyeTrackerFB");
+    const auto xrGetEyeGazesFB = getLayerFunction<PFN_xrGetEyeGazesFB>(fixture, "xrGetEyeGazesFB");
+
+    XrEyeTrackerCreateInfoFB createInfo{XR_TYPE_EYE_TRACKER_CREATE_INFO_FB};
+    XrEyeTrackerFB eyeTracker{XR_NULL_HANDLE};
+    CHECK_XR(xrCreateEyeTrackerFB(fixture.session, &createInfo, &eyeTracker));
+    CHECK(mock_runtime::GetCallCount(mock_runtime::Call::CreateEyeTracker) == 2);
+
+    const uint64_t runtimeQueriesBefore = mock_runtime::GetCallCount(mock_runtime::Call::GetEyeGazes);
+    const uint64_t queriesBefore = ReadCounter(metrics::Counter::EyeGazesFB);
+    XrEyeGazesInfoFB gazeInfo{XR_TYPE_EYE_GAZES_INFO_FB};
+    gazeInfo.baseSpace = fixture.localSpace;
+    gazeInfo.time = fixture.lastDisplayTime;
+    XrEyeGazesFB eyeGazes{XR_TYPE_EYE_GAZES_FB};
+    CHECK_XR(xrGetEyeGazesFB(eyeTracker, &gazeInfo, &eyeGazes));
+    CHECK(mock_runtime::GetCallCount(mock_runtime::Call::GetEyeGazes) - runtimeQueriesBefore == 1);
+    CHECK(ReadCounter(metrics::Counter::EyeGazesFB) - queriesBefore == 0);
+
+    // The gazes of the runtime are returned as is.
+    for (uint32_t eye = 0; eye < xr::StereoView::Count; eye++) {
+        CHECK(eyeGazes.gaze[eye].isValid);
+        CHECK(memcmp(&eyeGazes.gaze[eye].gazePose, &options.eyeGazePoses[eye], sizeof(XrPosef)) == 0);
+        CHECK(eyeGazes.gaze[eye].gazeConfidence == options.eyeGazeConfidence);
+    }
+    CHECK(eyeGazes.time == gazeInfo.time);
+
+    CHECK_XR(xrDestroyEyeTrackerFB(eyeTracker));
+    CHECK(mock_runtime::GetCallCount(mock_runtime::Call::DestroyEyeTracker) == 1);
+}
+
+// The application renders the quad views on a runtime that only has the stereo views: the layer places the focus views
+// around the gaze and composites the four views into the stereo views.
+TEST(QuadViewsAreEmulated) {
+    ApplicationOptions application;
+    application.extensions = {XR_VARJO_QUAD_VIEWS_EXTENSION_NAME};
+    application.viewConfigurationType = XR_VIEW_CONFIGURATION_TYPE_PRIMARY_QUAD_VARJO;
+    LayerFixture fixture(GetReplaySettings(GetFixedGazeCapture()), {}, application);
+
+    uint32_t typeCount = 0;
+    CHECK_XR(fixture.xr.xrEnumerateViewConfigurations(fixture.instance, fixture.systemId, 0, &typeCount, nullptr));
+    std::vector<XrViewConfigurationType> types(typeCount);
+    CHECK_XR(fixture.xr.xrEnumerateViewConfigurations(
+        fixture.instance, fixture.systemId, typeCount, &typeCount, types.data()));
+    CHECK(std::find(types.cbegin(), types.cend(), XR_VIEW_CONFIGURATION_TYPE_PRIMARY_QUAD_VARJO) != types.cend());
+
+    // The context views are at 40% of the 1000x1000 stereo views, the focus views cover 35% of them at full density.
+    XrViewConfigurationView configurationViews[4]{{XR_TYPE_VIEW_CONFIGURATION_VIEW},
+                                                  {XR_TYPE_VIEW_CONFIGURATION_VIEW},
+                                                  {XR_TYPE_VIEW_CONFIGURATION_VIEW},
+                                                  {XR_TYPE_VIEW_CONFIGURATION_VIEW}};
+    uint32_t viewCount = 0;
+    CHECK_XR(fixture.xr.xrEnumerateViewConfigurationViews(fixture.instance,
+                                                          fixture.systemId,
+                                                          XR_VIEW_CONFIGURATION_TYPE_PRIMARY_QUAD_VARJO,
+                                                          4,
+                                                          &viewCount,
+                                                          configurationViews));
+    CHECK(viewCount == 4);
+    for (uint32_t i = 0; i < 4; i++) {
+        const uint32_t expected = i < xr::StereoView::Count ? 400 : 350;
+        CHECK(configurationViews[i].recommendedImageRectWidth == expected);
+        CHECK(configurationViews[i].recommendedImageRectHeight == expected);
+    }
+
+    // The context views are the stereo views, the focus views are centered on the gaze.
+    fixture.runFrame();
+    CHECK(fixture.viewCount == 4);
+    const float tanHalfFov = std::tan(0.8f);
+    const float tanGazeX = k_fixedGazeDirection.x / -k_fixedGazeDirection.z;
+    const float tanGazeY = k_fixedGazeDirection.y / -k_fixedGazeDirection.z;
+    for (uint32_t eye = 0; eye < xr::StereoView::Count; eye++) {
+        const XrFovf& context = fixture.views[eye].fov;
+        CHECK_NEAR(context.angleLeft, -0.8f, 1e-6f);
+        CHECK_NEAR(context.angleRight, 0.8f, 1e-6f);
+        CHECK_NEAR(context.angleUp, 0.8f, 1e-6f);
+        CHECK_NEAR(context.angleDown, -0.8f, 1e-6f);
+
+        const XrFovf& focus = fixture.views[eye + xr::StereoView::Count].fov;
+        CHECK_NEAR((std::tan(focus.angleLeft) + std::tan(focus.angleRight)) / 2, tanGazeX, 1e-4f);
+        CHECK_NEAR((std::tan(focus.angleUp) + std::tan(focus.angleDown)) / 2, tanGazeY, 1e-4f);
+        CHECK_NEAR(std::tan(focus.angleRight) - std::tan(focus.angleLeft), 0.35f * 2 * tanHalfFov, 1e-4f);
+        CHECK_NEAR(std::tan(focus.angleUp) - std::tan(focus.angleDown), 0.35f * 2 * tanHalfFov, 1e-4f);
+    }
+
+    std::vector<XrSwapchain> swapchains;
+    for (uint32_t i = 0; i < 4; i++) {
+        XrSwapchainCreateInfo createInfo{XR_TYPE_SWAPCHAIN_CREATE_INFO};
+        createInfo.usageFlags = XR_SWAPCHAIN_USAGE_COLOR_ATTACHMENT_BIT;
+        createInfo.format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        createInfo.sampleCount = 1;
+        createInfo.width = configurationViews[i].recommendedImageRectWidth;
+        createInfo.height = configurationViews[i].recommendedImageRectHeight;
+        createInfo.faceCount = 1;
+        createInfo.arraySize = 1;
+        createInfo.mipCount = 1;
+        CHECK_XR(fixture.xr.xrCreateSwapchain(fixture.session, &createInfo, &swapchains.emplace_back()));
+    }
+
+    const uint64_t framesComposedBefore = ReadCounter(metrics::Counter::QuadViewsFramesComposed);
+    for (uint32_t frame = 0; frame < 10; frame++) {
+        XrCompositionLayerProjectionView projectionViews[4];
+        for (uint32_t i = 0; i < 4; i++) {
+            uint32_t index;
+            CHECK_XR(fixture.xr.xrAcquireSwapchainImage(swapchains[i], nullptr, &index));
+            XrSwapchainImageWaitInfo waitInfo{XR_TYPE_SWAPCHAIN_IMAGE_WAIT_INFO};
+            waitInfo.timeout = XR_INFINITE_DURATION;
+            CHECK_XR(fixture.xr.xrWaitSwapchainImage(swapchains[i], &waitInfo));
+            CHECK_XR(fixture.xr.xrReleaseSwapchainImage(swapchains[i], nullptr));
+
+            projectionViews[i] = {XR_TYPE_COMPOSITION_LAYER_PROJECTION_VIEW};
+            projectionViews[i].pose = fixture.views[i].pose;
+            projectionViews[i].fov = fixture.views[i].fov;
+            projectionViews[i].subImage.swapchain = swapchains[i];
+            projectionViews[i].subImage.imageRect.extent = {
+                static_cast<int32_t>(configurationViews[i].recommendedImageRectWidth),
+                static_cast<int32_t>(configurationViews[i].recommendedImageRectHeight)};
+        }
+
+        XrCompositionLayerProjection layer{XR_TYPE_COMPOSITION_LAYER_PROJECTION};
+        layer.space = fixture.localSpace;
+        layer.viewCount = 4;
+        layer.views = projectionViews;
+        fixture.runFrame({reinterpret_cast<const XrCompositionLayerBaseHeader*>(&layer)});
+
+        // The runtime receives the stereo views, with the field of view of the context views.
+        const std::vector<XrCompositionLayerProjectionView> stereoViews = mock_runtime::GetLastFrameProjectionViews();
+        CHECK(stereoViews.size() == xr::StereoView::Count);
+        for (uint32_t eye = 0; eye < stereoViews.size(); eye++) {
+            CHECK(std::find(swapchains.cbegin(), swapchains.cend(), stereoViews[eye].subImage.swapchain) ==
+                  swapchains.cend());
+            CHECK(stereoViews[eye].subImage.imageArrayIndex == eye);
+            CHECK(stereoViews[eye].subImage.imageRect.extent.width == 1000);
+            CHECK(stereoViews[eye].fov.angleLeft == projectionViews[eye].fov.angleLeft);
+            CHECK(stereoViews[eye].fov.angleUp == projectionViews[eye].fov.angleUp);
+        }
+    }
+
+    // (400x400 + 350x350) x 2 pixels for 1000x1000 x 2.
+    CHECK(ReadCounter(metrics::Counter::QuadViewsFramesComposed) - framesComposedBefore == 10);
+    CHECK(ReadGauge(metrics::Gauge::QuadViewsPixelsPercent) == 28);
+
+    for (XrSwapchain swapchain : swapchains) {
+        CHECK_XR(fixture.xr.xrDestroySwapchain(swapchain));
+    }
+}
+
+// The gaze is held still towards a quad 2 meters ahead and a cylinder of 3 meters around the user, located in the LOCAL
+// space at the identity like the view space. The topmost layer under the gaze is picked, whatever its type.
+TEST(GazedLayerIsPicked) {
+    LayerFixture fixture(getPickingSettings());
+
+    const XrVector3f quadCenter{2 * k_fixedGazeDirection.x, 2 * k_fixedGazeDirection.y, 2 * k_fixedGazeDirection.z};
+    const XrCompositionLayerQuad quad = makeQuad(fixture.localSpace, quadCenter, {0.2f, 0.2f});
+    const XrCompositionLayerQuad missedQuad = makeQuad(fixture.localSpace, {5.f, 0.f, -2.f}, {0.2f, 0.2f});
+    const XrCompositionLayerCylinderKHR cylinder = makeCylinder(fixture.localSpace, 0.f, 3.f, 1.f);
+    const auto header = [](const auto& layer) {
+        return reinterpret_cast<const XrCompositionLayerBaseHeader*>(&layer);
+    };
+
+    const uint64_t pickedBefore = ReadHistogram(metrics::Histogram::LayerPickingTime).count;
+    CHECK(ReadGauge(metrics::Gauge::GazedLayerIndex) == -1);
+
+    // Layers that are not under the gaze are skipped.
+    fixture.runFrame({header(cylinder), header(quad), header(missedQuad)});
+    CHECK(ReadGauge(metrics::Gauge::GazedLayerIndex) == 1);
+
+    // The cylinder is drawn over the quad.
+    fixture.runFrame({header(quad), header(cylinder)});
+    CHECK(ReadGauge(metrics::Gauge::GazedLayerIndex) == 1);
+
+    fixture.runFrame({header(cylinder), header(missedQuad)});
+    CHECK(ReadGauge(metrics::Gauge::GazedLayerIndex) == 0);
+
+    fixture.runFrame({header(missedQuad)});
+    CHECK(ReadGauge(metrics::Gauge::GazedLayerIndex) == -1);
+
+    CHECK(ReadHistogram(metrics::Histogram::LayerPickingTime).count - pickedBefore == 4);
+}
+
+// The layer counts its own heap allocations made during the per-frame calls, once the session is warmed up (see
+// allocations.h). None are allowed.
+TEST(PerFramePathDoesNotAllocate) {
+    LayerFixture fixture(GetReplaySettings());
+
+    // Past the warm-up of the layer.
+    for (uint32_t i = 0; i < 150; i++) {
+        fixture.runFrame();
+    }
+
+    const uint64_t allocationsBefore = ReadCounter(metrics::Counter::HotPathAllocations);
+    for (uint32_t i = 0; i < 500; i++) {
+        fixture.runFrame();
+
+        XrSpaceLocation location{XR_TYPE_SPACE_LOCATION};
+        CHECK_XR(fixture.xr.xrLocateSpace(fixture.localSpace, fixture.localSpace, fixture.lastDisplayTime, &location));
+    }
+    CHECK(ReadCounter(metrics::Counter::HotPathAllocations) - allocationsBefore == 0);
+}
+
+// Cost of the layer on the calls made by an engine every frame, against the same calls made to the runtime directly.
+// The runtime returns immediately, so the differences are the overhead of the layer.
+BENCHMARK(LayerOverhead) {
+    LayerFixture fixture(GetReplaySettings());
+    for (uint32_t i = 0; i < 200; i++) {
+        fixture.runFrame();
+    }
+
+    const auto runtimeLocateSpace = getRuntimeFunction<PFN_xrLocateSpace>(fixture.instance, "xrLocateSpace");
+    const auto runtimeWaitFrame = getRuntimeFunction<PFN_xrWaitFrame>(fixture.instance, "xrWaitFrame");
+    const auto runtimeBeginFrame = getRuntimeFunction<PFN_xrBeginFrame>(fixture.instance, "xrBeginFrame");
+    const auto runtimeEndFrame = getRuntimeFunction<PFN_xrEndFrame>(fixture.instance, "xrEndFrame");
+
+    const XrTime time = fixture.lastDisplayTime;
+    double checksum = 0;
+    const auto locate = [&](PFN_xrLocateSpace xrLocateSpace, XrSpace space) {
+        return MeasureNanoseconds([&] {
+            XrSpaceLocation location{XR_TYPE_SPACE_LOCATION};
+            xrLocateSpace(space, fixture.localSpace, time, &location);
+            checksum += location.pose.orientation.x;
+        });
+    };
+    const auto frame = [&](PFN_xrWaitFrame xrWaitFrame, PFN_xrBeginFrame xrBeginFrame, PFN_xrEndFrame xrEndFrame) {
+        return MeasureNanoseconds(
+            [&] {
+                XrFrameState frameState{XR_TYPE_FRAME_STATE};
+                xrWaitFrame(fixture.session, nullptr, &frameState);
+                xrBeginFrame(fixture.session, nullptr);
+                XrFrameEndInfo frameEndInfo{XR_TYPE_FRAME_END_INFO};
+                frameEndInfo.displayTime = frameState.predictedDisplayTime;
+                frameEndInfo.environmentBlendMode = XR_ENVIRONMENT_BLEND_MODE_OPAQUE;
+                xrEndFrame(fixture.session, &frameEndInfo);
+            },
+            100);
+    };
+
+    Report("xrLocateSpace, runtime", locate(runtimeLocateSpace, fixture.localSpace), "ns");
+    Report("xrLocateSpace, layer, other space", locate(fixture.xr.xrLocateSpace, fixture.localSpace), "ns");
+    Report("xrLocateSpace, layer, eye gaze space", locate(fixture.xr.xrLocateSpace, fixture.gazeSpace), "ns");
+    Report("xrWaitFrame/xrBeginFrame/xrEndFrame, runtime",
+           frame(runtimeWaitFrame, runtimeBeginFrame, runtimeEndFrame),
+           "ns");
+    Report("xrWaitFrame/xrBeginFrame/xrEndFrame, layer",
+           frame(fixture.xr.xrWaitFrame, fixture.xr.xrBeginFrame, fixture.xr.xrEndFrame),
+           "ns");
+    Report("Engine frame with eye gaze, layer", MeasureNanoseconds([&] { fixture.runFrame(); }, 100), "ns");
+    Consume(checksum);
+}
+
+// Cost of picking the gazed layer in xrEndFrame, in the worst case where no layer is under the gaze and all of them are
+// tested: quads beside the gaze alternating with cylinders whose arc is behind the user. The picking time is the one
+// recorded by the layer, and the engine frame shows what it adds to the frame of an application.
+BENCHMARK(GazedLayerPicking) {
+    LayerFixture fixture(getPickingSettings());
+    for (uint32_t i = 0; i < 200; i++) {
+        fixture.runFrame();
+    }
+
+    Report("Engine frame without layers", MeasureNanoseconds([&] { fixture.runFrame(); }, 100), "ns");
+    for (const uint32_t layerCount : {1, 8, 16, 32, 64}) {
+        std::vector<XrCompositionLayerQuad> quads;
+        std::vector<XrCompositionLayerCylinderKHR> cylinders;
+        for (uint32_t i = 0; i < layerCount; i++) {
+            if (i % 2) {
+                cylinders.push_back(makeCylinder(fixture.localSpace, static_cast<float>(M_PI), 3.f, 1.f));
+            } else {
+                quads.push_back(makeQuad(fixture.localSpace, {5.f, 0.f, -2.f - i}, {0.2f, 0.2f}));
+            }
+        }
+        std::vector<const XrCompositionLayerBaseHeader*> layers;
+        for (uint32_t i = 0; i < layerCount; i++) {
+            layers.push_back(i % 2 ? reinterpret_cast<const XrCompositionLayerBaseHeader*>(&cylinders[i / 2])
+                                   : reinterpret_cast<const XrCompositionLayerBaseHeader*>(&quads[i / 2]));
+        }
+
+        const auto& histogram = ReadHistogram(metrics::Histogram::LayerPickingTime);
+        const uint64_t countBefore = histogram.count;
+        const uint64_t sumBefore = histogram.sum;
+        const double frameNanoseconds = MeasureNanoseconds([&] { fixture.runFrame(layers); }, 100);
+        CHECK(ReadGauge(metrics::Gauge::GazedLayerIndex) == -1);
+
+        Report(fmt::format("{} layers, picking", layerCount),
+               static_cast<double>(histogram.sum - sumBefore) / (histogram.count - countBefore),
+               "ns");
+        Report(fmt::format("{} layers, engine frame", layerCount), frameNanoseconds, "ns");
+    }
+}
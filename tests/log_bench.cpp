@@ -0,0 +1,108 @@
+// MIT License
+//
+// Copyright(c) 2022-2023 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "pch.h"
+
+#include "layer_fixture.h"
+
+#include <framework/log.h>
+
+namespace {
+
+    using namespace openxr_api_layer::log;
+    using namespace openxr_api_layer::testing;
+    using namespace openxr_api_layer::tests;
+
+    // Threads that keep the writer thread busy: each one logs a record of a typical length, then waits for the given
+    // period (or not at all, which keeps the queue full).
+    class BusyWriter {
+      public:
+        BusyWriter(uint32_t threadCount, std::chrono::microseconds period) {
+            for (uint32_t i = 0; i < threadCount; i++) {
+                m_threads.emplace_back([this, period, i] {
+                    using clock = std::chrono::steady_clock;
+
+                    uint64_t index = 0;
+                    while (!m_isStopping.load(std::memory_order_relaxed)) {
+                        Log("Background thread %u, record %llu: tracker %s, gaze (%.3f, %.3f, %.3f)\n",
+                            i,
+                            index++,
+                            "Simulated",
+                            0.1f,
+                            -0.2f,
+                            -0.97f);
+                        const auto deadline = clock::now() + period;
+                        while (clock::now() < deadline) {
+                        }
+                    }
+                });
+            }
+        }
+
+        ~BusyWriter() {
+            m_isStopping = true;
+            for (auto& thread : m_threads) {
+                thread.join();
+            }
+        }
+
+      private:
+        std::atomic<bool> m_isStopping{false};
+        std::vector<std::thread> m_threads;
+    };
+
+    void measureCallers(const std::string& label) {
+        fmt::print("    {}:\n", label);
+        uint64_t index = 0;
+        Report("  Log() formatted",
+               MeasureNanoseconds([&] { Log("Frame %llu: %u layers, gaze %.3f\n", index++, 4u, 0.5f); }),
+               "ns");
+        const std::string_view text = "xrEndFrame: no projection layer\n";
+        Report("  Log() string", MeasureNanoseconds([&] { Log(text); }), "ns");
+
+        // Past its first records, a call site is suppressed until the end of the window.
+        Report("  ErrorLog() suppressed",
+               MeasureNanoseconds([&] { ErrorLog("Failed to locate the gaze: %llu\n", index++); }),
+               "ns");
+    }
+
+} // namespace
+
+// The cost of logging for the calling thread (usually the frame loop of the application), while the writer thread is
+// idle, while other threads keep it busy, and while they keep the queue full (the records of the callers are then
+// dropped).
+BENCHMARK(LogCallerCost) {
+    StartLogging(GetTemporaryFolder() / "log_bench.log");
+
+    measureCallers("writer idle");
+    {
+        BusyWriter busyWriter(2, 20us);
+        measureCallers("writer busy, 2 threads logging every 20us");
+    }
+    {
+        BusyWriter busyWriter(2, 0us);
+        measureCallers("queue full, 2 threads flooding");
+    }
+
+    FlushLog();
+}
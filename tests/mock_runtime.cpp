@@ -0,0 +1,838 @@
+// MIT License
+//
+// Copyright(c) 2022-2023 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "pch.h"
+
+#include "mock_runtime.h"
+
+namespace {
+
+    using namespace openxr_api_layer::tests::mock_runtime;
+
+    constexpr XrSystemId k_systemId = 1;
+
+    Options g_options;
+    std::atomic<uint64_t> g_callCounts[static_cast<uint32_t>(Call::Count)];
+    std::atomic<uint64_t> g_nextHandle{1};
+
+    // XrPath values are the index in g_paths plus one.
+    std::mutex g_pathsMutex;
+    std::vector<std::string> g_paths;
+    std::unordered_map<std::string, XrPath> g_pathIds;
+
+    std::mutex g_eventsMutex;
+    std::deque<XrEventDataSessionStateChanged> g_events;
+
+    constexpr uint32_t k_swapchainLength = 3;
+
+    struct Swapchain {
+        uint32_t nextImage{0};
+        std::deque<uint32_t> acquiredImages;
+        // The oldest acquired images that were waited.
+        uint32_t waitedImages{0};
+    };
+
+    std::mutex g_swapchainsMutex;
+    std::unordered_map<XrSwapchain, Swapchain> g_swapchains;
+
+    std::mutex g_lastFrameMutex;
+    std::vector<XrCompositionLayerProjectionView> g_lastFrameProjectionViews;
+
+    void count(Call call) {
+        g_callCounts[static_cast<uint32_t>(call)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    template <typename Handle>
+    Handle newHandle() {
+        return (Handle)g_nextHandle.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Simulates the cost of the runtime without yielding the thread.
+    void spin(std::chrono::nanoseconds duration) {
+        if (duration.count() <= 0) {
+            return;
+        }
+        const auto end = std::chrono::steady_clock::now() + duration;
+        while (std::chrono::steady_clock::now() < end) {
+            YieldProcessor();
+        }
+    }
+
+    XrTime toXrTime(const LARGE_INTEGER& counter) {
+        static const int64_t frequency = [] {
+            LARGE_INTEGER frequency;
+            QueryPerformanceFrequency(&frequency);
+            return frequency.QuadPart;
+        }();
+        return (counter.QuadPart / frequency) * 1'000'000'000 +
+               (counter.QuadPart % frequency) * 1'000'000'000 / frequency;
+    }
+
+    XrTime now() {
+        LARGE_INTEGER counter;
+        QueryPerformanceCounter(&counter);
+        return toXrTime(counter);
+    }
+
+    void queueSessionState(XrSession session, XrSessionState state) {
+        XrEventDataSessionStateChanged event{XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED};
+        event.session = session;
+        event.state = state;
+        event.time = now();
+
+        std::unique_lock lock(g_eventsMutex);
+        g_events.push_back(event);
+    }
+
+    XrResult XRAPI_CALL xrEnumerateInstanceExtensionProperties(const char* layerName,
+                                                              uint32_t propertyCapacityInput,
+                                                              uint32_t* propertyCountOutput,
+                                                              XrExtensionProperties* properties) {
+        std::vector<const char*> extensions;
+        if (g_options.supportsPerformanceCounterConversion) {
+            extensions.push_back(XR_KHR_WIN32_CONVERT_PERFORMANCE_COUNTER_TIME_EXTENSION_NAME);
+        }
+        if (g_options.supportsEyeTrackingSocial) {
+            extensions.push_back(XR_FB_EYE_TRACKING_SOCIAL_EXTENSION_NAME);
+        }
+
+        *propertyCountOutput = static_cast<uint32_t>(extensions.size());
+        if (!propertyCapacityInput) {
+            return XR_SUCCESS;
+        }
+        if (propertyCapacityInput < extensions.size()) {
+            return XR_ERROR_SIZE_INSUFFICIENT;
+        }
+        for (size_t i = 0; i < extensions.size(); i++) {
+            strcpy_s(properties[i].extensionName, extensions[i]);
+            properties[i].extensionVersion = 1;
+        }
+        return XR_SUCCESS;
+    }
+
+    XrResult XRAPI_CALL xrDestroyInstance(XrInstance instance) {
+        count(Call::DestroyInstance);
+        return XR_SUCCESS;
+    }
+
+    XrResult XRAPI_CALL xrGetInstanceProperties(XrInstance instance, XrInstanceProperties* instanceProperties) {
+        if (instanceProperties->type != XR_TYPE_INSTANCE_PROPERTIES) {
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+        strcpy_s(instanceProperties->runtimeName, "Mock runtime");
+        instanceProperties->runtimeVersion = XR_MAKE_VERSION(1, 0, 0);
+        return XR_SUCCESS;
+    }
+
+    XrResult XRAPI_CALL xrPollEvent(XrInstance instance, XrEventDataBuffer* eventData) {
+        std::unique_lock lock(g_eventsMutex);
+        if (g_events.empty()) {
+            return XR_EVENT_UNAVAILABLE;
+        }
+        *reinterpret_cast<XrEventDataSessionStateChanged*>(eventData) = g_events.front();
+        g_events.pop_front();
+        return XR_SUCCESS;
+    }
+
+    XrResult XRAPI_CALL xrGetSystem(XrInstance instance, const XrSystemGetInfo* getInfo, XrSystemId* systemId) {
+        count(Call::GetSystem);
+        if (getInfo->type != XR_TYPE_SYSTEM_GET_INFO) {
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+        if (getInfo->formFactor != XR_FORM_FACTOR_HEAD_MOUNTED_DISPLAY) {
+            return XR_ERROR_FORM_FACTOR_UNSUPPORTED;
+        }
+        *systemId = k_systemId;
+        return XR_SUCCESS;
+    }
+
+    // Extension structures chained by the caller are left untouched, except for the eye tracking properties.
+    XrResult XRAPI_CALL xrGetSystemProperties(XrInstance instance,
+                                              XrSystemId systemId,
+                                              XrSystemProperties* properties) {
+        if (properties->type != XR_TYPE_SYSTEM_PROPERTIES) {
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+        if (systemId != k_systemId) {
+            return XR_ERROR_SYSTEM_INVALID;
+        }
+        properties->systemId = k_systemId;
+        properties->vendorId = 0;
+        strcpy_s(properties->systemName, g_options.systemName.c_str());
+        properties->graphicsProperties.maxSwapchainImageWidth = 4096;
+        properties->graphicsProperties.maxSwapchainImageHeight = 4096;
+        properties->graphicsProperties.maxLayerCount = XR_MIN_COMPOSITION_LAYERS_SUPPORTED;
+        properties->trackingProperties.orientationTracking = XR_TRUE;
+        properties->trackingProperties.positionTracking = XR_TRUE;
+
+        auto entry = reinterpret_cast<XrBaseOutStructure*>(properties->next);
+        while (entry) {
+            if (entry->type == XR_TYPE_SYSTEM_EYE_TRACKING_PROPERTIES_FB) {
+                reinterpret_cast<XrSystemEyeTrackingPropertiesFB*>(entry)->supportsEyeTracking =
+                    g_options.supportsEyeTrackingSocial ? XR_TRUE : XR_FALSE;
+            }
+            entry = entry->next;
+        }
+        return XR_SUCCESS;
+    }
+
+    XrResult XRAPI_CALL xrEnumerateViewConfigurations(XrInstance instance,
+                                                      XrSystemId systemId,
+                                                      uint32_t viewConfigurationTypeCapacityInput,
+                                                      uint32_t* viewConfigurationTypeCountOutput,
+                                                      XrViewConfigurationType* viewConfigurationTypes) {
+        if (systemId != k_systemId) {
+            return XR_ERROR_SYSTEM_INVALID;
+        }
+
+        *viewConfigurationTypeCountOutput = 1;
+        if (!viewConfigurationTypeCapacityInput) {
+            return XR_SUCCESS;
+        }
+        viewConfigurationTypes[0] = XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO;
+        return XR_SUCCESS;
+    }
+
+    XrResult XRAPI_CALL xrGetViewConfigurationProperties(XrInstance instance,
+                                                         XrSystemId systemId,
+                                                         XrViewConfigurationType viewConfigurationType,
+                                                         XrViewConfigurationProperties* configurationProperties) {
+        if (configurationProperties->type != XR_TYPE_VIEW_CONFIGURATION_PROPERTIES) {
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+        if (systemId != k_systemId) {
+            return XR_ERROR_SYSTEM_INVALID;
+        }
+        if (viewConfigurationType != XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO) {
+            return XR_ERROR_VIEW_CONFIGURATION_TYPE_UNSUPPORTED;
+        }
+        configurationProperties->viewConfigurationType = viewConfigurationType;
+        configurationProperties->fovMutable = XR_TRUE;
+        return XR_SUCCESS;
+    }
+
+    XrResult XRAPI_CALL xrEnumerateViewConfigurationViews(XrInstance instance,
+                                                          XrSystemId systemId,
+                                                          XrViewConfigurationType viewConfigurationType,
+                                                          uint32_t viewCapacityInput,
+                                                          uint32_t* viewCountOutput,
+                                                          XrViewConfigurationView* views) {
+        if (systemId != k_systemId) {
+            return XR_ERROR_SYSTEM_INVALID;
+        }
+        if (viewConfigurationType != XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO) {
+            return XR_ERROR_VIEW_CONFIGURATION_TYPE_UNSUPPORTED;
+        }
+
+        *viewCountOutput = xr::StereoView::Count;
+        if (!viewCapacityInput) {
+            return XR_SUCCESS;
+        }
+        if (viewCapacityInput < xr::StereoView::Count) {
+            return XR_ERROR_SIZE_INSUFFICIENT;
+        }
+        for (uint32_t eye = 0; eye < xr::StereoView::Count; eye++) {
+            if (views[eye].type != XR_TYPE_VIEW_CONFIGURATION_VIEW) {
+                return XR_ERROR_VALIDATION_FAILURE;
+            }
+            views[eye].recommendedImageRectWidth = g_options.recommendedResolution.width;
+            views[eye].recommendedImageRectHeight = g_options.recommendedResolution.height;
+            views[eye].maxImageRectWidth = 4096;
+            views[eye].maxImageRectHeight = 4096;
+            views[eye].recommendedSwapchainSampleCount = 1;
+            views[eye].maxSwapchainSampleCount = 4;
+        }
+        return XR_SUCCESS;
+    }
+
+    XrResult XRAPI_CALL xrEnumerateEnvironmentBlendModes(XrInstance instance,
+                                                         XrSystemId systemId,
+                                                         XrViewConfigurationType viewConfigurationType,
+                                                         uint32_t environmentBlendModeCapacityInput,
+                                                         uint32_t* environmentBlendModeCountOutput,
+                                                         XrEnvironmentBlendMode* environmentBlendModes) {
+        if (systemId != k_systemId) {
+            return XR_ERROR_SYSTEM_INVALID;
+        }
+        if (viewConfigurationType != XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO) {
+            return XR_ERROR_VIEW_CONFIGURATION_TYPE_UNSUPPORTED;
+        }
+
+        *environmentBlendModeCountOutput = 1;
+        if (!environmentBlendModeCapacityInput) {
+            return XR_SUCCESS;
+        }
+        environmentBlendModes[0] = XR_ENVIRONMENT_BLEND_MODE_OPAQUE;
+        return XR_SUCCESS;
+    }
+
+    XrResult XRAPI_CALL xrStringToPath(XrInstance instance, const char* pathString, XrPath* path) {
+        if (!pathString || pathString[0] != '/') {
+            return XR_ERROR_PATH_FORMAT_INVALID;
+        }
+
+        std::unique_lock lock(g_pathsMutex);
+        const auto it = g_pathIds.find(pathString);
+        if (it != g_pathIds.end()) {
+            *path = it->second;
+        } else {
+            g_paths.push_back(pathString);
+            *path = g_paths.size();
+            g_pathIds.insert_or_assign(pathString, *path);
+        }
+        return XR_SUCCESS;
+    }
+
+    XrResult XRAPI_CALL xrPathToString(
+        XrInstance instance, XrPath path, uint32_t bufferCapacityInput, uint32_t* bufferCountOutput, char* buffer) {
+        std::unique_lock lock(g_pathsMutex);
+        if (path == XR_NULL_PATH || path > g_paths.size()) {
+            return XR_ERROR_PATH_INVALID;
+        }
+
+        const std::string& pathString = g_paths[path - 1];
+        *bufferCountOutput = static_cast<uint32_t>(pathString.size() + 1);
+        if (!bufferCapacityInput) {
+            return XR_SUCCESS;
+        }
+        if (bufferCapacityInput < *bufferCountOutput) {
+            return XR_ERROR_SIZE_INSUFFICIENT;
+        }
+        std::memcpy(buffer, pathString.c_str(), *bufferCountOutput);
+        return XR_SUCCESS;
+    }
+
+    XrResult XRAPI_CALL xrCreateSession(XrInstance instance,
+                                        const XrSessionCreateInfo* createInfo,
+                                        XrSession* session) {
+        count(Call::CreateSession);
+        if (createInfo->type != XR_TYPE_SESSION_CREATE_INFO) {
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+        if (createInfo->systemId != k_systemId) {
+            return XR_ERROR_SYSTEM_INVALID;
+        }
+        *session = newHandle<XrSession>();
+        queueSessionState(*session, XR_SESSION_STATE_IDLE);
+        queueSessionState(*session, XR_SESSION_STATE_READY);
+        return XR_SUCCESS;
+    }
+
+    XrResult XRAPI_CALL xrDestroySession(XrSession session) {
+        count(Call::DestroySession);
+        return XR_SUCCESS;
+    }
+
+    XrResult XRAPI_CALL xrBeginSession(XrSession session, const XrSessionBeginInfo* beginInfo) {
+        if (beginInfo->type != XR_TYPE_SESSION_BEGIN_INFO) {
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+        if (beginInfo->primaryViewConfigurationType != XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO) {
+            return XR_ERROR_VIEW_CONFIGURATION_TYPE_UNSUPPORTED;
+        }
+        queueSessionState(session, XR_SESSION_STATE_SYNCHRONIZED);
+        queueSessionState(session, XR_SESSION_STATE_VISIBLE);
+        queueSessionState(session, XR_SESSION_STATE_FOCUSED);
+        return XR_SUCCESS;
+    }
+
+    XrResult XRAPI_CALL xrEndSession(XrSession session) {
+        return XR_SUCCESS;
+    }
+
+    XrResult XRAPI_CALL xrCreateReferenceSpace(XrSession session,
+                                               const XrReferenceSpaceCreateInfo* createInfo,
+                                               XrSpace* space) {
+        count(Call::CreateReferenceSpace);
+        if (createInfo->type != XR_TYPE_REFERENCE_SPACE_CREATE_INFO) {
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+        *space = newHandle<XrSpace>();
+        return XR_SUCCESS;
+    }
+
+    XrResult XRAPI_CALL xrCreateActionSpace(XrSession session,
+                                            const XrActionSpaceCreateInfo* createInfo,
+                                            XrSpace* space) {
+        count(Call::CreateActionSpace);
+        if (createInfo->type != XR_TYPE_ACTION_SPACE_CREATE_INFO) {
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+        *space = newHandle<XrSpace>();
+        return XR_SUCCESS;
+    }
+
+    XrResult XRAPI_CALL xrDestroySpace(XrSpace space) {
+        return XR_SUCCESS;
+    }
+
+    XrResult XRAPI_CALL xrLocateSpace(XrSpace space, XrSpace baseSpace, XrTime time, XrSpaceLocation* location) {
+        count(Call::LocateSpace);
+        if (location->type != XR_TYPE_SPACE_LOCATION) {
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+        if (time <= 0) {
+            return XR_ERROR_TIME_INVALID;
+        }
+        spin(g_options.locateSpaceCost);
+        location->pose = xr::math::Pose::Identity();
+        location->locationFlags = XR_SPACE_LOCATION_ORIENTATION_VALID_BIT | XR_SPACE_LOCATION_ORIENTATION_TRACKED_BIT |
+                                  XR_SPACE_LOCATION_POSITION_VALID_BIT | XR_SPACE_LOCATION_POSITION_TRACKED_BIT;
+        return XR_SUCCESS;
+    }
+
+    XrResult XRAPI_CALL xrLocateViews(XrSession session,
+                                      const XrViewLocateInfo* viewLocateInfo,
+                                      XrViewState* viewState,
+                                      uint32_t viewCapacityInput,
+                                      uint32_t* viewCountOutput,
+                                      XrView* views) {
+        count(Call::LocateViews);
+        if (viewLocateInfo->type != XR_TYPE_VIEW_LOCATE_INFO || viewState->type != XR_TYPE_VIEW_STATE) {
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+        if (viewLocateInfo->viewConfigurationType != XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO) {
+            return XR_ERROR_VIEW_CONFIGURATION_TYPE_UNSUPPORTED;
+        }
+
+        *viewCountOutput = xr::StereoView::Count;
+        if (!viewCapacityInput) {
+            return XR_SUCCESS;
+        }
+        if (viewCapacityInput < xr::StereoView::Count) {
+            return XR_ERROR_SIZE_INSUFFICIENT;
+        }
+        viewState->viewStateFlags = XR_VIEW_STATE_ORIENTATION_VALID_BIT | XR_VIEW_STATE_ORIENTATION_TRACKED_BIT |
+                                    XR_VIEW_STATE_POSITION_VALID_BIT | XR_VIEW_STATE_POSITION_TRACKED_BIT;
+        for (uint32_t eye = 0; eye < xr::StereoView::Count; eye++) {
+            views[eye].pose = g_options.viewPoses[eye];
+            views[eye].fov = g_options.viewFovs[eye];
+        }
+        return XR_SUCCESS;
+    }
+
+    XrResult XRAPI_CALL xrWaitFrame(XrSession session, const XrFrameWaitInfo* frameWaitInfo, XrFrameState* frameState) {
+        count(Call::WaitFrame);
+        if (frameState->type != XR_TYPE_FRAME_STATE) {
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+        spin(g_options.frameCost);
+        frameState->predictedDisplayPeriod = g_options.displayPeriod;
+        frameState->predictedDisplayTime = now() + 2 * g_options.displayPeriod;
+        frameState->shouldRender = XR_TRUE;
+        return XR_SUCCESS;
+    }
+
+    XrResult XRAPI_CALL xrBeginFrame(XrSession session, const XrFrameBeginInfo* frameBeginInfo) {
+        count(Call::BeginFrame);
+        return XR_SUCCESS;
+    }
+
+    XrResult XRAPI_CALL xrEndFrame(XrSession session, const XrFrameEndInfo* frameEndInfo) {
+        count(Call::EndFrame);
+        if (frameEndInfo->type != XR_TYPE_FRAME_END_INFO) {
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+        if (frameEndInfo->displayTime <= 0) {
+            return XR_ERROR_TIME_INVALID;
+        }
+
+        std::vector<XrCompositionLayerProjectionView> projectionViews;
+        for (uint32_t i = 0; i < frameEndInfo->layerCount; i++) {
+            if (frameEndInfo->layers[i]->type != XR_TYPE_COMPOSITION_LAYER_PROJECTION) {
+                continue;
+            }
+            const auto layer = reinterpret_cast<const XrCompositionLayerProjection*>(frameEndInfo->layers[i]);
+            if (layer->viewCount != xr::StereoView::Count) {
+                return XR_ERROR_VALIDATION_FAILURE;
+            }
+            projectionViews.insert(projectionViews.end(), layer->views, layer->views + layer->viewCount);
+        }
+
+        std::unique_lock lock(g_lastFrameMutex);
+        g_lastFrameProjectionViews = std::move(projectionViews);
+        return XR_SUCCESS;
+    }
+
+    XrResult XRAPI_CALL xrEnumerateSwapchainFormats(XrSession session,
+                                                    uint32_t formatCapacityInput,
+                                                    uint32_t* formatCountOutput,
+                                                    int64_t* formats) {
+        const int64_t supportedFormats[] = {
+            DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_FORMAT_D32_FLOAT};
+
+        *formatCountOutput = static_cast<uint32_t>(std::size(supportedFormats));
+        if (!formatCapacityInput) {
+            return XR_SUCCESS;
+        }
+        if (formatCapacityInput < std::size(supportedFormats)) {
+            return XR_ERROR_SIZE_INSUFFICIENT;
+        }
+        std::copy(std::cbegin(supportedFormats), std::cend(supportedFormats), formats);
+        return XR_SUCCESS;
+    }
+
+    XrResult XRAPI_CALL xrCreateSwapchain(XrSession session,
+                                          const XrSwapchainCreateInfo* createInfo,
+                                          XrSwapchain* swapchain) {
+        count(Call::CreateSwapchain);
+        if (createInfo->type != XR_TYPE_SWAPCHAIN_CREATE_INFO) {
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+        *swapchain = newHandle<XrSwapchain>();
+
+        std::unique_lock lock(g_swapchainsMutex);
+        g_swapchains.insert_or_assign(*swapchain, Swapchain{});
+        return XR_SUCCESS;
+    }
+
+    XrResult XRAPI_CALL xrDestroySwapchain(XrSwapchain swapchain) {
+        count(Call::DestroySwapchain);
+
+        std::unique_lock lock(g_swapchainsMutex);
+        return g_swapchains.erase(swapchain) ? XR_SUCCESS : XR_ERROR_HANDLE_INVALID;
+    }
+
+    XrResult XRAPI_CALL xrEnumerateSwapchainImages(XrSwapchain swapchain,
+                                                   uint32_t imageCapacityInput,
+                                                   uint32_t* imageCountOutput,
+                                                   XrSwapchainImageBaseHeader* images) {
+        std::unique_lock lock(g_swapchainsMutex);
+        if (g_swapchains.find(swapchain) == g_swapchains.cend()) {
+            return XR_ERROR_HANDLE_INVALID;
+        }
+
+        *imageCountOutput = k_swapchainLength;
+        if (imageCapacityInput && imageCapacityInput < k_swapchainLength) {
+            return XR_ERROR_SIZE_INSUFFICIENT;
+        }
+        return XR_SUCCESS;
+    }
+
+    XrResult XRAPI_CALL xrAcquireSwapchainImage(XrSwapchain swapchain,
+                                                const XrSwapchainImageAcquireInfo* acquireInfo,
+                                                uint32_t* index) {
+        count(Call::AcquireSwapchainImage);
+
+        std::unique_lock lock(g_swapchainsMutex);
+        const auto it = g_swapchains.find(swapchain);
+        if (it == g_swapchains.end()) {
+            return XR_ERROR_HANDLE_INVALID;
+        }
+        Swapchain& state = it->second;
+        if (state.acquiredImages.size() == k_swapchainLength) {
+            return XR_ERROR_CALL_ORDER_INVALID;
+        }
+        *index = state.nextImage;
+        state.acquiredImages.push_back(state.nextImage);
+        state.nextImage = (state.nextImage + 1) % k_swapchainLength;
+        return XR_SUCCESS;
+    }
+
+    XrResult XRAPI_CALL xrWaitSwapchainImage(XrSwapchain swapchain, const XrSwapchainImageWaitInfo* waitInfo) {
+        if (waitInfo->type != XR_TYPE_SWAPCHAIN_IMAGE_WAIT_INFO) {
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+
+        std::unique_lock lock(g_swapchainsMutex);
+        const auto it = g_swapchains.find(swapchain);
+        if (it == g_swapchains.end()) {
+            return XR_ERROR_HANDLE_INVALID;
+        }
+        Swapchain& state = it->second;
+        if (state.waitedImages == state.acquiredImages.size()) {
+            return XR_ERROR_CALL_ORDER_INVALID;
+        }
+        state.waitedImages++;
+        return XR_SUCCESS;
+    }
+
+    XrResult XRAPI_CALL xrReleaseSwapchainImage(XrSwapchain swapchain,
+                                                const XrSwapchainImageReleaseInfo* releaseInfo) {
+        count(Call::ReleaseSwapchainImage);
+
+        std::unique_lock lock(g_swapchainsMutex);
+        const auto it = g_swapchains.find(swapchain);
+        if (it == g_swapchains.end()) {
+            return XR_ERROR_HANDLE_INVALID;
+        }
+        Swapchain& state = it->second;
+        if (!state.waitedImages) {
+            return XR_ERROR_CALL_ORDER_INVALID;
+        }
+        state.acquiredImages.pop_front();
+        state.waitedImages--;
+        return XR_SUCCESS;
+    }
+
+    XrResult XRAPI_CALL xrCreateActionSet(XrInstance instance,
+                                          const XrActionSetCreateInfo* createInfo,
+                                          XrActionSet* actionSet) {
+        if (createInfo->type != XR_TYPE_ACTION_SET_CREATE_INFO) {
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+        *actionSet = newHandle<XrActionSet>();
+        return XR_SUCCESS;
+    }
+
+    XrResult XRAPI_CALL xrDestroyActionSet(XrActionSet actionSet) {
+        return XR_SUCCESS;
+    }
+
+    XrResult XRAPI_CALL xrCreateAction(XrActionSet actionSet, const XrActionCreateInfo* createInfo, XrAction* action) {
+        if (createInfo->type != XR_TYPE_ACTION_CREATE_INFO) {
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+        *action = newHandle<XrAction>();
+        return XR_SUCCESS;
+    }
+
+    XrResult XRAPI_CALL xrDestroyAction(XrAction action) {
+        return XR_SUCCESS;
+    }
+
+    // Like a runtime without eye tracking, the eye gaze interaction profile is rejected.
+    XrResult XRAPI_CALL xrSuggestInteractionProfileBindings(
+        XrInstance instance, const XrInteractionProfileSuggestedBinding* suggestedBindings) {
+        count(Call::SuggestInteractionProfileBindings);
+        if (suggestedBindings->type != XR_TYPE_INTERACTION_PROFILE_SUGGESTED_BINDING) {
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+
+        std::unique_lock lock(g_pathsMutex);
+        const auto it = g_pathIds.find("/interaction_profiles/ext/eye_gaze_interaction");
+        if (it != g_pathIds.end() && it->second == suggestedBindings->interactionProfile) {
+            return XR_ERROR_PATH_UNSUPPORTED;
+        }
+        return XR_SUCCESS;
+    }
+
+    XrResult XRAPI_CALL xrAttachSessionActionSets(XrSession session, const XrSessionActionSetsAttachInfo* attachInfo) {
+        if (attachInfo->type != XR_TYPE_SESSION_ACTION_SETS_ATTACH_INFO) {
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+        return XR_SUCCESS;
+    }
+
+    XrResult XRAPI_CALL xrSyncActions(XrSession session, const XrActionsSyncInfo* syncInfo) {
+        count(Call::SyncActions);
+        if (syncInfo->type != XR_TYPE_ACTIONS_SYNC_INFO) {
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+        spin(g_options.syncActionsCost);
+        return XR_SUCCESS;
+    }
+
+    XrResult XRAPI_CALL xrGetActionStatePose(XrSession session,
+                                             const XrActionStateGetInfo* getInfo,
+                                             XrActionStatePose* state) {
+        count(Call::GetActionStatePose);
+        if (getInfo->type != XR_TYPE_ACTION_STATE_GET_INFO || state->type != XR_TYPE_ACTION_STATE_POSE) {
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+        state->isActive = XR_TRUE;
+        return XR_SUCCESS;
+    }
+
+    XrResult XRAPI_CALL xrConvertWin32PerformanceCounterToTimeKHR(XrInstance instance,
+                                                                  const LARGE_INTEGER* performanceCounter,
+                                                                  XrTime* time) {
+        count(Call::ConvertWin32PerformanceCounterToTime);
+        *time = toXrTime(*performanceCounter);
+        return XR_SUCCESS;
+    }
+
+    XrResult XRAPI_CALL xrCreateEyeTrackerFB(XrSession session,
+                                             const XrEyeTrackerCreateInfoFB* createInfo,
+                                             XrEyeTrackerFB* eyeTracker) {
+        count(Call::CreateEyeTracker);
+        if (createInfo->type != XR_TYPE_EYE_TRACKER_CREATE_INFO_FB) {
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+        *eyeTracker = newHandle<XrEyeTrackerFB>();
+        return XR_SUCCESS;
+    }
+
+    XrResult XRAPI_CALL xrDestroyEyeTrackerFB(XrEyeTrackerFB eyeTracker) {
+        count(Call::DestroyEyeTracker);
+        return XR_SUCCESS;
+    }
+
+    XrResult XRAPI_CALL xrGetEyeGazesFB(XrEyeTrackerFB eyeTracker,
+                                        const XrEyeGazesInfoFB* gazeInfo,
+                                        XrEyeGazesFB* eyeGazes) {
+        count(Call::GetEyeGazes);
+        if (gazeInfo->type != XR_TYPE_EYE_GAZES_INFO_FB || eyeGazes->type != XR_TYPE_EYE_GAZES_FB) {
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+        if (gazeInfo->time <= 0) {
+            return XR_ERROR_TIME_INVALID;
+        }
+        for (uint32_t eye = 0; eye < xr::StereoView::Count; eye++) {
+            eyeGazes->gaze[eye].isValid = XR_TRUE;
+            eyeGazes->gaze[eye].gazePose = g_options.eyeGazePoses[eye];
+            eyeGazes->gaze[eye].gazeConfidence = g_options.eyeGazeConfidence;
+        }
+        eyeGazes->time = gazeInfo->time;
+        return XR_SUCCESS;
+    }
+
+#define MOCK_FUNCTION(name)                                                                                            \
+    {                                                                                                                  \
+        #name, reinterpret_cast<PFN_xrVoidFunction>(static_cast<PFN_##name>(name))                                     \
+    }
+
+    const std::map<std::string_view, PFN_xrVoidFunction> k_functions = {
+        MOCK_FUNCTION(xrGetInstanceProcAddr),
+        MOCK_FUNCTION(xrEnumerateInstanceExtensionProperties),
+        MOCK_FUNCTION(xrDestroyInstance),
+        MOCK_FUNCTION(xrGetInstanceProperties),
+        MOCK_FUNCTION(xrPollEvent),
+        MOCK_FUNCTION(xrGetSystem),
+        MOCK_FUNCTION(xrGetSystemProperties),
+        MOCK_FUNCTION(xrEnumerateViewConfigurations),
+        MOCK_FUNCTION(xrGetViewConfigurationProperties),
+        MOCK_FUNCTION(xrEnumerateViewConfigurationViews),
+        MOCK_FUNCTION(xrEnumerateEnvironmentBlendModes),
+        MOCK_FUNCTION(xrStringToPath),
+        MOCK_FUNCTION(xrPathToString),
+        MOCK_FUNCTION(xrCreateSession),
+        MOCK_FUNCTION(xrDestroySession),
+        MOCK_FUNCTION(xrBeginSession),
+        MOCK_FUNCTION(xrEndSession),
+        MOCK_FUNCTION(xrCreateReferenceSpace),
+        MOCK_FUNCTION(xrCreateActionSpace),
+        MOCK_FUNCTION(xrDestroySpace),
+        MOCK_FUNCTION(xrLocateSpace),
+        MOCK_FUNCTION(xrLocateViews),
+        MOCK_FUNCTION(xrWaitFrame),
+        MOCK_FUNCTION(xrBeginFrame),
+        MOCK_FUNCTION(xrEndFrame),
+        MOCK_FUNCTION(xrEnumerateSwapchainFormats),
+        MOCK_FUNCTION(xrCreateSwapchain),
+        MOCK_FUNCTION(xrDestroySwapchain),
+        MOCK_FUNCTION(xrEnumerateSwapchainImages),
+        MOCK_FUNCTION(xrAcquireSwapchainImage),
+        MOCK_FUNCTION(xrWaitSwapchainImage),
+        MOCK_FUNCTION(xrReleaseSwapchainImage),
+        MOCK_FUNCTION(xrCreateActionSet),
+        MOCK_FUNCTION(xrDestroyActionSet),
+        MOCK_FUNCTION(xrCreateAction),
+        MOCK_FUNCTION(xrDestroyAction),
+        MOCK_FUNCTION(xrSuggestInteractionProfileBindings),
+        MOCK_FUNCTION(xrAttachSessionActionSets),
+        MOCK_FUNCTION(xrSyncActions),
+        MOCK_FUNCTION(xrGetActionStatePose),
+    };
+
+    const std::map<std::string_view, PFN_xrVoidFunction> k_eyeTrackingSocialFunctions = {
+        MOCK_FUNCTION(xrCreateEyeTrackerFB),
+        MOCK_FUNCTION(xrDestroyEyeTrackerFB),
+        MOCK_FUNCTION(xrGetEyeGazesFB),
+    };
+
+#undef MOCK_FUNCTION
+
+} // namespace
+
+namespace openxr_api_layer::tests::mock_runtime {
+
+    void Reset(const Options& options) {
+        g_options = options;
+        for (auto& callCount : g_callCounts) {
+            callCount = 0;
+        }
+
+        {
+            std::unique_lock lock(g_eventsMutex);
+            g_events.clear();
+        }
+        {
+            std::unique_lock lock(g_swapchainsMutex);
+            g_swapchains.clear();
+        }
+        {
+            std::unique_lock lock(g_lastFrameMutex);
+            g_lastFrameProjectionViews.clear();
+        }
+    }
+
+    uint64_t GetCallCount(Call call) {
+        return g_callCounts[static_cast<uint32_t>(call)].load(std::memory_order_relaxed);
+    }
+
+    std::vector<XrCompositionLayerProjectionView> GetLastFrameProjectionViews() {
+        std::unique_lock lock(g_lastFrameMutex);
+        return g_lastFrameProjectionViews;
+    }
+
+    XrResult XRAPI_CALL xrGetInstanceProcAddr(XrInstance instance, const char* name, PFN_xrVoidFunction* function) {
+        const std::string_view functionName(name);
+        if (functionName == "xrConvertWin32PerformanceCounterToTimeKHR" &&
+            g_options.supportsPerformanceCounterConversion) {
+            *function = reinterpret_cast<PFN_xrVoidFunction>(::xrConvertWin32PerformanceCounterToTimeKHR);
+            return XR_SUCCESS;
+        }
+
+        if (g_options.supportsEyeTrackingSocial) {
+            const auto it = k_eyeTrackingSocialFunctions.find(functionName);
+            if (it != k_eyeTrackingSocialFunctions.cend()) {
+                *function = it->second;
+                return XR_SUCCESS;
+            }
+        }
+
+        const auto it = k_functions.find(functionName);
+        if (it == k_functions.cend()) {
+            *function = nullptr;
+            return XR_ERROR_FUNCTION_UNSUPPORTED;
+        }
+        *function = it->second;
+        return XR_SUCCESS;
+    }
+
+    XrResult XRAPI_CALL xrCreateApiLayerInstance(const XrInstanceCreateInfo* createInfo,
+                                                 const XrApiLayerCreateInfo* apiLayerInfo,
+                                                 XrInstance* instance) {
+        count(Call::CreateInstance);
+        if (createInfo->type != XR_TYPE_INSTANCE_CREATE_INFO) {
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+
+        // The layer enables its implicit extensions only when they are advertised.
+        for (uint32_t i = 0; i < createInfo->enabledExtensionCount; i++) {
+            const std::string_view extension(createInfo->enabledExtensionNames[i]);
+            const bool isSupported =
+                (extension == XR_KHR_WIN32_CONVERT_PERFORMANCE_COUNTER_TIME_EXTENSION_NAME &&
+                 g_options.supportsPerformanceCounterConversion) ||
+                (extension == XR_FB_EYE_TRACKING_SOCIAL_EXTENSION_NAME && g_options.supportsEyeTrackingSocial);
+            if (!isSupported) {
+                return XR_ERROR_EXTENSION_NOT_PRESENT;
+            }
+        }
+
+        *instance = newHandle<XrInstance>();
+        return XR_SUCCESS;
+    }
+
+} // namespace openxr_api_layer::tests::mock_runtime
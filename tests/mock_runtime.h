@@ -0,0 +1,105 @@
+// MIT License
+//
+// Copyright(c) 2022-2023 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+// An OpenXR runtime living in the test process, so that the layer can be driven without a loader nor a headset. It
+// implements the subset of OpenXR used by the layer and by the tests: one head-mounted system, optionally with the eye
+// tracking of XR_FB_eye_tracking_social, spaces that are all located at the identity, and a frame loop that never
+// blocks. XrTime is the performance counter
+// in nanoseconds. The cost of a real runtime can be simulated by spinning in the calls. Only the stereo view
+// configuration is supported, and the frames are only validated against it.
+//
+// The runtime is thread-safe. Spaces, actions and action sets are not tracked, only paths and swapchains are. Sessions
+// have no graphics bindings, so swapchains have no images to enumerate: only the state of their 3 images is tracked
+// (acquired, waited and released in order).
+namespace openxr_api_layer::tests::mock_runtime {
+
+    struct Options {
+        std::string systemName{"Mock runtime"};
+        bool supportsPerformanceCounterConversion{true};
+        XrDuration displayPeriod{11'111'111};
+        // Recommended resolution of each stereo view.
+        XrExtent2Di recommendedResolution{1000, 1000};
+        // Located views, relative to the view space.
+        std::array<XrPosef, xr::StereoView::Count> viewPoses{xr::math::Pose::Translation({-0.032f, 0, 0}),
+                                                             xr::math::Pose::Translation({0.032f, 0, 0})};
+        std::array<XrFovf, xr::StereoView::Count> viewFovs{XrFovf{-0.8f, 0.8f, 0.8f, -0.8f},
+                                                           XrFovf{-0.8f, 0.8f, 0.8f, -0.8f}};
+
+        // Eye tracking through XR_FB_eye_tracking_social, like on Quest Pro. Every query returns the same gazes.
+        bool supportsEyeTrackingSocial{false};
+        std::array<XrPosef, xr::StereoView::Count> eyeGazePoses{
+            xr::math::Pose::Translation({-0.032f, 0, 0}), xr::math::Pose::Translation({0.032f, 0, 0})};
+        float eyeGazeConfidence{0.9f};
+
+        // Time spent spinning in each call.
+        std::chrono::nanoseconds locateSpaceCost{0};
+        std::chrono::nanoseconds syncActionsCost{0};
+        std::chrono::nanoseconds frameCost{0};
+    };
+
+    // Runtime entry points counted by GetCallCount().
+    enum class Call : uint32_t {
+        CreateInstance = 0,
+        DestroyInstance,
+        GetSystem,
+        CreateSession,
+        DestroySession,
+        CreateReferenceSpace,
+        CreateActionSpace,
+        LocateSpace,
+        LocateViews,
+        WaitFrame,
+        BeginFrame,
+        EndFrame,
+        SuggestInteractionProfileBindings,
+        SyncActions,
+        GetActionStatePose,
+        ConvertWin32PerformanceCounterToTime,
+        CreateSwapchain,
+        DestroySwapchain,
+        AcquireSwapchainImage,
+        ReleaseSwapchainImage,
+        CreateEyeTracker,
+        DestroyEyeTracker,
+        GetEyeGazes,
+
+        Count
+    };
+
+    // Options apply to the next instance created. Resets the call counts.
+    void Reset(const Options& options = {});
+
+    uint64_t GetCallCount(Call call);
+
+    // The views of the projection layers submitted with the last frame, in order.
+    std::vector<XrCompositionLayerProjectionView> GetLastFrameProjectionViews();
+
+    // The downstream chain to hand to the layer (see XrApiLayerNextInfo).
+    XrResult XRAPI_CALL xrGetInstanceProcAddr(XrInstance instance, const char* name, PFN_xrVoidFunction* function);
+    XrResult XRAPI_CALL xrCreateApiLayerInstance(const XrInstanceCreateInfo* createInfo,
+                                                 const XrApiLayerCreateInfo* apiLayerInfo,
+                                                 XrInstance* instance);
+
+} // namespace openxr_api_layer::tests::mock_runtime
@@ -0,0 +1,112 @@
+// MIT License
+//
+// Copyright(c) 2022-2023 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "pch.h"
+
+namespace {
+
+    using namespace openxr_api_layer::testing;
+
+    struct Entry {
+        Kind kind;
+        const char* name;
+        void (*function)();
+    };
+
+    std::vector<Entry>& getEntries() {
+        static std::vector<Entry> entries;
+        return entries;
+    }
+
+} // namespace
+
+namespace openxr_api_layer::testing {
+
+    namespace internal {
+        volatile double g_sink;
+    } // namespace internal
+
+    Registration::Registration(Kind kind, const char* name, void (*function)()) {
+        getEntries().push_back({kind, name, function});
+    }
+
+    void Fail(const char* file, int line, const std::string& message) {
+        throw TestFailure(fmt::format("{}({}): {}", std::filesystem::path(file).filename().string(), line, message));
+    }
+
+    void Report(std::string_view label, double value, std::string_view unit) {
+        fmt::print("    {:<56} {:>12.1f} {}\n", label, value, unit);
+    }
+
+} // namespace openxr_api_layer::testing
+
+int main(int argc, char** argv) {
+    bool runBenchmarks = false;
+    std::vector<std::string_view> filters;
+    for (int i = 1; i < argc; i++) {
+        const std::string_view argument(argv[i]);
+        if (argument == "--benchmarks") {
+            runBenchmarks = true;
+        } else {
+            filters.push_back(argument);
+        }
+    }
+
+#ifdef _DEBUG
+    if (runBenchmarks) {
+        fmt::print("Warning: benchmarks of a Debug build are not representative\n");
+    }
+#endif
+
+    uint32_t ran = 0;
+    uint32_t failed = 0;
+    for (const Entry& entry : getEntries()) {
+        if ((entry.kind == Kind::Benchmark) != runBenchmarks) {
+            continue;
+        }
+        if (!filters.empty() && std::none_of(filters.cbegin(), filters.cend(), [&](std::string_view filter) {
+                return std::string_view(entry.name).find(filter) != std::string_view::npos;
+            })) {
+            continue;
+        }
+
+        fmt::print("[ RUN      ] {}\n", entry.name);
+        std::fflush(stdout);
+        try {
+            entry.function();
+            fmt::print("[       OK ] {}\n", entry.name);
+        } catch (TestFailure& failure) {
+            fmt::print("[  FAILED  ] {}: {}\n", entry.name, failure.what());
+            failed++;
+        } catch (std::exception& exc) {
+            fmt::print("[  FAILED  ] {}: unexpected exception: {}\n", entry.name, exc.what());
+            failed++;
+        }
+        std::fflush(stdout);
+        ran++;
+    }
+
+    fmt::print("{} of {} {} passed\n", ran - failed, ran, runBenchmarks ? "benchmarks" : "tests");
+
+    return failed ? 1 : 0;
+}
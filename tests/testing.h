@@ -0,0 +1,126 @@
+// MIT License
+//
+// Copyright(c) 2022-2023 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+// A minimal runner for the tests and benchmarks of the layer. Tests run by default, benchmarks only with --benchmarks
+// (their timings are only meaningful in Release builds). Any other argument selects the tests or benchmarks whose name
+// contains it.
+namespace openxr_api_layer::testing {
+
+    struct TestFailure : std::runtime_error {
+        using std::runtime_error::runtime_error;
+    };
+
+    enum class Kind {
+        Test,
+        Benchmark,
+    };
+
+    // Registers a test or a benchmark during static initialization (see TEST() and BENCHMARK()).
+    struct Registration {
+        Registration(Kind kind, const char* name, void (*function)());
+    };
+
+    [[noreturn]] void Fail(const char* file, int line, const std::string& message);
+
+    // Prints one measurement of a benchmark.
+    void Report(std::string_view label, double value, std::string_view unit);
+
+    namespace internal {
+        extern volatile double g_sink;
+    } // namespace internal
+
+    // Keeps a computation from being optimized away. Benchmarks accumulate their results and pass them here once, after
+    // the timed loop.
+    static inline void Consume(double value) {
+        internal::g_sink = value;
+    }
+
+    // Calls the function in batches until the duration elapsed, after a first batch to warm up the caches, and returns
+    // the mean time per call in nanoseconds.
+    template <typename Function>
+    double MeasureNanoseconds(Function&& function,
+                              uint32_t batchSize = 1000,
+                              std::chrono::milliseconds duration = 200ms) {
+        using clock = std::chrono::steady_clock;
+
+        for (uint32_t i = 0; i < batchSize; i++) {
+            function();
+        }
+
+        uint64_t calls = 0;
+        const auto start = clock::now();
+        auto now = start;
+        do {
+            for (uint32_t i = 0; i < batchSize; i++) {
+                function();
+            }
+            calls += batchSize;
+            now = clock::now();
+        } while (now - start < duration);
+
+        return std::chrono::duration<double, std::nano>(now - start).count() / calls;
+    }
+
+} // namespace openxr_api_layer::testing
+
+#define TEST(name)                                                                                                     \
+    static void name();                                                                                                \
+    static const openxr_api_layer::testing::Registration name##Registration(                                           \
+        openxr_api_layer::testing::Kind::Test, #name, &name);                                                          \
+    static void name()
+
+#define BENCHMARK(name)                                                                                                \
+    static void name();                                                                                                \
+    static const openxr_api_layer::testing::Registration name##Registration(                                           \
+        openxr_api_layer::testing::Kind::Benchmark, #name, &name);                                                     \
+    static void name()
+
+#define CHECK(condition)                                                                                               \
+    do {                                                                                                               \
+        if (!(condition)) {                                                                                            \
+            openxr_api_layer::testing::Fail(__FILE__, __LINE__, #condition);                                           \
+        }                                                                                                              \
+    } while (false)
+
+#define CHECK_NEAR(actual, expected, tolerance)                                                                        \
+    do {                                                                                                               \
+        const double actualValue = (actual);                                                                           \
+        const double expectedValue = (expected);                                                                       \
+        if (!(std::abs(actualValue - expectedValue) <= (tolerance))) {                                                 \
+            openxr_api_layer::testing::Fail(                                                                           \
+                __FILE__,                                                                                              \
+                __LINE__,                                                                                              \
+                fmt::format("{} is {}, expected {} +/- {}", #actual, actualValue, expectedValue, (tolerance)));        \
+        }                                                                                                              \
+    } while (false)
+
+#define CHECK_XR(call)                                                                                                 \
+    do {                                                                                                               \
+        const XrResult checkedResult = (call);                                                                         \
+        if (XR_FAILED(checkedResult)) {                                                                                \
+            openxr_api_layer::testing::Fail(                                                                           \
+                __FILE__, __LINE__, fmt::format("{} failed with {}", #call, xr::ToCString(checkedResult)));            \
+        }                                                                                                              \
+    } while (false)